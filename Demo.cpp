@@ -52,7 +52,7 @@ namespace Core {
         worldMatrix.multiply(rotationMatrixB);
 
         WeakPointer<Object3D> cameraOwner(cameraPtr->getOwner());
-        cameraOwner->getTransform().getLocalMatrix().copy(worldMatrix);
+        cameraOwner->getTransform().setLocalMatrix(worldMatrix);
       }
 
     });
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include <new>
 
 #include "Engine.h"
@@ -25,6 +26,14 @@
 
 namespace Core {
 
+    // drop the components in [components] whose owner is one of [owners]
+    template <typename T>
+    static void eraseOwnedComponents(std::vector<std::shared_ptr<T>>& components, const std::vector<const Object3D*>& owners) {
+        components.erase(std::remove_if(components.begin(), components.end(), [&owners](const std::shared_ptr<T>& component) {
+            return std::find(owners.begin(), owners.end(), component->getOwner().get()) != owners.end();
+        }), components.end());
+    }
+
     std::shared_ptr<Engine> Engine::_instance;
 
     WeakPointer<Engine> Engine::instance() {
@@ -107,6 +116,8 @@ namespace Core {
         for (auto func : this->persistentUpdateCallbacks) {
             func();
         }
+        this->textureStreamer.update();
+        this->assetStreamer.update();
     }
 
     void Engine::resolveRenderCallbacks(std::vector<LifecycleEventCallback>& oneTime, const std::vector<LifecycleEventCallback>& persistent) {
@@ -153,6 +164,18 @@ namespace Core {
         return this->modelLoader;
     }
 
+    TextureCache& Engine::getTextureCache() {
+        return this->textureCache;
+    }
+
+    AssetStreamer& Engine::getAssetStreamer() {
+        return this->assetStreamer;
+    }
+
+    TextureStreamer& Engine::getTextureStreamer() {
+        return this->textureStreamer;
+    }
+
     WeakPointer<Graphics> Engine::getGraphicsSystem() {
         return this->graphics;
     }
@@ -176,17 +199,73 @@ namespace Core {
         return newScene;
     }
 
+    /*
+     * Detach [object] from its parent and destroy it along with everything below it: the engine drops
+     * the objects, their renderers, cameras, lights and reflection probes, and their registry entries.
+     * Meshes and materials may be shared between objects, so they are left to destroyMesh() and
+     * destroyMaterial().
+     */
+    void Engine::destroyObject3D(WeakPointer<Object3D> object) {
+        WeakPointer<Object3D> parent = object->getParent();
+        if (parent.isValid()) parent->removeChild(object);
+
+        std::vector<const Object3D*> objects;
+        this->collectHierarchy(object, objects);
+        for (const Object3D* owner : objects) {
+            this->cameraRegistry.remove(owner);
+            this->lightRegistry.remove(owner);
+            this->reflectionProbeRegistry.remove(owner);
+            this->renderableContainerRegistry.remove(owner);
+        }
+        eraseOwnedComponents(this->objectRenderers, objects);
+        eraseOwnedComponents(this->cameras, objects);
+        eraseOwnedComponents(this->lights, objects);
+        eraseOwnedComponents(this->reflectionProbes, objects);
+        this->sceneObjects.erase(std::remove_if(this->sceneObjects.begin(), this->sceneObjects.end(), [&objects](const std::shared_ptr<Object3D>& sceneObject) {
+            return std::find(objects.begin(), objects.end(), sceneObject.get()) != objects.end();
+        }), this->sceneObjects.end());
+    }
+
+    void Engine::collectHierarchy(WeakPointer<Object3D> object, std::vector<const Object3D*>& objects) {
+        objects.push_back(object.get());
+        for (UInt32 i = 0; i < object->childCount(); i++) {
+            this->collectHierarchy(object->getChild(i), objects);
+        }
+    }
+
     WeakPointer<Mesh> Engine::createMesh(UInt32 size, UInt32 indexCount) {
+        return this->createMesh(size, indexCount, WeakPointer<Material>());
+    }
+
+    /*
+     * Create a mesh that will be drawn with [targetMaterial], so its vertex attributes can be
+     * laid out to match what that material consumes (see Mesh::init(WeakPointer<Material>)).
+     */
+    WeakPointer<Mesh> Engine::createMesh(UInt32 size, UInt32 indexCount, WeakPointer<Material> targetMaterial) {
         Mesh* newMeshPtr = new(std::nothrow) Mesh(this->graphics, size, indexCount);
         if (newMeshPtr == nullptr) {
             throw AllocationException("Engine::createMesh -> Unable to allocate new Mesh");
         }
         std::shared_ptr<Mesh> newMesh = std::shared_ptr<Mesh>(newMeshPtr);
-        newMesh->init();
+        newMesh->init(targetMaterial);
         this->meshes.push_back(newMesh);
         return newMesh;
     }
 
+    void Engine::destroyMesh(WeakPointer<Mesh> mesh) {
+        const Mesh* meshPtr = mesh.get();
+        this->meshes.erase(std::remove_if(this->meshes.begin(), this->meshes.end(), [meshPtr](const std::shared_ptr<Mesh>& entry) {
+            return entry.get() == meshPtr;
+        }), this->meshes.end());
+    }
+
+    void Engine::destroyMaterial(WeakPointer<Material> material) {
+        const Material* materialPtr = material.get();
+        this->materials.erase(std::remove_if(this->materials.begin(), this->materials.end(), [materialPtr](const std::shared_ptr<Material>& entry) {
+            return entry.get() == materialPtr;
+        }), this->materials.end());
+    }
+
     WeakPointer<Camera> Engine::createPerspectiveCamera(WeakPointer<Object3D> owner, Real fov, Real aspect, Real near, Real far) {
         std::shared_ptr<Camera> newCamera = std::shared_ptr<Camera>(Camera::createPerspectiveCamera(owner, fov, aspect, near, far));
         this->cameras.push_back(newCamera);
@@ -212,7 +291,11 @@ namespace Core {
     }
 
     void Engine::destroyTexture2D(WeakPointer<Texture2D> texture) {
-        this->graphics->destroyTexture2D(texture);
+        // textures shared through the cache stay alive until their last user releases them
+        if (this->textureCache.releaseTexture2D(texture)) {
+            this->textureStreamer.removeTexture(texture.get());
+            this->graphics->destroyTexture2D(texture);
+        }
     }
 
     void Engine::destroyCubeTexture(WeakPointer<CubeTexture> texture) {
@@ -266,4 +349,49 @@ namespace Core {
         if (!persistent) this->postRenderCallbacks.push_back(func);
         else this->persistentPostRenderCallbacks.push_back(func);
     }
-}
\ No newline at end of file
+
+    /*
+     * Called by Object3D::addComponent() for every component attached to an object, however
+     * it was created, so the renderer finds it in the registry for its type.
+     */
+    void Engine::registerComponent(WeakPointer<Object3DComponent> component, Object3D* owner) {
+        WeakPointer<Camera> camera = WeakPointer<Object3DComponent>::dynamicPointerCast<Camera>(component);
+        if (camera.isValid()) {
+            this->cameraRegistry.add(camera, owner);
+            return;
+        }
+        WeakPointer<ReflectionProbe> reflectionProbe = WeakPointer<Object3DComponent>::dynamicPointerCast<ReflectionProbe>(component);
+        if (reflectionProbe.isValid()) {
+            this->reflectionProbeRegistry.add(reflectionProbe, owner);
+            return;
+        }
+        WeakPointer<Light> light = WeakPointer<Object3DComponent>::dynamicPointerCast<Light>(component);
+        if (light.isValid()) {
+            this->lightRegistry.add(light, owner);
+        }
+    }
+
+    const ComponentRegistry<Camera>& Engine::getCameraRegistry() const {
+        return this->cameraRegistry;
+    }
+
+    const ComponentRegistry<Light>& Engine::getLightRegistry() const {
+        return this->lightRegistry;
+    }
+
+    const ComponentRegistry<ReflectionProbe>& Engine::getReflectionProbeRegistry() const {
+        return this->reflectionProbeRegistry;
+    }
+
+    const ComponentRegistry<BaseRenderableContainer>& Engine::getRenderableContainerRegistry() const {
+        return this->renderableContainerRegistry;
+    }
+
+    TransformStore& Engine::getTransformStore() {
+        return this->transformStore;
+    }
+
+    ThreadPool& Engine::getThreadPool() {
+        return this->threadPool;
+    }
+}
@@ -5,12 +5,19 @@
 
 #include "util/PersistentWeakPointer.h"
 #include "scene/Object3D.h"
+#include "scene/ComponentRegistry.h"
+#include "scene/TransformStore.h"
+#include "util/ThreadPool.h"
 #include "geometry/Mesh.h"
+#include "asset/AssetStreamer.h"
 #include "asset/ModelLoader.h"
 #include "geometry/Vector4.h"
 #include "image/TextureAttr.h"
+#include "image/TextureCache.h"
+#include "image/TextureStreamer.h"
 #include "material/Material.h"
 #include "material/MaterialLibrary.h"
+#include "render/BaseRenderableContainer.h"
 #include "render/RenderableContainer.h"
 #include "render/Renderer.h"
 #include "light/Light.h"
@@ -30,6 +37,8 @@ namespace Core {
     class ReflectionProbe;
 
     class Engine final {
+        friend class Object3D;
+
     public:
         typedef std::function<void()> LifecycleEventCallback;
 
@@ -46,6 +55,9 @@ namespace Core {
 
         MaterialLibrary& getMaterialLibrary();
         ModelLoader& getModelLoader();
+        TextureCache& getTextureCache();
+        AssetStreamer& getAssetStreamer();
+        TextureStreamer& getTextureStreamer();
 
         WeakPointer<Graphics> getGraphicsSystem();
 
@@ -95,10 +107,15 @@ namespace Core {
             objPtr->_self = _temp;
             objPtr->setName("GameObject");
             this->sceneObjects.push_back(objPtr);
+            this->registerObject3D(objPtr, std::is_base_of<BaseRenderableContainer, T>());
             return objPtr;
         }
 
+        void destroyObject3D(WeakPointer<Object3D> object);
+
         WeakPointer<Mesh> createMesh(UInt32 size, UInt32 indexCount);
+        WeakPointer<Mesh> createMesh(UInt32 size, UInt32 indexCount, WeakPointer<Material> targetMaterial);
+        void destroyMesh(WeakPointer<Mesh> mesh);
 
         template <typename T, typename R>
         WeakPointer<typename std::enable_if<std::is_base_of<ObjectRenderer<R>, T>::value, T>::type> createRenderer(WeakPointer<Material> material,
@@ -119,6 +136,8 @@ namespace Core {
             return materialPtr;
         }
 
+        void destroyMaterial(WeakPointer<Material> material);
+
         WeakPointer<Texture2D> createTexture2D(const TextureAttributes& attributes);
         WeakPointer<CubeTexture> createCubeTexture(const TextureAttributes& attributes);
         void destroyTexture2D(WeakPointer<Texture2D> texture);
@@ -137,16 +156,40 @@ namespace Core {
         void onPreRender(LifecycleEventCallback func, Bool persistent = false);
         void onPostRender(LifecycleEventCallback func, Bool persistent = false);
 
+        const ComponentRegistry<Camera>& getCameraRegistry() const;
+        const ComponentRegistry<Light>& getLightRegistry() const;
+        const ComponentRegistry<ReflectionProbe>& getReflectionProbeRegistry() const;
+        const ComponentRegistry<BaseRenderableContainer>& getRenderableContainerRegistry() const;
+        TransformStore& getTransformStore();
+        ThreadPool& getThreadPool();
+
     private:
         Engine();
         void init();
         void cleanup();
         void resolveRenderCallbacks(std::vector<LifecycleEventCallback>& oneTime, const std::vector<LifecycleEventCallback>& persistent);
+        void registerComponent(WeakPointer<Object3DComponent> component, Object3D* owner);
+        void collectHierarchy(WeakPointer<Object3D> object, std::vector<const Object3D*>& objects);
+
+        template <typename T>
+        void registerObject3D(std::shared_ptr<T> object, std::true_type isRenderableContainer) {
+            WeakPointer<T> objectPtr = object;
+            object->renderableContainer = object.get();
+            this->renderableContainerRegistry.add(objectPtr, object.get());
+        }
+
+        template <typename T>
+        void registerObject3D(std::shared_ptr<T> object, std::false_type isRenderableContainer) {
+        }
 
         static std::shared_ptr<Engine> _instance;
         
         std::shared_ptr<Graphics> graphics;
 
+        // declared ahead of the scene object containers so it outlives every Transform
+        TransformStore transformStore;
+        ThreadPool threadPool;
+
         std::vector<std::shared_ptr<Scene>> scenes;
         std::shared_ptr<Scene> activeScene;
         std::vector<std::shared_ptr<Camera>> cameras;
@@ -157,6 +200,11 @@ namespace Core {
         std::vector<std::shared_ptr<Mesh>> meshes;
         std::vector<std::shared_ptr<ReflectionProbe>> reflectionProbes;
 
+        ComponentRegistry<Camera> cameraRegistry;
+        ComponentRegistry<Light> lightRegistry;
+        ComponentRegistry<ReflectionProbe> reflectionProbeRegistry;
+        ComponentRegistry<BaseRenderableContainer> renderableContainerRegistry;
+
         PersistentWeakPointer<ImageLoader> imageLoader;
         PersistentWeakPointer<AssetLoader> assetLoader;
         std::vector<LifecycleEventCallback> updateCallbacks;
@@ -168,6 +216,10 @@ namespace Core {
 
         MaterialLibrary materialLibrary;
         ModelLoader modelLoader;
+        TextureCache textureCache;
+        TextureStreamer textureStreamer;
+        // declared last so its streaming threads stop before anything they load into goes away
+        AssetStreamer assetStreamer;
         
     };
 }
@@ -0,0 +1,242 @@
+#include <string.h>
+
+#include "AttributeArrayGPUStorageGL.h"
+#include "GraphicsGL.h"
+#include "../common/Exception.h"
+#include "../geometry/AttributeEncoder.h"
+
+namespace Core {
+
+    AttributeArrayGPUStorageGL::AttributeArrayGPUStorageGL(UInt32 size, UInt32 componentCount, AttributeType attributeType, GLboolean normalize,
+                                                           GLsizei stride, GPUStorageUsage usage, Bool immutableStorageSupported):
+        size(size), componentCount(componentCount), bufferID(0), attributeType(attributeType), type(GraphicsGL::convertAttributeType(attributeType)),
+        normalize(normalize), stride(stride), offset(0), usage(usage), immutableStorageSupported(immutableStorageSupported),
+        allocated(false), immutable(false), mappedRing(nullptr), ringIndex(0), ringCopyInUse(false) {
+        for (UInt32 i = 0; i < RingSize; i++) this->ringFences[i] = 0;
+        initLayout();
+        buildGPUBuffer();
+    }
+
+    AttributeArrayGPUStorageGL::AttributeArrayGPUStorageGL(UInt32 size, UInt32 componentCount, AttributeType attributeType, GLboolean normalize,
+                                                           std::shared_ptr<InterleavedAttributeBufferGL> interleavedBuffer, UInt32 offset):
+        size(size), componentCount(componentCount), bufferID(0), attributeType(attributeType), type(GraphicsGL::convertAttributeType(attributeType)),
+        normalize(normalize), stride(interleavedBuffer->getStride()), offset(offset), interleavedBuffer(interleavedBuffer),
+        usage(interleavedBuffer->getUsage()), immutableStorageSupported(false), allocated(true), immutable(false),
+        mappedRing(nullptr), ringIndex(0), ringCopyInUse(false) {
+        for (UInt32 i = 0; i < RingSize; i++) this->ringFences[i] = 0;
+        initLayout();
+    }
+
+    AttributeArrayGPUStorageGL::~AttributeArrayGPUStorageGL() {
+        destroyGPUBuffer();
+    }
+
+    Int32 AttributeArrayGPUStorageGL::getBufferID() const {
+        if (this->interleavedBuffer) return this->interleavedBuffer->getBufferID();
+        return this->bufferID;
+    }
+
+    GLenum AttributeArrayGPUStorageGL::getType() const {
+        return this->type;
+    }
+
+    GLboolean AttributeArrayGPUStorageGL::shouldNormalize() const {
+        return this->normalize;
+    }
+
+    GLsizei AttributeArrayGPUStorageGL::getStride() const {
+        return stride;
+    }
+
+    void AttributeArrayGPUStorageGL::flush() {
+        if (this->interleavedBuffer) this->interleavedBuffer->upload();
+    }
+
+    void AttributeArrayGPUStorageGL::prepareForDraw(UInt32 location) {
+        this->flush();
+        // the current ring copy moves with every write, so the recorded pointer goes stale
+        if (this->mappedRing) this->pointAttribute(location);
+    }
+
+    void AttributeArrayGPUStorageGL::sendToShader(UInt32 location) {
+        this->flush();
+        glEnableVertexAttribArray(location);
+        this->pointAttribute(location);
+    }
+
+    void AttributeArrayGPUStorageGL::updateBufferData(void * data) {
+        this->updateBufferData(data, 0, this->size);
+    }
+
+    /*
+     * [data] points at the start of the whole attribute array; only bytes [offset, offset + size)
+     * of it have changed.
+     */
+    void AttributeArrayGPUStorageGL::updateBufferData(void * data, UInt32 offset, UInt32 size) {
+        if (offset >= this->size || this->elementCount == 0) return;
+        if (size > this->size - offset) size = this->size - offset;
+
+        UInt32 sourceElementSize = this->componentCount * sizeof(Real);
+        UInt32 first = offset / sourceElementSize;
+        UInt32 count = (offset + size + sourceElementSize - 1) / sourceElementSize - first;
+
+        if (this->interleavedBuffer) {
+            const Byte* encodedData = this->encode(data, first, count);
+            this->interleavedBuffer->storeAttribute(encodedData, this->offset, this->gpuElementSize, first, count);
+            this->releaseEncodeScratch();
+            return;
+        }
+
+        if (this->mappedRing) {
+            // every ring copy must hold the complete data, so the whole array is written
+            if (this->writeRing(this->encode(data, 0, this->elementCount))) return;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, this->bufferID);
+        if (!this->allocated) {
+            const Byte* encodedData = this->encode(data, 0, this->elementCount);
+            if (this->usage == GPUStorageUsage::Static && this->immutableStorageSupported) {
+                glBufferStorage(GL_ARRAY_BUFFER, this->gpuSize, encodedData, GL_DYNAMIC_STORAGE_BIT);
+                this->immutable = true;
+            }
+            else {
+                glBufferData(GL_ARRAY_BUFFER, this->gpuSize, encodedData, GraphicsGL::getGLBufferUsage(this->usage));
+            }
+            this->allocated = true;
+        }
+        else if (!this->immutable && count >= this->elementCount / 2) {
+            // respecifying the whole store lets the driver orphan the old one instead of stalling
+            const Byte* encodedData = this->encode(data, 0, this->elementCount);
+            glBufferData(GL_ARRAY_BUFFER, this->gpuSize, encodedData, GraphicsGL::getGLBufferUsage(this->usage));
+        }
+        else {
+            const Byte* encodedData = this->encode(data, first, count);
+            glBufferSubData(GL_ARRAY_BUFFER, first * this->gpuElementSize, count * this->gpuElementSize, encodedData + first * this->gpuElementSize);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        this->releaseEncodeScratch();
+    }
+
+    void AttributeArrayGPUStorageGL::initLayout() {
+        UInt32 sourceElementSize = this->componentCount * sizeof(Real);
+        this->elementCount = sourceElementSize > 0 ? this->size / sourceElementSize : 0;
+        this->gpuElementSize = this->componentCount * AttributeEncoder::getComponentSize(this->attributeType);
+        this->gpuSize = this->elementCount * this->gpuElementSize;
+    }
+
+    /*
+     * Encode elements [first, first + count) of [data] into the GPU format. The result is laid
+     * out like the whole array (element i at i * gpuElementSize), so the returned pointer is
+     * the base of the encoded array, not of the range. It lives in [encodeScratch] and is only
+     * valid until the upload that follows.
+     */
+    const Byte* AttributeArrayGPUStorageGL::encode(const void* data, UInt32 first, UInt32 count) {
+        if (this->attributeType == AttributeType::Float && sizeof(Real) == sizeof(float)) return (const Byte*)data;
+
+        if (this->encodeScratch.size() != this->gpuSize) this->encodeScratch.resize(this->gpuSize);
+        const Real* source = (const Real*)data + first * this->componentCount;
+        AttributeEncoder::encode(source, this->componentCount, this->attributeType, this->encodeScratch.data() + first * this->gpuElementSize, count);
+        return this->encodeScratch.data();
+    }
+
+    /*
+     * Static data is rarely uploaded more than once, so the scratch space is freed after an
+     * upload rather than kept around as a second CPU copy of the attribute.
+     */
+    void AttributeArrayGPUStorageGL::releaseEncodeScratch() {
+        if (this->usage == GPUStorageUsage::Static) std::vector<Byte>().swap(this->encodeScratch);
+    }
+
+    void AttributeArrayGPUStorageGL::buildGPUBuffer() {
+        glGenBuffers(1, &this->bufferID);
+        if (this->usage == GPUStorageUsage::Stream && this->immutableStorageSupported && this->gpuSize > 0) {
+            if (!this->buildRing()) {
+                // the failed attempt left immutable storage behind, start over with a plain buffer
+                glDeleteBuffers(1, &this->bufferID);
+                glGenBuffers(1, &this->bufferID);
+            }
+        }
+    }
+
+    Bool AttributeArrayGPUStorageGL::buildRing() {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBindBuffer(GL_ARRAY_BUFFER, this->bufferID);
+        glBufferStorage(GL_ARRAY_BUFFER, this->gpuSize * RingSize, nullptr, flags);
+        this->mappedRing = (Byte*)glMapBufferRange(GL_ARRAY_BUFFER, 0, this->gpuSize * RingSize, flags);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        this->allocated = this->mappedRing != nullptr;
+        return this->allocated;
+    }
+
+    void AttributeArrayGPUStorageGL::destroyGPUBuffer() {
+        for (UInt32 i = 0; i < RingSize; i++) {
+            if (this->ringFences[i]) {
+                glDeleteSync(this->ringFences[i]);
+                this->ringFences[i] = 0;
+            }
+        }
+        if (this->mappedRing) {
+            glBindBuffer(GL_ARRAY_BUFFER, this->bufferID);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            this->mappedRing = nullptr;
+        }
+        if (this->bufferID > 0) glDeleteBuffers(1, &this->bufferID);
+    }
+
+    /*
+     * Write [data] (already in the GPU format) into the current ring copy. If that copy may
+     * already be referenced by a draw, fence it and move on to the next copy, waiting for the
+     * GPU to release it first. The wait is bounded by [RingWaitTimeout]; if it runs out or the
+     * wait fails, the ring is released and false is returned so the caller can fall back to
+     * respecifying a plain buffer.
+     */
+    Bool AttributeArrayGPUStorageGL::writeRing(const void* data) {
+        if (this->ringCopyInUse) {
+            if (this->ringFences[this->ringIndex]) glDeleteSync(this->ringFences[this->ringIndex]);
+            this->ringFences[this->ringIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            this->ringIndex = (this->ringIndex + 1) % RingSize;
+
+            GLsync fence = this->ringFences[this->ringIndex];
+            if (fence) {
+                GLenum result = GL_TIMEOUT_EXPIRED;
+                for (UInt32 i = 0; i < RingWaitTimeout / RingWaitInterval && result == GL_TIMEOUT_EXPIRED; i++) {
+                    result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, RingWaitInterval);
+                }
+                if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+                    this->releaseRing();
+                    return false;
+                }
+                glDeleteSync(fence);
+                this->ringFences[this->ringIndex] = 0;
+            }
+            this->ringCopyInUse = false;
+        }
+        memcpy(this->mappedRing + this->ringIndex * this->gpuSize, data, this->gpuSize);
+        return true;
+    }
+
+    /*
+     * Give up on the persistently mapped ring and replace it with an unallocated plain buffer,
+     * which updateBufferData() then fills (and orphans on later updates) with glBufferData().
+     */
+    void AttributeArrayGPUStorageGL::releaseRing() {
+        this->destroyGPUBuffer();
+        this->ringIndex = 0;
+        this->ringCopyInUse = false;
+        this->allocated = false;
+        glGenBuffers(1, &this->bufferID);
+        this->renewSerial();
+    }
+
+    void AttributeArrayGPUStorageGL::pointAttribute(UInt32 location) {
+        size_t dataOffset = this->offset;
+        if (this->mappedRing) {
+            dataOffset += this->ringIndex * this->gpuSize;
+            this->ringCopyInUse = true;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, this->getBufferID());
+        glVertexAttribPointer(location, this->componentCount, this->type, this->normalize, this->stride, (const GLvoid*)dataOffset);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
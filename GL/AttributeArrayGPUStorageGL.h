@@ -1,69 +1,90 @@
 #pragma once
 
-#include <string.h>
-#include <new>
+#include <memory>
+#include <vector>
 
 #include "../geometry/AttributeArrayGPUStorage.h"
+#include "../geometry/AttributeType.h"
+#include "../geometry/GPUStorageUsage.h"
 #include "../common/types.h"
 #include "../common/gl.h"
+#include "InterleavedAttributeBufferGL.h"
 
 namespace Core {
 
+    /*
+     * GPU side of an AttributeArray. It either owns a dedicated buffer, or it is one attribute
+     * slot ([offset] bytes into each vertex) of a shared InterleavedAttributeBufferGL. The source
+     * data is always Real; when [attributeType] is a more compact format the data is encoded
+     * on upload.
+     *
+     * A dedicated buffer is filled according to its usage: static data goes into immutable
+     * storage when available, dynamic data is updated in place with glBufferSubData() for small
+     * ranges, and streamed data is written into a persistently mapped ring of [RingSize] copies,
+     * so the CPU never writes a copy the GPU may still be reading.
+     */
     class AttributeArrayGPUStorageGL final: public AttributeArrayGPUStorage {
     public:
-        AttributeArrayGPUStorageGL(UInt32 size, UInt32 componentCount, GLenum type, GLboolean normalize, GLsizei stride): 
-            size(size), componentCount(componentCount), type(type), normalize(normalize), stride(stride) {
-            buildGPUBuffer();
-        }
+        static const UInt32 RingSize = 3;
+        // how long, in nanoseconds, a write waits for the GPU to release a ring copy, and in what steps
+        static const UInt64 RingWaitTimeout = 100000000;
+        static const UInt64 RingWaitInterval = 1000000;
 
-        ~AttributeArrayGPUStorageGL() {
-            destroyGPUBuffer();
-        }
+        AttributeArrayGPUStorageGL(UInt32 size, UInt32 componentCount, AttributeType attributeType, GLboolean normalize, GLsizei stride,
+                                   GPUStorageUsage usage, Bool immutableStorageSupported);
+        AttributeArrayGPUStorageGL(UInt32 size, UInt32 componentCount, AttributeType attributeType, GLboolean normalize,
+                                   std::shared_ptr<InterleavedAttributeBufferGL> interleavedBuffer, UInt32 offset);
+        ~AttributeArrayGPUStorageGL();
 
-        Int32 getBufferID() const override {
-            return this->bufferID;
-        }
+        Int32 getBufferID() const override;
+        GLenum getType() const;
+        GLboolean shouldNormalize() const;
+        GLsizei getStride() const;
 
-        GLenum getType() const {
-            return this->type;
-        }
-
-        GLboolean shouldNormalize() const {
-            return this->normalize;
-        }
-
-        GLsizei getStride() const {
-            return stride;
-        }
-
-        void sendToShader(UInt32 location) override {
-            glBindBuffer(GL_ARRAY_BUFFER, this->bufferID);
-            glEnableVertexAttribArray(location);
-            glVertexAttribPointer(location, this->componentCount, this->type, this->normalize, this->stride, 0);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-        }
-
-        void updateBufferData(void * data) override {
-            glBindBuffer(GL_ARRAY_BUFFER, this->bufferID);
-            glBufferData(GL_ARRAY_BUFFER, this->size, data, GL_DYNAMIC_DRAW);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-        }
+        void flush() override;
+        void prepareForDraw(UInt32 location) override;
+        void sendToShader(UInt32 location) override;
+        void updateBufferData(void * data) override;
+        void updateBufferData(void * data, UInt32 offset, UInt32 size) override;
 
     private:
+        // size in bytes of the Real source data
         UInt32 size;
         UInt32 componentCount;
         GLuint bufferID;
+        AttributeType attributeType;
         GLenum type;
         GLboolean normalize;
         GLsizei stride;
+        UInt32 offset;
+        std::shared_ptr<InterleavedAttributeBufferGL> interleavedBuffer;
+
+        UInt32 elementCount;
+        UInt32 gpuElementSize;
+        UInt32 gpuSize;
+        // space the source data is encoded in on its way to the GPU, when the GPU format differs from Real
+        std::vector<Byte> encodeScratch;
 
-        void buildGPUBuffer() {
-            glGenBuffers(1, &this->bufferID);
-        }
+        GPUStorageUsage usage;
+        Bool immutableStorageSupported;
+        Bool allocated;
+        Bool immutable;
 
-        void destroyGPUBuffer() {
-            glDeleteBuffers(1, &this->bufferID);
-        }
+        // persistently mapped ring, only used for streamed data
+        Byte* mappedRing;
+        UInt32 ringIndex;
+        GLsync ringFences[RingSize];
+        // whether the current ring copy may have been referenced by a draw since it was written
+        Bool ringCopyInUse;
 
+        void initLayout();
+        const Byte* encode(const void* data, UInt32 first, UInt32 count);
+        void releaseEncodeScratch();
+        void buildGPUBuffer();
+        Bool buildRing();
+        void destroyGPUBuffer();
+        Bool writeRing(const void* data);
+        void releaseRing();
+        void pointAttribute(UInt32 location);
     };
 }
@@ -7,6 +7,8 @@
 #include "../common/Exception.h"
 #include "../common/gl.h"
 #include "../image/RawImage.h"
+#include "../image/CompressedImage.h"
+#include "../image/MipChainBuilder.h"
 
 namespace Core {
 
@@ -23,7 +25,23 @@ namespace Core {
                                         WeakPointer<StandardImage> left, WeakPointer<StandardImage> right) {
         if (this->attributes.Format != TextureFormat::RGBA8) {
             throw TextureException("CubeTextureGL::build() -> Textures built with StandardImage must have type RGBA8.");
-        }                  
+        }
+        if (this->attributes.MipLevels > 1) {
+            // color faces, filtered as sRGB like in Texture2DGL::buildFromImage()
+            const StandardImage* faces[6] = {front.get(), back.get(), top.get(), bottom.get(), left.get(), right.get()};
+            std::vector<std::shared_ptr<StandardImage>> mipLevels[6];
+            MipChainBuilder::Settings mipSettings;
+            mipSettings.sRGB = true;
+            mipSettings.maxLevels = this->attributes.MipLevels;
+            for (UInt32 i = 0; i < 6; i++) {
+                if (faces[i]->getWidth() != front->getWidth() || faces[i]->getHeight() != front->getHeight()) {
+                    throw TextureException("CubeTextureGL::build() -> All faces must have the same size.");
+                }
+                mipLevels[i] = MipChainBuilder::buildMipChain(*faces[i], mipSettings, &Engine::instance()->getThreadPool());
+            }
+            this->setupMipChainTexture(faces, mipLevels);
+            return;
+        }
         this->setupTexture(front->getWidth(), front->getHeight(), 
                            front->getImageData(), back->getImageData(), 
                            top->getImageData(), bottom->getImageData(), 
@@ -42,16 +60,39 @@ namespace Core {
                            left->getImageBytes(), right->getImageBytes());
     }
 
+    void CubeTextureGL::buildFromCompressedImages(WeakPointer<CompressedImage> front, WeakPointer<CompressedImage> back,
+                                                  WeakPointer<CompressedImage> top, WeakPointer<CompressedImage> bottom,
+                                                  WeakPointer<CompressedImage> left, WeakPointer<CompressedImage> right) {
+        const CompressedImage* faces[6] = {front.get(), back.get(), top.get(), bottom.get(), left.get(), right.get()};
+        for (UInt32 i = 0; i < 6; i++) {
+            if (this->attributes.Format != faces[i]->getFormat()) {
+                throw TextureException("CubeTextureGL::build() -> Textures built with CompressedImage must have the images' format.");
+            }
+            if (faces[i]->getWidth() != front->getWidth() || faces[i]->getHeight() != front->getHeight() ||
+                faces[i]->getLevelCount() != front->getLevelCount()) {
+                throw TextureException("CubeTextureGL::build() -> All faces must have the same size and level count.");
+            }
+        }
+        this->setupCompressedTexture(faces);
+    }
+
     void CubeTextureGL::buildEmpty(UInt32 width, UInt32 height) {
         this->setupTexture(width, height, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
     }
 
     void CubeTextureGL::updateMipMaps() {
+        // the driver can't generate mip levels for block-compressed formats; they come with the images
+        if (CompressedImage::isCompressedFormat(this->attributes.Format)) return;
         glBindTexture(GL_TEXTURE_CUBE_MAP, this->getTextureID());
         glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
         glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
     }
 
+    /*
+     * Create the cube texture with storage for its faces and the levels MipLevels asks for, and upload the
+     * face images (if any) as level 0; see Texture2DGL::setupTexture(). Like there, only HDR and empty
+     * textures get their lower levels from the driver.
+     */
     void CubeTextureGL::setupTexture(UInt32 width, UInt32 height, Byte* front, Byte* back, Byte* top, Byte* bottom, Byte* left, Byte* right) {
         WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
         WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
@@ -65,36 +106,126 @@ namespace Core {
         }
         glBindTexture(GL_TEXTURE_CUBE_MAP, tex);
 
-        GLvoid * frontPixels = front != nullptr ? front : (GLvoid*)0;
-        GLvoid * backPixels = back != nullptr ? back : (GLvoid*)0;
-        GLvoid * topPixels = top != nullptr ? top : (GLvoid*)0;
-        GLvoid * bottomPixels = bottom != nullptr ? bottom : (GLvoid*)0;
-        GLvoid * leftPixels = left != nullptr ? left : (GLvoid*)0;
-        GLvoid * rightPixels = right != nullptr ? right : (GLvoid*)0;
+        const Byte* images[6] = {front, back, top, bottom, left, right};
+        const GLenum faces[6] = {GL_TEXTURE_CUBE_MAP_POSITIVE_Z, GL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
+                                 GL_TEXTURE_CUBE_MAP_POSITIVE_Y, GL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
+                                 GL_TEXTURE_CUBE_MAP_NEGATIVE_X, GL_TEXTURE_CUBE_MAP_POSITIVE_X};
+
+        if (attributes.IsDepthTexture) {
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        }
+
+        UInt32 levelCount = 1;
+        if (this->attributes.MipLevels > 1) {
+            levelCount = MipChainBuilder::getFullChainLevelCount(width, height);
+            if (this->attributes.MipLevels < levelCount) levelCount = this->attributes.MipLevels;
+        }
+        graphicsGL->allocateTextureStorage(GL_TEXTURE_CUBE_MAP, this->attributes, levelCount, width, height);
+        for (UInt32 i = 0; i < 6; i++) {
+            if (images[i] != nullptr && !attributes.IsDepthTexture) {
+                graphicsGL->uploadTextureLevel(faces[i], 0, attributes.Format, width, height, images[i]);
+            }
+        }
+
+        this->setTextureParameters();
+
+        if (this->attributes.MipLevels > 1) {
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_ANISOTROPY_EXT, levelCount - 1);
+            glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+        }
+
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        this->textureId = (Int32)tex;
+    }
+
+    /*
+     * Upload the levels of the six [faces] as they are; see Texture2DGL::setupCompressedTexture().
+     */
+    void CubeTextureGL::setupCompressedTexture(const CompressedImage* faces[6]) {
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
 
-        std::vector<GLvoid*> images = {frontPixels, backPixels, topPixels, bottomPixels, leftPixels, rightPixels};
-        std::vector<GLuint> faces = {GL_TEXTURE_CUBE_MAP_POSITIVE_Z, GL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
-                                     GL_TEXTURE_CUBE_MAP_POSITIVE_Y, GL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
-                                     GL_TEXTURE_CUBE_MAP_NEGATIVE_X, GL_TEXTURE_CUBE_MAP_POSITIVE_X};
+        GLuint tex;
+        glGenTextures(1, &tex);
+        if (!tex) {
+            throw AllocationException("CubeTextureGL::setupCompressedTexture -> Unable to generate texture");
+        }
+        glBindTexture(GL_TEXTURE_CUBE_MAP, tex);
 
-        GLint textureFormat = graphicsGL->getGLTextureFormat(attributes.Format);
-        GLenum pixelFormat = graphicsGL->getGLPixelFormat(attributes.Format);
-        GLenum pixelType = graphicsGL->getGLPixelType(attributes.Format);
+        const GLuint targets[6] = {GL_TEXTURE_CUBE_MAP_POSITIVE_Z, GL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
+                                   GL_TEXTURE_CUBE_MAP_POSITIVE_Y, GL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
+                                   GL_TEXTURE_CUBE_MAP_NEGATIVE_X, GL_TEXTURE_CUBE_MAP_POSITIVE_X};
 
+        UInt32 levelCount = faces[0]->getLevelCount();
+        if (attributes.MipLevels > 0 && attributes.MipLevels < levelCount) levelCount = attributes.MipLevels;
+        graphicsGL->allocateTextureStorage(GL_TEXTURE_CUBE_MAP, this->attributes, levelCount, faces[0]->getWidth(), faces[0]->getHeight());
         for (UInt32 i = 0; i < 6; i++) {
-             if (attributes.IsDepthTexture) {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
-                glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_TEXTURE_MODE, GL_INTENSITY);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+            for (UInt32 level = 0; level < levelCount; level++) {
+                graphicsGL->uploadTextureLevel(targets[i], level, attributes.Format, faces[i]->getLevelWidth(level), faces[i]->getLevelHeight(level),
+                                               faces[i]->getLevelData(level));
             }
-            else {
-                glTexImage2D(faces[i], 0, textureFormat, width, height, 0, pixelFormat, pixelType, images[i]);
+        }
+
+        this->setTextureParameters();
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        if (levelCount > 1) {
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_ANISOTROPY_EXT, levelCount - 1);
+        }
+
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        this->textureId = (Int32)tex;
+    }
+
+    /*
+     * Upload the six [faces] as level 0 and their [mipLevels] (as built by MipChainBuilder) as the levels
+     * below it; see Texture2DGL::setupMipChainTexture().
+     */
+    void CubeTextureGL::setupMipChainTexture(const StandardImage* faces[6], const std::vector<std::shared_ptr<StandardImage>> mipLevels[6]) {
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        GLuint tex;
+        glGenTextures(1, &tex);
+        if (!tex) {
+            throw AllocationException("CubeTextureGL::setupMipChainTexture -> Unable to generate texture");
+        }
+        glBindTexture(GL_TEXTURE_CUBE_MAP, tex);
+
+        const GLuint targets[6] = {GL_TEXTURE_CUBE_MAP_POSITIVE_Z, GL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
+                                   GL_TEXTURE_CUBE_MAP_POSITIVE_Y, GL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
+                                   GL_TEXTURE_CUBE_MAP_NEGATIVE_X, GL_TEXTURE_CUBE_MAP_POSITIVE_X};
+
+        UInt32 levelCount = (UInt32)mipLevels[0].size() + 1;
+        if (attributes.MipLevels > 0 && attributes.MipLevels < levelCount) levelCount = attributes.MipLevels;
+        graphicsGL->allocateTextureStorage(GL_TEXTURE_CUBE_MAP, this->attributes, levelCount, faces[0]->getWidth(), faces[0]->getHeight());
+        for (UInt32 i = 0; i < 6; i++) {
+            graphicsGL->uploadTextureLevel(targets[i], 0, attributes.Format, faces[i]->getWidth(), faces[i]->getHeight(), faces[i]->calcOffsetLocationBytes(0, 0));
+            for (UInt32 level = 1; level < levelCount; level++) {
+                const StandardImage& levelImage = *mipLevels[i][level - 1];
+                graphicsGL->uploadTextureLevel(targets[i], level, attributes.Format, levelImage.getWidth(), levelImage.getHeight(),
+                                               levelImage.calcOffsetLocationBytes(0, 0));
             }
         }
 
-        // set the relevant texture properties
-        
+        this->setTextureParameters();
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        if (levelCount > 1) {
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_ANISOTROPY_EXT, levelCount - 1);
+        }
+
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        this->textureId = (Int32)tex;
+    }
+
+    /*
+     * Set the filter and wrap modes of the bound cube texture.
+     */
+    void CubeTextureGL::setTextureParameters() {
         // set the filter mode. if bi-linear or tri-linear filtering is used,
         // we will be using mip-maps
         if (this->attributes.FilterMode == TextureFilter::Linear) {
@@ -117,15 +248,5 @@ namespace Core {
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-        if (this->attributes.MipLevels > 1) {
-            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, attributes.MipLevels - 1);
-            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_ANISOTROPY_EXT,  attributes.MipLevels - 1);
-            glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
-        }
-
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-
-        this->textureId = (Int32)tex;
     }
 }
\ No newline at end of file
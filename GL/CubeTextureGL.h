@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "../image/CubeTexture.h"
 #include "../image/RawImage.h"
 
@@ -19,11 +22,17 @@ namespace Core {
         void buildFromImages(WeakPointer<HDRImage> frontData, WeakPointer<HDRImage> backData, 
                              WeakPointer<HDRImage> topData,WeakPointer<HDRImage> bottomData, 
                              WeakPointer<HDRImage> leftData, WeakPointer<HDRImage> rightData) override;
+        void buildFromCompressedImages(WeakPointer<CompressedImage> frontData, WeakPointer<CompressedImage> backData,
+                                       WeakPointer<CompressedImage> topData, WeakPointer<CompressedImage> bottomData,
+                                       WeakPointer<CompressedImage> leftData, WeakPointer<CompressedImage> rightData) override;
         void buildEmpty(UInt32 width, UInt32 height) override;
         void updateMipMaps() override;
 
     private:
         CubeTextureGL(const TextureAttributes& attributes);
         void setupTexture(UInt32 width, UInt32 height, Byte* front, Byte* back, Byte* top, Byte* bottom, Byte* left, Byte* right);
+        void setupCompressedTexture(const CompressedImage* faces[6]);
+        void setupMipChainTexture(const StandardImage* faces[6], const std::vector<std::shared_ptr<StandardImage>> mipLevels[6]);
+        void setTextureParameters();
     };
 }
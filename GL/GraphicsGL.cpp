@@ -1,15 +1,22 @@
 #include <algorithm>
+#include <string.h>
 
 #include "../common/Exception.h"
+#include "../geometry/AttributeArrayGPUStorage.h"
+#include "../geometry/Mesh.h"
+#include "../material/Shader.h"
 #include "GraphicsGL.h"
 #include "AttributeArrayGPUStorageGL.h"
 #include "CubeTextureGL.h"
 #include "IndexBufferGL.h"
+#include "InterleavedAttributeBufferGL.h"
 #include "RendererGL.h"
 #include "ShaderGL.h"
 #include "Texture2DGL.h"
 #include "RenderTarget2DGL.h"
 #include "RenderTargetCubeGL.h"
+#include "TextureUploadRingGL.h"
+#include "../image/CompressedImage.h"
 
 namespace Core {
 
@@ -20,9 +27,18 @@ namespace Core {
 
     GraphicsGL::GraphicsGL(GLVersion version) : glVersion(version) {
         this->renderStyle = RenderStyle::Fill;
+        this->vertexArrayActive = false;
+        this->immutableStorageSupported = false;
+        this->textureStorageSupported = false;
+        this->copyImageSupported = false;
     }
 
     GraphicsGL::~GraphicsGL() {
+        if (this->textureUploadRing) this->textureUploadRing->destroy();
+        for (auto& entry : this->vertexArrays) {
+            glDeleteVertexArrays(1, &entry.second.vao);
+        }
+        this->vertexArrays.clear();
     }
 
     void GraphicsGL::init() {
@@ -37,6 +53,41 @@ namespace Core {
         this->currentRenderTarget = this->defaultRenderTarget;
         this->shaderDirectory.init();
 
+        // GL_MAJOR_VERSION, GL_NUM_EXTENSIONS and glGetStringi() only exist from GL 3.0, and the
+        // features probed for here are not used on a GL2 context
+        this->immutableStorageSupported = false;
+        this->textureStorageSupported = false;
+        this->copyImageSupported = false;
+        if (this->glVersion == GLVersion::Three) {
+            GLint majorVersion = 0, minorVersion = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+            glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+            this->immutableStorageSupported = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 4);
+            this->textureStorageSupported = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 2);
+            this->copyImageSupported = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 3);
+            if (!this->immutableStorageSupported || !this->textureStorageSupported || !this->copyImageSupported) {
+                GLint extensionCount = 0;
+                glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+                for (GLint i = 0; i < extensionCount; i++) {
+                    const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+                    if (!extension) continue;
+                    if (strcmp(extension, "GL_ARB_buffer_storage") == 0) this->immutableStorageSupported = true;
+                    else if (strcmp(extension, "GL_ARB_texture_storage") == 0) this->textureStorageSupported = true;
+                    else if (strcmp(extension, "GL_ARB_copy_image") == 0) this->copyImageSupported = true;
+                }
+            }
+        }
+
+        if (this->immutableStorageSupported) {
+            TextureUploadRingGL* ringPtr = new(std::nothrow) TextureUploadRingGL();
+            if (ringPtr == nullptr) {
+                throw AllocationException("GraphicsGL::init -> Unable to allocate texture upload ring.");
+            }
+            this->textureUploadRing = std::shared_ptr<TextureUploadRingGL>(ringPtr);
+            // without the ring, texture data is uploaded straight from client memory
+            if (!this->textureUploadRing->init(TextureUploadRingGL::DefaultSize)) this->textureUploadRing.reset();
+        }
+
         this->renderer = this->createRenderer();
         if (!this->sharedRenderState) {
             this->setupRenderState();
@@ -50,6 +101,7 @@ namespace Core {
     }
 
     void GraphicsGL::preRender() {
+        if (this->textureUploadRing) this->textureUploadRing->retire();
         if (!this->sharedRenderState) {
             this->saveState();
             this->setupRenderState();
@@ -106,6 +158,88 @@ namespace Core {
         }
     }
 
+    std::shared_ptr<StagedTextureData> GraphicsGL::stageTextureData(const Byte* data, UInt64 size) {
+        if (!this->textureUploadRing) return std::shared_ptr<StagedTextureData>();
+        return this->textureUploadRing->stage(data, size);
+    }
+
+    /*
+     * Give the bound texture at [target] (GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP) storage for [levelCount] levels
+     * of a [width] x [height] image. The storage is immutable when glTexStorage2D() is available; otherwise each
+     * level is specified with empty data, which leaves the texture just as complete.
+     */
+    void GraphicsGL::allocateTextureStorage(GLenum target, const TextureAttributes& attributes, UInt32 levelCount, UInt32 width, UInt32 height) {
+        GLenum textureFormat = attributes.IsDepthTexture ? GL_DEPTH_COMPONENT32 : (GLenum)GraphicsGL::getGLTextureFormat(attributes.Format);
+        if (this->textureStorageSupported) {
+            glTexStorage2D(target, levelCount, textureFormat, width, height);
+            return;
+        }
+
+        const GLenum cubeTargets[6] = {GL_TEXTURE_CUBE_MAP_POSITIVE_Z, GL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
+                                       GL_TEXTURE_CUBE_MAP_POSITIVE_Y, GL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
+                                       GL_TEXTURE_CUBE_MAP_NEGATIVE_X, GL_TEXTURE_CUBE_MAP_POSITIVE_X};
+        UInt32 targetCount = target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+        for (UInt32 level = 0; level < levelCount; level++) {
+            UInt32 levelWidth = (width >> level) > 0 ? width >> level : 1;
+            UInt32 levelHeight = (height >> level) > 0 ? height >> level : 1;
+            for (UInt32 i = 0; i < targetCount; i++) {
+                GLenum levelTarget = target == GL_TEXTURE_CUBE_MAP ? cubeTargets[i] : target;
+                if (attributes.IsDepthTexture) {
+                    glTexImage2D(levelTarget, level, textureFormat, levelWidth, levelHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+                }
+                else if (CompressedImage::isCompressedFormat(attributes.Format)) {
+                    glCompressedTexImage2D(levelTarget, level, textureFormat, levelWidth, levelHeight, 0,
+                                           (GLsizei)CompressedImage::calcLevelSizeBytes(attributes.Format, levelWidth, levelHeight), 0);
+                }
+                else {
+                    glTexImage2D(levelTarget, level, textureFormat, levelWidth, levelHeight, 0,
+                                 GraphicsGL::getGLPixelFormat(attributes.Format), GraphicsGL::getGLPixelType(attributes.Format), 0);
+                }
+            }
+        }
+    }
+
+    /*
+     * Fill [level] of the bound texture (or cube face) at [target], which already has storage, with [data]. The
+     * data is uploaded straight from client memory; staging it in the upload ring on this thread would only add
+     * a copy, so the ring is left to data staged on loader threads (see stageTextureData()).
+     */
+    void GraphicsGL::uploadTextureLevel(GLenum target, UInt32 level, TextureFormat format, UInt32 width, UInt32 height, const Byte* data) {
+        if (CompressedImage::isCompressedFormat(format)) {
+            glCompressedTexSubImage2D(target, level, 0, 0, width, height, GraphicsGL::getGLTextureFormat(format),
+                                      (GLsizei)CompressedImage::calcLevelSizeBytes(format, width, height), data);
+        }
+        else {
+            glTexSubImage2D(target, level, 0, 0, width, height, GraphicsGL::getGLPixelFormat(format), GraphicsGL::getGLPixelType(format), data);
+        }
+    }
+
+    /*
+     * Fill [level] of the bound texture at [target] with data staged by stageTextureData().
+     */
+    void GraphicsGL::uploadTextureLevel(GLenum target, UInt32 level, TextureFormat format, UInt32 width, UInt32 height, StagedTextureData& staged) {
+        if (!this->textureUploadRing) {
+            throw Exception("GraphicsGL::uploadTextureLevel -> No upload ring to upload staged data from.");
+        }
+        this->textureUploadRing->upload(staged, target, level, width, height, format);
+    }
+
+    Bool GraphicsGL::isTextureStorageSupported() const {
+        return this->textureStorageSupported;
+    }
+
+    Bool GraphicsGL::isCopyImageSupported() const {
+        return this->copyImageSupported;
+    }
+
+    /*
+     * Changing which levels of a streamed texture are allocated copies the loaded ones over with
+     * glCopyImageSubData().
+     */
+    Bool GraphicsGL::isTextureStreamingSupported() const {
+        return this->copyImageSupported;
+    }
+
     WeakPointer<Shader> GraphicsGL::createShader(const std::string& vertex, const std::string& fragment) {
         ShaderGL* shaderPtr = new(std::nothrow) ShaderGL(vertex, fragment);
         return this->addShader(shaderPtr);
@@ -140,9 +274,26 @@ namespace Core {
         glUseProgram(shader->getProgram());
     }
 
-    std::shared_ptr<AttributeArrayGPUStorage> GraphicsGL::createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize) const {
+    std::shared_ptr<AttributeArrayGPUStorage> GraphicsGL::createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize,
+                                                                           GPUStorageUsage usage) const {
+        AttributeArrayGPUStorageGL* gpuStorage =
+            new (std::nothrow) AttributeArrayGPUStorageGL(size, componentCount, type, normalize ? GL_TRUE : GL_FALSE, 0,
+                                                          usage, this->immutableStorageSupported);
+        if (gpuStorage == nullptr) {
+            throw AllocationException("GraphicsGL::createGPUStorage() -> Unable to allocate gpu buffer.");
+        }
+        std::shared_ptr<AttributeArrayGPUStorageGL> gpuStoragePtr(gpuStorage);
+        return gpuStoragePtr;
+    }
+
+    std::shared_ptr<AttributeArrayGPUStorage> GraphicsGL::createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize,
+                                                                           std::shared_ptr<InterleavedAttributeBuffer> interleavedBuffer, UInt32 offset) const {
+        std::shared_ptr<InterleavedAttributeBufferGL> interleavedBufferGL = std::dynamic_pointer_cast<InterleavedAttributeBufferGL>(interleavedBuffer);
+        if (!interleavedBufferGL) {
+            throw Exception("GraphicsGL::createGPUStorage() -> 'interleavedBuffer' is not an OpenGL buffer.");
+        }
         AttributeArrayGPUStorageGL* gpuStorage =
-            new (std::nothrow) AttributeArrayGPUStorageGL(size, componentCount, convertAttributeType(type), normalize ? GL_TRUE : GL_FALSE, 0);
+            new (std::nothrow) AttributeArrayGPUStorageGL(size, componentCount, type, normalize ? GL_TRUE : GL_FALSE, interleavedBufferGL, offset);
         if (gpuStorage == nullptr) {
             throw AllocationException("GraphicsGL::createGPUStorage() -> Unable to allocate gpu buffer.");
         }
@@ -150,6 +301,15 @@ namespace Core {
         return gpuStoragePtr;
     }
 
+    std::shared_ptr<InterleavedAttributeBuffer> GraphicsGL::createInterleavedAttributeBuffer(UInt32 vertexCount, UInt32 stride, GPUStorageUsage usage) const {
+        InterleavedAttributeBufferGL* buffer = new (std::nothrow) InterleavedAttributeBufferGL(vertexCount, stride, usage, this->immutableStorageSupported);
+        if (buffer == nullptr) {
+            throw AllocationException("GraphicsGL::createInterleavedAttributeBuffer() -> Unable to allocate interleaved buffer.");
+        }
+        std::shared_ptr<InterleavedAttributeBuffer> bufferPtr(buffer);
+        return bufferPtr;
+    }
+
     std::shared_ptr<IndexBuffer> GraphicsGL::createIndexBuffer(UInt32 size) const {
         IndexBufferGL* indexBuffer = new (std::nothrow) IndexBufferGL(size);
         if (indexBuffer == nullptr) {
@@ -160,6 +320,94 @@ namespace Core {
         return bufferPtr;
     }
 
+    /*
+     * GL_HALF_FLOAT vertex data and the current snorm conversion rules need GL 3, so a GL2
+     * context keeps every attribute in full-precision floats.
+     */
+    Bool GraphicsGL::areCompactAttributesSupported() const {
+        return this->glVersion == GLVersion::Three;
+    }
+
+    /*
+     * Compare the (location, storage serial) pairs a vertex array was recorded with against [bindings]
+     * without building a new signature, so a cache hit does not allocate.
+     */
+    static Bool signatureMatches(const std::vector<UInt64>& signature, const std::vector<VertexAttributeBinding>& bindings) {
+        if (signature.size() != bindings.size() * 2) return false;
+        for (UInt32 i = 0; i < bindings.size(); i++) {
+            if (signature[i * 2] != bindings[i].location) return false;
+            if (signature[i * 2 + 1] != bindings[i].storage->getSerial()) return false;
+        }
+        return true;
+    }
+
+    static void buildSignature(const std::vector<VertexAttributeBinding>& bindings, std::vector<UInt64>& signature) {
+        signature.clear();
+        for (auto& binding : bindings) {
+            signature.push_back(binding.location);
+            signature.push_back(binding.storage->getSerial());
+        }
+    }
+
+    /*
+     * Binds the vertex array object cached for [mesh] rendered with [shader]. Returns true if
+     * the cached VAO already describes [bindings], in which case no attribute needs to be sent.
+     * Otherwise a fresh VAO is bound and false is returned; the caller then sends each binding
+     * with sendToShader(), which the VAO records for the next draw. On GL2 no VAO is bound and
+     * false is always returned.
+     */
+    Bool GraphicsGL::activateVertexArray(WeakPointer<Mesh> mesh, WeakPointer<Shader> shader, const std::vector<VertexAttributeBinding>& bindings) {
+        if (this->glVersion != GLVersion::Three) return false;
+
+        VertexArrayKey key = {mesh.get(), shader->getProgram()};
+        auto result = this->vertexArrays.find(key);
+        if (result != this->vertexArrays.end()) {
+            CachedVertexArray& cached = result->second;
+            glBindVertexArray(cached.vao);
+            this->vertexArrayActive = true;
+            if (signatureMatches(cached.signature, bindings)) {
+                // a VAO only records buffer bindings, so pending uploads still have to go out
+                for (auto& binding : bindings) {
+                    WeakPointer<AttributeArrayGPUStorage> storage = binding.storage;
+                    storage->prepareForDraw(binding.location);
+                }
+                return true;
+            }
+            // re-record into the same VAO; the caller's sendToShader() calls replace the old bindings
+            for (UInt32 i = 0; i < cached.signature.size(); i += 2) {
+                glDisableVertexAttribArray((GLuint)cached.signature[i]);
+            }
+            buildSignature(bindings, cached.signature);
+            return false;
+        }
+
+        CachedVertexArray& cached = this->vertexArrays[key];
+        glGenVertexArrays(1, &cached.vao);
+        buildSignature(bindings, cached.signature);
+        glBindVertexArray(cached.vao);
+        this->vertexArrayActive = true;
+        return false;
+    }
+
+    void GraphicsGL::deactivateVertexArray() {
+        if (this->vertexArrayActive) {
+            glBindVertexArray(0);
+            this->vertexArrayActive = false;
+        }
+    }
+
+    void GraphicsGL::destroyVertexArrays(const Mesh* mesh) {
+        for (auto itr = this->vertexArrays.begin(); itr != this->vertexArrays.end();) {
+            if (itr->first.mesh == mesh) {
+                glDeleteVertexArrays(1, &itr->second.vao);
+                itr = this->vertexArrays.erase(itr);
+            }
+            else {
+                ++itr;
+            }
+        }
+    }
+
     void GraphicsGL::drawBoundVertexBuffer(UInt32 vertexCount) {
         glPolygonMode(GL_FRONT_AND_BACK, getGLRenderStyle(this->renderStyle));
         glDrawArrays(GL_TRIANGLES, 0, vertexCount);
@@ -167,8 +415,9 @@ namespace Core {
 
     void GraphicsGL::drawBoundVertexBuffer(UInt32 vertexCount, WeakPointer<IndexBuffer> indices) {
         glPolygonMode(GL_FRONT_AND_BACK, getGLRenderStyle(this->renderStyle));
+        GLenum indexType = indices->getIndexType() == IndexType::UnsignedShort ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices->getBufferID());
-        glDrawElements(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, (void*)(0));
+        glDrawElements(GL_TRIANGLES, vertexCount, indexType, (void*)(0));
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
@@ -590,6 +839,14 @@ namespace Core {
                 return GL_UNSIGNED_INT;
             case AttributeType::Int:
                 return GL_INT;
+            case AttributeType::HalfFloat:
+                return GL_HALF_FLOAT;
+            case AttributeType::Short:
+                return GL_SHORT;
+            case AttributeType::UnsignedShort:
+                return GL_UNSIGNED_SHORT;
+            case AttributeType::UnsignedByte:
+                return GL_UNSIGNED_BYTE;
         }
         return 0;
     }
@@ -615,6 +872,16 @@ namespace Core {
                 return GL_DEPTH_COMPONENT24;
             case TextureFormat::DEPTH32:
                 return GL_DEPTH_COMPONENT32;
+            case TextureFormat::BC1:
+                return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case TextureFormat::BC3:
+                return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case TextureFormat::BC4:
+                return GL_COMPRESSED_RED_RGTC1;
+            case TextureFormat::BC5:
+                return GL_COMPRESSED_RG_RGTC2;
+            case TextureFormat::BC7:
+                return GL_COMPRESSED_RGBA_BPTC_UNORM;
 
         }
 
@@ -638,7 +905,16 @@ namespace Core {
                 return GL_RG;
             case TextureFormat::DEPTH:
                 return GL_DEPTH_COMPONENT;
-
+            // block-compressed data is uploaded with glCompressedTexImage2D(), which takes no pixel format;
+            // this only matters when storage is allocated without data
+            case TextureFormat::BC1:
+            case TextureFormat::BC3:
+            case TextureFormat::BC4:
+            case TextureFormat::BC5:
+            case TextureFormat::BC7:
+                return GL_RGBA;
+            default:
+                break;
         }
 
         return GL_RGBA;
@@ -659,11 +935,42 @@ namespace Core {
                 return GL_FLOAT;
             case TextureFormat::RG16F:
                 return GL_FLOAT;
+            // see getGLPixelFormat()
+            case TextureFormat::BC1:
+            case TextureFormat::BC3:
+            case TextureFormat::BC4:
+            case TextureFormat::BC5:
+            case TextureFormat::BC7:
+                return GL_UNSIGNED_BYTE;
+            default:
+                break;
         }
 
         return GL_UNSIGNED_BYTE;
     }
 
+    /*
+     * Number of bytes glTexSubImage2D() (or glCompressedTexSubImage2D()) reads for a [width] x [height] level of
+     * [format], given the client pixel format and type the level is uploaded with. This is not the size of the
+     * level in video memory: RGBA16F, for example, is uploaded from 32-bit floats.
+     */
+    UInt64 GraphicsGL::getClientLevelSizeBytes(TextureFormat format, UInt32 width, UInt32 height) {
+        if (CompressedImage::isCompressedFormat(format)) return CompressedImage::calcLevelSizeBytes(format, width, height);
+
+        UInt64 channelCount = 4;
+        switch (GraphicsGL::getGLPixelFormat(format)) {
+            case GL_RED:
+            case GL_DEPTH_COMPONENT:
+                channelCount = 1;
+                break;
+            case GL_RG:
+                channelCount = 2;
+                break;
+        }
+        UInt64 channelSize = GraphicsGL::getGLPixelType(format) == GL_FLOAT ? 4 : 1;
+        return (UInt64)width * height * channelCount * channelSize;
+    }
+
     GLenum GraphicsGL::getGLRenderStyle(RenderStyle style) {
         switch(style) {
             case RenderStyle::Fill:
@@ -676,6 +983,18 @@ namespace Core {
         return GL_FILL;
     }
 
+    GLenum GraphicsGL::getGLBufferUsage(GPUStorageUsage usage) {
+        switch(usage) {
+            case GPUStorageUsage::Static:
+                return GL_STATIC_DRAW;
+            case GPUStorageUsage::Dynamic:
+                return GL_DYNAMIC_DRAW;
+            case GPUStorageUsage::Stream:
+                return GL_STREAM_DRAW;
+        }
+        return GL_STATIC_DRAW;
+    }
+
     GLenum GraphicsGL::getGLStencilFunction(RenderState::StencilFunction function) {
         switch (function) {
             case RenderState::StencilFunction::Never:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "../util/PersistentWeakPointer.h"
@@ -20,6 +21,7 @@ namespace Core {
     class RenderTargetGL;
     class RenderTarget2DGL;
     class RenderTargetCubeGL;
+    class TextureUploadRingGL;
 
     class GraphicsGL final : public Graphics {
         friend class Engine;
@@ -43,6 +45,14 @@ namespace Core {
         WeakPointer<CubeTexture> createCubeTexture(const TextureAttributes& attributes) override;
         void destroyTexture2D(WeakPointer<Texture2D> texture) override;
         void destroyCubeTexture(WeakPointer<CubeTexture> texture) override;
+        std::shared_ptr<StagedTextureData> stageTextureData(const Byte* data, UInt64 size) override;
+        Bool isTextureStreamingSupported() const override;
+
+        void allocateTextureStorage(GLenum target, const TextureAttributes& attributes, UInt32 levelCount, UInt32 width, UInt32 height);
+        void uploadTextureLevel(GLenum target, UInt32 level, TextureFormat format, UInt32 width, UInt32 height, const Byte* data);
+        void uploadTextureLevel(GLenum target, UInt32 level, TextureFormat format, UInt32 width, UInt32 height, StagedTextureData& staged);
+        Bool isTextureStorageSupported() const;
+        Bool isCopyImageSupported() const;
         
         WeakPointer<Shader> createShader(const std::string& vertex, const std::string& fragment) override;
         WeakPointer<Shader> createShader(const std::string& vertex, const std::string& geometry, const std::string& fragment) override;
@@ -50,8 +60,17 @@ namespace Core {
         WeakPointer<Shader> createShader(const char vertex[], const char geometry[], const char fragment[]) override;
         void activateShader(WeakPointer<Shader> shader) override;
 
-        std::shared_ptr<AttributeArrayGPUStorage> createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize) const override;
+        std::shared_ptr<AttributeArrayGPUStorage> createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize,
+                                                                   GPUStorageUsage usage) const override;
+        std::shared_ptr<AttributeArrayGPUStorage> createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize,
+                                                                   std::shared_ptr<InterleavedAttributeBuffer> interleavedBuffer, UInt32 offset) const override;
+        std::shared_ptr<InterleavedAttributeBuffer> createInterleavedAttributeBuffer(UInt32 vertexCount, UInt32 stride, GPUStorageUsage usage) const override;
         std::shared_ptr<IndexBuffer> createIndexBuffer(UInt32 size) const override;
+        Bool areCompactAttributesSupported() const override;
+
+        Bool activateVertexArray(WeakPointer<Mesh> mesh, WeakPointer<Shader> shader, const std::vector<VertexAttributeBinding>& bindings) override;
+        void deactivateVertexArray() override;
+        void destroyVertexArrays(const Mesh* mesh) override;
 
         void drawBoundVertexBuffer(UInt32 vertexCount) override;
         void drawBoundVertexBuffer(UInt32 vertexCount, WeakPointer<IndexBuffer> indices) override;
@@ -109,11 +128,36 @@ namespace Core {
         static GLint getGLTextureFormat(TextureFormat format);
         static GLenum getGLPixelFormat(TextureFormat format);
         static GLenum getGLPixelType(TextureFormat format);
+        static UInt64 getClientLevelSizeBytes(TextureFormat format, UInt32 width, UInt32 height);
         static GLenum getGLRenderStyle(RenderStyle style);
+        static GLenum getGLBufferUsage(GPUStorageUsage usage);
         static GLenum getGLStencilFunction(RenderState::StencilFunction function);
         static GLenum getGLStencilAction(RenderState::StencilAction action);
 
     private:
+        class VertexArrayKey {
+        public:
+            const Mesh* mesh;
+            UInt32 program;
+
+            Bool operator==(const VertexArrayKey& other) const {
+                return this->mesh == other.mesh && this->program == other.program;
+            }
+
+            typedef struct {
+                size_t operator()(const VertexArrayKey& key) const {
+                    return std::hash<const Mesh*>()(key.mesh) ^ (std::hash<UInt32>()(key.program) << 1);
+                }
+            } Hasher;
+        };
+
+        class CachedVertexArray {
+        public:
+            GLuint vao;
+            // (location, storage serial) pairs the vertex array was recorded with
+            std::vector<UInt64> signature;
+        };
+
         GraphicsGL(GLVersion version);
         std::shared_ptr<RendererGL> createRenderer();
         std::shared_ptr<RenderTarget2DGL> createDefaultRenderTarget();
@@ -121,6 +165,14 @@ namespace Core {
         void setupRenderState();
 
         GLVersion glVersion;
+        // glBufferStorage() (GL 4.4 or ARB_buffer_storage) is available
+        Bool immutableStorageSupported;
+        // glTexStorage2D() (GL 4.2 or ARB_texture_storage) is available
+        Bool textureStorageSupported;
+        // glCopyImageSubData() (GL 4.3 or ARB_copy_image) is available
+        Bool copyImageSupported;
+        // pixel unpack buffer texture data is staged in; only exists with immutable buffer storage
+        std::shared_ptr<TextureUploadRingGL> textureUploadRing;
         std::shared_ptr<RendererGL> renderer;
         std::vector<std::shared_ptr<Texture2DGL>> textures2D;
         std::vector<std::shared_ptr<CubeTextureGL>> cubeTextures;
@@ -131,6 +183,8 @@ namespace Core {
         PersistentWeakPointer<RenderTarget> currentRenderTarget;
         ShaderManagerGL shaderDirectory;
         RenderStyle renderStyle;
+        std::unordered_map<VertexArrayKey, CachedVertexArray, VertexArrayKey::Hasher> vertexArrays;
+        Bool vertexArrayActive;
 
         Vector4u _viewport;
         GLint _stateFrontFace;
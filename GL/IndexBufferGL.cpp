@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "IndexBufferGL.h"
 #include "../common/Exception.h"
 
@@ -35,7 +37,13 @@ namespace Core {
     void IndexBufferGL::setIndices(UInt32* indices) {
         IndexBuffer::setIndices(indices);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->bufferID);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->size * sizeof(UInt32), indices, GL_DYNAMIC_DRAW);
+        if (this->indexType == IndexType::UnsignedShort) {
+            std::vector<UInt16> shortIndices(indices, indices + this->size);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->size * sizeof(UInt16), shortIndices.data(), GL_DYNAMIC_DRAW);
+        }
+        else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->size * sizeof(UInt32), indices, GL_DYNAMIC_DRAW);
+        }
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
@@ -0,0 +1,63 @@
+#include "InterleavedAttributeBufferGL.h"
+#include "GraphicsGL.h"
+#include "../common/Exception.h"
+
+namespace Core {
+
+    InterleavedAttributeBufferGL::InterleavedAttributeBufferGL(UInt32 vertexCount, UInt32 stride, GPUStorageUsage usage, Bool immutableStorageSupported):
+        InterleavedAttributeBuffer(vertexCount, stride, usage), bufferID(0), immutableStorageSupported(immutableStorageSupported),
+        allocated(false), immutable(false) {
+        glGenBuffers(1, &this->bufferID);
+        if (!this->bufferID) {
+            throw AllocationException("InterleavedAttributeBufferGL::InterleavedAttributeBufferGL() -> Unable to generate vertex buffer.");
+        }
+    }
+
+    InterleavedAttributeBufferGL::~InterleavedAttributeBufferGL() {
+        if (this->bufferID > 0) {
+            glDeleteBuffers(1, &this->bufferID);
+            this->bufferID = 0;
+        }
+    }
+
+    Int32 InterleavedAttributeBufferGL::getBufferID() const {
+        return this->bufferID;
+    }
+
+    /*
+     * Attributes are stored one at a time, so the upload is deferred until the buffer is about
+     * to be drawn from and then done once for all of them. Only the dirty vertex range is sent,
+     * unless it covers most of the buffer, in which case mutable storage is respecified whole.
+     * Static buffers get immutable storage when the driver supports it.
+     */
+    void InterleavedAttributeBufferGL::upload() {
+        if (this->dirtyEnd <= this->dirtyFirst) return;
+
+        UInt32 totalSize = this->vertexCount * this->stride;
+        UInt32 dirtyOffset = this->dirtyFirst * this->stride;
+        UInt32 dirtySize = (this->dirtyEnd - this->dirtyFirst) * this->stride;
+
+        glBindBuffer(GL_ARRAY_BUFFER, this->bufferID);
+        if (!this->allocated) {
+            if (this->usage == GPUStorageUsage::Static && this->immutableStorageSupported) {
+                glBufferStorage(GL_ARRAY_BUFFER, totalSize, this->staging, GL_DYNAMIC_STORAGE_BIT);
+                this->immutable = true;
+            }
+            else {
+                glBufferData(GL_ARRAY_BUFFER, totalSize, this->staging, GraphicsGL::getGLBufferUsage(this->usage));
+            }
+            this->allocated = true;
+        }
+        else if (!this->immutable && dirtySize >= totalSize / 2) {
+            glBufferData(GL_ARRAY_BUFFER, totalSize, this->staging, GraphicsGL::getGLBufferUsage(this->usage));
+        }
+        else {
+            glBufferSubData(GL_ARRAY_BUFFER, dirtyOffset, dirtySize, this->staging + dirtyOffset);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        this->dirtyFirst = 0;
+        this->dirtyEnd = 0;
+    }
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../geometry/InterleavedAttributeBuffer.h"
+#include "../common/gl.h"
+
+namespace Core {
+
+    class InterleavedAttributeBufferGL final: public InterleavedAttributeBuffer {
+    public:
+        InterleavedAttributeBufferGL(UInt32 vertexCount, UInt32 stride, GPUStorageUsage usage, Bool immutableStorageSupported);
+        ~InterleavedAttributeBufferGL();
+        Int32 getBufferID() const override;
+        void upload() override;
+    private:
+        GLuint bufferID;
+        Bool immutableStorageSupported;
+        Bool allocated;
+        Bool immutable;
+    };
+
+}
@@ -683,8 +683,10 @@ namespace Core {
             "    tangent = normalize(tangent); \n "
             "    tangent = normalize(tangent - dot(tangent, normal) * normal); \n "
             "    vec3 biTangent = cross(tangent, normal); \n "
-            "    vec3 bumpMapNormal = mappedNormal; \n "
-            "    bumpMapNormal = 2.0 * bumpMapNormal - vec3(1.0, 1.0, 1.0); \n "
+            // z is rebuilt from x and y, so two-channel (BC5) normal maps work as well
+            "    vec3 bumpMapNormal; \n "
+            "    bumpMapNormal.xy = 2.0 * mappedNormal.xy - vec2(1.0, 1.0); \n "
+            "    bumpMapNormal.z = sqrt(max(1.0 - dot(bumpMapNormal.xy, bumpMapNormal.xy), 0.0)); \n "
             "    vec3 newNormal; \n "
             "    mat3 tbn = mat3(tangent, biTangent, normal); \n "
 
@@ -710,6 +712,13 @@ namespace Core {
             "}\n"
             "vec3 gammaCorrectCustom(vec3 color, float gamma) { \n"
             "    return pow(color, vec3(1.0 / gamma));\n"
+            "}\n"
+            // [region] is where a mirror-wrapped texture was packed into an atlas (see TextureAtlas); the wrapping
+            // is done here, with the derivatives of the unwrapped coordinates so mip selection isn't thrown off at the seams
+            "vec4 sampleMap(sampler2D map, vec2 uv, bool atlased, vec4 region) { \n"
+            "    if (!atlased) return texture(map, uv); \n"
+            "    vec2 mirrored = vec2(1.0) - abs(mod(uv, 2.0) - vec2(1.0)); \n"
+            "    return textureGrad(map, region.xy + mirrored * region.zw, dFdx(uv) * region.zw, dFdy(uv) * region.zw); \n"
             "}\n";
 
         this->Physical_Lighting_Single_vertex =
@@ -920,11 +929,16 @@ namespace Core {
             "#include \"PhysicalLightingSingle\"\n"
             + CAMERA_POSITION_DEF +
             "uniform int enabledMap; \n"
+            "uniform int atlasMap; \n"
             "uniform vec4 albedo; \n"
             "uniform sampler2D albedoMap; \n"
             "uniform sampler2D normalMap; \n"
             "uniform sampler2D roughnessMap; \n"
             "uniform sampler2D metallicMap; \n"
+            "uniform vec4 albedoMapRegion; \n"
+            "uniform vec4 normalMapRegion; \n"
+            "uniform vec4 roughnessMapRegion; \n"
+            "uniform vec4 metallicMapRegion; \n"
             "uniform float metallic; \n"
             "uniform float roughness; \n"
             "uniform float ambientOcclusion; \n"
@@ -943,26 +957,26 @@ namespace Core {
             "   int metallicMapEnabled = enabledMap & 8; \n"
             "   vec4 _albedo; \n"
             "   if (albedoMapEnabled != 0) { \n"
-            "       _albedo = texture(albedoMap, vAlbedoUV); \n"
+            "       _albedo = sampleMap(albedoMap, vAlbedoUV, (atlasMap & 1) != 0, albedoMapRegion); \n"
             "   } else { \n"
             "      _albedo = albedo; \n"
             "   } \n"
             "   vec3 _normal; \n"
             "   if (normalMapEnabled != 0) { \n"
-            "      _normal = calcMappedNormal(texture(normalMap, vNormalUV).xyz, vNormal, vTangent); \n"
+            "      _normal = calcMappedNormal(sampleMap(normalMap, vNormalUV, (atlasMap & 2) != 0, normalMapRegion).xyz, vNormal, vTangent); \n"
             "   } else { \n"
             "       _normal = normalize(vNormal); \n"
             "   } \n"
             "   float _roughness; \n"
             "   if (roughnessMapEnabled != 0) { \n"
-            "       vec3 fullRoughness = texture(roughnessMap, vAlbedoUV).rgb; \n"
+            "       vec3 fullRoughness = sampleMap(roughnessMap, vAlbedoUV, (atlasMap & 4) != 0, roughnessMapRegion).rgb; \n"
             "      _roughness = fullRoughness.r; \n"
             "   } else { \n"
             "       _roughness = roughness; \n"
             "   } \n"
             "   float _metallic; \n"
             "   if (metallicMapEnabled != 0) { \n"
-            "      vec4 fullMetallic = texture(metallicMap, vAlbedoUV); \n"
+            "      vec4 fullMetallic = sampleMap(metallicMap, vAlbedoUV, (atlasMap & 8) != 0, metallicMapRegion); \n"
             "      _metallic = fullMetallic.r; \n"
             "   } else { \n"
             "       _metallic = metallic; \n"
@@ -1013,9 +1027,12 @@ namespace Core {
             "#include \"PhysicalLightingSingle\"\n"
             + CAMERA_POSITION_DEF +
             "uniform int enabledMap; \n"
+            "uniform int atlasMap; \n"
             "uniform vec4 albedo; \n"
             "uniform sampler2D albedoMap; \n"
             "uniform sampler2D normalMap; \n"
+            "uniform vec4 albedoMapRegion; \n"
+            "uniform vec4 normalMapRegion; \n"
             "uniform float metallic; \n"
             "uniform float roughness; \n"
             "uniform float ambientOcclusion; \n"
@@ -1033,20 +1050,20 @@ namespace Core {
             "   int roughnessMapEnabled = enabledMap & 4; \n"
             "   vec4 _albedo; \n"
             "   if (albedoMapEnabled != 0) { \n"
-            "       _albedo = texture(albedoMap, vAlbedoUV); \n"
+            "       _albedo = sampleMap(albedoMap, vAlbedoUV, (atlasMap & 1) != 0, albedoMapRegion); \n"
             "   } else { \n"
             "      _albedo = albedo; \n"
             "   } \n"
             "   vec3 _normal; \n"
             "   if (normalMapEnabled != 0) { \n"
-            "      _normal = calcMappedNormal(texture(normalMap, vNormalUV).xyz, vNormal, vTangent); \n"
+            "      _normal = calcMappedNormal(sampleMap(normalMap, vNormalUV, (atlasMap & 2) != 0, normalMapRegion).xyz, vNormal, vTangent); \n"
             "   } else { \n"
             "       _normal = normalize(vNormal); \n"
             "   } \n"
             "    if (" + LIGHT_TYPE + "[0] == AMBIENT_IBL_LIGHT) { \n"
-            "       out_color = litColorPhysical(0, texture(albedoMap, vAlbedoUV), vWorldPos, _normal, " + CAMERA_POSITION + ", metallic, roughness, ambientOcclusion);\n"
+            "       out_color = litColorPhysical(0, _albedo, vWorldPos, _normal, " + CAMERA_POSITION + ", metallic, roughness, ambientOcclusion);\n"
             "   } else { \n"
-            "       out_color = litColorBlinnPhong(0, texture(albedoMap, vAlbedoUV), vWorldPos, _normal, " + CAMERA_POSITION + ");\n"
+            "       out_color = litColorBlinnPhong(0, _albedo, vWorldPos, _normal, " + CAMERA_POSITION + ");\n"
             "   } \n"
             "}\n";
         
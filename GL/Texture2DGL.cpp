@@ -3,6 +3,8 @@
 #include "../Engine.h"
 #include "../common/Exception.h"
 #include "../image/RawImage.h"
+#include "../image/CompressedImage.h"
+#include "../image/MipChainBuilder.h"
 
 namespace Core {
 
@@ -16,10 +18,24 @@ namespace Core {
         }
     }
 
+    /*
+     * Build the texture from [imageData]. Its mip levels, if MipLevels asks for any, are built on the CPU by
+     * MipChainBuilder. RGBA8 is the format color images (albedo maps, environment maps) are built in, so the
+     * levels are filtered as sRGB; linear data like normal maps comes with its own levels (see buildFromMipChain()).
+     */
     void Texture2DGL::buildFromImage(WeakPointer<StandardImage> imageData) {
         if (this->attributes.Format != TextureFormat::RGBA8) {
             throw TextureException("Texture2DGL::build() -> Textures built with StandardImage must have type RGBA8.");
         }
+        if (this->attributes.MipLevels > 1) {
+            MipChainBuilder::Settings mipSettings;
+            mipSettings.sRGB = true;
+            mipSettings.maxLevels = this->attributes.MipLevels;
+            std::vector<std::shared_ptr<StandardImage>> mipLevels = MipChainBuilder::buildMipChain(*imageData.get(), mipSettings,
+                                                                                                   &Engine::instance()->getThreadPool());
+            this->setupMipChainTexture(*imageData.get(), mipLevels);
+            return;
+        }
         this->setupTexture(imageData->getWidth(), imageData->getHeight(), imageData->getImageData());
     }
 
@@ -30,27 +46,281 @@ namespace Core {
         this->setupTexture(imageData->getWidth(), imageData->getHeight(), imageData->getImageBytes());
     }
       
+    void Texture2DGL::buildFromCompressedImage(WeakPointer<CompressedImage> imageData) {
+        if (this->attributes.Format != imageData->getFormat()) {
+            throw TextureException("Texture2DGL::build() -> Textures built with CompressedImage must have the image's format.");
+        }
+        this->setupCompressedTexture(*imageData.get());
+    }
+
+    void Texture2DGL::buildFromMipChain(WeakPointer<StandardImage> imageData, const std::vector<std::shared_ptr<StandardImage>>& mipLevels) {
+        if (this->attributes.Format != TextureFormat::RGBA8) {
+            throw TextureException("Texture2DGL::build() -> Textures built with StandardImage must have type RGBA8.");
+        }
+        this->setupMipChainTexture(*imageData.get(), mipLevels);
+    }
+
+    /*
+     * Build the texture from [levels], the full-size image first and every level below it in order, laid out
+     * the way the texture's format stores them. Levels that were staged on a loader thread are uploaded from
+     * the upload ring, the others from client memory. At most MipLevels levels are used.
+     */
+    void Texture2DGL::buildFromLevels(const std::vector<LevelData>& levels) {
+        if (levels.size() == 0 || levels[0].level != 0) {
+            throw TextureException("Texture2DGL::buildFromLevels() -> Levels must start with the full-size image.");
+        }
+        if (this->attributes.IsDepthTexture) {
+            throw TextureException("Texture2DGL::buildFromLevels() -> Depth textures can't be built from levels.");
+        }
+
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        GLuint tex = this->generateTexture();
+
+        UInt32 levelCount = (UInt32)levels.size();
+        if (attributes.MipLevels > 0 && attributes.MipLevels < levelCount) levelCount = attributes.MipLevels;
+        graphicsGL->allocateTextureStorage(GL_TEXTURE_2D, this->attributes, levelCount, levels[0].width, levels[0].height);
+        for (UInt32 level = 0; level < levelCount; level++) {
+            const LevelData& levelData = levels[level];
+            if (levelData.staged) {
+                graphicsGL->uploadTextureLevel(GL_TEXTURE_2D, level, attributes.Format, levelData.width, levelData.height, *levelData.staged);
+            }
+            else {
+                graphicsGL->uploadTextureLevel(GL_TEXTURE_2D, level, attributes.Format, levelData.width, levelData.height, levelData.data.data());
+            }
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        if (levelCount > 1) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, levelCount - 1);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        this->textureId = (Int32)tex;
+    }
+
+    /*
+     * Create a texture whose mip levels are streamed in and out (see TextureStreamer). The full
+     * chain has [levelCount] levels for a [width] x [height] image; storage is allocated for the
+     * levels from [firstAllocatedLevel] down, but none hold data until uploadStreamedLevel().
+     */
+    void Texture2DGL::buildStreamed(UInt32 width, UInt32 height, UInt32 levelCount, UInt32 firstAllocatedLevel) {
+        if (levelCount == 0 || firstAllocatedLevel >= levelCount) {
+            throw TextureException("Texture2DGL::buildStreamed() -> Invalid level range.");
+        }
+        if (this->attributes.IsDepthTexture) {
+            throw TextureException("Texture2DGL::buildStreamed() -> Depth textures can't be streamed.");
+        }
+        if (!Engine::instance()->getGraphicsSystem()->isTextureStreamingSupported()) {
+            throw TextureException("Texture2DGL::buildStreamed() -> Texture streaming requires glCopyImageSubData (GL 4.3 or ARB_copy_image).");
+        }
+        if (this->textureId > 0) {
+            glDeleteTextures(1, &this->textureId);
+            this->textureId = 0;
+        }
+
+        this->streamed = true;
+        this->streamedWidth = width;
+        this->streamedHeight = height;
+        this->streamedLevelCount = levelCount;
+        this->firstAllocatedLevel = levelCount;
+        this->firstLoadedLevel = levelCount;
+        this->allocateStreamedLevels(firstAllocatedLevel);
+    }
+
+    /*
+     * Replace the texture's storage with immutable storage for the levels from [firstLevel] down,
+     * copying over the levels that are loaded and still allocated. Storage level 0 is full-chain
+     * level [firstLevel]; sampling is clamped to the loaded levels with GL_TEXTURE_BASE_LEVEL, so
+     * levels can be uploaded one at a time, coarsest first. Dropping levels frees their memory.
+     */
+    void Texture2DGL::allocateStreamedLevels(UInt32 firstLevel) {
+        if (!this->streamed || firstLevel >= this->streamedLevelCount) {
+            throw TextureException("Texture2DGL::allocateStreamedLevels() -> Invalid level for streamed texture.");
+        }
+        if (firstLevel == this->firstAllocatedLevel) return;
+
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        UInt32 width = this->streamedWidth >> firstLevel;
+        UInt32 height = this->streamedHeight >> firstLevel;
+        GLuint tex = this->generateTexture();
+        graphicsGL->allocateTextureStorage(GL_TEXTURE_2D, this->attributes, this->streamedLevelCount - firstLevel, width > 0 ? width : 1, height > 0 ? height : 1);
+
+        UInt32 firstLoadedLevel = this->firstLoadedLevel > firstLevel ? this->firstLoadedLevel : firstLevel;
+        if (this->textureId > 0) {
+            for (UInt32 level = firstLoadedLevel; level < this->streamedLevelCount; level++) {
+                UInt32 levelWidth = this->streamedWidth >> level;
+                UInt32 levelHeight = this->streamedHeight >> level;
+                glCopyImageSubData(this->textureId, GL_TEXTURE_2D, level - this->firstAllocatedLevel, 0, 0, 0,
+                                   tex, GL_TEXTURE_2D, level - firstLevel, 0, 0, 0,
+                                   levelWidth > 0 ? levelWidth : 1, levelHeight > 0 ? levelHeight : 1, 1);
+            }
+            glDeleteTextures(1, &this->textureId);
+        }
+
+        this->textureId = (Int32)tex;
+        this->firstAllocatedLevel = firstLevel;
+        this->firstLoadedLevel = firstLoadedLevel;
+        this->updateStreamedLevelRange();
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    /*
+     * Upload the level in [levelData], which must be allocated and directly above the finest
+     * loaded level (or the coarsest level of the chain, if none is loaded yet). Data that was staged
+     * on a loader thread is uploaded from the upload ring.
+     */
+    void Texture2DGL::uploadStreamedLevel(const LevelData& levelData) {
+        if (!this->streamed || levelData.level < this->firstAllocatedLevel || levelData.level + 1 != this->firstLoadedLevel) {
+            throw TextureException("Texture2DGL::uploadStreamedLevel() -> Level is not the next one to load.");
+        }
+
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        GLint storageLevel = levelData.level - this->firstAllocatedLevel;
+        glBindTexture(GL_TEXTURE_2D, this->getTextureID());
+        if (levelData.staged) {
+            graphicsGL->uploadTextureLevel(GL_TEXTURE_2D, storageLevel, attributes.Format, levelData.width, levelData.height, *levelData.staged);
+        }
+        else {
+            graphicsGL->uploadTextureLevel(GL_TEXTURE_2D, storageLevel, attributes.Format, levelData.width, levelData.height, levelData.data.data());
+        }
+        this->firstLoadedLevel = levelData.level;
+        this->updateStreamedLevelRange();
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
     void Texture2DGL::buildEmpty(UInt32 width, UInt32 height) {
         this->setupTexture(width, height, nullptr);
     }
 
     void Texture2DGL::updateMipMaps() {
+        // the driver can't generate mip levels for block-compressed formats; they come with the image.
+        // streamed textures get theirs from TextureStreamer
+        if (CompressedImage::isCompressedFormat(this->attributes.Format) || this->streamed) return;
         glBindTexture(GL_TEXTURE_2D, this->getTextureID());
         glGenerateMipmap(GL_TEXTURE_2D);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
 
 
+    /*
+     * Create the texture with storage for level 0 of a [width] x [height] image, plus as many levels below it as
+     * MipLevels asks for, and upload [data] (if any) as level 0. The levels below are generated by the driver; only
+     * HDR images and empty textures (e.g. render targets, see updateMipMaps()) get their levels this way.
+     */
     void Texture2DGL::setupTexture(UInt32 width, UInt32 height, Byte* data) {
         WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
         WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
 
+        GLuint tex = this->generateTexture();
+
+        if (attributes.IsDepthTexture) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        }
+
+        UInt32 levelCount = 1;
+        if (attributes.MipLevels > 1) {
+            levelCount = MipChainBuilder::getFullChainLevelCount(width, height);
+            if (attributes.MipLevels < levelCount) levelCount = attributes.MipLevels;
+        }
+        graphicsGL->allocateTextureStorage(GL_TEXTURE_2D, this->attributes, levelCount, width, height);
+        if (data != nullptr && !attributes.IsDepthTexture) {
+            graphicsGL->uploadTextureLevel(GL_TEXTURE_2D, 0, attributes.Format, width, height, data);
+        }
+
+        if (attributes.MipLevels > 1) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, levelCount - 1);
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+       
+        glBindTexture(GL_TEXTURE_2D, 0);
+        this->textureId = (Int32)tex;
+    }
+
+    /*
+     * Upload the levels of [image] as they are. Only as many levels as the image has (and at most
+     * MipLevels) are used, since compressed textures can't have their mip levels generated.
+     */
+    void Texture2DGL::setupCompressedTexture(const CompressedImage& image) {
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        GLuint tex = this->generateTexture();
+
+        UInt32 levelCount = image.getLevelCount();
+        if (attributes.MipLevels > 0 && attributes.MipLevels < levelCount) levelCount = attributes.MipLevels;
+        graphicsGL->allocateTextureStorage(GL_TEXTURE_2D, this->attributes, levelCount, image.getWidth(), image.getHeight());
+        for (UInt32 level = 0; level < levelCount; level++) {
+            graphicsGL->uploadTextureLevel(GL_TEXTURE_2D, level, attributes.Format, image.getLevelWidth(level), image.getLevelHeight(level), image.getLevelData(level));
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        if (levelCount > 1) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, levelCount - 1);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        this->textureId = (Int32)tex;
+    }
+
+    /*
+     * Upload [image] as level 0 and [mipLevels] (as built by MipChainBuilder) as the levels below
+     * it, instead of having the driver generate them. At most MipLevels levels are used.
+     */
+    void Texture2DGL::setupMipChainTexture(const StandardImage& image, const std::vector<std::shared_ptr<StandardImage>>& mipLevels) {
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        WeakPointer<GraphicsGL> graphicsGL =  WeakPointer<Graphics>::dynamicPointerCast<GraphicsGL>(graphics);
+
+        GLuint tex = this->generateTexture();
+
+        UInt32 levelCount = (UInt32)mipLevels.size() + 1;
+        if (attributes.MipLevels > 0 && attributes.MipLevels < levelCount) levelCount = attributes.MipLevels;
+        graphicsGL->allocateTextureStorage(GL_TEXTURE_2D, this->attributes, levelCount, image.getWidth(), image.getHeight());
+        graphicsGL->uploadTextureLevel(GL_TEXTURE_2D, 0, attributes.Format, image.getWidth(), image.getHeight(), image.calcOffsetLocationBytes(0, 0));
+        for (UInt32 level = 1; level < levelCount; level++) {
+            const StandardImage& levelImage = *mipLevels[level - 1];
+            graphicsGL->uploadTextureLevel(GL_TEXTURE_2D, level, attributes.Format, levelImage.getWidth(), levelImage.getHeight(), levelImage.calcOffsetLocationBytes(0, 0));
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        if (levelCount > 1) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, levelCount - 1);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        this->textureId = (Int32)tex;
+    }
+
+    /*
+     * Limit sampling of the (bound) streamed texture to the loaded levels. While none are, the
+     * base level is past the last one, which leaves the texture incomplete.
+     */
+    void Texture2DGL::updateStreamedLevelRange() {
+        UInt32 storageLevelCount = this->streamedLevelCount - this->firstAllocatedLevel;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, this->firstLoadedLevel - this->firstAllocatedLevel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, storageLevelCount - 1);
+        if (storageLevelCount > 1) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, storageLevelCount - 1);
+        }
+    }
+
+    /*
+     * Create the OpenGL texture and set its wrap and filter modes. It is left bound.
+     */
+    GLuint Texture2DGL::generateTexture() {
         GLuint tex;
         
         // generate the OpenGL texture
         glGenTextures(1, &tex);
         if (!tex) {
-            throw AllocationException("Texture2DGL::setupTexture -> Unable to generate texture");
+            throw AllocationException("Texture2DGL::generateTexture -> Unable to generate texture");
         }
         glBindTexture(GL_TEXTURE_2D, tex);
 
@@ -97,27 +367,7 @@ namespace Core {
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         }
 
-        GLenum textureFormat = graphicsGL->getGLTextureFormat(attributes.Format);
-        GLenum pixelFormat = graphicsGL->getGLPixelFormat(attributes.Format);
-        GLenum pixelType = graphicsGL->getGLPixelType(attributes.Format);
-
-        if (attributes.IsDepthTexture) {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
-        }
-        else {
-            glTexImage2D(GL_TEXTURE_2D, 0, textureFormat, width, height, 0, pixelFormat, pixelType, data);
-        }
-
-        if (attributes.MipLevels > 1) {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, attributes.MipLevels - 1);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, attributes.MipLevels - 1);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-       
-        glBindTexture(GL_TEXTURE_2D, 0);
-        this->textureId = (Int32)tex;
+        return tex;
     }
     
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "../common/gl.h"
 #include "../image/Texture2D.h"
@@ -18,11 +19,21 @@ namespace Core {
 
         void buildFromImage(WeakPointer<StandardImage> imageData) override;
         void buildFromImage(WeakPointer<HDRImage> imageData) override;
+        void buildFromCompressedImage(WeakPointer<CompressedImage> imageData) override;
+        void buildFromMipChain(WeakPointer<StandardImage> imageData, const std::vector<std::shared_ptr<StandardImage>>& mipLevels) override;
+        void buildFromLevels(const std::vector<LevelData>& levels) override;
+        void buildStreamed(UInt32 width, UInt32 height, UInt32 levelCount, UInt32 firstAllocatedLevel) override;
+        void allocateStreamedLevels(UInt32 firstLevel) override;
+        void uploadStreamedLevel(const LevelData& levelData) override;
         void buildEmpty(UInt32 width, UInt32 height) override;
         void updateMipMaps() override;
 
     protected:
         Texture2DGL(const TextureAttributes& attributes);
         void setupTexture(UInt32 width, UInt32 height, Byte* data);
+        void setupCompressedTexture(const CompressedImage& image);
+        void setupMipChainTexture(const StandardImage& image, const std::vector<std::shared_ptr<StandardImage>>& mipLevels);
+        GLuint generateTexture();
+        void updateStreamedLevelRange();
     };
 }
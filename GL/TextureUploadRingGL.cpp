@@ -0,0 +1,220 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "TextureUploadRingGL.h"
+#include "GraphicsGL.h"
+#include "../common/Exception.h"
+#include "../image/CompressedImage.h"
+
+namespace Core {
+
+    const UInt64 TextureUploadRingGL::DefaultSize;
+    const UInt64 TextureUploadRingGL::BlockAlignment;
+
+    TextureUploadRingGL::StagedTextureDataGL::StagedTextureDataGL(std::shared_ptr<TextureUploadRingGL> ring, UInt64 offset, UInt64 size):
+        StagedTextureData(size), ring(ring), offset(offset), submitted(false) {
+
+    }
+
+    TextureUploadRingGL::StagedTextureDataGL::~StagedTextureDataGL() {
+        // never uploaded, so nothing can be reading the block
+        if (!this->submitted) this->ring->release(this->offset);
+    }
+
+    TextureUploadRingGL::TextureUploadRingGL(): bufferID(0), mapped(nullptr), size(0), head(0) {
+
+    }
+
+    TextureUploadRingGL::~TextureUploadRingGL() {
+
+    }
+
+    /*
+     * Create the buffer with [size] bytes of immutable storage and map it for good. Requires
+     * glBufferStorage() (GL 4.4 or ARB_buffer_storage).
+     */
+    Bool TextureUploadRingGL::init(UInt64 size) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->mapped) return true;
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &this->bufferID);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->bufferID);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, flags);
+        this->mapped = (Byte*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        if (!this->mapped) {
+            glDeleteBuffers(1, &this->bufferID);
+            this->bufferID = 0;
+            return false;
+        }
+        this->size = size;
+        this->head = 0;
+        return true;
+    }
+
+    void TextureUploadRingGL::destroy() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (Block& block : this->blocks) {
+            if (block.fence) glDeleteSync(block.fence);
+        }
+        // blocks staged but not uploaded yet are simply dropped; releasing them later finds nothing
+        this->blocks.clear();
+        if (this->mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->bufferID);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            this->mapped = nullptr;
+        }
+        if (this->bufferID) {
+            glDeleteBuffers(1, &this->bufferID);
+            this->bufferID = 0;
+        }
+        this->size = 0;
+        this->head = 0;
+    }
+
+    Bool TextureUploadRingGL::isActive() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->mapped != nullptr;
+    }
+
+    GLuint TextureUploadRingGL::getBufferID() const {
+        return this->bufferID;
+    }
+
+    /*
+     * Copy [size] bytes of [data] into the ring. Returns an empty pointer if the ring isn't active
+     * or doesn't have that much room until the GPU is done with earlier uploads; the caller then
+     * keeps the data in client memory. Safe to call from any thread.
+     */
+    std::shared_ptr<StagedTextureData> TextureUploadRingGL::stage(const Byte* data, UInt64 size) {
+        UInt64 offset;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (!this->mapped || size == 0 || !this->reserve(size, offset)) return std::shared_ptr<StagedTextureData>();
+        }
+
+        // the block is ours until it is uploaded or released, so the copy doesn't need the lock
+        memcpy(this->mapped + offset, data, size);
+
+        StagedTextureDataGL* stagedPtr = new(std::nothrow) StagedTextureDataGL(this->shared_from_this(), offset, size);
+        if (stagedPtr == nullptr) {
+            this->release(offset);
+            throw AllocationException("TextureUploadRingGL::stage -> Unable to allocate staged texture data.");
+        }
+        return std::shared_ptr<StagedTextureData>(stagedPtr);
+    }
+
+    /*
+     * Upload [staged] into the region of [level] of the bound texture at [target], which must have storage
+     * for a [width] x [height] image of [format], then fence the block so it is reused only after the
+     * GPU has read it. Each staged block can be uploaded once.
+     */
+    void TextureUploadRingGL::upload(StagedTextureData& staged, GLenum target, GLint level, GLsizei width, GLsizei height, TextureFormat format) {
+        StagedTextureDataGL& stagedGL = static_cast<StagedTextureDataGL&>(staged);
+        if (stagedGL.ring.get() != this || stagedGL.submitted) {
+            throw Exception("TextureUploadRingGL::upload -> Data was not staged in this ring or was already uploaded.");
+        }
+        // the GL reads the level in its client layout, which must all lie within the staged block
+        if (staged.getSize() < GraphicsGL::getClientLevelSizeBytes(format, width, height)) {
+            throw Exception("TextureUploadRingGL::upload -> Staged data is smaller than the level.");
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        Block* block = this->findBlock(stagedGL.offset);
+        if (block == nullptr || block->state != BlockState::Reserved) {
+            throw Exception("TextureUploadRingGL::upload -> Staged block no longer exists.");
+        }
+
+        // with a pixel unpack buffer bound, the data pointer is an offset into it
+        const GLvoid* pixels = reinterpret_cast<const GLvoid*>(static_cast<uintptr_t>(stagedGL.offset));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->bufferID);
+        if (CompressedImage::isCompressedFormat(format)) {
+            glCompressedTexSubImage2D(target, level, 0, 0, width, height, GraphicsGL::getGLTextureFormat(format), (GLsizei)staged.getSize(), pixels);
+        }
+        else {
+            glTexSubImage2D(target, level, 0, 0, width, height, GraphicsGL::getGLPixelFormat(format), GraphicsGL::getGLPixelType(format), pixels);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        block->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        block->state = BlockState::Submitted;
+        stagedGL.submitted = true;
+    }
+
+    /*
+     * Free the oldest blocks the GPU is done with. Blocks are freed in allocation order, so one
+     * that was staged but not uploaded yet holds back the ones after it. Called once per frame.
+     */
+    void TextureUploadRingGL::retire() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        while (!this->blocks.empty()) {
+            Block& block = this->blocks.front();
+            if (block.state == BlockState::Submitted) {
+                GLint status = GL_UNSIGNALED;
+                glGetSynciv(block.fence, GL_SYNC_STATUS, 1, nullptr, &status);
+                if (status != GL_SIGNALED) break;
+                glDeleteSync(block.fence);
+            }
+            else if (block.state != BlockState::Released) {
+                break;
+            }
+            this->blocks.pop_front();
+        }
+        if (this->blocks.empty()) this->head = 0;
+    }
+
+    /*
+     * Find room for [size] bytes after the newest block, wrapping around to the start of the buffer
+     * if the end is too short. The mutex must be held.
+     */
+    Bool TextureUploadRingGL::reserve(UInt64 size, UInt64& offset) {
+        UInt64 alignedSize = (size + BlockAlignment - 1) / BlockAlignment * BlockAlignment;
+        if (alignedSize > this->size) return false;
+
+        if (this->blocks.empty()) {
+            this->head = 0;
+        }
+        else {
+            UInt64 tail = this->blocks.front().offset;
+            if (this->head > tail) {
+                if (this->head + alignedSize > this->size) {
+                    if (alignedSize > tail) return false;
+                    // the space left at the end goes unused this time around
+                    if (this->head < this->size) this->blocks.push_back({this->head, this->size - this->head, BlockState::Released, 0});
+                    this->head = 0;
+                }
+            }
+            // the live blocks wrapped around; with [head] at [tail] the ring is full
+            else if (this->head + alignedSize > tail) {
+                return false;
+            }
+        }
+
+        offset = this->head;
+        this->blocks.push_back({this->head, alignedSize, BlockState::Reserved, 0});
+        this->head += alignedSize;
+        return true;
+    }
+
+    /*
+     * Give back the block at [offset] without uploading it. Safe to call from any thread.
+     */
+    void TextureUploadRingGL::release(UInt64 offset) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        Block* block = this->findBlock(offset);
+        if (block != nullptr && block->state == BlockState::Reserved) block->state = BlockState::Released;
+    }
+
+    /*
+     * The live block at [offset], if any. The mutex must be held.
+     */
+    TextureUploadRingGL::Block* TextureUploadRingGL::findBlock(UInt64 offset) {
+        for (Block& block : this->blocks) {
+            if (block.offset == offset && block.state != BlockState::Released) return &block;
+        }
+        return nullptr;
+    }
+}
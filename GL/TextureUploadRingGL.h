@@ -0,0 +1,80 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "../common/types.h"
+#include "../common/gl.h"
+#include "../image/StagedTextureData.h"
+#include "../image/TextureAttr.h"
+
+namespace Core {
+
+    /*
+     * Persistently mapped pixel unpack buffer that texture data is staged in before it is
+     * uploaded with glTexSubImage2D(), so the upload is a copy on the GPU's side instead of a
+     * synchronous copy out of client memory. Space is handed out in allocation order, like a
+     * ring; each uploaded block is fenced and reused once the GPU has read it.
+     *
+     * reserve() and release() may be called from any thread, so loader threads can copy their
+     * data in directly. Everything else issues GL commands and runs on the main thread.
+     */
+    class TextureUploadRingGL final : public std::enable_shared_from_this<TextureUploadRingGL> {
+    public:
+        static const UInt64 DefaultSize = 64 * 1024 * 1024;
+
+        TextureUploadRingGL();
+        ~TextureUploadRingGL();
+
+        Bool init(UInt64 size);
+        void destroy();
+        Bool isActive() const;
+        GLuint getBufferID() const;
+
+        std::shared_ptr<StagedTextureData> stage(const Byte* data, UInt64 size);
+        void upload(StagedTextureData& staged, GLenum target, GLint level, GLsizei width, GLsizei height, TextureFormat format);
+        void retire();
+
+    private:
+        enum class BlockState { Reserved = 0, Submitted = 1, Released = 2 };
+
+        class Block {
+        public:
+            UInt64 offset;
+            UInt64 size;
+            BlockState state;
+            GLsync fence;
+        };
+
+        class StagedTextureDataGL final : public StagedTextureData {
+            friend class TextureUploadRingGL;
+
+        public:
+            StagedTextureDataGL(std::shared_ptr<TextureUploadRingGL> ring, UInt64 offset, UInt64 size);
+            ~StagedTextureDataGL();
+
+        private:
+            std::shared_ptr<TextureUploadRingGL> ring;
+            UInt64 offset;
+            Bool submitted;
+        };
+
+        TextureUploadRingGL(const TextureUploadRingGL& other) = delete;
+        TextureUploadRingGL& operator=(const TextureUploadRingGL& other) = delete;
+
+        Bool reserve(UInt64 size, UInt64& offset);
+        void release(UInt64 offset);
+        Block* findBlock(UInt64 offset);
+
+        static const UInt64 BlockAlignment = 16;
+
+        mutable std::mutex mutex;
+        GLuint bufferID;
+        Byte* mapped;
+        UInt64 size;
+        // where the next block goes; the oldest live block is blocks.front()
+        UInt64 head;
+        std::deque<Block> blocks;
+    };
+}
@@ -6,6 +6,7 @@
 #include "util/WeakPointer.h"
 #include "image/TextureAttr.h"
 #include "geometry/AttributeType.h"
+#include "geometry/GPUStorageUsage.h"
 #include "render/RenderState.h"
 #include "render/RenderBuffer.h"
 #include "render/RenderStyle.h"
@@ -21,6 +22,8 @@ namespace Core {
     class CubeTexture;
     class Shader;
     class AttributeArrayGPUStorage;
+    class InterleavedAttributeBuffer;
+    class VertexAttributeBinding;
     class IndexBuffer;
     class Renderer;
     class Scene;
@@ -29,6 +32,7 @@ namespace Core {
     class RenderTarget2D;
     class RenderTargetCube;
     class Material;
+    class StagedTextureData;
     
     class Graphics {
     public:
@@ -51,6 +55,10 @@ namespace Core {
         virtual WeakPointer<CubeTexture> createCubeTexture(const TextureAttributes& attributes) = 0;
         virtual void destroyTexture2D(WeakPointer<Texture2D> texture) = 0;
         virtual void destroyCubeTexture(WeakPointer<CubeTexture> texture) = 0;
+        // copy texture data into upload memory from any thread; empty if there's no room for it
+        virtual std::shared_ptr<StagedTextureData> stageTextureData(const Byte* data, UInt64 size) = 0;
+        // whether Texture2D::buildStreamed() and the streaming of mip levels in and out can be used
+        virtual Bool isTextureStreamingSupported() const = 0;
 
         virtual WeakPointer<Shader> createShader(const std::string& vertex, const std::string& fragment) = 0;
         virtual WeakPointer<Shader> createShader(const std::string& vertex, const std::string& geometry, const std::string& fragment) = 0;
@@ -58,8 +66,18 @@ namespace Core {
         virtual WeakPointer<Shader> createShader(const char vertex[], const char geometry[], const char fragment[]) = 0;
         virtual void activateShader(WeakPointer<Shader> shader) = 0;
     
-        virtual std::shared_ptr<AttributeArrayGPUStorage> createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize) const = 0;
+        virtual std::shared_ptr<AttributeArrayGPUStorage> createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize,
+                                                                           GPUStorageUsage usage) const = 0;
+        virtual std::shared_ptr<AttributeArrayGPUStorage> createGPUStorage(UInt32 size, UInt32 componentCount, AttributeType type, Bool normalize,
+                                                                           std::shared_ptr<InterleavedAttributeBuffer> interleavedBuffer, UInt32 offset) const = 0;
+        virtual std::shared_ptr<InterleavedAttributeBuffer> createInterleavedAttributeBuffer(UInt32 vertexCount, UInt32 stride, GPUStorageUsage usage) const = 0;
         virtual std::shared_ptr<IndexBuffer> createIndexBuffer(UInt32 size) const = 0;
+        // whether half-float and normalized short vertex attributes can be fetched
+        virtual Bool areCompactAttributesSupported() const = 0;
+
+        virtual Bool activateVertexArray(WeakPointer<Mesh> mesh, WeakPointer<Shader> shader, const std::vector<VertexAttributeBinding>& bindings) = 0;
+        virtual void deactivateVertexArray() = 0;
+        virtual void destroyVertexArrays(const Mesh* mesh) = 0;
 
         virtual void drawBoundVertexBuffer(UInt32 vertexCount) = 0;
         virtual void drawBoundVertexBuffer(UInt32 vertexCount, WeakPointer<IndexBuffer> indices) = 0;
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+#include "AssetStreamer.h"
+#include "../common/Exception.h"
+
+namespace Core {
+
+    const UInt32 AssetStreamer::DefaultThreadCount;
+
+    AssetStreamer::Request::Request(Priority priority, UInt64 sequence, LoadFunction load, CompletionCallback onComplete):
+        state(State::Queued), cancelled(false), priority(priority), sequence(sequence), load(load), onComplete(onComplete) {
+
+    }
+
+    AssetStreamer::State AssetStreamer::Request::getState() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->state;
+    }
+
+    Bool AssetStreamer::Request::isDone() const {
+        State state = this->getState();
+        return state == State::Complete || state == State::Failed || state == State::Cancelled;
+    }
+
+    AssetStreamer::Priority AssetStreamer::Request::getPriority() const {
+        return this->priority;
+    }
+
+    std::string AssetStreamer::Request::getError() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->error;
+    }
+
+    /*
+     * Stop the request as soon as possible. A request that has not started loading never will; a
+     * load function that is already running can check isCancelled() to stop early. Uploads that
+     * have not run yet are dropped. The completion callback still gets invoked, with the request
+     * in the Cancelled state, unless the request had already finished.
+     */
+    void AssetStreamer::Request::cancel() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->cancelled = true;
+    }
+
+    Bool AssetStreamer::Request::isCancelled() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->cancelled;
+    }
+
+    /*
+     * Queue [upload] to run on the main thread once the load function has returned. Uploads run in
+     * the order they were added; [byteCount] is how much the upload sends to the GPU and counts
+     * against the per-frame byte budget. Can be called from the load function or from an upload.
+     */
+    void AssetStreamer::Request::addUpload(UInt64 byteCount, UploadFunction upload) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->uploads.push_back(Upload(byteCount, upload));
+    }
+
+    void AssetStreamer::Request::setState(State state) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->state = state;
+    }
+
+    void AssetStreamer::Request::fail(const std::string& error) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->state = State::Failed;
+        this->error = error;
+        this->uploads.clear();
+    }
+
+    AssetStreamer::AssetStreamer(): threadCount(DefaultThreadCount), uploadByteBudget(0), uploadTimeBudget(0.0f), nextSequence(0),
+                                    shuttingDown(false) {
+
+    }
+
+    AssetStreamer::~AssetStreamer() {
+        this->stopThreads();
+    }
+
+    /*
+     * Queue a request. [load] runs on a streaming thread and must not touch the graphics system or
+     * create engine objects; it queues that work with Request::addUpload() instead. [onComplete]
+     * (optional) runs on the main thread once the request is complete, has failed or was cancelled.
+     */
+    AssetStreamer::RequestHandle AssetStreamer::enqueue(Priority priority, LoadFunction load, CompletionCallback onComplete) {
+        std::unique_lock<std::mutex> lock(this->queueMutex);
+        RequestHandle request = RequestHandle(new(std::nothrow) Request(priority, this->nextSequence++, load, onComplete));
+        if (!request) {
+            throw AllocationException("AssetStreamer::enqueue -> Unable to allocate request.");
+        }
+        this->queuedRequests.push_back(request);
+        if (this->workers.size() == 0) this->startThreads();
+        lock.unlock();
+
+        this->queueCondition.notify_one();
+        return request;
+    }
+
+    /*
+     * Run queued uploads until this frame's budget is spent, then invoke the completion callbacks
+     * of every request that finished. At least one upload runs per frame, so a single upload that
+     * is larger than the budget still goes through. Must be called on the main thread.
+     */
+    void AssetStreamer::update() {
+        std::vector<RequestHandle> loaded;
+        {
+            std::lock_guard<std::mutex> lock(this->queueMutex);
+            loaded.swap(this->loadedRequests);
+        }
+
+        std::vector<RequestHandle> finished;
+        for (RequestHandle& request : loaded) {
+            std::unique_lock<std::mutex> lock(request->mutex);
+            if (request->state == State::Failed || request->cancelled) {
+                lock.unlock();
+                this->finish(request, finished);
+                continue;
+            }
+            request->state = State::Uploading;
+            lock.unlock();
+            this->uploadingRequests.push_back(request);
+        }
+        std::stable_sort(this->uploadingRequests.begin(), this->uploadingRequests.end(), AssetStreamer::hasPrecedence);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        UInt64 uploadedBytes = 0;
+        Bool firstUpload = true;
+        Bool budgetSpent = false;
+        for (RequestHandle& request : this->uploadingRequests) {
+            while (!budgetSpent) {
+                Request::Upload upload(0, nullptr);
+                {
+                    std::lock_guard<std::mutex> lock(request->mutex);
+                    if (request->cancelled || request->state != State::Uploading || request->uploads.size() == 0) break;
+
+                    if (!firstUpload) {
+                        Real elapsed = std::chrono::duration<Real, std::milli>(std::chrono::steady_clock::now() - start).count();
+                        Bool overBytes = this->uploadByteBudget > 0 && uploadedBytes + request->uploads.front().byteCount > this->uploadByteBudget;
+                        Bool overTime = this->uploadTimeBudget > 0.0f && elapsed >= this->uploadTimeBudget;
+                        if (overBytes || overTime) {
+                            budgetSpent = true;
+                            break;
+                        }
+                    }
+                    upload = request->uploads.front();
+                    request->uploads.pop_front();
+                }
+
+                try {
+                    upload.func(*request);
+                }
+                catch (const Exception& e) {
+                    request->fail(e.getMessage());
+                }
+                catch (const std::exception& e) {
+                    request->fail(e.what());
+                }
+                catch (...) {
+                    request->fail("AssetStreamer::update -> Upload failed.");
+                }
+                uploadedBytes += upload.byteCount;
+                firstUpload = false;
+            }
+            if (budgetSpent) break;
+        }
+
+        for (UInt32 i = 0; i < this->uploadingRequests.size(); i++) {
+            RequestHandle request = this->uploadingRequests[i];
+            std::unique_lock<std::mutex> lock(request->mutex);
+            Bool done = request->cancelled || request->state != State::Uploading || request->uploads.size() == 0;
+            lock.unlock();
+            if (!done) continue;
+
+            this->finish(request, finished);
+            this->uploadingRequests.erase(this->uploadingRequests.begin() + i);
+            i--;
+        }
+
+        for (RequestHandle& request : finished) {
+            if (request->onComplete) request->onComplete(*request);
+            // drop whatever the callbacks captured
+            request->load = nullptr;
+            request->onComplete = nullptr;
+        }
+    }
+
+    /*
+     * Use [threadCount] streaming threads (at least one). Loads that are running when this is
+     * called finish first.
+     */
+    void AssetStreamer::setThreadCount(UInt32 threadCount) {
+        if (threadCount == 0) threadCount = 1;
+        this->stopThreads();
+
+        std::lock_guard<std::mutex> lock(this->queueMutex);
+        this->threadCount = threadCount;
+        if (this->queuedRequests.size() > 0) this->startThreads();
+    }
+
+    UInt32 AssetStreamer::getThreadCount() const {
+        return this->threadCount;
+    }
+
+    /*
+     * Limit the uploads update() runs per frame to [bytesPerFrame] bytes and [millisecondsPerFrame]
+     * milliseconds. Zero means no limit.
+     */
+    void AssetStreamer::setUploadBudget(UInt64 bytesPerFrame, Real millisecondsPerFrame) {
+        this->uploadByteBudget = bytesPerFrame;
+        this->uploadTimeBudget = millisecondsPerFrame;
+    }
+
+    UInt64 AssetStreamer::getUploadByteBudget() const {
+        return this->uploadByteBudget;
+    }
+
+    Real AssetStreamer::getUploadTimeBudget() const {
+        return this->uploadTimeBudget;
+    }
+
+    // must be called with [queueMutex] held
+    void AssetStreamer::startThreads() {
+        for (UInt32 i = 0; i < this->threadCount; i++) {
+            this->workers.push_back(std::thread(&AssetStreamer::workerLoop, this));
+        }
+    }
+
+    void AssetStreamer::stopThreads() {
+        {
+            std::lock_guard<std::mutex> lock(this->queueMutex);
+            this->shuttingDown = true;
+        }
+        this->queueCondition.notify_all();
+        for (std::thread& worker : this->workers) {
+            worker.join();
+        }
+
+        std::lock_guard<std::mutex> lock(this->queueMutex);
+        this->workers.clear();
+        this->shuttingDown = false;
+    }
+
+    void AssetStreamer::workerLoop() {
+        while (true) {
+            RequestHandle request;
+            {
+                std::unique_lock<std::mutex> lock(this->queueMutex);
+                this->queueCondition.wait(lock, [this]() {
+                    return this->shuttingDown || this->queuedRequests.size() > 0;
+                });
+                if (this->shuttingDown) return;
+                request = this->popQueuedRequest();
+            }
+
+            if (!request->isCancelled()) {
+                request->setState(State::Loading);
+                try {
+                    request->load(*request);
+                }
+                catch (const Exception& e) {
+                    request->fail(e.getMessage());
+                }
+                catch (const std::exception& e) {
+                    request->fail(e.what());
+                }
+                catch (...) {
+                    request->fail("AssetStreamer::workerLoop -> Load failed.");
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(this->queueMutex);
+            this->loadedRequests.push_back(request);
+        }
+    }
+
+    // must be called with [queueMutex] held and at least one request queued
+    AssetStreamer::RequestHandle AssetStreamer::popQueuedRequest() {
+        UInt32 best = 0;
+        for (UInt32 i = 1; i < this->queuedRequests.size(); i++) {
+            if (AssetStreamer::hasPrecedence(this->queuedRequests[i], this->queuedRequests[best])) best = i;
+        }
+        RequestHandle request = this->queuedRequests[best];
+        this->queuedRequests[best] = this->queuedRequests.back();
+        this->queuedRequests.pop_back();
+        return request;
+    }
+
+    void AssetStreamer::finish(RequestHandle request, std::vector<RequestHandle>& finished) {
+        std::lock_guard<std::mutex> lock(request->mutex);
+        if (request->state != State::Failed) {
+            request->state = request->cancelled ? State::Cancelled : State::Complete;
+        }
+        request->uploads.clear();
+        finished.push_back(request);
+    }
+
+    /*
+     * Higher priority first, then first come, first served.
+     */
+    Bool AssetStreamer::hasPrecedence(const RequestHandle& a, const RequestHandle& b) {
+        if (a->priority != b->priority) return a->priority > b->priority;
+        return a->sequence < b->sequence;
+    }
+}
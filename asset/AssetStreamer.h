@@ -0,0 +1,113 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/types.h"
+
+namespace Core {
+
+    /*
+     * Loads assets in the background. Every request runs its load function on one of the
+     * streaming threads, highest priority first. Whatever has to happen on the main thread
+     * (creating engine objects, sending data to the GPU) is queued by the request as uploads,
+     * which update() works through each frame within the upload budget. Once a request's
+     * uploads are done, or it failed or was cancelled, its completion callback is invoked from
+     * update(), i.e. from Engine::update() on the main thread.
+     */
+    class AssetStreamer {
+    public:
+        enum class Priority { Low = 0, Normal = 1, High = 2, Critical = 3 };
+        enum class State { Queued = 0, Loading = 1, Uploading = 2, Complete = 3, Failed = 4, Cancelled = 5 };
+
+        class Request;
+        typedef std::shared_ptr<Request> RequestHandle;
+        typedef std::function<void(Request&)> LoadFunction;
+        typedef std::function<void(Request&)> UploadFunction;
+        typedef std::function<void(Request&)> CompletionCallback;
+
+        class Request {
+            friend class AssetStreamer;
+
+        public:
+            State getState() const;
+            Bool isDone() const;
+            Priority getPriority() const;
+            std::string getError() const;
+            void cancel();
+            Bool isCancelled() const;
+            void addUpload(UInt64 byteCount, UploadFunction upload);
+
+        private:
+            class Upload {
+            public:
+                Upload(UInt64 byteCount, UploadFunction func): byteCount(byteCount), func(func) {}
+
+                UInt64 byteCount;
+                UploadFunction func;
+            };
+
+            Request(Priority priority, UInt64 sequence, LoadFunction load, CompletionCallback onComplete);
+            void setState(State state);
+            void fail(const std::string& error);
+
+            mutable std::mutex mutex;
+            State state;
+            Bool cancelled;
+            Priority priority;
+            UInt64 sequence;
+            std::string error;
+            LoadFunction load;
+            CompletionCallback onComplete;
+            std::deque<Upload> uploads;
+        };
+
+        AssetStreamer();
+        ~AssetStreamer();
+
+        RequestHandle enqueue(Priority priority, LoadFunction load, CompletionCallback onComplete);
+        void update();
+
+        void setThreadCount(UInt32 threadCount);
+        UInt32 getThreadCount() const;
+        void setUploadBudget(UInt64 bytesPerFrame, Real millisecondsPerFrame);
+        UInt64 getUploadByteBudget() const;
+        Real getUploadTimeBudget() const;
+
+        static const UInt32 DefaultThreadCount = 2;
+
+    private:
+        AssetStreamer(const AssetStreamer& other) = delete;
+        AssetStreamer& operator=(const AssetStreamer& other) = delete;
+
+        void startThreads();
+        void stopThreads();
+        void workerLoop();
+        RequestHandle popQueuedRequest();
+        void finish(RequestHandle request, std::vector<RequestHandle>& finished);
+
+        static Bool hasPrecedence(const RequestHandle& a, const RequestHandle& b);
+
+        UInt32 threadCount;
+        UInt64 uploadByteBudget;
+        Real uploadTimeBudget;
+        UInt64 nextSequence;
+
+        std::vector<std::thread> workers;
+        std::mutex queueMutex;
+        std::condition_variable queueCondition;
+        Bool shuttingDown;
+        // waiting to load, in no particular order; the one with precedence is picked when a thread is free
+        std::vector<RequestHandle> queuedRequests;
+        // done loading, handed back to the main thread
+        std::vector<RequestHandle> loadedRequests;
+        // main thread only: requests whose uploads are in progress
+        std::vector<RequestHandle> uploadingRequests;
+    };
+}
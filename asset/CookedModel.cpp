@@ -0,0 +1,373 @@
+#include <fstream>
+#include <string.h>
+
+#include "CookedModel.h"
+#include "../geometry/Vector2.h"
+#include "../geometry/Vector3.h"
+#include "../color/Color.h"
+
+namespace Core {
+
+    const UInt32 CookedModel::Magic;
+    const UInt32 CookedModel::Version;
+    const UInt32 CookedModel::Alignment;
+    const Int32 CookedModel::None;
+    const UInt64 CookedModel::NoStream;
+    const UInt32 CookedModel::CompressedAttributes;
+
+    static UInt64 alignOffset(UInt64 offset) {
+        return (offset + CookedModel::Alignment - 1) & ~((UInt64)CookedModel::Alignment - 1);
+    }
+
+    /*
+     * Table for the reflected CRC-32 polynomial 0xEDB88320.
+     */
+    class ChecksumTable {
+    public:
+        ChecksumTable() {
+            for (UInt32 i = 0; i < 256; i++) {
+                UInt32 value = i;
+                for (UInt32 bit = 0; bit < 8; bit++) {
+                    value = (value & 1) ? (value >> 1) ^ 0xEDB88320 : value >> 1;
+                }
+                entries[i] = value;
+            }
+        }
+
+        UInt32 entries[256];
+    };
+
+    UInt32 CookedModel::calculateChecksum(const Byte* data, UInt64 size) {
+        static const ChecksumTable table;
+        UInt32 checksum = 0xFFFFFFFF;
+        for (UInt64 i = 0; i < size; i++) {
+            checksum = table.entries[(checksum ^ data[i]) & 0xFF] ^ (checksum >> 8);
+        }
+        return checksum ^ 0xFFFFFFFF;
+    }
+
+    UInt64 CookedModel::getStreamSize(Stream stream, UInt32 vertexCount, UInt32 indexCount) {
+        switch (stream) {
+            case Stream::Positions:
+                return (UInt64)vertexCount * Point3rs::ComponentCount * sizeof(Real);
+            case Stream::Normals:
+            case Stream::AveragedNormals:
+            case Stream::FaceNormals:
+            case Stream::Tangents:
+                return (UInt64)vertexCount * Vector3rs::ComponentCount * sizeof(Real);
+            case Stream::Colors:
+                return (UInt64)vertexCount * ColorS::ComponentCount * sizeof(Real);
+            case Stream::AlbedoUVs:
+            case Stream::NormalUVs:
+                return (UInt64)vertexCount * Vector2rs::ComponentCount * sizeof(Real);
+            case Stream::Indices:
+                return (UInt64)indexCount * sizeof(UInt32);
+            default:
+                return 0;
+        }
+    }
+
+    CookedModel::Writer::Writer() {
+
+    }
+
+    /*
+     * Add the image file at [path] to the list of textures, unless it is already there. Returns its index.
+     */
+    UInt32 CookedModel::Writer::addTexture(const std::string& path) {
+        auto slot = this->textureSlots.find(path);
+        if (slot != this->textureSlots.end()) return slot->second;
+
+        TextureRecord record;
+        record.pathOffset = this->addString(path);
+        record.pathLength = (UInt32)path.size();
+        UInt32 index = (UInt32)this->textures.size();
+        this->textures.push_back(record);
+        this->textureSlots[path] = index;
+        return index;
+    }
+
+    /*
+     * [textures] holds a texture index (see addTexture()) or None for every TextureSlot.
+     */
+    UInt32 CookedModel::Writer::addMaterial(LongMask shaderMaterialCharacteristics, const Int32* textures) {
+        MaterialRecord record;
+        memset(&record, 0, sizeof(MaterialRecord));
+        record.shaderMaterialCharacteristics = shaderMaterialCharacteristics;
+        for (UInt32 t = 0; t < (UInt32)TextureSlot::_Count; t++) {
+            record.textures[t] = textures[t];
+        }
+        this->materials.push_back(record);
+        return (UInt32)this->materials.size() - 1;
+    }
+
+    /*
+     * [streams] holds a pointer to the data of every Stream, or nullptr where the mesh does not
+     * have it. Vertex streams are tightly packed Reals, indices are UInt32s.
+     */
+    UInt32 CookedModel::Writer::addMesh(UInt32 vertexCount, UInt32 indexCount, UInt32 material, UInt32 flags,
+                                        UInt32 enabledAttributes, const void* const* streams) {
+        MeshRecord record;
+        memset(&record, 0, sizeof(MeshRecord));
+        record.vertexCount = vertexCount;
+        record.indexCount = indexCount;
+        record.material = material;
+        record.flags = flags;
+        record.enabledAttributes = enabledAttributes;
+        for (UInt32 s = 0; s < (UInt32)Stream::_Count; s++) {
+            UInt64 size = CookedModel::getStreamSize((Stream)s, vertexCount, indexCount);
+            record.streams[s] = streams[s] != nullptr && size > 0 ? this->addData(streams[s], size) : NoStream;
+        }
+        this->meshes.push_back(record);
+        return (UInt32)this->meshes.size() - 1;
+    }
+
+    /*
+     * Add a node below [parent], which must have been added before it (or be None for the root).
+     * [material] is None for plain objects; otherwise the node holds [meshes] rendered with that material.
+     */
+    UInt32 CookedModel::Writer::addNode(const std::string& name, Int32 parent, const Real* localMatrix, Int32 material,
+                                        const std::vector<UInt32>& meshes) {
+        NodeRecord record;
+        memset(&record, 0, sizeof(NodeRecord));
+        record.nameOffset = this->addString(name);
+        record.nameLength = (UInt32)name.size();
+        record.parent = parent;
+        record.material = material;
+        record.firstMeshReference = (UInt32)this->meshReferences.size();
+        record.meshReferenceCount = (UInt32)meshes.size();
+        memcpy(record.localMatrix, localMatrix, sizeof(record.localMatrix));
+        this->meshReferences.insert(this->meshReferences.end(), meshes.begin(), meshes.end());
+        this->nodes.push_back(record);
+        return (UInt32)this->nodes.size() - 1;
+    }
+
+    UInt32 CookedModel::Writer::addString(const std::string& value) {
+        UInt32 offset = (UInt32)this->strings.size();
+        this->strings += value;
+        return offset;
+    }
+
+    UInt64 CookedModel::Writer::addData(const void* source, UInt64 size) {
+        UInt64 offset = alignOffset(this->data.size());
+        this->data.resize(offset + size);
+        memcpy(this->data.data() + offset, source, size);
+        return offset;
+    }
+
+    /*
+     * Write the cooked model to the file at [path], replacing it if it exists.
+     */
+    void CookedModel::Writer::save(const std::string& path) const {
+        const void* sectionData[(UInt32)Section::_Count] = {this->strings.data(), this->textures.data(), this->materials.data(),
+                                                             this->meshes.data(), this->nodes.data(), this->meshReferences.data(),
+                                                             this->data.data()};
+        UInt64 sectionSizes[(UInt32)Section::_Count] = {this->strings.size(), this->textures.size() * sizeof(TextureRecord),
+                                                        this->materials.size() * sizeof(MaterialRecord), this->meshes.size() * sizeof(MeshRecord),
+                                                        this->nodes.size() * sizeof(NodeRecord), this->meshReferences.size() * sizeof(UInt32),
+                                                        this->data.size()};
+        UInt32 sectionCounts[(UInt32)Section::_Count] = {(UInt32)this->strings.size(), (UInt32)this->textures.size(),
+                                                         (UInt32)this->materials.size(), (UInt32)this->meshes.size(),
+                                                         (UInt32)this->nodes.size(), (UInt32)this->meshReferences.size(),
+                                                         (UInt32)this->data.size()};
+
+        Header header;
+        memset(&header, 0, sizeof(Header));
+        header.magic = Magic;
+        header.version = Version;
+        header.headerSize = sizeof(Header);
+        header.realSize = sizeof(Real);
+
+        UInt64 offset = alignOffset(sizeof(Header));
+        for (UInt32 s = 0; s < (UInt32)Section::_Count; s++) {
+            header.sections[s].offset = offset;
+            header.sections[s].size = sectionSizes[s];
+            header.sections[s].count = sectionCounts[s];
+            header.sections[s].checksum = CookedModel::calculateChecksum((const Byte*)sectionData[s], sectionSizes[s]);
+            offset = alignOffset(offset + sectionSizes[s]);
+        }
+        header.fileSize = offset;
+        header.headerChecksum = CookedModel::calculateChecksum((const Byte*)&header, sizeof(Header));
+
+        std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw CookedModelException(std::string("CookedModel::Writer::save -> Could not open file: ") + path);
+        }
+
+        const Byte padding[Alignment] = {0};
+        file.write((const char*)&header, sizeof(Header));
+        UInt64 written = sizeof(Header);
+        for (UInt32 s = 0; s < (UInt32)Section::_Count; s++) {
+            file.write((const char*)padding, header.sections[s].offset - written);
+            file.write((const char*)sectionData[s], sectionSizes[s]);
+            written = header.sections[s].offset + sectionSizes[s];
+        }
+        file.write((const char*)padding, header.fileSize - written);
+
+        if (!file.good()) {
+            throw CookedModelException(std::string("CookedModel::Writer::save -> Could not write file: ") + path);
+        }
+    }
+
+    CookedModel::Reader::Reader(): header(nullptr) {
+
+    }
+
+    /*
+     * Map the cooked model at [path] and check that it is complete and intact before anything
+     * reads from it.
+     */
+    void CookedModel::Reader::open(const std::string& path) {
+        this->header = nullptr;
+        if (!this->file.open(path)) {
+            throw CookedModelException(std::string("CookedModel::Reader::open -> Could not open file: ") + path);
+        }
+
+        const Header* header = (const Header*)this->file.getData();
+        if (this->file.getSize() < sizeof(Header) || header->magic != Magic) {
+            throw CookedModelException(std::string("CookedModel::Reader::open -> Not a cooked model: ") + path);
+        }
+        if (header->version != Version || header->headerSize != sizeof(Header) || header->realSize != sizeof(Real)) {
+            throw CookedModelException(std::string("CookedModel::Reader::open -> Incompatible cooked model version: ") + path);
+        }
+
+        Header uncheckedHeader = *header;
+        uncheckedHeader.headerChecksum = 0;
+        if (header->fileSize != this->file.getSize() ||
+            CookedModel::calculateChecksum((const Byte*)&uncheckedHeader, sizeof(Header)) != header->headerChecksum) {
+            throw CookedModelException(std::string("CookedModel::Reader::open -> Corrupt cooked model header: ") + path);
+        }
+
+        this->header = header;
+        this->validate();
+    }
+
+    void CookedModel::Reader::close() {
+        this->header = nullptr;
+        this->file.close();
+    }
+
+    /*
+     * Check the section checksums and that every record only refers to data inside the file.
+     */
+    void CookedModel::Reader::validate() const {
+        const UInt64 recordSizes[(UInt32)Section::_Count] = {1, sizeof(TextureRecord), sizeof(MaterialRecord), sizeof(MeshRecord),
+                                                             sizeof(NodeRecord), sizeof(UInt32), 1};
+        for (UInt32 s = 0; s < (UInt32)Section::_Count; s++) {
+            const SectionRecord& section = this->header->sections[s];
+            if (section.offset % Alignment != 0 || section.offset > this->header->fileSize ||
+                section.size > this->header->fileSize - section.offset || section.size != (UInt64)section.count * recordSizes[s] ||
+                CookedModel::calculateChecksum(this->file.getData() + section.offset, section.size) != section.checksum) {
+                throw CookedModelException("CookedModel::Reader::validate -> Corrupt section.");
+            }
+        }
+
+        UInt32 stringsSize = this->getCount(Section::Strings);
+        UInt64 dataSize = this->header->sections[(UInt32)Section::Data].size;
+
+        const TextureRecord* textures = this->getRecords<TextureRecord>(Section::Textures);
+        for (UInt32 i = 0; i < this->getTextureCount(); i++) {
+            if (textures[i].pathOffset > stringsSize || textures[i].pathLength > stringsSize - textures[i].pathOffset) {
+                throw CookedModelException("CookedModel::Reader::validate -> Texture path is out of range.");
+            }
+        }
+
+        const MaterialRecord* materials = this->getRecords<MaterialRecord>(Section::Materials);
+        for (UInt32 i = 0; i < this->getMaterialCount(); i++) {
+            for (UInt32 t = 0; t < (UInt32)TextureSlot::_Count; t++) {
+                if (materials[i].textures[t] != None && (materials[i].textures[t] < 0 || (UInt32)materials[i].textures[t] >= this->getTextureCount())) {
+                    throw CookedModelException("CookedModel::Reader::validate -> Material texture is out of range.");
+                }
+            }
+        }
+
+        const MeshRecord* meshes = this->getRecords<MeshRecord>(Section::Meshes);
+        for (UInt32 i = 0; i < this->getMeshCount(); i++) {
+            if (meshes[i].material >= this->getMaterialCount()) {
+                throw CookedModelException("CookedModel::Reader::validate -> Mesh material is out of range.");
+            }
+            for (UInt32 s = 0; s < (UInt32)Stream::_Count; s++) {
+                UInt64 offset = meshes[i].streams[s];
+                if (offset == NoStream) continue;
+                UInt64 size = CookedModel::getStreamSize((Stream)s, meshes[i].vertexCount, meshes[i].indexCount);
+                if (offset % Alignment != 0 || offset > dataSize || size > dataSize - offset) {
+                    throw CookedModelException("CookedModel::Reader::validate -> Mesh stream is out of range.");
+                }
+            }
+            if (meshes[i].streams[(UInt32)Stream::Positions] == NoStream) {
+                throw CookedModelException("CookedModel::Reader::validate -> Mesh has no positions.");
+            }
+        }
+
+        const NodeRecord* nodes = this->getRecords<NodeRecord>(Section::Nodes);
+        const UInt32* meshReferences = this->getRecords<UInt32>(Section::MeshReferences);
+        UInt32 meshReferenceCount = this->getCount(Section::MeshReferences);
+        if (this->getNodeCount() == 0 || nodes[0].parent != None) {
+            throw CookedModelException("CookedModel::Reader::validate -> Cooked model has no root node.");
+        }
+        for (UInt32 i = 0; i < this->getNodeCount(); i++) {
+            const NodeRecord& node = nodes[i];
+            if (node.nameOffset > stringsSize || node.nameLength > stringsSize - node.nameOffset ||
+                (i > 0 && (node.parent < 0 || (UInt32)node.parent >= i)) ||
+                (node.material != None && (node.material < 0 || (UInt32)node.material >= this->getMaterialCount())) ||
+                node.firstMeshReference > meshReferenceCount || node.meshReferenceCount > meshReferenceCount - node.firstMeshReference) {
+                throw CookedModelException("CookedModel::Reader::validate -> Node is out of range.");
+            }
+            for (UInt32 m = 0; m < node.meshReferenceCount; m++) {
+                if (meshReferences[node.firstMeshReference + m] >= this->getMeshCount()) {
+                    throw CookedModelException("CookedModel::Reader::validate -> Node mesh is out of range.");
+                }
+            }
+        }
+    }
+
+    UInt32 CookedModel::Reader::getTextureCount() const {
+        return this->getCount(Section::Textures);
+    }
+
+    std::string CookedModel::Reader::getTexturePath(UInt32 index) const {
+        const TextureRecord& texture = this->getRecords<TextureRecord>(Section::Textures)[index];
+        return std::string(this->getRecords<Char>(Section::Strings) + texture.pathOffset, texture.pathLength);
+    }
+
+    UInt32 CookedModel::Reader::getMaterialCount() const {
+        return this->getCount(Section::Materials);
+    }
+
+    const CookedModel::MaterialRecord& CookedModel::Reader::getMaterial(UInt32 index) const {
+        return this->getRecords<MaterialRecord>(Section::Materials)[index];
+    }
+
+    UInt32 CookedModel::Reader::getMeshCount() const {
+        return this->getCount(Section::Meshes);
+    }
+
+    const CookedModel::MeshRecord& CookedModel::Reader::getMesh(UInt32 index) const {
+        return this->getRecords<MeshRecord>(Section::Meshes)[index];
+    }
+
+    /*
+     * Get [stream] of [mesh] in place in the mapped file, or nullptr if the mesh does not have it.
+     */
+    const void* CookedModel::Reader::getStream(const MeshRecord& mesh, Stream stream) const {
+        UInt64 offset = mesh.streams[(UInt32)stream];
+        if (offset == NoStream) return nullptr;
+        return this->getRecords<Byte>(Section::Data) + offset;
+    }
+
+    UInt32 CookedModel::Reader::getNodeCount() const {
+        return this->getCount(Section::Nodes);
+    }
+
+    const CookedModel::NodeRecord& CookedModel::Reader::getNode(UInt32 index) const {
+        return this->getRecords<NodeRecord>(Section::Nodes)[index];
+    }
+
+    std::string CookedModel::Reader::getNodeName(const NodeRecord& node) const {
+        return std::string(this->getRecords<Char>(Section::Strings) + node.nameOffset, node.nameLength);
+    }
+
+    const UInt32* CookedModel::Reader::getMeshReferences(const NodeRecord& node) const {
+        return this->getRecords<UInt32>(Section::MeshReferences) + node.firstMeshReference;
+    }
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../common/types.h"
+#include "../common/Exception.h"
+#include "../base/BitMask.h"
+#include "../filesys/MappedFile.h"
+
+namespace Core {
+
+    /*
+     * Binary format for models that have already been imported, so they can be loaded again without
+     * Assimp. A cooked model holds exactly what ModelLoader builds from a model file: the Object3D
+     * hierarchy with local matrices, every mesh with its final vertex attributes and indices, the
+     * shader characteristics of each material and the image files of its textures.
+     *
+     * The file is laid out to be memory-mapped and read in place. It starts with a Header whose
+     * section table locates fixed-size records for each kind of object; strings live in one string
+     * section and all vertex and index streams in one data section, each stream aligned to
+     * [Alignment] bytes so it can be copied straight into an AttributeArray. Numbers are stored in
+     * the byte order and Real size of the machine that cooked the file. The header and every
+     * section carry a CRC-32, and files with a different [Version] are rejected.
+     */
+    class CookedModel {
+    public:
+        class CookedModelException : public Exception {
+        public:
+            CookedModelException(const std::string& msg) : Exception(msg) {
+            }
+            CookedModelException(const char* msg) : Exception(msg) {
+            }
+        };
+
+        enum class Section { Strings = 0, Textures = 1, Materials = 2, Meshes = 3, Nodes = 4, MeshReferences = 5, Data = 6, _Count = 7 };
+
+        enum class Stream { Positions = 0, Normals = 1, AveragedNormals = 2, FaceNormals = 3, Tangents = 4,
+                            Colors = 5, AlbedoUVs = 6, NormalUVs = 7, Indices = 8, _Count = 9 };
+
+        enum class TextureSlot { Albedo = 0, Normals = 1, RoughnessGloss = 2, _Count = 3 };
+
+        // "CMDL"
+        static const UInt32 Magic = 0x4C444D43;
+        static const UInt32 Version = 1;
+        static const UInt32 Alignment = 16;
+        static const Int32 None = -1;
+        static const UInt64 NoStream = 0xFFFFFFFFFFFFFFFFull;
+
+        // MeshRecord flags
+        static const UInt32 CompressedAttributes = 0x1;
+
+        class SectionRecord {
+        public:
+            UInt64 offset;
+            UInt64 size;
+            UInt32 count;
+            UInt32 checksum;
+        };
+
+        class Header {
+        public:
+            UInt32 magic;
+            UInt32 version;
+            UInt32 headerSize;
+            UInt32 realSize;
+            UInt64 fileSize;
+            UInt32 headerChecksum;
+            UInt32 reserved;
+            SectionRecord sections[(UInt32)Section::_Count];
+        };
+
+        class TextureRecord {
+        public:
+            UInt32 pathOffset;
+            UInt32 pathLength;
+        };
+
+        class MaterialRecord {
+        public:
+            LongMask shaderMaterialCharacteristics;
+            Int32 textures[(UInt32)TextureSlot::_Count];
+            UInt32 reserved;
+        };
+
+        class MeshRecord {
+        public:
+            UInt32 vertexCount;
+            UInt32 indexCount;
+            UInt32 material;
+            UInt32 flags;
+            UInt32 enabledAttributes;
+            UInt32 reserved;
+            // offsets into the data section, or NoStream
+            UInt64 streams[(UInt32)Stream::_Count];
+        };
+
+        // nodes are stored parents first; a node with a material is a mesh container whose
+        // meshes are [meshReferenceCount] entries of the mesh reference section
+        class NodeRecord {
+        public:
+            UInt32 nameOffset;
+            UInt32 nameLength;
+            Int32 parent;
+            Int32 material;
+            UInt32 firstMeshReference;
+            UInt32 meshReferenceCount;
+            Real localMatrix[16];
+        };
+
+        class Writer {
+        public:
+            Writer();
+
+            UInt32 addTexture(const std::string& path);
+            UInt32 addMaterial(LongMask shaderMaterialCharacteristics, const Int32* textures);
+            UInt32 addMesh(UInt32 vertexCount, UInt32 indexCount, UInt32 material, UInt32 flags, UInt32 enabledAttributes, const void* const* streams);
+            UInt32 addNode(const std::string& name, Int32 parent, const Real* localMatrix, Int32 material, const std::vector<UInt32>& meshes);
+            void save(const std::string& path) const;
+
+        private:
+            UInt32 addString(const std::string& value);
+            UInt64 addData(const void* source, UInt64 size);
+
+            std::string strings;
+            std::map<std::string, UInt32> textureSlots;
+            std::vector<TextureRecord> textures;
+            std::vector<MaterialRecord> materials;
+            std::vector<MeshRecord> meshes;
+            std::vector<NodeRecord> nodes;
+            std::vector<UInt32> meshReferences;
+            std::vector<Byte> data;
+        };
+
+        class Reader {
+        public:
+            Reader();
+
+            void open(const std::string& path);
+            void close();
+
+            UInt32 getTextureCount() const;
+            std::string getTexturePath(UInt32 index) const;
+            UInt32 getMaterialCount() const;
+            const MaterialRecord& getMaterial(UInt32 index) const;
+            UInt32 getMeshCount() const;
+            const MeshRecord& getMesh(UInt32 index) const;
+            const void* getStream(const MeshRecord& mesh, Stream stream) const;
+            UInt32 getNodeCount() const;
+            const NodeRecord& getNode(UInt32 index) const;
+            std::string getNodeName(const NodeRecord& node) const;
+            const UInt32* getMeshReferences(const NodeRecord& node) const;
+
+        private:
+            void validate() const;
+
+            template <typename T>
+            const T* getRecords(Section section) const {
+                return (const T*)(this->file.getData() + this->header->sections[(UInt32)section].offset);
+            }
+
+            UInt32 getCount(Section section) const {
+                return this->header->sections[(UInt32)section].count;
+            }
+
+            MappedFile file;
+            const Header* header;
+        };
+
+        static UInt32 calculateChecksum(const Byte* data, UInt64 size);
+        static UInt64 getStreamSize(Stream stream, UInt32 vertexCount, UInt32 indexCount);
+
+    private:
+        CookedModel();
+    };
+}
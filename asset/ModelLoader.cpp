@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <bitset>
+#include <exception>
+#include <string.h>
 #include <fstream>
 #include <queue>
 
@@ -11,11 +14,21 @@
 #include "assimp/scene.h"
 
 #include "../Engine.h"
+#include "../util/ThreadPool.h"
+#include "../common/debug.h"
+#include "../geometry/IndexBuffer.h"
+#include "../geometry/Mesh.h"
+#include "../geometry/MeshOptimizer.h"
+#include "../geometry/VertexWelder.h"
 #include "../filesys/FileSystem.h"
 #include "../scene/Object3D.h"
 #include "../image/Texture.h"
 #include "../image/TextureAttr.h"
+#include "../image/TextureCache.h"
 #include "../image/Texture2D.h"
+#include "../image/TextureCompressor.h"
+#include "../image/MipChainBuilder.h"
+#include "../image/TextureStreamer.h"
 #include "../material/Material.h"
 #include "../material/BasicTexturedMaterial.h"
 #include "../material/BasicTexturedLitMaterial.h"
@@ -30,7 +43,15 @@
 namespace Core {
     static std::shared_ptr<Assimp::Importer> importer = nullptr;
 
-    ModelLoader::ModelLoader() {
+    // textures larger than this get little from sharing a texture and would crowd an atlas
+    static const UInt32 MaxAtlasedTextureSize = 512;
+    // numbers the texture cache keys of atlas textures, which have no file of their own; only used on the main thread
+    static UInt32 nextTextureAtlasID = 0;
+    // level ranges for ModelLoader::decodeTextureImage(): a streamed texture's tail, and the end of its mip chain
+    static const UInt32 TailTextureLevel = 0xFFFFFFFF;
+    static const UInt32 LastTextureLevel = 0xFFFFFFFF;
+
+    ModelLoader::ModelLoader(): compressTextures(false), streamTextures(false), atlasTextures(false) {
     }
 
     ModelLoader::~ModelLoader() {
@@ -47,17 +68,13 @@ namespace Core {
     }
 
     /**
-     * Load an Assimp compatible model/scene located at [filePath]. [filePath] Must be a native file-system
-     * compatible path, so the the engine's FileSystem singleton should be used to derive the correct platform-specific
-     * path before calling this method.
+     * Load an Assimp compatible model/scene located at [filePath] with [importer], which owns the returned scene.
+     * [filePath] Must be a native file-system compatible path, so the the engine's FileSystem singleton should be
+     * used to derive the correct platform-specific path before calling this method.
      */
-    const aiScene* ModelLoader::loadAIScene(const std::string& filePath, Bool preserveFBXPivots) {
-        // the global Assimp scene object
+    const aiScene* ModelLoader::loadAIScene(Assimp::Importer& importer, const std::string& filePath, Bool preserveFBXPivots) {
         const aiScene* scene = nullptr;
 
-        // Create an instance of the Assimp Importer class
-        this->initImporter();
-
         // Check if model file exists
         std::ifstream fin(filePath.c_str());
         if (!fin.fail()) {
@@ -68,14 +85,14 @@ namespace Core {
         }
 
         // tell Assimp not to create extra nodes when importing FBX files
-        importer->SetPropertyInteger(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, preserveFBXPivots ? 1 : 0);
+        importer.SetPropertyInteger(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, preserveFBXPivots ? 1 : 0);
 
         // read the model file in from disk
-        scene = importer->ReadFile(filePath, aiProcessPreset_TargetRealtime_Quality);
+        scene = importer.ReadFile(filePath, aiProcessPreset_TargetRealtime_Quality);
 
         // If the import failed, report it
         if (!scene) {
-            std::string msg = std::string("ModeLoader::loadAIScene -> Could not import file: ") + std::string(importer->GetErrorString());
+            std::string msg = std::string("ModeLoader::loadAIScene -> Could not import file: ") + std::string(importer.GetErrorString());
             throw ModelLoaderException(msg);
         }
 
@@ -95,11 +112,13 @@ namespace Core {
         std::string fixedModelPath = fileSystem->fixupPathForLocalFilesystem(modelPath);
 
         // the global Assimp scene object
-        const aiScene* scene = this->loadAIScene(fixedModelPath, preserveFBXPivots);
+        this->initImporter();
+        const aiScene* scene = ModelLoader::loadAIScene(*importer, fixedModelPath, preserveFBXPivots);
 
         if (scene) {
             // the model has been loaded from disk into Assimp data structures, now convert to engine-native structures
-            WeakPointer<Object3D> result = processModelScene(fixedModelPath, *scene, importScale, smoothingThreshold, castShadows, receiveShadows, preferPhysicalMaterial);
+            WeakPointer<Object3D> result = processModelScene(fixedModelPath, *scene, importScale, smoothingThreshold, castShadows, receiveShadows,
+                                                             preferPhysicalMaterial, nullptr, nullptr);
             result->setActive(true);
             return result;
         } else {
@@ -107,37 +126,444 @@ namespace Core {
         }
     }
 
+    /**
+     * Load the model at [modelPath] exactly like loadModel() does, and additionally write the result to a cooked
+     * model file at [cookedPath] that loadCookedModel() can load later without going through Assimp.
+     *
+     * [cookedPath] - Native file-system compatible path of the cooked model file to write.
+     */
+    WeakPointer<Object3D> ModelLoader::cookModel(const std::string& modelPath, const std::string& cookedPath, Real importScale, UInt32 smoothingThreshold,
+                                                 Bool castShadows, Bool receiveShadows, Bool preserveFBXPivots, Bool preferPhysicalMaterial) {
+        std::shared_ptr<FileSystem> fileSystem = FileSystem::getInstance();
+        std::string fixedModelPath = fileSystem->fixupPathForLocalFilesystem(modelPath);
+
+        this->initImporter();
+        const aiScene* scene = ModelLoader::loadAIScene(*importer, fixedModelPath, preserveFBXPivots);
+        if (!scene) {
+            throw ModelLoaderException("ModelLoder::cookModel() -> Error occured while loading Assimp scene.");
+        }
+
+        CookedModel::Writer cookedModel;
+        WeakPointer<Object3D> result = processModelScene(fixedModelPath, *scene, importScale, smoothingThreshold, castShadows, receiveShadows,
+                                                         preferPhysicalMaterial, &cookedModel, nullptr);
+        cookedModel.save(fileSystem->fixupPathForLocalFilesystem(cookedPath));
+        result->setActive(true);
+        return result;
+    }
+
+    /**
+     * Load a model that was written by cookModel(). The vertex data is read in place from the memory-mapped file and
+     * goes straight into the meshes' attribute arrays, so none of the import, welding, optimization, normal or
+     * tangent generation work is repeated.
+     *
+     * [cookedPath] - Native file-system compatible path of the cooked model file.
+     */
+    WeakPointer<Object3D> ModelLoader::loadCookedModel(const std::string& cookedPath, Bool castShadows, Bool receiveShadows) {
+        CookedModelImport cookedImport;
+        this->readCookedModel(cookedPath, cookedImport);
+        WeakPointer<Object3D> root = this->instantiateCookedModel(cookedImport, nullptr);
+        ModelLoader::releaseCachedTextures(cookedImport.textureImports);
+        root->setActive(true);
+        return root;
+    }
+
+    /**
+     * Open and validate the cooked model at [cookedPath] and decode the images of its textures into [cookedImport].
+     * Creates no engine objects, so it can run on a streaming thread.
+     */
+    void ModelLoader::readCookedModel(const std::string& cookedPath, CookedModelImport& cookedImport) const {
+        std::shared_ptr<FileSystem> fileSystem = FileSystem::getInstance();
+        CookedModel::Reader& cookedModel = cookedImport.reader;
+        cookedModel.open(fileSystem->fixupPathForLocalFilesystem(cookedPath));
+
+        const TextureType slotTypes[] = {TextureType::Albedo, TextureType::Normals, TextureType::RoughnessGloss};
+        const UInt32 slotCount = (UInt32)CookedModel::TextureSlot::_Count;
+        cookedImport.materialTextures.assign(cookedModel.getMaterialCount() * slotCount, -1);
+        for (UInt32 m = 0; m < cookedModel.getMaterialCount(); m++) {
+            const CookedModel::MaterialRecord& record = cookedModel.getMaterial(m);
+            for (UInt32 t = 0; t < slotCount; t++) {
+                if (record.textures[t] == CookedModel::None) continue;
+                cookedImport.materialTextures[m * slotCount + t] = ModelLoader::addTextureImport(cookedImport.textureImports,
+                                                                   cookedModel.getTexturePath(record.textures[t]),
+                                                                   this->getImportTextureAttributes(slotTypes[t]),
+                                                                   slotTypes[t] == TextureType::Albedo);
+            }
+        }
+        this->decodeTextureImages(cookedImport.textureImports);
+
+        // only physical materials can sample a texture from an atlas
+        std::vector<Bool> packable(cookedImport.textureImports.size(), true);
+        for (UInt32 m = 0; m < cookedModel.getMaterialCount(); m++) {
+            if (LongMaskUtil::isBitSet(cookedModel.getMaterial(m).shaderMaterialCharacteristics, (Int16)ShaderMaterialCharacteristic::Physical)) continue;
+            for (UInt32 t = 0; t < slotCount; t++) {
+                Int32 texture = cookedImport.materialTextures[m * slotCount + t];
+                if (texture >= 0) packable[texture] = false;
+            }
+        }
+        this->packTextureAtlases(cookedImport.textureImports, packable, cookedImport.textureAtlases);
+    }
+
+    /**
+     * Create the textures, materials, meshes and scene objects of a cooked model read by readCookedModel(). The root
+     * object is returned inactive. If [pendingUploads] is given, the meshes are added to it instead of having their
+     * vertex data sent to the GPU, and the textures are left for the caller to build (see addTextureUploads()).
+     */
+    WeakPointer<Object3D> ModelLoader::instantiateCookedModel(CookedModelImport& cookedImport, std::vector<WeakPointer<Mesh>>* pendingUploads) const {
+        const CookedModel::Reader& cookedModel = cookedImport.reader;
+        const UInt32 slotCount = (UInt32)CookedModel::TextureSlot::_Count;
+
+        MaterialLibrary& materialLibrary = Engine::instance()->getMaterialLibrary();
+        std::vector<WeakPointer<Material>> materials;
+        for (UInt32 m = 0; m < cookedModel.getMaterialCount(); m++) {
+            const CookedModel::MaterialRecord& record = cookedModel.getMaterial(m);
+            if (!materialLibrary.hasMaterial(record.shaderMaterialCharacteristics)) {
+                std::string msg = "ModelLoader::loadCookedModel -> Could not find loaded material for: ";
+                msg += std::bitset<64>(record.shaderMaterialCharacteristics).to_string();
+                throw ModelLoaderException(msg);
+            }
+            WeakPointer<Material> material = materialLibrary.getMaterial(record.shaderMaterialCharacteristics)->clone();
+
+            WeakPointer<Texture> textures[slotCount];
+            const TextureImport* textureImports[slotCount] = {};
+            for (UInt32 t = 0; t < slotCount; t++) {
+                Int32 texture = cookedImport.materialTextures[m * slotCount + t];
+                if (texture >= 0) {
+                    textureImports[t] = &cookedImport.textureImports[texture];
+                    textures[t] = this->createTexture(cookedImport.textureImports[texture], cookedImport.textureAtlases);
+                }
+            }
+            this->setTexturesOnMaterial(material, textures[(UInt32)CookedModel::TextureSlot::Albedo], textures[(UInt32)CookedModel::TextureSlot::Normals],
+                                        textures[(UInt32)CookedModel::TextureSlot::RoughnessGloss]);
+            ModelLoader::setTextureRegionsOnMaterial(material, textureImports[(UInt32)CookedModel::TextureSlot::Albedo],
+                                                     textureImports[(UInt32)CookedModel::TextureSlot::Normals],
+                                                     textureImports[(UInt32)CookedModel::TextureSlot::RoughnessGloss]);
+            materials.push_back(material);
+        }
+
+        std::vector<WeakPointer<Mesh>> meshes;
+        for (UInt32 i = 0; i < cookedModel.getMeshCount(); i++) {
+            const CookedModel::MeshRecord& record = cookedModel.getMesh(i);
+            meshes.push_back(this->convertCookedMesh(cookedModel, record, materials[record.material]));
+        }
+        ModelLoader::runParallel((UInt32)meshes.size(), [&meshes](UInt32 i) {
+            meshes[i]->generateAttributes();
+        });
+        if (pendingUploads != nullptr) {
+            pendingUploads->insert(pendingUploads->end(), meshes.begin(), meshes.end());
+        }
+        else {
+            this->buildTextures(cookedImport.textureImports, cookedImport.textureAtlases);
+            for (WeakPointer<Mesh>& mesh : meshes) {
+                mesh->updateGPUStorage();
+            }
+        }
+
+        std::vector<WeakPointer<Object3D>> nodes;
+        for (UInt32 n = 0; n < cookedModel.getNodeCount(); n++) {
+            const CookedModel::NodeRecord& record = cookedModel.getNode(n);
+            WeakPointer<Object3D> node;
+            if (record.material == CookedModel::None) {
+                node = Engine::instance()->createObject3D();
+            }
+            else {
+                WeakPointer<RenderableContainer<Mesh>> meshContainer = Engine::instance()->createObject3D<RenderableContainer<Mesh>>();
+                if (meshContainer.isValid()) {
+                    const UInt32* meshReferences = cookedModel.getMeshReferences(record);
+                    for (UInt32 m = 0; m < record.meshReferenceCount; m++) {
+                        meshContainer->addRenderable(meshes[meshReferences[m]]);
+                    }
+                    Engine::instance()->createRenderer<MeshRenderer>(materials[record.material], meshContainer);
+                }
+                node = meshContainer;
+            }
+            if (!node.isValid()) throw ModelLoaderException("ModelLoader::loadCookedModel -> Could not create scene object.");
+
+            node->setName(cookedModel.getNodeName(record));
+            Matrix4x4 localMatrix;
+            localMatrix.copy(record.localMatrix);
+            node->getTransform().setLocalMatrix(localMatrix);
+            if (record.parent != CookedModel::None) nodes[record.parent]->addChild(node);
+            nodes.push_back(node);
+        }
+
+        WeakPointer<Object3D> root = nodes[0];
+        root->setActive(false);
+        return root;
+    }
+
+    /**
+     * Asynchronous version of loadModel(). The Assimp import, the texture decoding and the preparation of the meshes
+     * run on a streaming thread (see AssetStreamer); creating the engine objects and the GPU uploads of the textures and
+     * meshes run on the main thread during Engine::update(), one upload per texture and mesh, spread across frames
+     * according to the streamer's upload budget. [onLoaded] is invoked with the active model once it is complete; the
+     * returned handle reports progress and errors and can cancel the load. If the load is cancelled or fails, whatever
+     * it had already created is destroyed again.
+     */
+    AssetStreamer::RequestHandle ModelLoader::loadModelAsync(const std::string& modelPath, Real importScale, UInt32 smoothingThreshold,
+                                                             Bool castShadows, Bool receiveShadows, Bool preserveFBXPivots, Bool preferPhysicalMaterial,
+                                                             AssetStreamer::Priority priority, ModelLoadedCallback onLoaded) {
+        std::shared_ptr<FileSystem> fileSystem = FileSystem::getInstance();
+        std::string fixedModelPath = fileSystem->fixupPathForLocalFilesystem(modelPath);
+        std::shared_ptr<ModelSceneImport> sceneImport = std::make_shared<ModelSceneImport>();
+        std::shared_ptr<WeakPointer<Object3D>> result = std::make_shared<WeakPointer<Object3D>>();
+
+        return Engine::instance()->getAssetStreamer().enqueue(priority,
+            [this, fixedModelPath, sceneImport, result, importScale, smoothingThreshold, castShadows, receiveShadows, preserveFBXPivots,
+             preferPhysicalMaterial](AssetStreamer::Request& request) {
+                // the shared importer belongs to the main thread, so each request gets its own
+                std::shared_ptr<Assimp::Importer> requestImporter = std::make_shared<Assimp::Importer>();
+                const aiScene* scene = ModelLoader::loadAIScene(*requestImporter, fixedModelPath, preserveFBXPivots);
+                this->readModelScene(fixedModelPath, *scene, smoothingThreshold, preferPhysicalMaterial, *sceneImport);
+                this->stageTextureLevels(sceneImport->textureImports, sceneImport->textureAtlases);
+
+                request.addUpload(0, [this, result, requestImporter, scene, sceneImport, importScale, smoothingThreshold,
+                                      castShadows, receiveShadows](AssetStreamer::Request& request) {
+                    std::vector<WeakPointer<Mesh>> pendingUploads;
+                    *result = this->instantiateModelScene(*scene, *sceneImport, importScale, smoothingThreshold, castShadows, receiveShadows,
+                                                          nullptr, &pendingUploads);
+                    requestImporter->FreeScene();
+                    this->addTextureUploads(request, sceneImport->textureImports, sceneImport->textureAtlases);
+                    ModelLoader::addMeshUploads(request, pendingUploads);
+                });
+            },
+            [result, sceneImport, onLoaded](AssetStreamer::Request& request) {
+                if (request.getState() == AssetStreamer::State::Complete && result->isValid()) {
+                    // drop the cache references of textures that never got created, and the decoded images
+                    ModelLoader::releaseCachedTextures(sceneImport->textureImports);
+                    (*result)->setActive(true);
+                }
+                else {
+                    ModelLoader::releaseTextures(sceneImport->textureImports, sceneImport->textureAtlases);
+                    if (result->isValid()) ModelLoader::destroyModel(*result);
+                    *result = WeakPointer<Object3D>();
+                }
+                sceneImport->textureImports.clear();
+                sceneImport->textureAtlases.clear();
+                if (result->isValid() && onLoaded) onLoaded(*result);
+            });
+    }
+
+    /**
+     * Store imported textures in block-compressed formats (see getImportTextureAttributes()) instead of RGBA8. Encoding
+     * happens during import; if [textureCacheDirectory] is not empty, encoded images are kept there and reused by later
+     * imports of the same files. The directory must exist.
+     */
+    void ModelLoader::setTextureCompression(Bool compressTextures, const std::string& textureCacheDirectory) {
+        this->compressTextures = compressTextures;
+        this->textureCacheDirectory = textureCacheDirectory;
+    }
+
+    Bool ModelLoader::getTextureCompression() const {
+        return this->compressTextures;
+    }
+
+    /**
+     * Create imported textures with only their smallest mip levels and let the engine's TextureStreamer load the finer
+     * ones as they are needed on screen. Imported textures then get their full mip chain, regardless of
+     * DefaultMaxMipLevels. The finer levels are decoded again from the image file when they are streamed in, and only
+     * the levels needed get encoded; with texture compression on, a texture cache directory is strongly recommended,
+     * since each texture is then encoded in full once and its levels are read from the cache from then on. Streaming stays off if the graphics
+     * system can't stream textures (see Graphics::isTextureStreamingSupported()), so it must be initialized first.
+     */
+    void ModelLoader::setTextureStreaming(Bool streamTextures) {
+        this->streamTextures = streamTextures && Engine::instance()->getGraphicsSystem()->isTextureStreamingSupported();
+    }
+
+    Bool ModelLoader::getTextureStreaming() const {
+        return this->streamTextures;
+    }
+
+    /**
+     * Pack small imported textures of physical materials into shared atlases (see TextureAtlas), so the materials of a
+     * model with many of them use a few textures instead of one each. Only uncompressed, mirror-wrapped textures are
+     * packed, and none while texture streaming is on. Packed textures aren't added to the engine's texture cache, so
+     * another import of the same files decodes them again; the atlases are, under keys of their own, so that every
+     * material slot using one holds a reference to it.
+     */
+    void ModelLoader::setTextureAtlasing(Bool atlasTextures) {
+        this->atlasTextures = atlasTextures;
+    }
+
+    Bool ModelLoader::getTextureAtlasing() const {
+        return this->atlasTextures;
+    }
+
+    /**
+     * Asynchronous version of loadCookedModel(). Mapping and validating the file and decoding its textures happen on
+     * a streaming thread; creating the engine objects and uploading the textures and meshes happen on the main thread
+     * like in loadModelAsync().
+     */
+    AssetStreamer::RequestHandle ModelLoader::loadCookedModelAsync(const std::string& cookedPath, Bool castShadows, Bool receiveShadows,
+                                                                   AssetStreamer::Priority priority, ModelLoadedCallback onLoaded) {
+        std::shared_ptr<CookedModelImport> cookedImport = std::make_shared<CookedModelImport>();
+        std::shared_ptr<WeakPointer<Object3D>> result = std::make_shared<WeakPointer<Object3D>>();
+
+        return Engine::instance()->getAssetStreamer().enqueue(priority,
+            [this, cookedPath, cookedImport, result](AssetStreamer::Request& request) {
+                this->readCookedModel(cookedPath, *cookedImport);
+                this->stageTextureLevels(cookedImport->textureImports, cookedImport->textureAtlases);
+
+                request.addUpload(0, [this, cookedImport, result](AssetStreamer::Request& request) {
+                    std::vector<WeakPointer<Mesh>> pendingUploads;
+                    *result = this->instantiateCookedModel(*cookedImport, &pendingUploads);
+                    this->addTextureUploads(request, cookedImport->textureImports, cookedImport->textureAtlases);
+                    ModelLoader::addMeshUploads(request, pendingUploads);
+                });
+            },
+            [result, cookedImport, onLoaded](AssetStreamer::Request& request) {
+                // release the mapped file and decoded images now rather than with the request handle
+                cookedImport->reader.close();
+                if (request.getState() == AssetStreamer::State::Complete && result->isValid()) {
+                    ModelLoader::releaseCachedTextures(cookedImport->textureImports);
+                    (*result)->setActive(true);
+                }
+                else {
+                    ModelLoader::releaseTextures(cookedImport->textureImports, cookedImport->textureAtlases);
+                    if (result->isValid()) ModelLoader::destroyModel(*result);
+                    *result = WeakPointer<Object3D>();
+                }
+                cookedImport->textureImports.clear();
+                cookedImport->textureAtlases.clear();
+                if (result->isValid() && onLoaded) onLoaded(*result);
+            });
+    }
+
+    /**
+     * Queue one upload on [request] for every mesh in [meshes], sized by the vertex data it sends to the GPU.
+     */
+    void ModelLoader::addMeshUploads(AssetStreamer::Request& request, const std::vector<WeakPointer<Mesh>>& meshes) {
+        for (const WeakPointer<Mesh>& mesh : meshes) {
+            request.addUpload(mesh->getGPUStorageSize(), [mesh](AssetStreamer::Request& request) {
+                WeakPointer<Mesh> uploadMesh = mesh;
+                uploadMesh->updateGPUStorage();
+            });
+        }
+    }
+
+    /**
+     * Destroy the scene objects below and including [root], and the meshes and materials they render with, of a model
+     * whose asynchronous load was cancelled or failed after it had been instantiated.
+     */
+    void ModelLoader::destroyModel(WeakPointer<Object3D> root) {
+        std::vector<WeakPointer<Object3D>> objects(1, root);
+        std::vector<WeakPointer<Mesh>> meshes;
+        std::vector<WeakPointer<Material>> materials;
+        for (UInt32 i = 0; i < objects.size(); i++) {
+            WeakPointer<Object3D> object = objects[i];
+            for (UInt32 c = 0; c < object->childCount(); c++) {
+                objects.push_back(object->getChild(c));
+            }
+            WeakPointer<RenderableContainer<Mesh>> meshContainer = WeakPointer<Object3D>::dynamicPointerCast<RenderableContainer<Mesh>>(object);
+            if (!meshContainer.isValid()) continue;
+            for (const WeakPointer<Mesh>& mesh : meshContainer->getRenderables()) {
+                if (std::find(meshes.begin(), meshes.end(), mesh) == meshes.end()) meshes.push_back(mesh);
+            }
+            WeakPointer<MeshRenderer> renderer = WeakPointer<ObjectRenderer<Mesh>>::dynamicPointerCast<MeshRenderer>(meshContainer->getRenderer());
+            if (renderer.isValid() && std::find(materials.begin(), materials.end(), renderer->getMaterial()) == materials.end()) {
+                materials.push_back(renderer->getMaterial());
+            }
+        }
+
+        Engine::instance()->destroyObject3D(root);
+        for (WeakPointer<Mesh>& mesh : meshes) {
+            Engine::instance()->destroyMesh(mesh);
+        }
+        for (WeakPointer<Material>& material : materials) {
+            Engine::instance()->destroyMaterial(material);
+        }
+    }
+
     WeakPointer<Object3D> ModelLoader::processModelScene(const std::string& modelPath, const aiScene& scene, Real importScale,
-                                                         UInt32 smoothingThreshold, Bool castShadows, Bool receiveShadows, Bool preferPhysicalMaterial) const {
-        // container for MaterialImportDescriptor instances that describe the engine-native
-        // materials that get created during the call to ProcessMaterials()
-        std::vector<MaterialImportDescriptor> materialImportDescriptors;
+                                                         UInt32 smoothingThreshold, Bool castShadows, Bool receiveShadows, Bool preferPhysicalMaterial,
+                                                         CookedModel::Writer* cookedModel, std::vector<WeakPointer<Mesh>>* pendingUploads) const {
+        ModelSceneImport sceneImport;
+        this->readModelScene(modelPath, scene, smoothingThreshold, preferPhysicalMaterial, sceneImport);
+        WeakPointer<Object3D> root = this->instantiateModelScene(scene, sceneImport, importScale, smoothingThreshold, castShadows,
+                                                                 receiveShadows, cookedModel, pendingUploads);
+        ModelLoader::releaseCachedTextures(sceneImport.textureImports);
+        return root;
+    }
 
+    /**
+     * The part of processModelScene() that does not create any engine objects, so that it can run on a streaming
+     * thread: find and decode the textures the materials use, work out the materials' import details and convert
+     * the meshes to welded, optimized vertex data with normals and tangents. The results go to [sceneImport].
+     */
+    void ModelLoader::readModelScene(const std::string& modelPath, const aiScene& scene, UInt32 smoothingThreshold, Bool preferPhysicalMaterial,
+                                     ModelSceneImport& sceneImport) const {
         // verify that we have a valid scene
-        if (scene.mRootNode == nullptr) throw ModelLoaderException("ModelLoader::processModelScene -> Assimp scene root is null.");
-        
+        if (scene.mRootNode == nullptr) throw ModelLoaderException("ModelLoader::readModelScene -> Assimp scene root is null.");
+
         std::shared_ptr<FileSystem> fileSystem = FileSystem::getInstance();
         std::string fixedModelPath = fileSystem->fixupPathForLocalFilesystem(modelPath);
 
-        // process all the Assimp materials in [scene] and create equivalent engine native materials.
-        // store those materials and their properties in MaterialImportDescriptor instances, which get
-        // added to [materialImportDescriptors]
-        Bool processMaterialsSuccess = this->processMaterials(fixedModelPath, scene, materialImportDescriptors, preferPhysicalMaterial);
-        if (!processMaterialsSuccess) {
-            throw ModelLoaderException("ModelLoader::processModelScene -> processMaterials() returned an error.");
-        }
+        // process all the Assimp materials in [scene] and store their properties in MaterialImportDescriptor
+        // instances; the engine native materials are created later by createMaterials()
+        this->readMaterials(fixedModelPath, scene, preferPhysicalMaterial, sceneImport);
+
+        // find every distinct way a mesh is referenced by the scene's nodes and convert those meshes to
+        // engine-ready vertex data in parallel; this is pure CPU work
+        this->collectMeshImports(scene, *(scene.mRootNode), sceneImport.materialImportDescriptors, sceneImport.importedMeshes,
+                                 sceneImport.importedMeshSlots);
+        std::vector<ImportedMeshData>& importedMeshes = sceneImport.importedMeshes;
+        ModelLoader::runParallel((UInt32)importedMeshes.size(), [this, &scene, &importedMeshes, smoothingThreshold](UInt32 i) {
+            this->prepareAssimpMesh(scene, importedMeshes[i], smoothingThreshold);
+        });
+    }
+
+    /**
+     * The part of processModelScene() that creates the engine objects from what readModelScene() stored in
+     * [sceneImport]; it must run on the main thread. If [pendingUploads] is given, the meshes are added to it and the
+     * textures left unbuilt, as in instantiateCookedModel().
+     */
+    WeakPointer<Object3D> ModelLoader::instantiateModelScene(const aiScene& scene, ModelSceneImport& sceneImport, Real importScale,
+                                                             UInt32 smoothingThreshold, Bool castShadows, Bool receiveShadows,
+                                                             CookedModel::Writer* cookedModel, std::vector<WeakPointer<Mesh>>* pendingUploads) const {
+        std::vector<MaterialImportDescriptor>& materialImportDescriptors = sceneImport.materialImportDescriptors;
+        this->createMaterials(scene, sceneImport);
 
         // container for all the SceneObject instances that get created during this process
         std::vector<WeakPointer<Object3D>> createdSceneObjects;
+        std::vector<WeakPointer<Mesh>> createdMeshes;
 
         // recursively move down the Assimp scene hierarchy and process each node one by one.
         // all instances of SceneObject that are generated get stored in [createdSceneObjects].
         // any time meshes or mesh renderers are created, the information in [materialImportDescriptors]
         // will be used to link their materials and textures as appropriate.
 
-        WeakPointer <Object3D> root = recursiveProcessModelScene(scene, *(scene.mRootNode), materialImportDescriptors, createdSceneObjects,
+        WeakPointer <Object3D> root = recursiveProcessModelScene(scene, *(scene.mRootNode), materialImportDescriptors, sceneImport.importedMeshes,
+                                                                 sceneImport.importedMeshSlots, createdSceneObjects, createdMeshes,
                                                                  smoothingThreshold, castShadows, receiveShadows);
-        root->getTransform().getLocalMatrix().scale(importScale, importScale, importScale);
+
+        // the bounding boxes are still left to calculate, after which the textures and GPU buffers
+        // are filled on this thread, unless the caller spreads that out itself
+        ModelLoader::runParallel((UInt32)createdMeshes.size(), [&createdMeshes](UInt32 i) {
+            createdMeshes[i]->generateAttributes();
+        });
+        if (pendingUploads != nullptr) {
+            pendingUploads->insert(pendingUploads->end(), createdMeshes.begin(), createdMeshes.end());
+        }
+        else {
+            this->buildTextures(sceneImport.textureImports, sceneImport.textureAtlases);
+            for (WeakPointer<Mesh>& mesh : createdMeshes) {
+                mesh->updateGPUStorage();
+            }
+        }
+        Matrix4x4 rootMatrix = root->getTransform().getConstLocalMatrix();
+        rootMatrix.scale(importScale, importScale, importScale);
+        root->getTransform().setLocalMatrix(rootMatrix);
+
+        if (cookedModel != nullptr) {
+            std::map<const Material*, const MeshSpecificMaterialDescriptor*> materialProperties;
+            for (MaterialImportDescriptor& materialImportDescriptor : materialImportDescriptors) {
+                for (auto& properties : materialImportDescriptor.meshSpecificProperties) {
+                    if (properties.second.material.isValid()) materialProperties[properties.second.material.get()] = &properties.second;
+                }
+            }
+            std::map<const Material*, UInt32> cookedMaterials;
+            std::map<const Mesh*, UInt32> cookedMeshes;
+            this->cookModelScene(root, CookedModel::None, materialProperties, cookedMaterials, cookedMeshes, *cookedModel);
+        }
 
         // deactivate the root scene object so that it is not immediately
         // active or visible in the scene after it has been loaded
@@ -174,9 +600,73 @@ namespace Core {
         return root;
     }
 
+    /**
+     * Walk the Assimp node hierarchy below [node] and add an entry to [importedMeshes] for every distinct
+     * combination of mesh and winding order the nodes reference. [importedMeshSlots] maps the key of each
+     * combination (see getMeshImportKey()) to its entry. The per-mesh material properties are copied into
+     * the entries so that preparing them does not need to touch [materialImportDescriptors].
+     */
+    void ModelLoader::collectMeshImports(const aiScene& scene, const aiNode& node, std::vector<MaterialImportDescriptor>& materialImportDescriptors,
+                                         std::vector<ImportedMeshData>& importedMeshes, std::map<UInt32, UInt32>& importedMeshSlots) const {
+        Matrix4x4 mat;
+        ModelLoader::convertAssimpMatrix(node.mTransformation, mat);
+        Bool invert = ModelLoader::hasOddReflections(mat);
+
+        for (UInt32 n = 0; n < node.mNumMeshes; n++) {
+            UInt32 sceneMeshIndex = node.mMeshes[n];
+            const aiMesh* mesh = sceneMeshIndex < scene.mNumMeshes ? scene.mMeshes[sceneMeshIndex] : nullptr;
+            if (mesh == nullptr) {
+                throw ModelLoaderException("ModelLoader::collectMeshImports -> Assimp node mesh is null.");
+            }
+
+            UInt32 key = ModelLoader::getMeshImportKey(sceneMeshIndex, invert);
+            if (importedMeshSlots.find(key) != importedMeshSlots.end()) continue;
+
+            ImportedMeshData data;
+            data.meshIndex = sceneMeshIndex;
+            data.invert = invert;
+            data.properties = materialImportDescriptors[mesh->mMaterialIndex].meshSpecificProperties[sceneMeshIndex];
+            importedMeshSlots[key] = (UInt32)importedMeshes.size();
+            importedMeshes.push_back(data);
+        }
+
+        for (UInt32 i = 0; i < node.mNumChildren; i++) {
+            const aiNode* childNode = node.mChildren[i];
+            if (childNode != nullptr) {
+                this->collectMeshImports(scene, *childNode, materialImportDescriptors, importedMeshes, importedMeshSlots);
+            }
+        }
+    }
+
+    UInt32 ModelLoader::getMeshImportKey(UInt32 meshIndex, Bool invert) {
+        return meshIndex * 2 + (invert ? 1 : 0);
+    }
+
+    /**
+     * Invoke [func] for every index in [0, count) on the engine's thread pool. An exception thrown by any
+     * invocation is re-thrown on the calling thread once all of them have finished.
+     */
+    void ModelLoader::runParallel(UInt32 count, const std::function<void(UInt32)>& func) {
+        std::vector<std::exception_ptr> errors(count);
+        Engine::instance()->getThreadPool().parallelFor(count, [&func, &errors](UInt32 i) {
+            try {
+                func(i);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+        for (std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
     WeakPointer<Object3D> ModelLoader::recursiveProcessModelScene(const aiScene& scene, const aiNode& node,
                                                                   std::vector<MaterialImportDescriptor>& materialImportDescriptors,
-                                                                  std::vector<WeakPointer<Object3D>>& createdSceneObjects, 
+                                                                  const std::vector<ImportedMeshData>& importedMeshes,
+                                                                  const std::map<UInt32, UInt32>& importedMeshSlots,
+                                                                  std::vector<WeakPointer<Object3D>>& createdSceneObjects,
+                                                                  std::vector<WeakPointer<Mesh>>& createdMeshes,
                                                                   UInt32 smoothingThreshold, Bool castShadows, Bool receiveShadows) const {
         WeakPointer<Object3D> nodeObject;
         nodeObject = Engine::instance()->createObject3D();
@@ -186,7 +676,7 @@ namespace Core {
         Matrix4x4 mat;
         aiMatrix4x4 matBaseTransformation = node.mTransformation;
         ModelLoader::convertAssimpMatrix(matBaseTransformation, mat);
-        nodeObject->getTransform().getLocalMatrix().copy(mat);
+        nodeObject->getTransform().setLocalMatrix(mat);
 
         std::queue<WeakPointer<Mesh>> tempMeshes;
         std::queue<std::string> tempMeshNames;
@@ -214,12 +704,17 @@ namespace Core {
                         throw ModelLoaderException("ModelLoader::recursiveProcessModelScene -> nullptr Material object encountered.");
                     }
 
-                    // if the transformation matrix for this node has an inverted scale, we need to process the mesh
-                    // differently or else it won't display correctly. we pass the [invert] flag to convertAssimpMesh()
+                    // if the transformation matrix for this node has an inverted scale, the mesh was prepared
+                    // differently or else it won't display correctly (see collectMeshImports())
                     Bool invert = ModelLoader::hasOddReflections(mat);
+                    auto importedMesh = importedMeshSlots.find(ModelLoader::getMeshImportKey(sceneMeshIndex, invert));
+                    if (importedMesh == importedMeshSlots.end()) {
+                        throw ModelLoaderException("ModelLoader::recursiveProcessModelScene -> Mesh was not prepared for import.");
+                    }
 
-                    // convert Assimp mesh to a Mesh object
-                    WeakPointer<Mesh> subMesh = this->convertAssimpMesh(sceneMeshIndex, scene, materialImportDescriptor, invert, smoothingThreshold);
+                    // convert the prepared mesh to a Mesh object
+                    WeakPointer<Mesh> subMesh = this->convertAssimpMesh(importedMeshes[importedMesh->second], material, smoothingThreshold);
+                    createdMeshes.push_back(subMesh);
                     tempMeshes.push(subMesh);
                     std::string meshName(mesh->mName.C_Str());
                     if (meshName.size() == 0) {
@@ -273,7 +768,8 @@ namespace Core {
         for (UInt32 i = 0; i < node.mNumChildren; i++) {
             const aiNode* childNode = node.mChildren[i];
             if (childNode != nullptr) {
-                WeakPointer<Object3D> childObject = this->recursiveProcessModelScene(scene, *childNode, materialImportDescriptors, createdSceneObjects, 
+                WeakPointer<Object3D> childObject = this->recursiveProcessModelScene(scene, *childNode, materialImportDescriptors, importedMeshes,
+                                                                                     importedMeshSlots, createdSceneObjects, createdMeshes,
                                                                                      smoothingThreshold, castShadows, receiveShadows);
                 nodeObject->addChild(childObject);
             }
@@ -283,22 +779,23 @@ namespace Core {
     }
 
     /**
-     * Convert an Assimp mesh to an engine-native SubMesh3D instance.
+     * Convert the Assimp mesh referenced by [data] to welded, indexed vertex data that is optimized for the
+     * GPU's vertex cache, calculate its normals and tangents, and store the result in [data]. This only reads
+     * [scene] and writes [data], so several meshes can be prepared at once on worker threads.
      *
-     * [meshIndex] - The index of the target Assimp mesh in the scene's list of meshes
      * [scene] - The Assimp scene/model.
-     * [materialImportDescriptor] - Descriptor for the mesh's material.
-     * [invert] - If true it means the mesh has an inverted scale transformation to deal with
+     * [data] - Which mesh to convert, how (see ImportedMeshData) and where the result goes.
+     * [smoothingThreshold] - Angle in degrees below which normals of adjacent faces are averaged.
      */
-    WeakPointer<Mesh> ModelLoader::convertAssimpMesh(UInt32 meshIndex, const aiScene& scene, MaterialImportDescriptor& materialImportDescriptor,
-                                                     Bool invert, UInt32 smoothingThreshold) const {
+    void ModelLoader::prepareAssimpMesh(const aiScene& scene, ImportedMeshData& data, UInt32 smoothingThreshold) const {
+        UInt32 meshIndex = data.meshIndex;
+        Bool invert = data.invert;
         if (meshIndex >= scene.mNumMeshes) {
-            throw ModelLoaderException("ModelLoader::convertAssimpMesh -> mesh index is out of range.");
+            throw ModelLoaderException("ModelLoader::prepareAssimpMesh -> mesh index is out of range.");
         }
 
         aiMesh& mesh = *scene.mMeshes[meshIndex];
-
-        UInt32 vertexCount = mesh.mNumFaces * 3;
+        MeshSpecificMaterialDescriptor& properties = data.properties;
 
         // create a set of standard attributes that will dictate the standard attributes
         // to be used by the function object created by this function.
@@ -309,16 +806,16 @@ namespace Core {
 
         Int32 diffuseTextureUVIndex = -1;
         // update the StandardAttributeSet to contain appropriate attributes (UV coords) for a diffuse texture
-        if (materialImportDescriptor.meshSpecificProperties[meshIndex].uvMappingHasKey(TextureType::Albedo)) {
+        if (properties.uvMappingHasKey(TextureType::Albedo)) {
             StandardAttributes::addAttribute(&meshAttributes, ModelLoader::mapTextureTypeToAttribute(TextureType::Albedo));
-            diffuseTextureUVIndex = materialImportDescriptor.meshSpecificProperties[meshIndex].uvMapping[TextureType::Albedo];
+            diffuseTextureUVIndex = properties.uvMapping[TextureType::Albedo];
         }
 
         Int32 normalsTextureUVIndex = -1;
         // update the StandardAttributeSet to contain appropriate attributes (UV coords) for a normals texture
-        if (materialImportDescriptor.meshSpecificProperties[meshIndex].uvMappingHasKey(TextureType::Normals)) {
+        if (properties.uvMappingHasKey(TextureType::Normals)) {
             StandardAttributes::addAttribute(&meshAttributes, ModelLoader::mapTextureTypeToAttribute(TextureType::Normals));
-            normalsTextureUVIndex = materialImportDescriptor.meshSpecificProperties[meshIndex].uvMapping[TextureType::Normals];
+            normalsTextureUVIndex = properties.uvMapping[TextureType::Normals];
         }
 
         // add normals & tangents regardless of whether the mesh has them or not. if the mesh does not
@@ -329,79 +826,28 @@ namespace Core {
 
         // if the Assimp mesh's material specifies vertex colors, add vertex colors
         // to the StandardAttributeSet
-        if (materialImportDescriptor.meshSpecificProperties[meshIndex].vertexColorsIndex >= 0) {
+        if (properties.vertexColorsIndex >= 0) {
             StandardAttributes::addAttribute(&meshAttributes, StandardAttribute::Color);
         }
 
-        // create Mesh3D object with the constructed StandardAttributeSet
-        WeakPointer<Mesh> coreMesh = Engine::instance()->createMesh(vertexCount, 0);
-        if (!coreMesh.isValid()) {
-            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Could not create Mesh3D object.");
-        }
-
-        Bool hasNormals = false;
-        Bool hasColors = false;
-        Bool hasAlbedoUVs = false;
-        Bool hasNormalUVs = false;
+        Int32 colorsIndex = properties.vertexColorsIndex;
+        Bool hasNormals = true;
+        Bool hasColors = data.hasColors = colorsIndex >= 0;
+        Bool hasAlbedoUVs = data.hasAlbedoUVs = diffuseTextureUVIndex >= 0;
+        Bool hasNormalUVs = data.hasNormalUVs = normalsTextureUVIndex >= 0;
 
         std::vector<Real> positions;
-        if (!coreMesh->initVertexPositions()) {
-            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize vertex positions.");
-        }
         positions.reserve(mesh.mNumFaces * 12);
-        coreMesh->enableAttribute(StandardAttribute::Position);
-
         std::vector<Real> normals;
-        std::vector<Real> faceNormals;
         normals.reserve(mesh.mNumFaces * 12);
-        faceNormals.reserve(mesh.mNumFaces * 12);
-        if (!coreMesh->initVertexNormals()) {
-            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize vertex normals.");
-        }
-        if (!coreMesh->initVertexFaceNormals()) {
-            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize face normals.");
-        }
-        if (!coreMesh->initVertexTangents()) {
-            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize vertex tangents.");
-        }
-        coreMesh->enableAttribute(StandardAttribute::Normal);
-        coreMesh->enableAttribute(StandardAttribute::FaceNormal);
-        coreMesh->enableAttribute(StandardAttribute::Tangent);
-        hasNormals = true;
-
         std::vector<Real> colors;
-        Int32 colorsIndex = materialImportDescriptor.meshSpecificProperties[meshIndex].vertexColorsIndex;
-        if (colorsIndex >= 0) {
-            colors.reserve(mesh.mNumFaces * 12);
-            if (!coreMesh->initVertexColors()) {
-                throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize vertex colors.");
-            }
-            coreMesh->enableAttribute(StandardAttribute::Color);
-            hasColors = true;
-        }
-
+        if (hasColors) colors.reserve(mesh.mNumFaces * 12);
         std::vector<Real> albedoUVs;
-        if (diffuseTextureUVIndex >= 0) {
-            albedoUVs.reserve(mesh.mNumFaces * 6);
-            if (!coreMesh->initVertexAlbedoUVs()) {
-                throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize albedo UVs.");
-            }
-            coreMesh->enableAttribute(StandardAttribute::AlbedoUV);
-            hasAlbedoUVs = true;
-        }
-
+        if (hasAlbedoUVs) albedoUVs.reserve(mesh.mNumFaces * 6);
         std::vector<Real> normalUVs;
-        if (normalsTextureUVIndex >= 0) {
-            normalUVs.reserve(mesh.mNumFaces * 6);
-            if (!coreMesh->initVertexNormalUVs()) {
-                throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize normal UVs.");
-            }
-            coreMesh->enableAttribute(StandardAttribute::NormalUV);
-            hasNormalUVs = true;
-        }
+        if (hasNormalUVs) normalUVs.reserve(mesh.mNumFaces * 6);
 
-        // loop through each face in the mesh and copy relevant vertex attributes
-        // into the newly created Mesh3D object
+        // loop through each face in the mesh and copy the relevant attributes of each of its corners
         for (UInt32 faceIndex = 0; faceIndex < mesh.mNumFaces; faceIndex++) {
             const aiFace* face = mesh.mFaces + faceIndex;
 
@@ -416,6 +862,17 @@ namespace Core {
                 inc = 1;
             }
 
+            Vector3r faceNormal;
+            if (mesh.mNormals == nullptr && face->mNumIndices >= 3) {
+                const aiVector3D& p1 = mesh.mVertices[face->mIndices[0]];
+                const aiVector3D& p2 = mesh.mVertices[face->mIndices[1]];
+                const aiVector3D& p3 = mesh.mVertices[face->mIndices[2]];
+                Vector3r a(p2.x - p1.x, p2.y - p1.y, p2.z - p1.z);
+                Vector3r b(p3.x - p1.x, p3.y - p1.y, p3.z - p1.z);
+                Vector3r::cross(a, b, faceNormal);
+                faceNormal.normalize();
+            }
+
             // ** IMPORTANT ** Normally we iterate through face vertices in reverse order. This is
             // necessary because vertices are stored in counter-clockwise order for each face.
             // if [invert] == true, then we instead iterate in forward order
@@ -436,17 +893,13 @@ namespace Core {
                         normals.push_back(srcNormal.x);
                         normals.push_back(srcNormal.y);
                         normals.push_back(srcNormal.z);
-                        faceNormals.push_back(srcNormal.x);
-                        faceNormals.push_back(srcNormal.y);
-                        faceNormals.push_back(srcNormal.z);
                     }
                     else {
-                        normals.push_back(0.0f);
-                        normals.push_back(0.0f);
-                        normals.push_back(0.0f);
-                        faceNormals.push_back(0.0f);
-                        faceNormals.push_back(0.0f);
-                        faceNormals.push_back(0.0f);
+                        // the normals get calculated later, but until then the face normal keeps
+                        // vertices of differently oriented faces from being welded together
+                        normals.push_back(faceNormal.x);
+                        normals.push_back(faceNormal.y);
+                        normals.push_back(faceNormal.z);
                     }
                     normals.push_back(0.0f);
                 }
@@ -463,7 +916,7 @@ namespace Core {
                 // copy relevant data for albedo texture (UV coords)
                 if (hasAlbedoUVs) {
                     albedoUVs.push_back(mesh.mTextureCoords[diffuseTextureUVIndex][vIndex].x);
-                    if (materialImportDescriptor.meshSpecificProperties[meshIndex].invertVCoords) {
+                    if (properties.invertVCoords) {
                         albedoUVs.push_back(1 - mesh.mTextureCoords[diffuseTextureUVIndex][vIndex].y);
                     } else {
                         albedoUVs.push_back(mesh.mTextureCoords[diffuseTextureUVIndex][vIndex].y);
@@ -472,7 +925,7 @@ namespace Core {
 
                 if (hasNormalUVs) {
                     normalUVs.push_back(mesh.mTextureCoords[normalsTextureUVIndex][vIndex].x);
-                    if (materialImportDescriptor.meshSpecificProperties[meshIndex].invertVCoords) {
+                    if (properties.invertVCoords) {
                         normalUVs.push_back(1 - mesh.mTextureCoords[normalsTextureUVIndex][vIndex].y);
                     } else {
                         normalUVs.push_back(mesh.mTextureCoords[normalsTextureUVIndex][vIndex].y);
@@ -481,21 +934,281 @@ namespace Core {
             }
         }
 
-        coreMesh->getVertexPositions()->store(positions.data());
-        if (hasNormals) {
-            coreMesh->getVertexNormals()->store(normals.data());
-            coreMesh->getVertexFaceNormals()->store(faceNormals.data());
+        // weld the identical corners and describe the triangles with indices instead
+        UInt32 cornerCount = (UInt32)(positions.size() / Point3rs::ComponentCount);
+        std::vector<VertexWelder::AttributeStream> streams;
+        streams.push_back(VertexWelder::AttributeStream(positions.data(), Point3rs::ComponentCount));
+        streams.push_back(VertexWelder::AttributeStream(normals.data(), Vector3rs::ComponentCount));
+        if (hasColors) streams.push_back(VertexWelder::AttributeStream(colors.data(), ColorS::ComponentCount));
+        if (hasAlbedoUVs) streams.push_back(VertexWelder::AttributeStream(albedoUVs.data(), Vector2rs::ComponentCount));
+        if (hasNormalUVs) streams.push_back(VertexWelder::AttributeStream(normalUVs.data(), Vector2rs::ComponentCount));
+
+        std::vector<UInt32> cornerVertices(cornerCount);
+        UInt32 vertexCount = VertexWelder::generateRemap(streams, cornerCount, cornerVertices.data());
+        data.vertexCount = vertexCount;
+        data.indices = cornerVertices;
+
+        // reorder the triangles and vertices for the GPU; [vertexOrder] tells where each welded vertex ends up
+        std::vector<Real> weldedPositions(vertexCount * Point3rs::ComponentCount);
+        VertexWelder::remapVertices(positions.data(), Point3rs::ComponentCount, cornerCount, cornerVertices.data(), weldedPositions.data());
+        std::vector<UInt32> vertexOrder(vertexCount);
+        data.optimization = MeshOptimizer::optimize(data.indices.data(), cornerCount, vertexCount, weldedPositions.data(),
+                                                    Point3rs::ComponentCount, vertexOrder.data());
+        for (UInt32 i = cornerCount - cornerCount % 3; i < cornerCount; i++) data.indices[i] = vertexOrder[data.indices[i]];
+        for (UInt32 c = 0; c < cornerCount; c++) cornerVertices[c] = vertexOrder[cornerVertices[c]];
+
+        data.positions.resize(vertexCount * Point3rs::ComponentCount);
+        VertexWelder::remapVertices(positions.data(), Point3rs::ComponentCount, cornerCount, cornerVertices.data(), data.positions.data());
+        data.normals.resize(vertexCount * Vector3rs::ComponentCount);
+        VertexWelder::remapVertices(normals.data(), Vector3rs::ComponentCount, cornerCount, cornerVertices.data(), data.normals.data());
+        if (hasColors) {
+            data.colors.resize(vertexCount * ColorS::ComponentCount);
+            VertexWelder::remapVertices(colors.data(), ColorS::ComponentCount, cornerCount, cornerVertices.data(), data.colors.data());
+        }
+        if (hasAlbedoUVs) {
+            data.albedoUVs.resize(vertexCount * Vector2rs::ComponentCount);
+            VertexWelder::remapVertices(albedoUVs.data(), Vector2rs::ComponentCount, cornerCount, cornerVertices.data(), data.albedoUVs.data());
+        }
+        if (hasNormalUVs) {
+            data.normalUVs.resize(vertexCount * Vector2rs::ComponentCount);
+            VertexWelder::remapVertices(normalUVs.data(), Vector2rs::ComponentCount, cornerCount, cornerVertices.data(), data.normalUVs.data());
+        }
+
+        // calculate the normals and tangents the same way Mesh::generateAttributes() would, so
+        // that the mesh only has to copy them
+        VertexCrossMap crossMap;
+        Mesh::buildVertexCrossMap(data.positions.data(), data.indices.data(), cornerCount, crossMap);
+        Real normalsSmoothingThreshold = (Real)smoothingThreshold * Math::DegreesToRads;
+        data.averagedNormals.resize(vertexCount * Vector3rs::ComponentCount);
+        data.faceNormals.resize(vertexCount * Vector3rs::ComponentCount);
+        Mesh::generateNormals(data.positions.data(), data.indices.data(), vertexCount, cornerCount, crossMap, normalsSmoothingThreshold,
+                              AttributeView<Vector3rs>(data.normals.data(), vertexCount),
+                              AttributeView<Vector3rs>(data.averagedNormals.data(), vertexCount),
+                              AttributeView<Vector3rs>(data.faceNormals.data(), vertexCount));
+        if (hasNormalUVs || hasAlbedoUVs) {
+            const std::vector<Real>& tangentUVs = hasNormalUVs ? data.normalUVs : data.albedoUVs;
+            data.tangents.resize(vertexCount * Vector3rs::ComponentCount);
+            data.hasTangents = Mesh::generateTangents(data.positions.data(), tangentUVs.data(), data.indices.data(), vertexCount, cornerCount,
+                                                      crossMap, normalsSmoothingThreshold, AttributeView<Vector3rs>(data.tangents.data(), vertexCount));
+        }
+    }
+
+    template <typename T>
+    static void copyVertexData(WeakPointer<AttributeArray<T>> attributes, const std::vector<Real>& data) {
+        memcpy(attributes->getStorage(), data.data(), attributes->getSize());
+    }
+
+    /**
+     * Create an engine-native Mesh from vertex data produced by prepareAssimpMesh(). The data, including the
+     * normals and tangents, is only copied into the mesh; the bounding box still needs calculating
+     * (Mesh::generateAttributes()) and the vertex attributes still need sending to the GPU (Mesh::updateGPUStorage()).
+     *
+     * [data] - The prepared mesh.
+     * [material] - The material created for the mesh by createMaterials().
+     * [smoothingThreshold] - Angle in degrees below which normals of adjacent faces are averaged.
+     */
+    WeakPointer<Mesh> ModelLoader::convertAssimpMesh(const ImportedMeshData& data, WeakPointer<Material> material, UInt32 smoothingThreshold) const {
+        // create Mesh3D object with the constructed StandardAttributeSet
+        WeakPointer<Mesh> coreMesh = Engine::instance()->createMesh(data.vertexCount, (UInt32)data.indices.size(), material);
+        if (!coreMesh.isValid()) {
+            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Could not create Mesh3D object.");
+        }
+        coreMesh->setCompressedAttributes(true);
+
+        if (!coreMesh->initVertexPositions()) {
+            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize vertex positions.");
+        }
+        coreMesh->enableAttribute(StandardAttribute::Position);
+        copyVertexData(coreMesh->getVertexPositions(), data.positions);
+
+        if (!coreMesh->initVertexNormals()) {
+            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize vertex normals.");
+        }
+        if (!coreMesh->initVertexFaceNormals()) {
+            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize face normals.");
+        }
+        if (!coreMesh->initVertexTangents()) {
+            throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize vertex tangents.");
+        }
+        coreMesh->enableAttribute(StandardAttribute::Normal);
+        coreMesh->enableAttribute(StandardAttribute::FaceNormal);
+        coreMesh->enableAttribute(StandardAttribute::Tangent);
+        copyVertexData(coreMesh->getVertexNormals(), data.normals);
+        copyVertexData(coreMesh->getVertexAveragedNormals(), data.averagedNormals);
+        copyVertexData(coreMesh->getVertexFaceNormals(), data.faceNormals);
+        if (data.hasTangents) copyVertexData(coreMesh->getVertexTangents(), data.tangents);
+
+        if (data.hasColors) {
+            if (!coreMesh->initVertexColors()) {
+                throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize vertex colors.");
+            }
+            coreMesh->enableAttribute(StandardAttribute::Color);
+            copyVertexData(coreMesh->getVertexColors(), data.colors);
+        }
+
+        if (data.hasAlbedoUVs) {
+            if (!coreMesh->initVertexAlbedoUVs()) {
+                throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize albedo UVs.");
+            }
+            coreMesh->enableAttribute(StandardAttribute::AlbedoUV);
+            copyVertexData(coreMesh->getVertexAlbedoUVs(), data.albedoUVs);
+        }
+
+        if (data.hasNormalUVs) {
+            if (!coreMesh->initVertexNormalUVs()) {
+                throw ModelLoaderException("ModeLoader::convertAssimpMesh -> Unable to initialize normal UVs.");
+            }
+            coreMesh->enableAttribute(StandardAttribute::NormalUV);
+            copyVertexData(coreMesh->getVertexNormalUVs(), data.normalUVs);
         }
-        if (hasColors) coreMesh->getVertexColors()->store(colors.data());
-        if (hasAlbedoUVs) coreMesh->getVertexAlbedoUVs()->store(albedoUVs.data());
-        if (hasNormalUVs) coreMesh->getVertexNormalUVs()->store(normalUVs.data());
+
+        std::vector<UInt32> indices = data.indices;
+        coreMesh->getIndexBuffer()->setIndices(indices.data());
 
         // if (invert) mesh3D->SetInvertNormals(true);
         coreMesh->setNormalsSmoothingThreshold((Real)smoothingThreshold * Math::DegreesToRads);
-        coreMesh->setCalculateNormals(true);
-        coreMesh->setCalculateTangents(true);
+        coreMesh->setCalculateNormals(false);
+        coreMesh->setCalculateTangents(false);
+        coreMesh->setCalculateBoundingBox(true);
+
+        return coreMesh;
+    }
+
+    /**
+     * Add [object] and everything below it to [cookedModel], as a child of the cooked node [parent]. Materials and
+     * meshes are added the first time a node uses them; [cookedMaterials] and [cookedMeshes] map the ones added so
+     * far to their cooked indices.
+     *
+     * [materialProperties] - The import properties of every material created by createMaterials().
+     */
+    void ModelLoader::cookModelScene(WeakPointer<Object3D> object, Int32 parent,
+                                     const std::map<const Material*, const MeshSpecificMaterialDescriptor*>& materialProperties,
+                                     std::map<const Material*, UInt32>& cookedMaterials, std::map<const Mesh*, UInt32>& cookedMeshes,
+                                     CookedModel::Writer& cookedModel) const {
+        Int32 material = CookedModel::None;
+        std::vector<UInt32> meshes;
+
+        RenderableContainer<Mesh>* meshContainer = dynamic_cast<RenderableContainer<Mesh>*>(object->getRenderableContainer());
+        if (meshContainer != nullptr) {
+            WeakPointer<MeshRenderer> meshRenderer = WeakPointer<ObjectRenderer<Mesh>>::dynamicPointerCast<MeshRenderer>(meshContainer->getRenderer());
+            if (!meshRenderer.isValid()) {
+                throw ModelLoaderException("ModelLoader::cookModelScene -> Mesh container has no mesh renderer.");
+            }
+            material = (Int32)this->cookMaterial(meshRenderer->getMaterial(), materialProperties, cookedMaterials, cookedModel);
+            for (const PersistentWeakPointer<Mesh>& mesh : meshContainer->getRenderables()) {
+                meshes.push_back(this->cookMesh(mesh, (UInt32)material, cookedMeshes, cookedModel));
+            }
+        }
+
+        Int32 node = (Int32)cookedModel.addNode(object->getName(), parent, object->getTransform().getConstLocalMatrix().getConstData(), material, meshes);
+        for (UInt32 i = 0; i < object->childCount(); i++) {
+            this->cookModelScene(object->getChild(i), node, materialProperties, cookedMaterials, cookedMeshes, cookedModel);
+        }
+    }
+
+    UInt32 ModelLoader::cookMaterial(WeakPointer<Material> material, const std::map<const Material*, const MeshSpecificMaterialDescriptor*>& materialProperties,
+                                     std::map<const Material*, UInt32>& cookedMaterials, CookedModel::Writer& cookedModel) const {
+        auto cookedMaterial = cookedMaterials.find(material.get());
+        if (cookedMaterial != cookedMaterials.end()) return cookedMaterial->second;
+
+        auto properties = materialProperties.find(material.get());
+        if (properties == materialProperties.end()) {
+            throw ModelLoaderException("ModelLoader::cookMaterial -> Material was not created by the import.");
+        }
+
+        const TextureType textureTypes[] = {TextureType::Albedo, TextureType::Normals, TextureType::RoughnessGloss};
+        Int32 textures[(UInt32)CookedModel::TextureSlot::_Count];
+        for (UInt32 t = 0; t < (UInt32)CookedModel::TextureSlot::_Count; t++) {
+            auto texturePath = properties->second->texturePaths.find(textureTypes[t]);
+            textures[t] = texturePath == properties->second->texturePaths.end() ? CookedModel::None : (Int32)cookedModel.addTexture(texturePath->second);
+        }
+
+        UInt32 index = cookedModel.addMaterial(properties->second->shaderMaterialChacteristics, textures);
+        cookedMaterials[material.get()] = index;
+        return index;
+    }
+
+    UInt32 ModelLoader::cookMesh(WeakPointer<Mesh> mesh, UInt32 material, std::map<const Mesh*, UInt32>& cookedMeshes, CookedModel::Writer& cookedModel) const {
+        auto cookedMesh = cookedMeshes.find(mesh.get());
+        if (cookedMesh != cookedMeshes.end()) return cookedMesh->second;
+
+        const void* streams[(UInt32)CookedModel::Stream::_Count] = {nullptr};
+        if (mesh->getVertexPositions().isValid()) streams[(UInt32)CookedModel::Stream::Positions] = mesh->getVertexPositions()->getStorage();
+        if (mesh->getVertexNormals().isValid()) streams[(UInt32)CookedModel::Stream::Normals] = mesh->getVertexNormals()->getStorage();
+        if (mesh->getVertexAveragedNormals().isValid()) streams[(UInt32)CookedModel::Stream::AveragedNormals] = mesh->getVertexAveragedNormals()->getStorage();
+        if (mesh->getVertexFaceNormals().isValid()) streams[(UInt32)CookedModel::Stream::FaceNormals] = mesh->getVertexFaceNormals()->getStorage();
+        if (mesh->getVertexTangents().isValid()) streams[(UInt32)CookedModel::Stream::Tangents] = mesh->getVertexTangents()->getStorage();
+        if (mesh->getVertexColors().isValid()) streams[(UInt32)CookedModel::Stream::Colors] = mesh->getVertexColors()->getStorage();
+        if (mesh->getVertexAlbedoUVs().isValid()) streams[(UInt32)CookedModel::Stream::AlbedoUVs] = mesh->getVertexAlbedoUVs()->getStorage();
+        if (mesh->getVertexNormalUVs().isValid()) streams[(UInt32)CookedModel::Stream::NormalUVs] = mesh->getVertexNormalUVs()->getStorage();
+        if (mesh->isIndexed()) streams[(UInt32)CookedModel::Stream::Indices] = mesh->getIndexBuffer()->getIndices();
+
+        StandardAttributeSet enabledAttributes = StandardAttributes::createAttributeSet();
+        for (UInt32 a = 0; a < (UInt32)StandardAttribute::_Count; a++) {
+            if (mesh->isAttributeEnabled((StandardAttribute)a)) StandardAttributes::addAttribute(&enabledAttributes, (StandardAttribute)a);
+        }
+
+        UInt32 flags = mesh->hasCompressedAttributes() ? CookedModel::CompressedAttributes : 0;
+        UInt32 index = cookedModel.addMesh(mesh->getVertexCount(), mesh->isIndexed() ? mesh->getIndexCount() : 0, material, flags,
+                                           (UInt32)enabledAttributes, streams);
+        cookedMeshes[mesh.get()] = index;
+        return index;
+    }
+
+    template <typename T>
+    static void copyCookedStream(WeakPointer<AttributeArray<T>> attributes, const void* stream) {
+        if (stream != nullptr) memcpy(attributes->getStorage(), stream, attributes->getSize());
+    }
+
+    /**
+     * Create a Mesh from the cooked mesh [record]. Its streams are copied straight from [cookedModel] into the
+     * mesh's attribute arrays; the normals and tangents are already final, so only the bounding box is left for
+     * Mesh::generateAttributes() and the data still needs sending to the GPU (Mesh::updateGPUStorage()).
+     */
+    WeakPointer<Mesh> ModelLoader::convertCookedMesh(const CookedModel::Reader& cookedModel, const CookedModel::MeshRecord& record,
+                                                     WeakPointer<Material> material) const {
+        WeakPointer<Mesh> coreMesh = Engine::instance()->createMesh(record.vertexCount, record.indexCount, material);
+        if (!coreMesh.isValid()) {
+            throw ModelLoaderException("ModeLoader::convertCookedMesh -> Could not create Mesh3D object.");
+        }
+        coreMesh->setCompressedAttributes((record.flags & CookedModel::CompressedAttributes) != 0);
+
+        const void* normals = cookedModel.getStream(record, CookedModel::Stream::Normals);
+        const void* faceNormals = cookedModel.getStream(record, CookedModel::Stream::FaceNormals);
+        const void* tangents = cookedModel.getStream(record, CookedModel::Stream::Tangents);
+        const void* colors = cookedModel.getStream(record, CookedModel::Stream::Colors);
+        const void* albedoUVs = cookedModel.getStream(record, CookedModel::Stream::AlbedoUVs);
+        const void* normalUVs = cookedModel.getStream(record, CookedModel::Stream::NormalUVs);
+        if (!coreMesh->initVertexPositions() || (normals && !coreMesh->initVertexNormals()) || (faceNormals && !coreMesh->initVertexFaceNormals()) ||
+            (tangents && !coreMesh->initVertexTangents()) || (colors && !coreMesh->initVertexColors()) ||
+            (albedoUVs && !coreMesh->initVertexAlbedoUVs()) || (normalUVs && !coreMesh->initVertexNormalUVs())) {
+            throw ModelLoaderException("ModeLoader::convertCookedMesh -> Unable to initialize vertex attributes.");
+        }
+
+        copyCookedStream(coreMesh->getVertexPositions(), cookedModel.getStream(record, CookedModel::Stream::Positions));
+        if (normals) {
+            copyCookedStream(coreMesh->getVertexNormals(), normals);
+            copyCookedStream(coreMesh->getVertexAveragedNormals(), cookedModel.getStream(record, CookedModel::Stream::AveragedNormals));
+        }
+        if (faceNormals) copyCookedStream(coreMesh->getVertexFaceNormals(), faceNormals);
+        if (tangents) copyCookedStream(coreMesh->getVertexTangents(), tangents);
+        if (colors) copyCookedStream(coreMesh->getVertexColors(), colors);
+        if (albedoUVs) copyCookedStream(coreMesh->getVertexAlbedoUVs(), albedoUVs);
+        if (normalUVs) copyCookedStream(coreMesh->getVertexNormalUVs(), normalUVs);
+
+        for (UInt32 a = 0; a < (UInt32)StandardAttribute::_Count; a++) {
+            if (StandardAttributes::hasAttribute(record.enabledAttributes, (StandardAttribute)a)) coreMesh->enableAttribute((StandardAttribute)a);
+        }
+
+        const void* indices = cookedModel.getStream(record, CookedModel::Stream::Indices);
+        if (indices) {
+            // setIndices() only reads from its argument
+            coreMesh->getIndexBuffer()->setIndices((UInt32*)indices);
+        }
+
+        coreMesh->setCalculateNormals(false);
+        coreMesh->setCalculateTangents(false);
         coreMesh->setCalculateBoundingBox(true);
-        coreMesh->update();
 
         return coreMesh;
     }
@@ -503,7 +1216,8 @@ namespace Core {
     /**
      * Process the Assimp materials (instances of aiMaterial) in the Assimp scene [scene]. This method loops through each
      * Assimp material and then examines which Assimp meshes use it. For each Assimp mesh that uses an Assimp material,
-     * a unique (and equivalent) engine-native Material instance is created.
+     * the properties a unique (and equivalent) engine-native Material instance needs are recorded; createMaterials()
+     * creates those instances later.
      *
      * For each mesh that uses a given Assimp material, we MUST create a unique engine-native Material object. Engine-native
      * Material objects are linked to shaders, and since different meshes may have different attributes, they may potentially
@@ -512,61 +1226,105 @@ namespace Core {
      *
      * [modelPath] - Native file-system compatible path that points to the model file in the file system.
      * [scene] - The Assimp model/scene.
-     * [materialImportDescriptors] - A vector of MaterialImportDescriptor structures that will be populated by ProcessMaterials().
+     * [sceneImport] - Receives a MaterialImportDescriptor for every material and the decoded textures they use.
      */
-    Bool ModelLoader::processMaterials(const std::string& modelPath, const aiScene& scene,
-                                       std::vector<MaterialImportDescriptor>& materialImportDescriptors, Bool preferPhysicalMaterial) const {
+    void ModelLoader::readMaterials(const std::string& modelPath, const aiScene& scene, Bool preferPhysicalMaterial,
+                                    ModelSceneImport& sceneImport) const {
         // TODO: Implement support for embedded textures
         if (scene.HasTextures()) {
-            throw ModelLoaderException("ModelLoader::processMaterials -> Support for meshes with embedded textures is not implemented");
+            throw ModelLoaderException("ModelLoader::readMaterials -> Support for meshes with embedded textures is not implemented");
         }
 
         std::shared_ptr<FileSystem> fileSystem = FileSystem::getInstance();
         std::string fixedModelPath = fileSystem->fixupPathForLocalFilesystem(modelPath);
 
+        // find the image files of all textures the materials use and decode them in parallel. the entries
+        // of [textureTypes] are in the order of the cooked model's texture slots, which is how
+        // [sceneImport.materialTextures] is laid out.
+        const aiTextureType textureTypes[] = {aiTextureType_DIFFUSE, aiTextureType_NORMALS, aiTextureType_SHININESS};
+        const TextureType importTypes[] = {TextureType::Albedo, TextureType::Normals, TextureType::RoughnessGloss};
+        const UInt32 textureTypeCount = (UInt32)CookedModel::TextureSlot::_Count;
+        std::vector<TextureImport>& textureImports = sceneImport.textureImports;
+        std::vector<Int32>& materialTextures = sceneImport.materialTextures;
+        materialTextures.assign(scene.mNumMaterials * textureTypeCount, -1);
+        for (UInt32 m = 0; m < scene.mNumMaterials; m++) {
+            aiMaterial* assimpMaterial = scene.mMaterials[m];
+            if (assimpMaterial == nullptr) continue;
+            for (UInt32 t = 0; t < textureTypeCount; t++) {
+                aiString aiTexturePath;
+                if (assimpMaterial->GetTexture(textureTypes[t], 0, &aiTexturePath) != AI_SUCCESS) continue;
+                std::string texturePath = this->findAITexturePath(*assimpMaterial, textureTypes[t], fixedModelPath);
+                materialTextures[m * textureTypeCount + t] = ModelLoader::addTextureImport(textureImports, texturePath,
+                                                                                           this->getImportTextureAttributes(importTypes[t]),
+                                                                                           importTypes[t] == TextureType::Albedo);
+            }
+        }
+        this->decodeTextureImages(textureImports);
+        this->packTextureAtlases(textureImports, std::vector<Bool>(textureImports.size(), preferPhysicalMaterial), sceneImport.textureAtlases);
+
         // loop through each scene material and extract relevant textures and
         // other properties and create a MaterialDescriptor object that will hold those
-        // properties and all corresponding Material objects
+        // properties
         for (UInt32 m = 0; m < scene.mNumMaterials; m++) {
-            aiString aiTexturePath;
-
             aiMaterial* assimpMaterial = scene.mMaterials[m];
             if (assimpMaterial == nullptr) {
-                throw ModelLoaderException("ModelLoader::processMaterials -> Scene contains a null material.");
+                throw ModelLoaderException("ModelLoader::readMaterials -> Scene contains a null material.");
             }
 
-            aiString mtName;
-            assimpMaterial->Get(AI_MATKEY_NAME, mtName);
-
             // build an import descriptor for this material
             MaterialImportDescriptor materialImportDescriptor;
             this->getImportDetails(assimpMaterial, materialImportDescriptor, scene, preferPhysicalMaterial);
 
-            aiReturn texFound = AI_SUCCESS;
-
-            WeakPointer<Texture> diffuseTexture;
-            WeakPointer<Texture> normalTexture;
-            WeakPointer<Texture> roughnessGlossTexture;
-
-            UInt32 defaultMipLevel = Core::Constants::DefaultMaxMipLevels;
-
-            // get diffuse texture (for now support only 1)
-            texFound = assimpMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &aiTexturePath);
-            if (texFound == AI_SUCCESS) {
-                diffuseTexture = this->loadAITexture(*assimpMaterial, aiTextureType_DIFFUSE, fixedModelPath, TextureFilter::TriLinear, defaultMipLevel);
+            Bool hasTexture[textureTypeCount];
+            for (UInt32 t = 0; t < textureTypeCount; t++) hasTexture[t] = materialTextures[m * textureTypeCount + t] >= 0;
+
+            // for each mesh that uses the material, store the Assimp UV channels of its textures for later
+            // processing of the mesh, and remember which files the textures came from so the model can be cooked
+            if (hasTexture[0] || hasTexture[1] || hasTexture[2]) {
+                for (UInt32 i = 0; i < scene.mNumMeshes; i++) {
+                    if (!materialImportDescriptor.usedByMesh(i)) continue;
+
+                    this->setupMeshSpecificUVMapping(*assimpMaterial, hasTexture[0], hasTexture[1], hasTexture[2], i, materialImportDescriptor);
+                    for (UInt32 t = 0; t < textureTypeCount; t++) {
+                        Int32 slot = materialTextures[m * textureTypeCount + t];
+                        if (slot < 0) continue;
+                        TextureType textureType = ModelLoader::convertAITextureKeyToTextureType(textureTypes[t]);
+                        materialImportDescriptor.meshSpecificProperties[i].texturePaths[textureType] = textureImports[slot].path;
+                    }
+                }
             }
 
-            texFound = assimpMaterial->GetTexture(aiTextureType_NORMALS, 0, &aiTexturePath);
-            if (texFound == AI_SUCCESS) {
-                normalTexture = this->loadAITexture(*assimpMaterial, aiTextureType_NORMALS, fixedModelPath, TextureFilter::TriLinear, defaultMipLevel);
-            }
+            // add the new MaterialImportDescriptor instance to [materialImportDescriptors]
+            sceneImport.materialImportDescriptors.push_back(materialImportDescriptor);
+        }
+    }
 
-            texFound = assimpMaterial->GetTexture(aiTextureType_SHININESS, 0, &aiTexturePath);
-            if (texFound == AI_SUCCESS) {
-                roughnessGlossTexture = this->loadAITexture(*assimpMaterial, aiTextureType_SHININESS, fixedModelPath, TextureFilter::TriLinear, defaultMipLevel);
+    /**
+     * Create the textures read by readMaterials() and, for every mesh that uses a material, a unique engine-native
+     * Material instance matching the mesh's properties (see readMaterials()). The materials are stored in the
+     * mesh-specific properties of the MaterialImportDescriptor instances in [sceneImport].
+     */
+    void ModelLoader::createMaterials(const aiScene& scene, ModelSceneImport& sceneImport) const {
+        const UInt32 textureTypeCount = (UInt32)CookedModel::TextureSlot::_Count;
+        MaterialLibrary& materialLibrary = Engine::instance()->getMaterialLibrary();
+        for (UInt32 m = 0; m < sceneImport.materialImportDescriptors.size(); m++) {
+            MaterialImportDescriptor& materialImportDescriptor = sceneImport.materialImportDescriptors[m];
+            WeakPointer<Texture> textures[textureTypeCount];
+            const TextureImport* materialTextureImports[textureTypeCount] = {};
+
+            // create the diffuse, normals and roughness/gloss textures (for now support only 1 of each)
+            for (UInt32 t = 0; t < textureTypeCount; t++) {
+                Int32 slot = sceneImport.materialTextures[m * textureTypeCount + t];
+                if (slot >= 0) {
+                    materialTextureImports[t] = &sceneImport.textureImports[slot];
+                    textures[t] = this->createTexture(sceneImport.textureImports[slot], sceneImport.textureAtlases);
+                }
             }
 
-            MaterialLibrary& materialLibrary = Engine::instance()->getMaterialLibrary();
+            WeakPointer<Texture> diffuseTexture = textures[0];
+            WeakPointer<Texture> normalTexture = textures[1];
+            WeakPointer<Texture> roughnessGlossTexture = textures[2];
+
             // loop through each mesh in the scene and check if it uses [material]. If so,
             // create a unique Material object for the mesh and attach it to [materialImportDescriptor]
             //
@@ -593,26 +1351,15 @@ namespace Core {
                     // map new material to its corresponding mesh
                     materialImportDescriptor.meshSpecificProperties[i].material = matchingMaterial;
 
-                    // if there is a diffuse texture, set it up in the new material
+                    // if there are textures, set them up in the new material
                     if (diffuseTexture.isValid() || normalTexture.isValid() || roughnessGlossTexture.isValid()) {
-                        // Add [diffuseTexture] to the new material (and for the appropriate shader variable), and store
-                        // Assimp UV channel for it in [materialImportDescriptor] for later processing of the mesh
-                        Bool setupSuccess =
-                            this->setupMeshSpecificMaterialWithTextures(*assimpMaterial, diffuseTexture, normalTexture,
-                                                                        roughnessGlossTexture, i, materialImportDescriptor);
-
-                        if (!setupSuccess) {
-                            throw ModelLoaderException("ModelLoader::ProcessMaterials -> Could not set up diffuse texture.");
-                        }
+                        this->setTexturesOnMaterial(matchingMaterial, diffuseTexture, normalTexture, roughnessGlossTexture);
+                        ModelLoader::setTextureRegionsOnMaterial(matchingMaterial, materialTextureImports[0], materialTextureImports[1],
+                                                                 materialTextureImports[2]);
                     }
                 }
             }
-
-            // add the new MaterialImportDescriptor instance to [materialImportDescriptors]
-            materialImportDescriptors.push_back(materialImportDescriptor);
         }
-
-        return true;
     }
 
     /**
@@ -695,8 +1442,8 @@ namespace Core {
     }
 
     /**
-     * Take an Assimp material [assimpMaterial] and use its properties to create and load an engine-native Texture instance
-     * for it that matches the type specified by [textureType].
+     * Take an Assimp material [assimpMaterial] and find the image file of its texture that matches the type specified
+     * by [textureType].
      *
      * This method looks in two places in the file system for the image files for the texture:
      *
@@ -707,9 +1454,7 @@ namespace Core {
      * [assimpMaterial] - The Assimp material.
      * [textureType] - The type of texture to look for (diffuse, specular, normal map, etc...)
      */
-    WeakPointer<Texture> ModelLoader::loadAITexture(aiMaterial& assimpMaterial, aiTextureType textureType, const std::string& modelPath, TextureFilter filter, UInt32 mipLevel) const {
-        // temp variables
-        WeakPointer<Texture2D> texture;
+    std::string ModelLoader::findAITexturePath(aiMaterial& assimpMaterial, aiTextureType textureType, const std::string& modelPath) const {
         aiString aiTexturePath;
         aiReturn texFound = AI_SUCCESS;
 
@@ -722,68 +1467,592 @@ namespace Core {
         texFound = assimpMaterial.GetTexture(textureType, 0, &aiTexturePath);
 
         if (texFound != AI_SUCCESS) {
-            throw ModelLoaderException("ModelLoader::loadAITexture -> Assimp material does not have desired texture type.");
+            throw ModelLoaderException("ModelLoader::findAITexturePath -> Assimp material does not have desired texture type.");
         }
 
         // build the full path to the texture image as specified by the Assimp material
         std::string texPath = fileSystem->fixupPathForLocalFilesystem(std::string(aiTexturePath.data));
         std::string fullTextureFilePath = fileSystem->concatenatePaths(modelDirectory, texPath);
 
-        TextureAttributes texAttributes;
-        texAttributes.FilterMode = filter;
-        texAttributes.MipLevels = mipLevel;
-        texAttributes.WrapMode = TextureWrap::Mirror;
-        texAttributes.Format = TextureFormat::RGBA8;
-
-        std::shared_ptr<StandardImage> textureImage;
         // check if the file specified by the full path in the Assimp material exists
         if (fileSystem->fileExists(fullTextureFilePath)) {
-            textureImage = ImageLoader::loadImageU(fullTextureFilePath);
-            texture = Engine::instance()->getGraphicsSystem()->createTexture2D(texAttributes);
+            return fullTextureFilePath;
         }
+
         // if it does not exist, try looking for the texture image file in the model's directory
-        else {
-            // get just the filename portion of the path
-            std::string filename = fileSystem->getFileName(fullTextureFilePath);
-            if (!(filename.length() <= 0)) {
-                // concatenate the file name with the model's directory location
-                filename = fileSystem->concatenatePaths(modelDirectory, filename);
-                // check if the image file is in the same directory as the model and if so, load it
-                if (fileSystem->fileExists(filename)) {
-                    textureImage = ImageLoader::loadImageU(filename.c_str());
-                    texture = Engine::instance()->getGraphicsSystem()->createTexture2D(texAttributes);
+        // get just the filename portion of the path
+        std::string filename = fileSystem->getFileName(fullTextureFilePath);
+        if (!(filename.length() <= 0)) {
+            // concatenate the file name with the model's directory location
+            filename = fileSystem->concatenatePaths(modelDirectory, filename);
+            // check if the image file is in the same directory as the model
+            if (fileSystem->fileExists(filename)) {
+                return filename;
+            }
+        }
+
+        std::string msg = std::string("ModelLoader::findAITexturePath -> Could not load texture file: ") + fullTextureFilePath;
+        throw ModelLoaderException(msg);
+    }
+
+    /**
+     * Get the texture for [textureImport] from the engine's texture cache, or create it on the GPU for the image
+     * decodeTextureImages() decoded for it. For a texture that was packed into one of [textureAtlases], the atlas
+     * texture is returned instead, and created the first time. A texture created here is empty until buildTexture()
+     * sends its images to the GPU and adds it to the cache; each call counts as another reference to it.
+     */
+    WeakPointer<Texture> ModelLoader::createTexture(TextureImport& textureImport, std::vector<TextureAtlasImport>& textureAtlases) const {
+        if (textureImport.atlas >= 0) {
+            TextureAtlasImport& atlasImport = textureAtlases[textureImport.atlas];
+            if (!atlasImport.texture.isValid()) {
+                atlasImport.texture = Engine::instance()->getGraphicsSystem()->createTexture2D(ModelLoader::getTextureAtlasAttributes(atlasImport));
+                if (!atlasImport.texture.isValid()) {
+                    throw ModelLoaderException("ModelLoader::createTexture -> Could not create texture atlas.");
                 }
             }
+            // several materials share the atlas, so like a texture from a file it needs a reference per
+            // material, or destroying one material's textures would destroy it for all of them
+            atlasImport.references++;
+            return atlasImport.texture;
+        }
+
+        TextureCache& textureCache = Engine::instance()->getTextureCache();
+        if (textureImport.cachedTexture.isValid()) {
+            // the reference acquired by decodeTextureImages() is handed to the first material that uses the texture,
+            // which also keeps the texture in the cache for any further materials
+            textureImport.texture = textureImport.cachedTexture;
+            textureImport.cachedTexture = WeakPointer<Texture2D>();
+            textureImport.cached = true;
+        }
+        else if (textureImport.texture.isValid()) {
+            if (textureImport.cached) textureCache.acquireTexture2D(textureImport.path, textureImport.attributes);
+        }
+        else {
+            textureImport.texture = textureCache.acquireTexture2D(textureImport.path, textureImport.attributes);
+            textureImport.cached = textureImport.texture.isValid();
+            if (!textureImport.cached && (textureImport.image || textureImport.compressedImage)) {
+                textureImport.texture = Engine::instance()->getGraphicsSystem()->createTexture2D(textureImport.attributes);
+            }
+            if (!textureImport.texture.isValid()) {
+                std::string msg = std::string("ModelLoader::createTexture -> Could not load texture file: ") + textureImport.path;
+                throw ModelLoaderException(msg);
+            }
         }
+        textureImport.references++;
+        return textureImport.texture;
+    }
 
-        WeakPointer<Texture2D> texturePtr(texture);
-        if (textureImage && texturePtr) {
-            texturePtr->buildFromImage(textureImage);
+    /**
+     * Send the images of [textureImport] to the texture createTexture() created for it, then add the texture to the
+     * engine's texture cache with a reference for every material slot it was handed to. Does nothing for a texture
+     * that came from the cache. Must be called on the main thread.
+     */
+    void ModelLoader::buildTexture(TextureImport& textureImport) const {
+        if (!textureImport.texture.isValid() || textureImport.cached) return;
+
+        WeakPointer<Texture2D> texture = textureImport.texture;
+        UInt32 levelCount = ModelLoader::getTextureLevelCount(textureImport);
+        if (this->isStreamedTexture(textureImport)) {
+            // upload just the tail, which is all decodeTextureImages() kept; the streamer decodes the file again
+            // for the finer levels when they are needed
+            UInt32 tailLevel = TextureStreamer::calculateTailLevel(textureImport.width, textureImport.height);
+            std::vector<Texture2D::LevelData> tailLevels;
+            ModelLoader::getTextureLevels(textureImport, tailLevel, levelCount - 1, tailLevels);
+            texture->buildStreamed(textureImport.width, textureImport.height, levelCount, tailLevel);
+            for (UInt32 i = (UInt32)tailLevels.size(); i > 0; i--) {
+                texture->uploadStreamedLevel(tailLevels[i - 1]);
+            }
+
+            TextureImport source;
+            source.path = textureImport.path;
+            source.attributes = textureImport.attributes;
+            source.sRGB = textureImport.sRGB;
+            std::string cacheDirectory = this->textureCacheDirectory;
+            Engine::instance()->getTextureStreamer().addTexture(texture, tailLevel,
+                [source, cacheDirectory](UInt32 firstLevel, UInt32 lastLevel, std::vector<Texture2D::LevelData>& levels) {
+                    TextureImport textureImport = source;
+                    ModelLoader::decodeTextureImage(textureImport, cacheDirectory, true, firstLevel, lastLevel, &Engine::instance()->getThreadPool());
+                    ModelLoader::getTextureLevels(textureImport, firstLevel, lastLevel, levels);
+                });
+        }
+        else if (textureImport.levels.size() > 0) {
+            texture->buildFromLevels(textureImport.levels);
+        }
+        else if (textureImport.compressedImage) {
+            texture->buildFromCompressedImage(textureImport.compressedImage);
+        }
+        else if (textureImport.mipLevels.size() > 0) {
+            texture->buildFromMipChain(textureImport.image, textureImport.mipLevels);
+        }
+        else {
+            texture->buildFromImage(textureImport.image);
         }
-        
+
         // did texture fail to load?
-        if (!textureImage || !texturePtr || !texturePtr->isBuilt()) {
-            std::string msg = std::string("ModelLoader::loadAITexture -> Could not load texture file: ") + fullTextureFilePath;
+        if (!texture->isBuilt()) {
+            std::string msg = std::string("ModelLoader::createTexture -> Could not load texture file: ") + textureImport.path;
             throw ModelLoaderException(msg);
         }
 
-        return texture;
+        // hand the upload memory back
+        std::vector<Texture2D::LevelData>().swap(textureImport.levels);
+
+        TextureCache& textureCache = Engine::instance()->getTextureCache();
+        textureCache.addTexture2D(textureImport.path, textureImport.attributes, texture);
+        for (UInt32 i = 1; i < textureImport.references; i++) {
+            textureCache.acquireTexture2D(textureImport.path, textureImport.attributes);
+        }
+        textureImport.cached = true;
+    }
+
+    /**
+     * Like buildTexture(), for the texture created from the atlas [atlasImport].
+     */
+    void ModelLoader::buildTextureAtlas(TextureAtlasImport& atlasImport) {
+        if (!atlasImport.texture.isValid() || atlasImport.cached) return;
+
+        WeakPointer<Texture2D> texture = atlasImport.texture;
+        if (atlasImport.levels.size() > 0) texture->buildFromLevels(atlasImport.levels);
+        else texture->buildFromMipChain(atlasImport.atlas.getImage(), atlasImport.atlas.getMipLevels());
+        if (!texture->isBuilt()) {
+            throw ModelLoaderException("ModelLoader::buildTextureAtlas -> Could not create texture atlas.");
+        }
+        std::vector<Texture2D::LevelData>().swap(atlasImport.levels);
+
+        TextureCache& textureCache = Engine::instance()->getTextureCache();
+        TextureAttributes attributes = ModelLoader::getTextureAtlasAttributes(atlasImport);
+        atlasImport.cacheKey = std::string("<texture atlas ") + std::to_string(nextTextureAtlasID++) + ">";
+        textureCache.addTexture2D(atlasImport.cacheKey, attributes, texture);
+        for (UInt32 i = 1; i < atlasImport.references; i++) {
+            textureCache.acquireTexture2D(atlasImport.cacheKey, attributes);
+        }
+        atlasImport.cached = true;
     }
 
     /**
-     * Set the material for the mesh specified by [meshIndex] in a material import descriptor [materialImportDesc] with an instance of
-     * Texture that has already been loaded [texture]. This method determines the correct shader variable name for the texture based on
-     * the type of texture [textureType], and sets that variable in the material for the mesh specified by [meshIndex] with [texture].
-     * The method then locates the Assimp UV data for that texture and stores that in the mesh-specific properties of
-     * [materialImportDesc].
+     * Build every texture createTexture() created for [textureImports] and [textureAtlases] right away.
      */
-    Bool ModelLoader::setupMeshSpecificMaterialWithTextures(const aiMaterial& assimpMaterial, WeakPointer<Texture> diffuseTexture,
-                                                           WeakPointer<Texture> normalsTexture,  WeakPointer<Texture> roughnessGlossTexture,
-                                                           UInt32 meshIndex, MaterialImportDescriptor& materialImportDesc) const {
+    void ModelLoader::buildTextures(std::vector<TextureImport>& textureImports, std::vector<TextureAtlasImport>& textureAtlases) const {
+        for (TextureAtlasImport& atlasImport : textureAtlases) {
+            ModelLoader::buildTextureAtlas(atlasImport);
+        }
+        for (TextureImport& textureImport : textureImports) {
+            this->buildTexture(textureImport);
+        }
+    }
+
+    /**
+     * Queue one upload on [request] for every texture createTexture() created for [textureImports] and [textureAtlases],
+     * sized by the image data it sends to the GPU. The vectors must stay alive until the request is done.
+     */
+    void ModelLoader::addTextureUploads(AssetStreamer::Request& request, std::vector<TextureImport>& textureImports,
+                                        std::vector<TextureAtlasImport>& textureAtlases) const {
+        for (TextureAtlasImport& atlasImport : textureAtlases) {
+            if (!atlasImport.texture.isValid()) continue;
+            UInt64 byteCount = (UInt64)atlasImport.atlas.getImage()->calcRowSizeBytes() * atlasImport.atlas.getImage()->getHeight();
+            for (const std::shared_ptr<StandardImage>& mipLevel : atlasImport.atlas.getMipLevels()) {
+                byteCount += (UInt64)mipLevel->calcRowSizeBytes() * mipLevel->getHeight();
+            }
+            TextureAtlasImport* atlasImportPtr = &atlasImport;
+            request.addUpload(byteCount, [atlasImportPtr](AssetStreamer::Request& request) {
+                ModelLoader::buildTextureAtlas(*atlasImportPtr);
+            });
+        }
+        for (TextureImport& textureImport : textureImports) {
+            if (!textureImport.texture.isValid() || textureImport.cached) continue;
+            UInt32 levelCount = ModelLoader::getTextureLevelCount(textureImport);
+            UInt32 firstLevel = textureImport.firstLevel;
+            if (this->isStreamedTexture(textureImport)) firstLevel = TextureStreamer::calculateTailLevel(textureImport.width, textureImport.height);
+            UInt64 byteCount = 0;
+            for (UInt32 level = firstLevel; level < levelCount; level++) {
+                byteCount += ModelLoader::getTextureLevelSizeBytes(textureImport, level);
+            }
+            TextureImport* textureImportPtr = &textureImport;
+            request.addUpload(byteCount, [this, textureImportPtr](AssetStreamer::Request& request) {
+                this->buildTexture(*textureImportPtr);
+            });
+        }
+    }
+
+    /**
+     * Whether buildTexture() hands [textureImport] to the TextureStreamer, which it does for textures with a full mip
+     * chain and a streaming tail while texture streaming is on.
+     */
+    Bool ModelLoader::isStreamedTexture(const TextureImport& textureImport) const {
+        UInt32 tailLevel = TextureStreamer::calculateTailLevel(textureImport.width, textureImport.height);
+        return this->streamTextures && tailLevel > 0 &&
+               ModelLoader::getTextureLevelCount(textureImport) == MipChainBuilder::getFullChainLevelCount(textureImport.width, textureImport.height);
+    }
+
+    /**
+     * Copy the levels of [textureImports] and [textureAtlases] that buildTexture() and buildTextureAtlas() will upload
+     * into upload memory (see Graphics::stageTextureData()) and release the images, so that building the textures on
+     * the main thread doesn't copy them again. Levels that don't fit stay in client memory. Textures packed into an
+     * atlas or taken from the texture cache are skipped, and the atlases keep their own images. Meant for loader
+     * threads; on the main thread it would only add a copy.
+     */
+    void ModelLoader::stageTextureLevels(std::vector<TextureImport>& textureImports, std::vector<TextureAtlasImport>& textureAtlases) const {
+        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        for (TextureAtlasImport& atlasImport : textureAtlases) {
+            std::vector<std::shared_ptr<StandardImage>> images(1, atlasImport.atlas.getImage());
+            images.insert(images.end(), atlasImport.atlas.getMipLevels().begin(), atlasImport.atlas.getMipLevels().end());
+            for (UInt32 level = 0; level < images.size(); level++) {
+                const StandardImage& image = *images[level];
+                Texture2D::LevelData levelData;
+                levelData.level = level;
+                levelData.width = image.getWidth();
+                levelData.height = image.getHeight();
+                UInt64 size = (UInt64)image.calcRowSizeBytes() * image.getHeight();
+                levelData.staged = graphics->stageTextureData(image.calcOffsetLocationBytes(0, 0), size);
+                if (!levelData.staged) levelData.data.assign(image.calcOffsetLocationBytes(0, 0), image.calcOffsetLocationBytes(0, 0) + size);
+                atlasImport.levels.push_back(levelData);
+            }
+        }
+        for (TextureImport& textureImport : textureImports) {
+            UInt32 levelCount = ModelLoader::getTextureLevelCount(textureImport);
+            if (textureImport.atlas >= 0 || levelCount == 0) continue;
+
+            UInt32 firstLevel = textureImport.firstLevel;
+            if (this->isStreamedTexture(textureImport)) firstLevel = TextureStreamer::calculateTailLevel(textureImport.width, textureImport.height);
+            else if (textureImport.attributes.MipLevels > 0 && textureImport.attributes.MipLevels < levelCount) levelCount = textureImport.attributes.MipLevels;
+            ModelLoader::getTextureLevels(textureImport, firstLevel, levelCount - 1, textureImport.levels);
+            for (Texture2D::LevelData& levelData : textureImport.levels) {
+                levelData.staged = graphics->stageTextureData(levelData.data.data(), levelData.data.size());
+                if (levelData.staged) std::vector<Byte>().swap(levelData.data);
+            }
+            textureImport.image.reset();
+            textureImport.mipLevels.clear();
+            textureImport.compressedImage.reset();
+        }
+    }
+
+    /**
+     * The attributes of the texture created from [atlasImport]: the gutters already hold the mirrored texels, so the
+     * atlas itself is clamped, and it has as many levels as the atlas built.
+     */
+    TextureAttributes ModelLoader::getTextureAtlasAttributes(const TextureAtlasImport& atlasImport) {
+        TextureAttributes attributes = atlasImport.attributes;
+        attributes.WrapMode = TextureWrap::Clamp;
+        attributes.MipLevels = atlasImport.atlas.getLevelCount();
+        return attributes;
+    }
+
+    /**
+     * Decode the image files of [textureImports] in parallel, skipping those for which the engine's texture cache
+     * already holds a texture; their images stay empty and a reference to the cached texture is acquired right away
+     * instead, so that the texture can't be destroyed before createTexture() gets to it. The mip levels are built here
+     * too (gamma-correct for sRGB images), rather than by the driver. Textures in a compressed format are encoded here
+     * as well, unless the texture cache directory already holds an up-to-date encoding, in which case the file isn't
+     * even decoded. With texture streaming on, only the tail levels are kept (see decodeTextureImage()).
+     */
+    void ModelLoader::decodeTextureImages(std::vector<TextureImport>& textureImports) const {
+        TextureCache& textureCache = Engine::instance()->getTextureCache();
+        ThreadPool* threadPool = &Engine::instance()->getThreadPool();
+        std::vector<UInt32> pendingTextures;
+        for (UInt32 i = 0; i < textureImports.size(); i++) {
+            textureImports[i].cachedTexture = textureCache.acquireTexture2D(textureImports[i].path, textureImports[i].attributes);
+            if (!textureImports[i].cachedTexture.isValid()) pendingTextures.push_back(i);
+        }
+        const std::string& cacheDirectory = this->textureCacheDirectory;
+        Bool streamed = this->streamTextures;
+        ModelLoader::runParallel((UInt32)pendingTextures.size(), [&textureImports, &pendingTextures, &cacheDirectory, streamed, threadPool](UInt32 i) {
+            ModelLoader::decodeTextureImage(textureImports[pendingTextures[i]], cacheDirectory, streamed, TailTextureLevel, LastTextureLevel, threadPool);
+        });
+    }
+
+    /**
+     * With texture atlasing on, pack the decoded textures of [textureImports] that are marked in [packable] and no larger
+     * than MaxAtlasedTextureSize into atlases, which are added to [textureAtlases]. Textures only share an atlas with
+     * others of the same attributes, and an atlas that would end up holding a single texture isn't kept. The images
+     * of packed textures are released.
+     */
+    void ModelLoader::packTextureAtlases(std::vector<TextureImport>& textureImports, const std::vector<Bool>& packable,
+                                         std::vector<TextureAtlasImport>& textureAtlases) const {
+        if (!this->atlasTextures || this->streamTextures) return;
+
+        std::vector<UInt32> candidates;
+        for (UInt32 i = 0; i < textureImports.size(); i++) {
+            const TextureImport& textureImport = textureImports[i];
+            if (!packable[i] || !textureImport.image || textureImport.compressedImage) continue;
+            if (textureImport.attributes.Format != TextureFormat::RGBA8 || textureImport.attributes.WrapMode != TextureWrap::Mirror) continue;
+            if (textureImport.image->getWidth() > MaxAtlasedTextureSize || textureImport.image->getHeight() > MaxAtlasedTextureSize) continue;
+            candidates.push_back(i);
+        }
+        // atlases pack best when filled tallest first
+        std::stable_sort(candidates.begin(), candidates.end(), [&textureImports](UInt32 a, UInt32 b) {
+            return textureImports[a].image->getHeight() > textureImports[b].image->getHeight();
+        });
+
+        std::vector<TextureAtlasImport> atlases;
+        std::vector<UInt32> entries(textureImports.size(), 0);
+        for (UInt32 i : candidates) {
+            TextureImport& textureImport = textureImports[i];
+            for (UInt32 a = 0; a < atlases.size() && textureImport.atlas < 0; a++) {
+                if (!(atlases[a].attributes == textureImport.attributes)) continue;
+                if (atlases[a].atlas.add(textureImport.image, textureImport.mipLevels, entries[i])) textureImport.atlas = (Int32)a;
+            }
+            if (textureImport.atlas < 0) {
+                TextureAtlasImport atlasImport(textureImport.attributes);
+                if (!atlasImport.atlas.add(textureImport.image, textureImport.mipLevels, entries[i])) continue;
+                textureImport.atlas = (Int32)atlases.size();
+                atlases.push_back(atlasImport);
+            }
+        }
+
+        ThreadPool* threadPool = &Engine::instance()->getThreadPool();
+        std::vector<Int32> atlasIndices(atlases.size(), -1);
+        for (UInt32 a = 0; a < atlases.size(); a++) {
+            if (atlases[a].atlas.getEntryCount() < 2) continue;
+            atlases[a].atlas.build(threadPool);
+            atlasIndices[a] = (Int32)textureAtlases.size();
+            textureAtlases.push_back(atlases[a]);
+        }
+        for (UInt32 i : candidates) {
+            TextureImport& textureImport = textureImports[i];
+            if (textureImport.atlas < 0) continue;
+            textureImport.atlas = atlasIndices[textureImport.atlas];
+            if (textureImport.atlas < 0) continue;
+            textureImport.atlasRegion = textureAtlases[textureImport.atlas].atlas.getRegion(entries[i]);
+            textureImport.image.reset();
+            textureImport.mipLevels.clear();
+        }
+    }
+
+    /**
+     * Decode the image file of [textureImport] and build as many mip levels as its attributes ask for. For compressed formats,
+     * an encoding from [cacheDirectory] is used if it is up to date and has those levels; otherwise the image is encoded and the
+     * result stored there.
+     *
+     * A [streamed] texture gets its full mip chain, of which only levels [firstLevel] to [lastLevel] are kept and encoded;
+     * TailTextureLevel stands for the texture's streaming tail (see TextureStreamer::calculateTailLevel()) and [lastLevel] is
+     * clamped to the chain. With a cache directory, a compressed texture is instead encoded in full the first time, so that
+     * later loads of any of its levels come from the cache without decoding the file.
+     */
+    void ModelLoader::decodeTextureImage(TextureImport& textureImport, const std::string& cacheDirectory, Bool streamed, UInt32 firstLevel,
+                                         UInt32 lastLevel, ThreadPool* threadPool) {
+        TextureFormat format = textureImport.attributes.Format;
+        Bool compressed = CompressedImage::isCompressedFormat(format);
+        Bool useCache = compressed && cacheDirectory.size() > 0;
+        UInt32 maxLevels = streamed ? 0 : textureImport.attributes.MipLevels;
+        textureImport.firstLevel = 0;
+        if (useCache) {
+            std::shared_ptr<CompressedImage> cachedImage = TextureCompressor::loadCachedImage(cacheDirectory, textureImport.path, format);
+            if (cachedImage) {
+                UInt32 fullLevelCount = MipChainBuilder::getFullChainLevelCount(cachedImage->getWidth(), cachedImage->getHeight());
+                UInt32 neededLevelCount = maxLevels > 0 && maxLevels < fullLevelCount ? maxLevels : fullLevelCount;
+                if (cachedImage->getLevelCount() >= neededLevelCount) {
+                    textureImport.width = cachedImage->getWidth();
+                    textureImport.height = cachedImage->getHeight();
+                    textureImport.compressedImage = cachedImage;
+                    return;
+                }
+            }
+        }
+
+        std::shared_ptr<StandardImage> image = ImageLoader::loadImageU(textureImport.path);
+        if (!image) return;
+        textureImport.width = image->getWidth();
+        textureImport.height = image->getHeight();
+
+        if (streamed) {
+            UInt32 fullLevelCount = MipChainBuilder::getFullChainLevelCount(image->getWidth(), image->getHeight());
+            if (firstLevel == TailTextureLevel) firstLevel = TextureStreamer::calculateTailLevel(image->getWidth(), image->getHeight());
+            if (lastLevel >= fullLevelCount) lastLevel = fullLevelCount - 1;
+            if (firstLevel > lastLevel) {
+                throw ModelLoaderException("ModelLoader::decodeTextureImage -> Invalid level range for: " + textureImport.path);
+            }
+            // the cached encoding must hold every level
+            if (useCache) {
+                firstLevel = 0;
+                lastLevel = fullLevelCount - 1;
+            }
+            maxLevels = lastLevel + 1;
+        }
+
+        std::vector<std::shared_ptr<StandardImage>> mipLevels;
+        if (streamed || textureImport.attributes.MipLevels > 1) {
+            MipChainBuilder::Settings mipSettings;
+            mipSettings.sRGB = textureImport.sRGB;
+            mipSettings.maxLevels = maxLevels;
+            mipLevels = MipChainBuilder::buildMipChain(*image, mipSettings, threadPool);
+        }
+        if (streamed && firstLevel > 0) {
+            // drop the finer levels nobody asked for before anything gets encoded
+            image = mipLevels[firstLevel - 1];
+            mipLevels.erase(mipLevels.begin(), mipLevels.begin() + firstLevel);
+            textureImport.firstLevel = firstLevel;
+        }
+        if (!compressed) {
+            textureImport.image = image;
+            textureImport.mipLevels = mipLevels;
+            return;
+        }
+
+        textureImport.compressedImage = TextureCompressor::compress(*image, mipLevels, format, threadPool);
+        if (useCache) {
+            // a cache that can't be written only costs the encoding time again on the next import
+            TextureCompressor::saveCachedImage(cacheDirectory, textureImport.path, *textureImport.compressedImage);
+        }
+    }
+
+    /**
+     * Number of mip levels decodeTextureImage() produced for [textureImport] (or stageTextureLevels() kept of them), including the full-size image.
+     */
+    UInt32 ModelLoader::getTextureLevelCount(const TextureImport& textureImport) {
+        if (textureImport.levels.size() > 0) return textureImport.levels.back().level + 1;
+        if (textureImport.compressedImage) return textureImport.firstLevel + textureImport.compressedImage->getLevelCount();
+        if (textureImport.image) return textureImport.firstLevel + (UInt32)textureImport.mipLevels.size() + 1;
+        return 0;
+    }
+
+    /**
+     * Size in bytes of mip level [level] of the decoded [textureImport], which must hold that level.
+     */
+    UInt64 ModelLoader::getTextureLevelSizeBytes(const TextureImport& textureImport, UInt32 level) {
+        if (textureImport.levels.size() > 0) {
+            const Texture2D::LevelData& levelData = textureImport.levels[level - textureImport.levels.front().level];
+            return levelData.staged ? levelData.staged->getSize() : levelData.data.size();
+        }
+        UInt32 heldLevel = level - textureImport.firstLevel;
+        if (textureImport.compressedImage) return textureImport.compressedImage->getLevelSizeBytes(heldLevel);
+        const StandardImage& image = heldLevel == 0 ? *textureImport.image : *textureImport.mipLevels[heldLevel - 1];
+        return (UInt64)image.calcRowSizeBytes() * image.getHeight();
+    }
+
+    /**
+     * Copy levels [firstLevel] to [lastLevel] of the decoded [textureImport] into [levels], in the layout its format uploads.
+     */
+    void ModelLoader::getTextureLevels(const TextureImport& textureImport, UInt32 firstLevel, UInt32 lastLevel, std::vector<Texture2D::LevelData>& levels) {
+        if (firstLevel < textureImport.firstLevel || lastLevel >= ModelLoader::getTextureLevelCount(textureImport)) {
+            throw ModelLoaderException("ModelLoader::getTextureLevels -> Texture does not have the requested levels: " + textureImport.path);
+        }
+        if (textureImport.levels.size() > 0) {
+            // already copied out by stageTextureLevels()
+            UInt32 heldLevel = textureImport.levels.front().level;
+            if (firstLevel < heldLevel) {
+                throw ModelLoaderException("ModelLoader::getTextureLevels -> Texture does not have the requested levels: " + textureImport.path);
+            }
+            levels.insert(levels.end(), textureImport.levels.begin() + (firstLevel - heldLevel), textureImport.levels.begin() + (lastLevel - heldLevel + 1));
+            return;
+        }
+
+        for (UInt32 level = firstLevel; level <= lastLevel; level++) {
+            Texture2D::LevelData levelData;
+            levelData.level = level;
+            const Byte* data = nullptr;
+            UInt64 size = 0;
+            UInt32 heldLevel = level - textureImport.firstLevel;
+            if (textureImport.compressedImage) {
+                const CompressedImage& image = *textureImport.compressedImage;
+                levelData.width = image.getLevelWidth(heldLevel);
+                levelData.height = image.getLevelHeight(heldLevel);
+                data = image.getLevelData(heldLevel);
+                size = image.getLevelSizeBytes(heldLevel);
+            }
+            else {
+                const StandardImage& image = heldLevel == 0 ? *textureImport.image : *textureImport.mipLevels[heldLevel - 1];
+                levelData.width = image.getWidth();
+                levelData.height = image.getHeight();
+                data = image.calcOffsetLocationBytes(0, 0);
+                size = (UInt64)image.calcRowSizeBytes() * image.getHeight();
+            }
+            levelData.data.assign(data, data + size);
+            levels.push_back(levelData);
+        }
+    }
+
+    /**
+     * All imported textures of a given type share the same attributes, so any file already in the engine's texture
+     * cache (e.g. from an earlier import) is reused instead of decoded again. With texture compression on, albedo
+     * maps are stored as BC7, normal maps as BC5 (X and Y only; the shaders rebuild Z) and roughness/gloss maps as BC4.
+     */
+    TextureAttributes ModelLoader::getImportTextureAttributes(TextureType textureType) const {
+        TextureAttributes texAttributes;
+        texAttributes.FilterMode = TextureFilter::TriLinear;
+        texAttributes.MipLevels = Core::Constants::DefaultMaxMipLevels;
+        texAttributes.WrapMode = TextureWrap::Mirror;
+        texAttributes.Format = TextureFormat::RGBA8;
+        if (this->compressTextures) {
+            if (textureType == TextureType::Normals) texAttributes.Format = TextureFormat::BC5;
+            else if (textureType == TextureType::RoughnessGloss) texAttributes.Format = TextureFormat::BC4;
+            else texAttributes.Format = TextureFormat::BC7;
+        }
+        return texAttributes;
+    }
+
+    /**
+     * Drop the texture cache references still held by [textureImports] (see decodeTextureImages()), for textures
+     * createTexture() never got to. Must be called on the main thread.
+     */
+    void ModelLoader::releaseCachedTextures(std::vector<TextureImport>& textureImports) {
+        for (TextureImport& textureImport : textureImports) {
+            if (textureImport.cachedTexture.isValid()) {
+                Engine::instance()->destroyTexture2D(textureImport.cachedTexture);
+                textureImport.cachedTexture = WeakPointer<Texture2D>();
+            }
+        }
+    }
+
+    /**
+     * Drop the references the materials of a model that is being thrown away hold to the textures createTexture()
+     * handed out for [textureImports] and [textureAtlases], along with those releaseCachedTextures() drops; a texture
+     * that never got built is destroyed. Must be called on the main thread.
+     */
+    void ModelLoader::releaseTextures(std::vector<TextureImport>& textureImports, std::vector<TextureAtlasImport>& textureAtlases) {
+        ModelLoader::releaseCachedTextures(textureImports);
+        for (TextureImport& textureImport : textureImports) {
+            if (!textureImport.texture.isValid()) continue;
+            UInt32 references = textureImport.cached ? textureImport.references : 1;
+            for (UInt32 i = 0; i < references; i++) {
+                Engine::instance()->destroyTexture2D(textureImport.texture);
+            }
+            textureImport.texture = WeakPointer<Texture2D>();
+            textureImport.references = 0;
+        }
+        for (TextureAtlasImport& atlasImport : textureAtlases) {
+            if (!atlasImport.texture.isValid()) continue;
+            UInt32 references = atlasImport.cached ? atlasImport.references : 1;
+            for (UInt32 i = 0; i < references; i++) {
+                Engine::instance()->destroyTexture2D(atlasImport.texture);
+            }
+            atlasImport.texture = WeakPointer<Texture2D>();
+            atlasImport.references = 0;
+        }
+    }
+
+    /**
+     * Get the index of the entry for the file at [path] with [attributes] in [textureImports], adding one if there is none.
+     * As with the engine's texture cache, the first use of a file decides whether it is treated as sRGB-encoded.
+     */
+    UInt32 ModelLoader::addTextureImport(std::vector<TextureImport>& textureImports, const std::string& path, const TextureAttributes& attributes, Bool sRGB) {
+        for (UInt32 i = 0; i < textureImports.size(); i++) {
+            if (textureImports[i].path == path && textureImports[i].attributes == attributes) return i;
+        }
+        TextureImport textureImport;
+        textureImport.path = path;
+        textureImport.attributes = attributes;
+        textureImport.sRGB = sRGB;
+        textureImport.width = 0;
+        textureImport.height = 0;
+        textureImport.firstLevel = 0;
+        textureImport.atlas = -1;
+        textureImport.references = 0;
+        textureImport.cached = false;
+        textureImports.push_back(textureImport);
+        return (UInt32)textureImports.size() - 1;
+    }
+
+    /**
+     * Locate the Assimp UV channels of the textures a material uses (as indicated by [hasDiffuseTexture], [hasNormalsTexture]
+     * and [hasRoughnessGlossTexture]) and store them in the mesh-specific properties of [materialImportDesc] for the mesh
+     * specified by [meshIndex].
+     */
+    void ModelLoader::setupMeshSpecificUVMapping(const aiMaterial& assimpMaterial, Bool hasDiffuseTexture, Bool hasNormalsTexture,
+                                                 Bool hasRoughnessGlossTexture, UInt32 meshIndex, MaterialImportDescriptor& materialImportDesc) const {
        
         Int32 mappedIndex;
 
-        if (diffuseTexture) {
+        if (hasDiffuseTexture) {
              // get the Assimp material key for textures of type [textureType]
             UInt32 aiDiffuseTextureKey = this->convertTextureTypeToAITextureKey(TextureType::Albedo);
             if (AI_SUCCESS == aiGetMaterialInteger(&assimpMaterial, AI_MATKEY_UVWSRC(aiDiffuseTextureKey, 0), &mappedIndex))
@@ -792,7 +2061,7 @@ namespace Core {
                 materialImportDesc.meshSpecificProperties[meshIndex].uvMapping[TextureType::Albedo] = 0;
         }
 
-        if (normalsTexture) {
+        if (hasNormalsTexture) {
             UInt32 aiNormalsTextureKey = this->convertTextureTypeToAITextureKey(TextureType::Normals);
             if (AI_SUCCESS == aiGetMaterialInteger(&assimpMaterial, AI_MATKEY_UVWSRC(aiNormalsTextureKey, 0), &mappedIndex))
                 materialImportDesc.meshSpecificProperties[meshIndex].uvMapping[TextureType::Normals] = mappedIndex;
@@ -800,13 +2069,9 @@ namespace Core {
                 materialImportDesc.meshSpecificProperties[meshIndex].uvMapping[TextureType::Normals] = 0;
         }
 
-        if (roughnessGlossTexture) {
+        if (hasRoughnessGlossTexture) {
             materialImportDesc.meshSpecificProperties[meshIndex].uvMapping[TextureType::RoughnessGloss] = 0;
         }
-
-        this->setTexturesOnMaterial(materialImportDesc.meshSpecificProperties[meshIndex].material, diffuseTexture, normalsTexture, roughnessGlossTexture);
-
-        return true;
     }
 
     void ModelLoader::setTexturesOnMaterial(WeakPointer<Material> material, WeakPointer<Texture> albedoMap, WeakPointer<Texture> normalMap,
@@ -843,6 +2108,20 @@ namespace Core {
         }
     }
 
+    /**
+     * Point a physical [material] at the parts of their atlases its texture maps were packed into, if they were.
+     * Any of the imports may be null.
+     */
+    void ModelLoader::setTextureRegionsOnMaterial(WeakPointer<Material> material, const TextureImport* albedoMap, const TextureImport* normalMap,
+                                                  const TextureImport* roughnessGlossMap) {
+        WeakPointer<StandardPhysicalMaterial> physicalMaterial = WeakPointer<Material>::dynamicPointerCast<StandardPhysicalMaterial>(material);
+        if (!physicalMaterial) return;
+
+        if (albedoMap && albedoMap->atlas >= 0) physicalMaterial->setAlbedoMapRegion(albedoMap->atlasRegion);
+        if (normalMap && normalMap->atlas >= 0) physicalMaterial->setNormalMapRegion(normalMap->atlasRegion);
+        if (roughnessGlossMap && roughnessGlossMap->atlas >= 0) physicalMaterial->setRoughnessMapRegion(roughnessGlossMap->atlasRegion);
+    }
+
     ModelLoader::TextureType ModelLoader::convertAITextureKeyToTextureType(Int32 aiTextureKey) {
         TextureType textureType = TextureType::_None;
         if (aiTextureKey == aiTextureType_SPECULAR)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -12,6 +13,13 @@
 
 #include "../util/WeakPointer.h"
 #include "../image/ImageLoader.h"
+#include "../image/TextureAttr.h"
+#include "../image/CompressedImage.h"
+#include "../image/Texture2D.h"
+#include "../image/TextureAtlas.h"
+#include "../geometry/MeshOptimizer.h"
+#include "AssetStreamer.h"
+#include "CookedModel.h"
 #include "../base/BitMask.h"
 #include "../common/Exception.h"
 #include "../common/types.h"
@@ -27,6 +35,7 @@ namespace Core {
     class Material;
     class Engine;
     class Mesh;
+    class ThreadPool;
 
     class ModelLoader {
     public:
@@ -38,10 +47,26 @@ namespace Core {
             }
         };
 
+        typedef std::function<void(WeakPointer<Object3D>)> ModelLoadedCallback;
+
         ModelLoader();
         ~ModelLoader();
         WeakPointer<Object3D> loadModel(const std::string& filePath, Real importScale, UInt32 smoothingThreshold, 
                                         Bool castShadows, Bool receiveShadows, Bool preserveFBXPivots, Bool preferPhysicalMaterial);
+        WeakPointer<Object3D> cookModel(const std::string& filePath, const std::string& cookedPath, Real importScale, UInt32 smoothingThreshold,
+                                        Bool castShadows, Bool receiveShadows, Bool preserveFBXPivots, Bool preferPhysicalMaterial);
+        WeakPointer<Object3D> loadCookedModel(const std::string& cookedPath, Bool castShadows, Bool receiveShadows);
+        AssetStreamer::RequestHandle loadModelAsync(const std::string& filePath, Real importScale, UInt32 smoothingThreshold,
+                                                    Bool castShadows, Bool receiveShadows, Bool preserveFBXPivots, Bool preferPhysicalMaterial,
+                                                    AssetStreamer::Priority priority, ModelLoadedCallback onLoaded);
+        AssetStreamer::RequestHandle loadCookedModelAsync(const std::string& cookedPath, Bool castShadows, Bool receiveShadows,
+                                                          AssetStreamer::Priority priority, ModelLoadedCallback onLoaded);
+        void setTextureCompression(Bool compressTextures, const std::string& textureCacheDirectory);
+        Bool getTextureCompression() const;
+        void setTextureStreaming(Bool streamTextures);
+        Bool getTextureStreaming() const;
+        void setTextureAtlasing(Bool atlasTextures);
+        Bool getTextureAtlasing() const;
 
     private:
 
@@ -59,6 +84,7 @@ namespace Core {
             WeakPointer<Material> material;
             Bool invertVCoords;
             std::map<TextureType, int> uvMapping;
+            std::map<TextureType, std::string> texturePaths;
 
             MeshSpecificMaterialDescriptor() {
                 vertexColorsIndex = -1;
@@ -82,23 +108,179 @@ namespace Core {
             }
         };
 
+        // one Assimp mesh, as referenced by the scene's nodes with a given winding order, converted
+        // to welded and optimized vertex data that is ready to be copied into a Mesh
+        class ImportedMeshData {
+        public:
+            UInt32 meshIndex;
+            Bool invert;
+            MeshSpecificMaterialDescriptor properties;
+
+            UInt32 vertexCount;
+            std::vector<UInt32> indices;
+            std::vector<Real> positions;
+            std::vector<Real> normals;
+            std::vector<Real> averagedNormals;
+            std::vector<Real> faceNormals;
+            std::vector<Real> tangents;
+            std::vector<Real> colors;
+            std::vector<Real> albedoUVs;
+            std::vector<Real> normalUVs;
+            Bool hasColors;
+            Bool hasAlbedoUVs;
+            Bool hasNormalUVs;
+            Bool hasTangents;
+            // vertex cache statistics before and after optimization, for callers that want to report them
+            MeshOptimizer::Report optimization;
+
+            ImportedMeshData() {
+                meshIndex = 0;
+                invert = false;
+                vertexCount = 0;
+                hasColors = false;
+                hasAlbedoUVs = false;
+                hasNormalUVs = false;
+                hasTangents = false;
+            }
+        };
+
+        // one texture a model uses: the image file, the attributes to create the texture with, whether its
+        // color channels are sRGB-encoded and, once decoded, the image with the mip levels below it (or the
+        // compressed image holding all levels if the attributes call for a compressed format). If the texture
+        // was packed into an atlas, [atlas] is the index of the atlas and [atlasRegion] where in it the texture is;
+        // its own images are released then. If the texture cache already held the texture, [cachedTexture] holds the
+        // reference acquired for it instead of any images, until createTexture() takes it over. [width] and [height] are
+        // the size of the full-resolution image; a streamed texture may hold only the levels from [firstLevel] down, in
+        // which case [image] (or the first level of [compressedImage]) is level [firstLevel] of the full chain.
+        // [texture] is what createTexture() handed to the [references] material slots using it; those references are
+        // held in the texture cache once [cached] is set, which for a new texture is when buildTexture() has built it.
+        // Once stageTextureLevels() has copied the levels to be uploaded into [levels], the images are released
+        class TextureImport {
+        public:
+            std::string path;
+            TextureAttributes attributes;
+            Bool sRGB;
+            UInt32 width;
+            UInt32 height;
+            UInt32 firstLevel;
+            std::shared_ptr<StandardImage> image;
+            std::vector<std::shared_ptr<StandardImage>> mipLevels;
+            std::shared_ptr<CompressedImage> compressedImage;
+            std::vector<Texture2D::LevelData> levels;
+            WeakPointer<Texture2D> cachedTexture;
+            Int32 atlas;
+            TextureAtlas::Region atlasRegion;
+            WeakPointer<Texture2D> texture;
+            UInt32 references;
+            Bool cached;
+        };
+
+        // an atlas that small textures with the same [attributes] were packed into; [texture] is created from
+        // it the first time a material needs it and, with a reference for each of the [references] material
+        // slots using it, added to the engine's texture cache under [cacheKey] once buildTexture() has built it.
+        // [levels] holds the atlas levels once stageTextureLevels() has copied them into upload memory
+        class TextureAtlasImport {
+        public:
+            TextureAtlas atlas;
+            std::vector<Texture2D::LevelData> levels;
+            TextureAttributes attributes;
+            WeakPointer<Texture2D> texture;
+            UInt32 references;
+            Bool cached;
+            std::string cacheKey;
+
+            TextureAtlasImport(const TextureAttributes& attributes):
+                atlas(TextureAtlas::DefaultMaxSize, attributes.MipLevels), attributes(attributes), references(0), cached(false) {
+            }
+        };
+
+        // a cooked model that has been read and validated, with its texture images decoded. [materialTextures]
+        // holds, for every material and texture slot, the index into [textureImports] or -1 if there is none
+        class CookedModelImport {
+        public:
+            CookedModel::Reader reader;
+            std::vector<TextureImport> textureImports;
+            std::vector<TextureAtlasImport> textureAtlases;
+            std::vector<Int32> materialTextures;
+        };
+
+        // everything read from an Assimp scene before any engine objects get created: the materials' import
+        // descriptors (without the materials themselves), the decoded textures with [materialTextures] laid out
+        // as in CookedModelImport, and the prepared meshes together with the slots of collectMeshImports()
+        class ModelSceneImport {
+        public:
+            std::vector<MaterialImportDescriptor> materialImportDescriptors;
+            std::vector<TextureImport> textureImports;
+            std::vector<TextureAtlasImport> textureAtlases;
+            std::vector<Int32> materialTextures;
+            std::vector<ImportedMeshData> importedMeshes;
+            std::map<UInt32, UInt32> importedMeshSlots;
+        };
+
         void initImporter();
-        const aiScene* loadAIScene(const std::string& filePath, Bool preserveFBXPivots);
+        static const aiScene* loadAIScene(Assimp::Importer& importer, const std::string& filePath, Bool preserveFBXPivots);
 
         WeakPointer<Object3D> processModelScene(const std::string& modelPath, const aiScene& scene, Real importScale,  UInt32 smoothingThreshold,
-                                                Bool castShadows, Bool receiveShadows, Bool preferPhysicalMaterial) const;
-        Bool processMaterials(const std::string& modelPath, const aiScene& scene,
-                             std::vector<MaterialImportDescriptor>& materialImportDescriptors, Bool preferPhysicalMaterial) const;
-        WeakPointer<Texture> loadAITexture(aiMaterial& assimpMaterial, aiTextureType textureType, const std::string& modelPath, TextureFilter filter, UInt32 mipLevel) const;
+                                                Bool castShadows, Bool receiveShadows, Bool preferPhysicalMaterial, CookedModel::Writer* cookedModel,
+                                                std::vector<WeakPointer<Mesh>>* pendingUploads) const;
+        void readModelScene(const std::string& modelPath, const aiScene& scene, UInt32 smoothingThreshold, Bool preferPhysicalMaterial,
+                            ModelSceneImport& sceneImport) const;
+        WeakPointer<Object3D> instantiateModelScene(const aiScene& scene, ModelSceneImport& sceneImport, Real importScale, UInt32 smoothingThreshold,
+                                                    Bool castShadows, Bool receiveShadows, CookedModel::Writer* cookedModel,
+                                                    std::vector<WeakPointer<Mesh>>* pendingUploads) const;
+        void readMaterials(const std::string& modelPath, const aiScene& scene, Bool preferPhysicalMaterial, ModelSceneImport& sceneImport) const;
+        void createMaterials(const aiScene& scene, ModelSceneImport& sceneImport) const;
+        std::string findAITexturePath(aiMaterial& assimpMaterial, aiTextureType textureType, const std::string& modelPath) const;
+        WeakPointer<Texture> createTexture(TextureImport& textureImport, std::vector<TextureAtlasImport>& textureAtlases) const;
+        void buildTexture(TextureImport& textureImport) const;
+        void buildTextures(std::vector<TextureImport>& textureImports, std::vector<TextureAtlasImport>& textureAtlases) const;
+        void addTextureUploads(AssetStreamer::Request& request, std::vector<TextureImport>& textureImports,
+                               std::vector<TextureAtlasImport>& textureAtlases) const;
+        Bool isStreamedTexture(const TextureImport& textureImport) const;
+        void stageTextureLevels(std::vector<TextureImport>& textureImports, std::vector<TextureAtlasImport>& textureAtlases) const;
+        void decodeTextureImages(std::vector<TextureImport>& textureImports) const;
+        void packTextureAtlases(std::vector<TextureImport>& textureImports, const std::vector<Bool>& packable,
+                                std::vector<TextureAtlasImport>& textureAtlases) const;
+        TextureAttributes getImportTextureAttributes(TextureType textureType) const;
         void getImportDetails(const aiMaterial* mtl, MaterialImportDescriptor& materialImportDesc, const aiScene& scene, Bool preferPhysicalMaterial) const;
-        Bool setupMeshSpecificMaterialWithTextures(const aiMaterial& assimpMaterial, WeakPointer<Texture> diffuseTexture,
-                                                  WeakPointer<Texture> normalsTexture, WeakPointer<Texture> roughnessGlossTexture,
-                                                  UInt32 meshIndex, MaterialImportDescriptor& materialImportDesc) const;
+        void setupMeshSpecificUVMapping(const aiMaterial& assimpMaterial, Bool hasDiffuseTexture, Bool hasNormalsTexture,
+                                        Bool hasRoughnessGlossTexture, UInt32 meshIndex, MaterialImportDescriptor& materialImportDesc) const;
+        void collectMeshImports(const aiScene& scene, const aiNode& node, std::vector<MaterialImportDescriptor>& materialImportDescriptors,
+                                std::vector<ImportedMeshData>& importedMeshes, std::map<UInt32, UInt32>& importedMeshSlots) const;
         WeakPointer<Object3D> recursiveProcessModelScene(const aiScene& scene, const aiNode& node, std::vector<MaterialImportDescriptor>& materialImportDescriptors,
-                                                         std::vector<WeakPointer<Object3D>>& createdSceneObjects, 
+                                                         const std::vector<ImportedMeshData>& importedMeshes,
+                                                         const std::map<UInt32, UInt32>& importedMeshSlots,
+                                                         std::vector<WeakPointer<Object3D>>& createdSceneObjects,
+                                                         std::vector<WeakPointer<Mesh>>& createdMeshes,
                                                          UInt32 smoothingThreshold, Bool castShadows, Bool receiveShadows) const;
-        WeakPointer<Mesh> convertAssimpMesh(UInt32 meshIndex, const aiScene& scene, MaterialImportDescriptor& materialImportDescriptor, Bool invert, UInt32 smoothingThreshold) const;
+        void prepareAssimpMesh(const aiScene& scene, ImportedMeshData& data, UInt32 smoothingThreshold) const;
+        WeakPointer<Mesh> convertAssimpMesh(const ImportedMeshData& data, WeakPointer<Material> material, UInt32 smoothingThreshold) const;
+        void cookModelScene(WeakPointer<Object3D> object, Int32 parent, const std::map<const Material*, const MeshSpecificMaterialDescriptor*>& materialProperties,
+                            std::map<const Material*, UInt32>& cookedMaterials, std::map<const Mesh*, UInt32>& cookedMeshes,
+                            CookedModel::Writer& cookedModel) const;
+        UInt32 cookMaterial(WeakPointer<Material> material, const std::map<const Material*, const MeshSpecificMaterialDescriptor*>& materialProperties,
+                            std::map<const Material*, UInt32>& cookedMaterials, CookedModel::Writer& cookedModel) const;
+        UInt32 cookMesh(WeakPointer<Mesh> mesh, UInt32 material, std::map<const Mesh*, UInt32>& cookedMeshes, CookedModel::Writer& cookedModel) const;
+        void readCookedModel(const std::string& cookedPath, CookedModelImport& cookedImport) const;
+        WeakPointer<Object3D> instantiateCookedModel(CookedModelImport& cookedImport, std::vector<WeakPointer<Mesh>>* pendingUploads) const;
+        WeakPointer<Mesh> convertCookedMesh(const CookedModel::Reader& cookedModel, const CookedModel::MeshRecord& record, WeakPointer<Material> material) const;
         
+        static void runParallel(UInt32 count, const std::function<void(UInt32)>& func);
+        static void setTextureRegionsOnMaterial(WeakPointer<Material> material, const TextureImport* albedoMap, const TextureImport* normalMap,
+                                                const TextureImport* roughnessGlossMap);
+        static void addMeshUploads(AssetStreamer::Request& request, const std::vector<WeakPointer<Mesh>>& meshes);
+        static void destroyModel(WeakPointer<Object3D> root);
+        static void buildTextureAtlas(TextureAtlasImport& atlasImport);
+        static TextureAttributes getTextureAtlasAttributes(const TextureAtlasImport& atlasImport);
+        static UInt32 getMeshImportKey(UInt32 meshIndex, Bool invert);
+        static void decodeTextureImage(TextureImport& textureImport, const std::string& cacheDirectory, Bool streamed, UInt32 firstLevel,
+                                       UInt32 lastLevel, ThreadPool* threadPool);
+        static UInt32 getTextureLevelCount(const TextureImport& textureImport);
+        static void getTextureLevels(const TextureImport& textureImport, UInt32 firstLevel, UInt32 lastLevel, std::vector<Texture2D::LevelData>& levels);
+        static UInt64 getTextureLevelSizeBytes(const TextureImport& textureImport, UInt32 level);
+        static void releaseCachedTextures(std::vector<TextureImport>& textureImports);
+        static void releaseTextures(std::vector<TextureImport>& textureImports, std::vector<TextureAtlasImport>& textureAtlases);
+        static UInt32 addTextureImport(std::vector<TextureImport>& textureImports, const std::string& path, const TextureAttributes& attributes, Bool sRGB);
         static ModelLoader::TextureType convertAITextureKeyToTextureType(Int32 aiTextureKey);
         static int convertTextureTypeToAITextureKey(TextureType textureType);
         static Bool hasOddReflections(Matrix4x4& mat);                            
@@ -107,6 +289,10 @@ namespace Core {
 #endif
 
         ImageLoader imageLoader;
+        Bool compressTextures;
+        std::string textureCacheDirectory;
+        Bool streamTextures;
+        Bool atlasTextures;
 
     };
 }
\ No newline at end of file
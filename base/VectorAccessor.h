@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string.h>
+
+#include "../common/types.h"
+
+namespace Core {
+
+    /*
+     * Lightweight view of a single vector that lives in external storage (e.g. one element of an
+     * AttributeArray). It holds nothing but a pointer to the first component: reading it produces
+     * a plain value of type V and assigning a V writes the components back.
+     *
+     * Copy-constructing an accessor copies the pointer (so accessors can be passed around by value),
+     * but assigning one accessor to another copies the components it points at, like a reference.
+     */
+    template <typename V>
+    class VectorAccessor {
+    public:
+        typedef V ValueType;
+        typedef typename V::ComponentType ComponentType;
+        static const UInt32 ComponentCount = V::ComponentCount;
+
+        explicit VectorAccessor(ComponentType* data): data(data) {}
+        VectorAccessor(const VectorAccessor& other) = default;
+
+        VectorAccessor& operator =(const VectorAccessor& other) {
+            memmove(this->data, other.data, sizeof(ComponentType) * ComponentCount);
+            return *this;
+        }
+
+        VectorAccessor& operator =(const V& value) {
+            this->copy(value);
+            return *this;
+        }
+
+        operator V() const {
+            return this->get();
+        }
+
+        V get() const {
+            V value;
+            memcpy(value.getData(), this->data, sizeof(ComponentType) * ComponentCount);
+            return value;
+        }
+
+        void copy(const V& value) {
+            memcpy(this->data, value.getConstData(), sizeof(ComponentType) * ComponentCount);
+        }
+
+        ComponentType* getData() {
+            return this->data;
+        }
+
+        ComponentType& operator [](UInt32 index) {
+            return this->data[index];
+        }
+
+    private:
+        ComponentType* data;
+    };
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../base/VectorStorage.h"
+#include "../base/VectorAccessor.h"
 #include "../common/types.h"
 #include "Color4Components.h"
 
@@ -8,29 +8,24 @@ namespace Core {
 
 #define COLOR_COMPONENT_COUNT 4
 
-    template <bool customStorage = false>
-    class Color4 : public VectorStorage<Real, COLOR_COMPONENT_COUNT, customStorage>, public Color4Components {
+    class Color4 : public Color4Components {
     public:
+        static const UInt32 ComponentCount = COLOR_COMPONENT_COUNT;
+        typedef Real ComponentType;
+
         Color4() : Color4(0.0, 0.0, 0.0, 1.0) {}
-        Color4(Real r, Real g, Real b, Real a) : Color4Components(this->data, r, g, b, a) {}
-        Color4(Real* storage) : Color4(storage, 0.0, 0.0, 0.0, 0.0) {}
-        Color4(Real* storage, Real r, Real g, Real b, Real a)
-            : VectorStorage<Real, COLOR_COMPONENT_COUNT, true>(storage), Color4Components(this->data, r, g, b, a) {}
-
-        Color4& operator =(const Color4& other) {
-            if (this == &other) return *this;
-            this->copy(other);
-            return *this;
+        Color4(Real r, Real g, Real b, Real a) : Color4Components(r, g, b, a) {}
+
+        Real* getData() {
+            return this->data;
         }
 
-        template <Bool otherCustomStorage>
-        Color4& operator =(const Color4<otherCustomStorage>& other) {
-            this->copy(other);
-            return *this;
+        const Real* getConstData() const {
+            return this->data;
         }
     };
 
-    typedef Color4<false> Color;
-    typedef Color4<true> ColorS;
+    typedef Color4 Color;
+    typedef VectorAccessor<Color> ColorS;
 
 }
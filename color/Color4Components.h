@@ -4,15 +4,19 @@
 
 namespace Core {
 
-    class Color4Components {
+    class alignas(16) Color4Components {
     public:
-        Real& r;
-        Real& g;
-        Real& b;
-        Real& a;
+        union {
+            struct {
+                Real r;
+                Real g;
+                Real b;
+                Real a;
+            };
+            Real data[4];
+        };
 
-        Color4Components(Real* data, const Real& r, const Real& g, const Real& b, const Real a);
-        virtual ~Color4Components() = 0;
+        Color4Components(const Real& r, const Real& g, const Real& b, const Real a);
 
         void set(const Real& r, const Real& g, const Real& b, const Real& a);
     };
@@ -11,7 +11,7 @@ namespace Core {
         IntColor(Byte gray): r(gray), g(gray), b(gray), a(gray) {}
         IntColor(Byte r, Byte g, Byte b, Byte a): r(r), g(g), b(b), a(a) {}
 
-        IntColor(const Color4<>& src) {
+        IntColor(const Color& src) {
             this->r = (Byte)src.r;
             this->g = (Byte)src.g;
             this->b = (Byte)src.b;
@@ -10,6 +10,8 @@ namespace Core {
         Exception(const std::string& msg): msg(msg) {std::cerr << msg << std::endl;}
         Exception(const char* msg): msg(msg) {std::cerr << msg << std::endl;}
 
+        const std::string& getMessage() const {return msg;}
+
     private:
         std::string msg;
     };
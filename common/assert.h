@@ -11,3 +11,10 @@
 		exit(-1);							                  \
 	}									   	                    \
 }
+
+// Checked only in debug builds; compiles to nothing when NDEBUG is defined.
+#ifdef NDEBUG
+#define DEBUG_ASSERT(exp, msg) ((void)0)
+#else
+#define DEBUG_ASSERT(exp, msg) ASSERT(exp, msg)
+#endif
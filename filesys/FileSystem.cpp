@@ -1,4 +1,7 @@
 #include <fstream>
+#include <vector>
+
+#include <sys/stat.h>
 
 #include "FileSystem.h"
 #include "FileSystemIX.h"
@@ -61,6 +64,18 @@ namespace Core {
         return isGood;
     }
 
+    /*
+     * Get the size in bytes and the last modification time (seconds since the epoch) of the file
+     * at [fullPath]. Returns false if the file does not exist.
+     */
+    Bool FileSystem::getFileInfo(const std::string& fullPath, UInt64& size, Int64& modificationTime) const {
+        struct stat fileStat;
+        if (stat(fullPath.c_str(), &fileStat) != 0) return false;
+        size = (UInt64)fileStat.st_size;
+        modificationTime = (Int64)fileStat.st_mtime;
+        return true;
+    }
+
     std::string FileSystem::getBasePath(const std::string& path) const {
         Char separator = this->getPathSeparator();
         size_t pos = path.find_last_of(separator);
@@ -73,4 +88,39 @@ namespace Core {
         return (std::string::npos == pos) ? std::string() : fullPath.substr(pos + 1);
     }
 
+    /*
+     * Normalize [path] lexically so that different spellings of the same file compare equal:
+     * separators are fixed up for the local file system, repeated separators and "." segments
+     * are dropped and ".." segments remove the segment before them. Symbolic links are not resolved.
+     */
+    std::string FileSystem::getCanonicalPath(const std::string& path) const {
+        std::string fixedPath = this->fixupPathForLocalFilesystem(path);
+        String::trim(fixedPath);
+        Char separator = this->getPathSeparator();
+        Bool absolute = fixedPath.size() > 0 && fixedPath[0] == separator;
+
+        std::vector<std::string> segments;
+        size_t start = 0;
+        while (start <= fixedPath.size()) {
+            size_t end = fixedPath.find(separator, start);
+            if (end == std::string::npos) end = fixedPath.size();
+            std::string segment = fixedPath.substr(start, end - start);
+            if (segment == "..") {
+                if (segments.size() > 0 && segments.back() != "..") segments.pop_back();
+                else if (!absolute) segments.push_back(segment);
+            }
+            else if (segment.size() > 0 && segment != ".") {
+                segments.push_back(segment);
+            }
+            start = end + 1;
+        }
+
+        std::string canonicalPath = absolute ? std::string(1, separator) : std::string();
+        for (UInt32 i = 0; i < segments.size(); i++) {
+            if (i > 0) canonicalPath.append(1, separator);
+            canonicalPath += segments[i];
+        }
+        return canonicalPath;
+    }
+
 }
\ No newline at end of file
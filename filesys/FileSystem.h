@@ -22,8 +22,10 @@ namespace Core {
         static std::shared_ptr<FileSystem> getInstance();
         std::string concatenatePaths(const std::string& pathA, const std::string& pathB) const;
         Bool fileExists(const std::string& fullPath) const;
+        Bool getFileInfo(const std::string& fullPath, UInt64& size, Int64& modificationTime) const;
         std::string getBasePath(const std::string& path) const;
         std::string getFileName(const std::string& fullPath) const;
+        std::string getCanonicalPath(const std::string& path) const;
 
         virtual Char getPathSeparator() const = 0;
         virtual std::string fixupPathForLocalFilesystem(const std::string& path) const = 0;
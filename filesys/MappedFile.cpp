@@ -0,0 +1,89 @@
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+namespace Core {
+
+    MappedFile::MappedFile(): data(nullptr), size(0), mapped(false) {
+
+    }
+
+    MappedFile::~MappedFile() {
+        this->close();
+    }
+
+    /*
+     * Make the contents of the file at [path] available through getData(). Returns false if the
+     * file cannot be opened or is empty.
+     */
+    Bool MappedFile::open(const std::string& path) {
+        this->close();
+
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat fileInfo;
+        if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* mapping = mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) return false;
+
+        this->data = (const Byte*)mapping;
+        this->size = (UInt64)fileInfo.st_size;
+        this->mapped = true;
+        return true;
+#else
+        std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+
+        std::streamoff fileSize = file.tellg();
+        if (fileSize <= 0) return false;
+
+        this->buffer.resize((size_t)fileSize);
+        file.seekg(0, std::ios::beg);
+        if (!file.read((char*)this->buffer.data(), fileSize)) {
+            this->buffer.clear();
+            return false;
+        }
+
+        this->data = this->buffer.data();
+        this->size = (UInt64)fileSize;
+        return true;
+#endif
+    }
+
+    void MappedFile::close() {
+#ifndef _WIN32
+        if (this->mapped) munmap((void*)this->data, (size_t)this->size);
+#endif
+        this->buffer.clear();
+        this->buffer.shrink_to_fit();
+        this->data = nullptr;
+        this->size = 0;
+        this->mapped = false;
+    }
+
+    Bool MappedFile::isOpen() const {
+        return this->data != nullptr;
+    }
+
+    const Byte* MappedFile::getData() const {
+        return this->data;
+    }
+
+    UInt64 MappedFile::getSize() const {
+        return this->size;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../common/types.h"
+
+namespace Core {
+
+    /*
+     * Read-only view of a whole file. On POSIX systems the file is memory-mapped, so pages are
+     * only read from disk when they are touched; elsewhere it is read into memory in one go.
+     */
+    class MappedFile {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        Bool open(const std::string& path);
+        void close();
+        Bool isOpen() const;
+        const Byte* getData() const;
+        UInt64 getSize() const;
+
+    private:
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+
+        const Byte* data;
+        UInt64 size;
+        Bool mapped;
+        std::vector<Byte> buffer;
+    };
+}
@@ -8,6 +8,7 @@
 #include "../common/assert.h"
 #include "../common/types.h"
 #include "AttributeArrayGPUStorage.h"
+#include "AttributeView.h"
 
 namespace Core {
 
@@ -38,11 +39,18 @@ namespace Core {
         std::shared_ptr<AttributeArrayGPUStorage> gpuStorage;
     };
 
+    /*
+     * Tightly packed array of vertex attributes. [T] is a VectorAccessor type (Point3rs, Vector3rs,
+     * ColorS, ...): the components of every element live in one contiguous block and individual
+     * elements are reached through accessors created on demand, so no per-element objects exist.
+     * Loops over many elements should take an AttributeView via getView() once and index that.
+     */
     template <typename T>
     class AttributeArray final: public AttributeArrayBase {
     public:
+        typedef typename T::ValueType ValueType;
 
-        AttributeArray(UInt32 attributeCount) : AttributeArrayBase(attributeCount, T::ComponentCount), storage(nullptr), attributes(nullptr) {
+        AttributeArray(UInt32 attributeCount) : AttributeArrayBase(attributeCount, T::ComponentCount), storage(nullptr), dirtyFirst(0), dirtyEnd(0) {
             allocate();
         }
 
@@ -54,31 +62,70 @@ namespace Core {
             return this->storage;
         }
 
-        T* getAttributes() {
-            return this->attributes;
+        T getAttribute(UInt32 index) {
+            DEBUG_ASSERT(index < this->attributeCount, "AttributeArray::getAttribute() -> 'index' is out of range.");
+            return T(this->storage + index * T::ComponentCount);
         }
 
-        T& getAttribute(UInt32 index) {
-            if (index >= this->attributeCount) {
-                throw OutOfRangeException("AttributeArray::getAttribute() -> 'index' is out of range.");
-            }
-            return this->attributes[index];
+        AttributeView<T> getView() {
+            return AttributeView<T>(this->storage, this->attributeCount);
         }
 
         void store(const typename T::ComponentType* data) {
             memcpy(this->storage, data, this->getSize());
+            this->clearDirty();
+            this->updateGPUStorageData();
+        }
+
+        /*
+         * Overwrite elements [first, first + count) with the packed elements in [data] and
+         * upload only that range.
+         */
+        void store(UInt32 first, UInt32 count, const typename T::ComponentType* data) {
+            DEBUG_ASSERT(first + count <= this->attributeCount, "AttributeArray::store() -> range is out of bounds.");
+            memcpy(this->storage + first * T::ComponentCount, data, count * this->getElementSize());
+            this->markDirty(first, count);
             this->updateGPUStorageData();
         }
 
         void setGPUStorage(std::shared_ptr<AttributeArrayGPUStorage> storage) { 
             this->gpuStorage = storage;
+            this->clearDirty();
             this->updateGPUStorageData();
         }
 
+        /*
+         * Record that elements [first, first + count) were modified in place (e.g. through a view)
+         * so the next updateGPUStorageData() only uploads what changed.
+         */
+        void markDirty(UInt32 first, UInt32 count) {
+            if (first >= this->attributeCount || count == 0) return;
+            if (count > this->attributeCount - first) count = this->attributeCount - first;
+            if (this->dirtyEnd <= this->dirtyFirst) {
+                this->dirtyFirst = first;
+                this->dirtyEnd = first + count;
+            }
+            else {
+                if (first < this->dirtyFirst) this->dirtyFirst = first;
+                if (first + count > this->dirtyEnd) this->dirtyEnd = first + count;
+            }
+        }
+
+        /*
+         * Send the range marked with markDirty() to the GPU, or the whole array if nothing
+         * has been marked.
+         */
         void updateGPUStorageData() {
             if (this->gpuStorage) {
-                this->gpuStorage->updateBufferData((void *)this->storage);
+                if (this->dirtyEnd > this->dirtyFirst) {
+                    this->gpuStorage->updateBufferData((void *)this->storage, this->dirtyFirst * this->getElementSize(),
+                                                       (this->dirtyEnd - this->dirtyFirst) * this->getElementSize());
+                }
+                else {
+                    this->gpuStorage->updateBufferData((void *)this->storage);
+                }
             }
+            this->clearDirty();
         }
 
         class iterator {
@@ -89,8 +136,8 @@ namespace Core {
             iterator(AttributeArray<T>* array, UInt32 index) : array(array), index(index) {
             }
 
-            T& operator *() {
-                return array->attributes[index];
+            T operator *() {
+                return T(array->storage + index * T::ComponentCount);
             }
 
             iterator operator ++() {
@@ -126,12 +173,23 @@ namespace Core {
         }
 
         UInt32 getSize() const {
-            return this->attributeCount * T::ComponentCount * sizeof(typename T::ComponentType);
+            return this->attributeCount * this->getElementSize();
+        }
+
+        UInt32 getElementSize() const {
+            return T::ComponentCount * sizeof(typename T::ComponentType);
         }
 
     protected:
         typename T::ComponentType* storage;
-        T* attributes;
+        // elements [dirtyFirst, dirtyEnd) are waiting to be uploaded
+        UInt32 dirtyFirst;
+        UInt32 dirtyEnd;
+
+        void clearDirty() {
+            this->dirtyFirst = 0;
+            this->dirtyEnd = 0;
+        }
 
         void allocate() {
             this->deallocate();
@@ -141,27 +199,16 @@ namespace Core {
                 throw AllocationException("AttributeArray::allocate() -> Unable to allocate storage!");
             }
 
-            Byte* tempAttributes = (Byte*)(::operator new(this->attributeCount * sizeof(T)));
-            if (tempAttributes == nullptr) {
-                throw AllocationException("AttributeArray::allocate() -> Unable to allocate attributes!");
-            }
-
-            this->attributes = reinterpret_cast<T*>(tempAttributes);
+            // start every element off as a default value (w = 1 for points, 0 for vectors, etc.)
+            ValueType defaultValue;
             for (UInt32 i = 0; i < this->attributeCount; i++) {
-                new (this->attributes + i) T(this->storage + (i * T::ComponentCount));
+                T(this->storage + (i * T::ComponentCount)) = defaultValue;
             }
         }
 
         void deallocate() {
-            if (this->attributes != nullptr) {
-                for (UInt32 i = 0; i < this->attributeCount; i++) {
-                    this->attributes[i].~T();
-                }
-                ::operator delete(this->attributes);
-                this->attributes = nullptr;
-            }
             if (this->storage != nullptr) {
-                delete this->storage;
+                delete[] this->storage;
                 this->storage = nullptr;
             }
         }
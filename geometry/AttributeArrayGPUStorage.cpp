@@ -2,8 +2,43 @@
 
 namespace Core {
 
+    std::atomic<UInt64> AttributeArrayGPUStorage::nextSerial(1);
+
+    AttributeArrayGPUStorage::AttributeArrayGPUStorage(): serial(nextSerial.fetch_add(1)) {
+
+    }
+
     AttributeArrayGPUStorage::~AttributeArrayGPUStorage() {
 
     }   
+
+    /*
+     * Make any pending data visible to the GPU before a draw. Storage that uploads eagerly has
+     * nothing to do here.
+     */
+    void AttributeArrayGPUStorage::flush() {
+
+    }
+
+    /*
+     * Called instead of sendToShader() when a cached vertex array that already points [location]
+     * at this storage is bound. Storage whose data can move within its buffer must re-point the
+     * attribute here.
+     */
+    void AttributeArrayGPUStorage::prepareForDraw(UInt32 location) {
+        this->flush();
+    }
+
+    UInt64 AttributeArrayGPUStorage::getSerial() const {
+        return this->serial;
+    }
+
+    /*
+     * Called when the storage moves to a different buffer, so vertex arrays recorded against
+     * the old one are not reused.
+     */
+    void AttributeArrayGPUStorage::renewSerial() {
+        this->serial = nextSerial.fetch_add(1);
+    }
     
-}
\ No newline at end of file
+}
@@ -1,15 +1,42 @@
 #pragma once
 
+#include <atomic>
+
 #include "../common/types.h"
+#include "../util/WeakPointer.h"
 
 namespace Core {
 
     class AttributeArrayGPUStorage {
     public:
-
+        AttributeArrayGPUStorage();
         virtual ~AttributeArrayGPUStorage() = 0;
         virtual Int32 getBufferID() const = 0;
         virtual void sendToShader(UInt32 location) = 0;
         virtual void updateBufferData(void * data) = 0;
+        virtual void updateBufferData(void * data, UInt32 offset, UInt32 size) = 0;
+        virtual void flush();
+        virtual void prepareForDraw(UInt32 location);
+
+        UInt64 getSerial() const;
+
+    protected:
+        void renewSerial();
+
+    private:
+        // unique for the lifetime of the program, unlike buffer IDs or addresses, which get reused
+        UInt64 serial;
+        static std::atomic<UInt64> nextSerial;
+    };
+
+    /*
+     * One GPU attribute source together with the shader attribute location it feeds.
+     */
+    class VertexAttributeBinding {
+    public:
+        VertexAttributeBinding(UInt32 location, WeakPointer<AttributeArrayGPUStorage> storage): location(location), storage(storage) {}
+
+        UInt32 location;
+        WeakPointer<AttributeArrayGPUStorage> storage;
     };
 }
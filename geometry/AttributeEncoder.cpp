@@ -0,0 +1,122 @@
+#include <string.h>
+
+#include "AttributeEncoder.h"
+#include "../math/Math.h"
+
+namespace Core {
+
+    UInt32 AttributeEncoder::getComponentSize(AttributeType type) {
+        switch (type) {
+            case AttributeType::UnsignedInt:
+            case AttributeType::Int:
+            case AttributeType::Float:
+                return 4;
+            case AttributeType::HalfFloat:
+            case AttributeType::Short:
+            case AttributeType::UnsignedShort:
+                return 2;
+            case AttributeType::UnsignedByte:
+                return 1;
+        }
+        return 4;
+    }
+
+    Bool AttributeEncoder::isNormalized(AttributeType type) {
+        return type == AttributeType::Short || type == AttributeType::UnsignedShort || type == AttributeType::UnsignedByte;
+    }
+
+    /*
+     * Convert [elementCount] elements of [componentCount] Reals each from [source] into packed
+     * components of [type] in [dest]. Normalized formats are clamped to their range.
+     */
+    void AttributeEncoder::encode(const Real* source, UInt32 componentCount, AttributeType type, Byte* dest, UInt32 elementCount) {
+        UInt32 count = elementCount * componentCount;
+        switch (type) {
+            case AttributeType::Float: {
+                float* out = (float*)dest;
+                for (UInt32 i = 0; i < count; i++) out[i] = (float)source[i];
+                break;
+            }
+            case AttributeType::HalfFloat: {
+                UInt16* out = (UInt16*)dest;
+                for (UInt32 i = 0; i < count; i++) out[i] = AttributeEncoder::toHalfFloat(source[i]);
+                break;
+            }
+            case AttributeType::Short: {
+                Int16* out = (Int16*)dest;
+                for (UInt32 i = 0; i < count; i++) {
+                    Real v = Math::clamp(source[i], (Real)-1.0, (Real)1.0);
+                    out[i] = (Int16)Math::round(v * 32767.0f);
+                }
+                break;
+            }
+            case AttributeType::UnsignedShort: {
+                UInt16* out = (UInt16*)dest;
+                for (UInt32 i = 0; i < count; i++) {
+                    Real v = Math::clamp(source[i], (Real)0.0, (Real)1.0);
+                    out[i] = (UInt16)Math::round(v * 65535.0f);
+                }
+                break;
+            }
+            case AttributeType::UnsignedByte: {
+                for (UInt32 i = 0; i < count; i++) {
+                    Real v = Math::clamp(source[i], (Real)0.0, (Real)1.0);
+                    dest[i] = (Byte)Math::round(v * 255.0f);
+                }
+                break;
+            }
+            case AttributeType::Int: {
+                Int32* out = (Int32*)dest;
+                for (UInt32 i = 0; i < count; i++) out[i] = (Int32)source[i];
+                break;
+            }
+            case AttributeType::UnsignedInt: {
+                UInt32* out = (UInt32*)dest;
+                for (UInt32 i = 0; i < count; i++) out[i] = (UInt32)source[i];
+                break;
+            }
+        }
+    }
+
+    /*
+     * IEEE 754 binary16 encoding of [value], rounded to nearest even. Values too large for a
+     * half become infinity, values too small become (signed) zero or a subnormal.
+     */
+    UInt16 AttributeEncoder::toHalfFloat(Real value) {
+        float f = (float)value;
+        UInt32 bits;
+        memcpy(&bits, &f, sizeof(bits));
+
+        UInt32 sign = (bits >> 16) & 0x8000;
+        UInt32 exponent = (bits >> 23) & 0xFF;
+        UInt32 mantissa = bits & 0x7FFFFF;
+
+        if (exponent == 0xFF) {
+            // infinity or NaN (keep NaN a NaN)
+            return (UInt16)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+        }
+
+        Int32 halfExponent = (Int32)exponent - 127 + 15;
+        if (halfExponent >= 0x1F) {
+            return (UInt16)(sign | 0x7C00);
+        }
+
+        if (halfExponent <= 0) {
+            if (halfExponent < -10) return (UInt16)sign;
+            // subnormal: shift the mantissa (with its implicit leading one) into place
+            mantissa |= 0x800000;
+            UInt32 shift = (UInt32)(14 - halfExponent);
+            UInt32 halfMantissa = mantissa >> shift;
+            UInt32 remainder = mantissa & ((1u << shift) - 1);
+            UInt32 halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (halfMantissa & 1))) halfMantissa++;
+            return (UInt16)(sign | halfMantissa);
+        }
+
+        UInt32 half = sign | ((UInt32)halfExponent << 10) | (mantissa >> 13);
+        UInt32 remainder = mantissa & 0x1FFF;
+        // a carry out of the mantissa correctly bumps the exponent (up to infinity)
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) half++;
+        return (UInt16)half;
+    }
+}
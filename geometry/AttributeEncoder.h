@@ -0,0 +1,18 @@
+#pragma once
+
+#include "../common/types.h"
+#include "AttributeType.h"
+
+namespace Core {
+
+    class AttributeEncoder {
+    public:
+        static UInt32 getComponentSize(AttributeType type);
+        static Bool isNormalized(AttributeType type);
+        static void encode(const Real* source, UInt32 componentCount, AttributeType type, Byte* dest, UInt32 elementCount);
+        static UInt16 toHalfFloat(Real value);
+
+    private:
+        AttributeEncoder();
+    };
+}
@@ -2,10 +2,19 @@
 
 namespace Core {
 
+    /*
+     * Component format of a vertex attribute on the GPU. Attribute data is always supplied as
+     * Real; the compact formats are encoded on upload. Short, UnsignedShort and UnsignedByte are
+     * meant to be used normalized (snorm16, unorm16 and unorm8 respectively).
+     */
     enum class AttributeType {
         UnsignedInt = 0,
         Int = 1,
-        Float = 2
+        Float = 2,
+        HalfFloat = 3,
+        Short = 4,
+        UnsignedShort = 5,
+        UnsignedByte = 6
     };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../common/assert.h"
+#include "../common/types.h"
+
+namespace Core {
+
+    /*
+     * Non-owning, typed view over [count] attributes that start at [base] and are [stride]
+     * components apart. [T] is a VectorAccessor type; element access builds the accessor on the
+     * fly from the base pointer, so the view itself is just a pointer and two integers and can be
+     * passed by value into tight loops. A stride larger than T::ComponentCount lets the same view
+     * walk one attribute inside interleaved vertex data.
+     */
+    template <typename T>
+    class AttributeView {
+    public:
+        typedef typename T::ValueType ValueType;
+        typedef typename T::ComponentType ComponentType;
+
+        AttributeView(ComponentType* base, UInt32 count): AttributeView(base, count, T::ComponentCount) {}
+        AttributeView(ComponentType* base, UInt32 count, UInt32 stride): base(base), count(count), stride(stride) {}
+
+        T operator [](UInt32 index) const {
+            DEBUG_ASSERT(index < this->count, "AttributeView::operator[] -> 'index' is out of range.");
+            return T(this->base + index * this->stride);
+        }
+
+        ValueType get(UInt32 index) const {
+            return this->operator[](index).get();
+        }
+
+        void set(UInt32 index, const ValueType& value) const {
+            this->operator[](index).copy(value);
+        }
+
+        ComponentType* getData() const {
+            return this->base;
+        }
+
+        UInt32 size() const {
+            return this->count;
+        }
+
+        UInt32 getStride() const {
+            return this->stride;
+        }
+
+    private:
+        ComponentType* base;
+        UInt32 count;
+        UInt32 stride;
+    };
+}
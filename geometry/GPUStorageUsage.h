@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Core {
+
+    /*
+     * How often the contents of a GPU buffer are expected to change.
+     */
+    enum class GPUStorageUsage {
+        // written once (or rarely) and drawn many times
+        Static = 0,
+        // rewritten now and then, often only in part
+        Dynamic = 1,
+        // rewritten every frame
+        Stream = 2
+    };
+
+}
@@ -4,7 +4,7 @@
 
 namespace Core {
 
-    IndexBuffer::IndexBuffer(UInt32 size) : size(size) {
+    IndexBuffer::IndexBuffer(UInt32 size) : size(size), indexType(IndexType::UnsignedInt) {
         this->indices = new (std::nothrow) UInt32[size];
         if (this->indices == nullptr) {
             throw AllocationException("IndexBuffer::IndexBuffer() -> Unable to allocate indices.");
@@ -20,13 +20,27 @@ namespace Core {
 
     void IndexBuffer::setIndices(UInt32 * indices) {
         memcpy(this->indices, indices, sizeof(UInt32) * this->size);
+
+        UInt32 maxIndex = 0;
+        for (UInt32 i = 0; i < this->size; i++) {
+            if (indices[i] > maxIndex) maxIndex = indices[i];
+        }
+        this->indexType = maxIndex <= 0xFFFF ? IndexType::UnsignedShort : IndexType::UnsignedInt;
     }
 
     UInt32 IndexBuffer::getIndex(UInt32 offset) {
         return this->indices[offset];
     }
 
+    const UInt32* IndexBuffer::getIndices() const {
+        return this->indices;
+    }
+
     UInt32 IndexBuffer::getSize() {
         return this->size;
     }
+
+    IndexType IndexBuffer::getIndexType() const {
+        return this->indexType;
+    }
 }
\ No newline at end of file
@@ -4,6 +4,15 @@
 
 namespace Core {
 
+    enum class IndexType {
+        UnsignedShort = 0,
+        UnsignedInt = 1
+    };
+
+    /*
+     * Triangle indices for a mesh. Indices are always supplied as UInt32, but when every index
+     * fits in 16 bits the GPU copy uses 16-bit indices, halving its size.
+     */
     class IndexBuffer {
     public:
         IndexBuffer(UInt32 size);
@@ -12,11 +21,14 @@ namespace Core {
         virtual void initIndices() = 0;
         virtual void setIndices(UInt32 * indices);
         UInt32 getIndex(UInt32 offset);
+        const UInt32* getIndices() const;
         UInt32 getSize();
+        IndexType getIndexType() const;
 
     protected:
         UInt32 size;
         UInt32 *indices;
+        IndexType indexType;
     };
 
 }
@@ -0,0 +1,68 @@
+#include <string.h>
+
+#include "InterleavedAttributeBuffer.h"
+#include "../common/Exception.h"
+
+namespace Core {
+
+    InterleavedAttributeBuffer::InterleavedAttributeBuffer(UInt32 vertexCount, UInt32 stride, GPUStorageUsage usage) :
+        vertexCount(vertexCount), stride(stride), usage(usage), dirtyFirst(0), dirtyEnd(vertexCount) {
+        this->staging = new (std::nothrow) Byte[vertexCount * stride];
+        if (this->staging == nullptr) {
+            throw AllocationException("InterleavedAttributeBuffer::InterleavedAttributeBuffer() -> Unable to allocate staging data.");
+        }
+        memset(this->staging, 0, vertexCount * stride);
+    }
+
+    InterleavedAttributeBuffer::~InterleavedAttributeBuffer() {
+        if (this->staging) {
+            delete[] this->staging;
+            this->staging = nullptr;
+        }
+    }
+
+    /*
+     * Copy [vertexCount] tightly packed elements of [attributeSize] bytes from [data] into the
+     * attribute slot that starts [offset] bytes into each vertex.
+     */
+    void InterleavedAttributeBuffer::storeAttribute(const void* data, UInt32 offset, UInt32 attributeSize) {
+        this->storeAttribute(data, offset, attributeSize, 0, this->vertexCount);
+    }
+
+    /*
+     * Same as above, but only elements [first, first + count) of [data] are copied.
+     */
+    void InterleavedAttributeBuffer::storeAttribute(const void* data, UInt32 offset, UInt32 attributeSize, UInt32 first, UInt32 count) {
+        if (first >= this->vertexCount) return;
+        if (count > this->vertexCount - first) count = this->vertexCount - first;
+
+        const Byte* src = (const Byte*)data + first * attributeSize;
+        Byte* dest = this->staging + first * this->stride + offset;
+        for (UInt32 i = 0; i < count; i++) {
+            memcpy(dest, src, attributeSize);
+            src += attributeSize;
+            dest += this->stride;
+        }
+
+        if (this->dirtyEnd <= this->dirtyFirst) {
+            this->dirtyFirst = first;
+            this->dirtyEnd = first + count;
+        }
+        else {
+            if (first < this->dirtyFirst) this->dirtyFirst = first;
+            if (first + count > this->dirtyEnd) this->dirtyEnd = first + count;
+        }
+    }
+
+    UInt32 InterleavedAttributeBuffer::getVertexCount() const {
+        return this->vertexCount;
+    }
+
+    UInt32 InterleavedAttributeBuffer::getStride() const {
+        return this->stride;
+    }
+
+    GPUStorageUsage InterleavedAttributeBuffer::getUsage() const {
+        return this->usage;
+    }
+}
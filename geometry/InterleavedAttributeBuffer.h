@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../common/types.h"
+#include "GPUStorageUsage.h"
+
+namespace Core {
+
+    /*
+     * A single vertex buffer that holds several attributes side by side, one vertex after another
+     * ([stride] bytes per vertex). Attribute data arrives one attribute at a time (each is packed
+     * contiguously in its AttributeArray) and is scattered into a CPU-side staging copy of the
+     * interleaved layout. Implementations upload the dirty range of the staging copy the next
+     * time the buffer is used.
+     */
+    class InterleavedAttributeBuffer {
+    public:
+        InterleavedAttributeBuffer(UInt32 vertexCount, UInt32 stride, GPUStorageUsage usage);
+        virtual ~InterleavedAttributeBuffer();
+        virtual Int32 getBufferID() const = 0;
+        virtual void upload() = 0;
+
+        void storeAttribute(const void* data, UInt32 offset, UInt32 attributeSize);
+        void storeAttribute(const void* data, UInt32 offset, UInt32 attributeSize, UInt32 first, UInt32 count);
+        UInt32 getVertexCount() const;
+        UInt32 getStride() const;
+        GPUStorageUsage getUsage() const;
+
+    protected:
+        UInt32 vertexCount;
+        UInt32 stride;
+        GPUStorageUsage usage;
+        Byte* staging;
+        // vertices [dirtyFirst, dirtyEnd) have changed since the last upload
+        UInt32 dirtyFirst;
+        UInt32 dirtyEnd;
+    };
+
+}
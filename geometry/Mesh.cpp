@@ -1,3 +1,5 @@
+#include <functional>
+
 #include "Mesh.h"
 #include "../common/Exception.h"
 #include "../common/types.h"
@@ -7,11 +9,22 @@
 #include "IndexBuffer.h"
 #include "../math/Math.h"
 #include "../common/Constants.h"
+#include "../material/Material.h"
+#include "../Engine.h"
+#include "../util/ThreadPool.h"
+
+#if !defined(_Real_DoublePrecision_) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define CORE_MESH_SSE
+#include <xmmintrin.h>
+#endif
 
 namespace Core {
 
+    const UInt32 Mesh::NoCorner;
+    const UInt32 Mesh::ParallelChunkSize;
+    constexpr Real Mesh::VertexWeldTolerance;
+
     Mesh::Mesh(WeakPointer<Graphics> graphics, UInt32 vertexCount, UInt32 indexCount): graphics(graphics), vertexCount(vertexCount), indexCount(indexCount) {
-        this->vertexCrossMap = nullptr;
         this->initialized = false;
         this->indexed = indexCount > 0 ? true : false;
         this->enabledAttributes = StandardAttributes::createAttributeSet();
@@ -19,11 +32,19 @@ namespace Core {
         this->shoudCalculateNormals = false;
         this->shoudCalculateTangents = false;
         this->shouldCalculateBoundingBox = false;
+        this->uvDensity = -1.0f;
+        this->gpuStorageUsage = GPUStorageUsage::Static;
+        this->compressedAttributes = false;
+        this->interleavedAttributes = StandardAttributes::createAttributeSet();
+        for (UInt32 i = 0; i < (UInt32)StandardAttribute::_Count; i++) {
+            this->interleavedOffsets[i] = 0;
+        }
         initAttributes();
     }
 
     Mesh::~Mesh() {
         this->destroyVertexCrossMap();
+        if (this->graphics.isValid()) this->graphics->destroyVertexArrays(this);
     }
 
     void Mesh::init() {
@@ -31,6 +52,132 @@ namespace Core {
         initialized = true;
     }
 
+    /*
+     * Initialize the mesh for rendering with [targetMaterial]: the attributes that material's
+     * shader reads are packed into a single interleaved vertex buffer. This must happen before
+     * the vertex attributes themselves are initialized.
+     */
+    void Mesh::init(WeakPointer<Material> targetMaterial) {
+        this->init();
+        if (targetMaterial.isValid()) {
+            this->setInterleavedAttributes(targetMaterial->getConsumedAttributes());
+        }
+    }
+
+    /*
+     * Lay out [attributes] side by side in one vertex buffer, in StandardAttribute order. Vertex
+     * attributes initialized afterwards that are part of [attributes] store their data in that
+     * buffer; all others keep a buffer of their own. Interleaving fewer than two attributes
+     * gains nothing, so in that case every attribute keeps its own buffer.
+     */
+    void Mesh::setInterleavedAttributes(StandardAttributeSet attributes) {
+        // normals and averaged normals are always initialized together
+        if (StandardAttributes::hasAttribute(attributes, StandardAttribute::Normal) ||
+            StandardAttributes::hasAttribute(attributes, StandardAttribute::AveragedNormal)) {
+            StandardAttributes::addAttribute(&attributes, StandardAttribute::Normal);
+            StandardAttributes::addAttribute(&attributes, StandardAttribute::AveragedNormal);
+        }
+
+        UInt32 stride = 0;
+        UInt32 attributeCount = 0;
+        for (UInt32 i = 0; i < (UInt32)StandardAttribute::_Count; i++) {
+            StandardAttribute attribute = (StandardAttribute)i;
+            this->interleavedOffsets[i] = 0;
+            if (StandardAttributes::hasAttribute(attributes, attribute)) {
+                this->interleavedOffsets[i] = stride;
+                AttributeType gpuType = Mesh::getAttributeGPUType(attribute, this->compressedAttributes);
+                stride += Mesh::getAttributeComponentCount(attribute) * AttributeEncoder::getComponentSize(gpuType);
+                attributeCount++;
+            }
+        }
+
+        if (attributeCount < 2 || this->vertexCount == 0) {
+            this->interleavedBuffer = nullptr;
+            this->interleavedAttributes = StandardAttributes::createAttributeSet();
+            return;
+        }
+
+        this->interleavedAttributes = attributes;
+        this->interleavedBuffer = this->graphics->createInterleavedAttributeBuffer(this->vertexCount, stride, this->gpuStorageUsage);
+    }
+
+    /*
+     * Tell the mesh how often its vertex data will change, which decides how the GPU buffers
+     * are allocated and updated (see GPUStorageUsage). Like setInterleavedAttributes(), this
+     * only affects vertex attributes initialized afterwards. Meshes are Static by default.
+     */
+    void Mesh::setGPUStorageUsage(GPUStorageUsage usage) {
+        this->gpuStorageUsage = usage;
+        if (this->interleavedBuffer && this->interleavedBuffer->getUsage() != usage) {
+            this->setInterleavedAttributes(this->interleavedAttributes);
+        }
+    }
+
+    GPUStorageUsage Mesh::getGPUStorageUsage() const {
+        return this->gpuStorageUsage;
+    }
+
+    /*
+     * Store vertex attributes on the GPU in compact formats: snorm16 normals and tangents,
+     * half-float UVs and unorm8 colors. Positions stay full precision. The vertex fetch hardware
+     * expands these back to floats, so shaders are unaffected. Vertex colors are clamped to
+     * [0, 1]. Like setGPUStorageUsage(), this only affects attributes initialized afterwards.
+     * Graphics that cannot fetch the compact formats keep full precision.
+     */
+    void Mesh::setCompressedAttributes(Bool compressed) {
+        if (compressed && !this->graphics->areCompactAttributesSupported()) compressed = false;
+        if (this->compressedAttributes == compressed) return;
+        this->compressedAttributes = compressed;
+        if (this->interleavedBuffer) {
+            this->setInterleavedAttributes(this->interleavedAttributes);
+        }
+    }
+
+    Bool Mesh::hasCompressedAttributes() const {
+        return this->compressedAttributes;
+    }
+
+    AttributeType Mesh::getAttributeGPUType(StandardAttribute attribute, Bool compressed) {
+        if (!compressed) return AttributeType::Float;
+        switch (attribute) {
+            case StandardAttribute::Color:
+                return AttributeType::UnsignedByte;
+            case StandardAttribute::AlbedoUV:
+            case StandardAttribute::NormalUV:
+                return AttributeType::HalfFloat;
+            case StandardAttribute::Normal:
+            case StandardAttribute::AveragedNormal:
+            case StandardAttribute::Tangent:
+            case StandardAttribute::FaceNormal:
+                return AttributeType::Short;
+            default:
+                return AttributeType::Float;
+        }
+    }
+
+    Bool Mesh::isInterleaved() const {
+        return this->interleavedBuffer != nullptr;
+    }
+
+    UInt32 Mesh::getAttributeComponentCount(StandardAttribute attribute) {
+        switch (attribute) {
+            case StandardAttribute::Position:
+                return Point3rs::ComponentCount;
+            case StandardAttribute::Color:
+                return ColorS::ComponentCount;
+            case StandardAttribute::AlbedoUV:
+            case StandardAttribute::NormalUV:
+                return Vector2rs::ComponentCount;
+            case StandardAttribute::Normal:
+            case StandardAttribute::AveragedNormal:
+            case StandardAttribute::Tangent:
+            case StandardAttribute::FaceNormal:
+                return Vector3rs::ComponentCount;
+            default:
+                return 0;
+        }
+    }
+
     UInt32 Mesh::getVertexCount() const {
         return this->vertexCount;
     }
@@ -80,10 +227,9 @@ namespace Core {
         WeakPointer<AttributeArray<Point3rs>> vertexPositions = this->vertexPositions;
 
         if (vertexPositions && this->isAttributeEnabled(StandardAttribute::Position)) {
-            UInt32 pointCount = vertexPositions->getAttributeCount();
-            Point3rs * pos = vertexPositions->getAttributes();
-            for (UInt32 i = 0; i < pointCount; i++) {
-                Point3rs& position = *pos;
+            AttributeView<Point3rs> positions = vertexPositions->getView();
+            for (UInt32 i = 0; i < positions.size(); i++) {
+                Point3r position = positions.get(i);
                 if (i == 0 || position.x < min.x) min.x = position.x;
                 if (i == 0 || position.y < min.y) min.y = position.y;
                 if (i == 0 || position.z < min.z) min.z = position.z;
@@ -91,7 +237,6 @@ namespace Core {
                 if (i == 0 || position.x > max.x) max.x = position.x;
                 if (i == 0 || position.y > max.y) max.y = position.y;
                 if (i == 0 || position.z > max.z) max.z = position.z;
-                pos++;
             }
         }
 
@@ -103,6 +248,52 @@ namespace Core {
         return this->boundingBox;
     }
 
+    /*
+     * Average number of object-space units one unit of albedo UV space covers, i.e. the square root of
+     * the mesh's surface area over its UV area. Texture streaming uses it to find the mip level a texture
+     * on this mesh needs at a given size on screen. Calculated on first use after update().
+     */
+    Real Mesh::getUVDensity() {
+        if (this->uvDensity < 0.0f) this->uvDensity = this->calculateUVDensity();
+        return this->uvDensity;
+    }
+
+    Real Mesh::calculateUVDensity() const {
+        if (!this->vertexPositions || !this->vertexAlbedoUVs) return 0.0f;
+
+        const UInt32* indices = this->indexed && this->indexBuffer ? this->indexBuffer->getIndices() : nullptr;
+        UInt32 cornerCount = indices ? this->indexCount : this->vertexCount;
+        const Real* positions = this->vertexPositions->getStorage();
+        const Real* uvs = this->vertexAlbedoUVs->getStorage();
+        const UInt32 positionStride = Point3rs::ComponentCount;
+        const UInt32 uvStride = Vector2rs::ComponentCount;
+
+        Real surfaceArea = 0.0f;
+        Real uvArea = 0.0f;
+        for (UInt32 c = 0; c + 2 < cornerCount; c += 3) {
+            UInt32 v0 = indices ? indices[c] : c;
+            UInt32 v1 = indices ? indices[c + 1] : c + 1;
+            UInt32 v2 = indices ? indices[c + 2] : c + 2;
+
+            const Real* p0 = positions + v0 * positionStride;
+            const Real* p1 = positions + v1 * positionStride;
+            const Real* p2 = positions + v2 * positionStride;
+            Vector3r e1(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+            Vector3r e2(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
+            Vector3r cross;
+            Vector3r::cross(e1, e2, cross);
+            surfaceArea += cross.magnitude() * 0.5f;
+
+            const Real* uv0 = uvs + v0 * uvStride;
+            const Real* uv1 = uvs + v1 * uvStride;
+            const Real* uv2 = uvs + v2 * uvStride;
+            uvArea += Math::abs((uv1[0] - uv0[0]) * (uv2[1] - uv0[1]) - (uv2[0] - uv0[0]) * (uv1[1] - uv0[1])) * 0.5f;
+        }
+
+        if (uvArea <= 0.0f) return 0.0f;
+        return Math::squareRoot(surfaceArea / uvArea);
+    }
+
     WeakPointer<AttributeArray<Point3rs>> Mesh::getVertexPositions() {
         return this->vertexPositions;
     }
@@ -136,34 +327,34 @@ namespace Core {
     }
 
     Bool Mesh::initVertexPositions() {
-        return this->initVertexAttributes<Point3rs>(&this->vertexPositions, this->vertexCount);
+        return this->initVertexAttributes<Point3rs>(&this->vertexPositions, this->vertexCount, StandardAttribute::Position);
     }
 
     Bool Mesh::initVertexNormals() {
         Bool result = true;
-        result = this->initVertexAttributes<Vector3rs>(&this->vertexNormals, this->vertexCount);
-        result = result && this->initVertexAttributes<Vector3rs>(&this->vertexAveragedNormals, this->vertexCount);
+        result = this->initVertexAttributes<Vector3rs>(&this->vertexNormals, this->vertexCount, StandardAttribute::Normal);
+        result = result && this->initVertexAttributes<Vector3rs>(&this->vertexAveragedNormals, this->vertexCount, StandardAttribute::AveragedNormal);
         return result;
     }
 
     Bool Mesh::initVertexFaceNormals() {
-        return this->initVertexAttributes<Vector3rs>(&this->vertexFaceNormals, this->vertexCount);
+        return this->initVertexAttributes<Vector3rs>(&this->vertexFaceNormals, this->vertexCount, StandardAttribute::FaceNormal);
     }
 
     Bool Mesh::initVertexTangents() {
-        return this->initVertexAttributes<Vector3rs>(&this->vertexTangents, this->vertexCount);
+        return this->initVertexAttributes<Vector3rs>(&this->vertexTangents, this->vertexCount, StandardAttribute::Tangent);
     }
 
     Bool Mesh::initVertexColors() {
-        return this->initVertexAttributes<ColorS>(&this->vertexColors, this->vertexCount);
+        return this->initVertexAttributes<ColorS>(&this->vertexColors, this->vertexCount, StandardAttribute::Color);
     }
 
     Bool Mesh::initVertexAlbedoUVs() {
-        return this->initVertexAttributes<Vector2rs>(&this->vertexAlbedoUVs, this->vertexCount);
+        return this->initVertexAttributes<Vector2rs>(&this->vertexAlbedoUVs, this->vertexCount, StandardAttribute::AlbedoUV);
     }
 
     Bool Mesh::initVertexNormalUVs() {
-        return this->initVertexAttributes<Vector2rs>(&this->vertexNormalUVs, this->vertexCount);
+        return this->initVertexAttributes<Vector2rs>(&this->vertexNormalUVs, this->vertexCount, StandardAttribute::NormalUV);
     }
 
     Bool Mesh::initIndices() {
@@ -176,6 +367,7 @@ namespace Core {
     }
 
     void Mesh::update() {
+        this->uvDensity = -1.0f;
         if (this->shouldCalculateBoundingBox) this->calculateBoundingBox();
         if (this->shoudCalculateNormals){
             this->calculateNormals((Real)this->normalsSmoothingThreshold);
@@ -187,6 +379,53 @@ namespace Core {
 
     }
 
+    /*
+     * Do the CPU side of update(): calculate the bounding box, normals and tangents as
+     * configured, without sending anything to the GPU. This only touches the mesh's own
+     * vertex data, so meshes can be processed concurrently, e.g. during model import.
+     * Follow up with updateGPUStorage() on the graphics thread.
+     */
+    void Mesh::generateAttributes() {
+        this->uvDensity = -1.0f;
+        if (this->shouldCalculateBoundingBox) this->calculateBoundingBox();
+        if (this->shoudCalculateNormals) {
+            this->generateNormals((Real)this->normalsSmoothingThreshold);
+        }
+        if (this->shoudCalculateTangents) {
+            this->generateTangents((Real)this->normalsSmoothingThreshold);
+        }
+    }
+
+    /*
+     * Send every initialized vertex attribute array to the GPU.
+     */
+    void Mesh::updateGPUStorage() {
+        if (this->vertexPositions) this->vertexPositions->updateGPUStorageData();
+        if (this->vertexNormals) this->vertexNormals->updateGPUStorageData();
+        if (this->vertexAveragedNormals) this->vertexAveragedNormals->updateGPUStorageData();
+        if (this->vertexFaceNormals) this->vertexFaceNormals->updateGPUStorageData();
+        if (this->vertexTangents) this->vertexTangents->updateGPUStorageData();
+        if (this->vertexColors) this->vertexColors->updateGPUStorageData();
+        if (this->vertexAlbedoUVs) this->vertexAlbedoUVs->updateGPUStorageData();
+        if (this->vertexNormalUVs) this->vertexNormalUVs->updateGPUStorageData();
+    }
+
+    /*
+     * Number of bytes updateGPUStorage() sends to the GPU.
+     */
+    UInt64 Mesh::getGPUStorageSize() const {
+        UInt64 size = 0;
+        if (this->vertexPositions) size += this->vertexPositions->getSize();
+        if (this->vertexNormals) size += this->vertexNormals->getSize();
+        if (this->vertexAveragedNormals) size += this->vertexAveragedNormals->getSize();
+        if (this->vertexFaceNormals) size += this->vertexFaceNormals->getSize();
+        if (this->vertexTangents) size += this->vertexTangents->getSize();
+        if (this->vertexColors) size += this->vertexColors->getSize();
+        if (this->vertexAlbedoUVs) size += this->vertexAlbedoUVs->getSize();
+        if (this->vertexNormalUVs) size += this->vertexNormalUVs->getSize();
+        return size;
+    }
+
     void Mesh::reverseVertexAttributeWindingOrder() {
         UInt32 realVertexCount = this->vertexCount;
         WeakPointer<IndexBuffer> indices;
@@ -205,29 +444,29 @@ namespace Core {
 
             }
             else {
-                Point3rs& p2 = vertexPositions->getAttribute(i + 1);
-                Point3rs& p3 = vertexPositions->getAttribute(i + 2);
+                Point3rs p2 = vertexPositions->getAttribute(i + 1);
+                Point3rs p3 = vertexPositions->getAttribute(i + 2);
 
                 Point3r temp = p2;
                 p2 = p3;
                 p3 = temp;
 
-                Vector3rs& n2 = vertexNormals->getAttribute(i + 1);
-                Vector3rs& n3 = vertexNormals->getAttribute(i + 2);
+                Vector3rs n2 = vertexNormals->getAttribute(i + 1);
+                Vector3rs n3 = vertexNormals->getAttribute(i + 2);
 
                 Vector3r tempV = n2;
                 n2 = n3;
                 n3 = tempV;
 
-                Vector3rs& an2 = vertexAveragedNormals->getAttribute(i + 1);
-                Vector3rs& an3 = vertexAveragedNormals->getAttribute(i + 2);
+                Vector3rs an2 = vertexAveragedNormals->getAttribute(i + 1);
+                Vector3rs an3 = vertexAveragedNormals->getAttribute(i + 2);
 
                 tempV = an2;
                 an2 = an3;
                 an3 = tempV;
 
-                Vector3rs& fn2 = vertexFaceNormals->getAttribute(i + 1);
-                Vector3rs& fn3 = vertexFaceNormals->getAttribute(i + 2);
+                Vector3rs fn2 = vertexFaceNormals->getAttribute(i + 1);
+                Vector3rs fn3 = vertexFaceNormals->getAttribute(i + 2);
 
                 tempV = fn2;
                 fn2 = fn3;
@@ -260,218 +499,182 @@ namespace Core {
         this->normalsSmoothingThreshold = threshold;
     }
 
+    /*
+     * Run [func] over [0, count) in chunks of [chunkSize], spread over the engine's thread pool
+     * when there is enough work to be worth it.
+     */
+    static void forEachChunk(UInt32 count, UInt32 chunkSize, const std::function<void(UInt32, UInt32)>& func) {
+        if (count <= chunkSize) {
+            if (count > 0) func(0, count);
+            return;
+        }
+        UInt32 chunkCount = (count + chunkSize - 1) / chunkSize;
+        Engine::instance()->getThreadPool().parallelFor(chunkCount, [count, chunkSize, &func](UInt32 chunk) {
+            UInt32 start = chunk * chunkSize;
+            UInt32 end = count - start < chunkSize ? count : start + chunkSize;
+            func(start, end);
+        });
+    }
+
     /*
     * Calculate vertex normals using the two incident edges to calculate the
     * cross product. For all triangles that share a given vertex,the method will
     * calculate the average normal for that vertex as long as the angle between
     * the un-averaged normals is less than [smoothingThreshhold]. [smoothingThreshhold]
     * is specified in radians.
+    *
+    * Where a vertex is shared by several triangles (indexed meshes), the result computed for
+    * the last corner that references it is the one that is kept.
     */
     void Mesh::calculateNormals(Real smoothingThreshhold) {
         if (!StandardAttributes::hasAttribute(this->enabledAttributes, StandardAttribute::Normal))return;
+        this->generateNormals(smoothingThreshhold);
+        this->vertexNormals->updateGPUStorageData();
+        this->vertexAveragedNormals->updateGPUStorageData();
+        this->vertexFaceNormals->updateGPUStorageData();
+    }
+
+    void Mesh::generateNormals(Real smoothingThreshhold) {
+        if (!StandardAttributes::hasAttribute(this->enabledAttributes, StandardAttribute::Normal))return;
 
-        if (this->vertexCrossMap == nullptr) {
+        if (!this->vertexCrossMap.isBuilt()) {
             this->buildVertexCrossMap();
         }
 
-        UInt32 realVertexCount = this->vertexCount;
-        WeakPointer<IndexBuffer> indices;
-        if (this->indexed) {
-            indices = this->getIndexBuffer();
-            realVertexCount = this->indexCount;
-        }
+        UInt32 cornerCount = this->indexed ? this->indexCount : this->vertexCount;
+        Mesh::generateNormals(this->vertexPositions->getStorage(), this->getCornerIndices(), this->vertexCount, cornerCount, this->vertexCrossMap,
+                              smoothingThreshhold, this->vertexNormals->getView(), this->vertexAveragedNormals->getView(),
+                              this->vertexFaceNormals->getView());
+    }
 
-        WeakPointer<AttributeArray<Vector3rs>> vertexNormals = this->vertexNormals;
-        WeakPointer<AttributeArray<Vector3rs>> vertexAveragedNormals = this->vertexAveragedNormals;
-        WeakPointer<AttributeArray<Vector3rs>> vertexFaceNormals = this->vertexFaceNormals;
-     
-        // loop through each triangle in this mesh's vertices
-        // and calculate normals for each
-        for (UInt32 v = 0; v < realVertexCount - 2; v += 3) {
-            Vector3r normal;
-            this->calculateFaceNormal(v, normal);
-
-            UInt32 mappedIndex1 = v;
-            UInt32 mappedIndex2 = v + 1;
-            UInt32 mappedIndex3 = v + 2;
-            if (this->indexed) {
-                mappedIndex1 = indices->getIndex(mappedIndex1);
-                mappedIndex2 = indices->getIndex(mappedIndex2);
-                mappedIndex3 = indices->getIndex(mappedIndex3);
+    /*
+     * Same as generateNormals(Real), for vertex data that does not belong to a mesh: [vertexCount] vertices
+     * at [positions], triangles described by [cornerCount] corners in [indices] (or by the vertices in order
+     * if [indices] is null) and [crossMap] built for those corners (see buildVertexCrossMap()).
+     */
+    void Mesh::generateNormals(const Real* positions, const UInt32* indices, UInt32 vertexCount, UInt32 cornerCount, const VertexCrossMap& crossMap,
+                               Real smoothingThreshhold, AttributeView<Vector3rs> normals, AttributeView<Vector3rs> averagedNormals,
+                               AttributeView<Vector3rs> faceNormals) {
+        UInt32 triangleCount = cornerCount / 3;
+        if (triangleCount == 0) return;
+        cornerCount = triangleCount * 3;
+
+        // normalized normal of every triangle
+        std::vector<Vector3r> triangleNormals(triangleCount);
+        forEachChunk(triangleCount, Mesh::ParallelChunkSize, [positions, indices, &triangleNormals](UInt32 start, UInt32 end) {
+            Mesh::calculateFaceNormals(positions, indices, start, end, triangleNormals.data());
+        });
+
+        // the average of all face normals that meet at a position does not depend on the corner,
+        // so it is computed once per group
+        std::vector<Vector3r> groupAverages(crossMap.getGroupCount());
+        forEachChunk(crossMap.getGroupCount(), Mesh::ParallelChunkSize, [&crossMap, &triangleNormals, &groupAverages](UInt32 start, UInt32 end) {
+            for (UInt32 g = start; g < end; g++) {
+                const UInt32* corners = crossMap.getGroupCorners(g);
+                UInt32 groupSize = crossMap.getGroupSize(g);
+                Vector3r fullAvg(0, 0, 0);
+                for (UInt32 i = 0; i < groupSize; i++) {
+                    const Vector3r& current = triangleNormals[corners[i] / 3];
+                    fullAvg.x += current.x;
+                    fullAvg.y += current.y;
+                    fullAvg.z += current.z;
+                }
+                fullAvg.scale((Real)1.0 / (Real)groupSize);
+                groupAverages[g] = fullAvg;
             }
+        });
 
-            vertexNormals->getAttribute(mappedIndex1).copy(normal);
-            vertexNormals->getAttribute(mappedIndex2).copy(normal);
-            vertexNormals->getAttribute(mappedIndex3).copy(normal);
-
-            this->vertexAveragedNormals->getAttribute(mappedIndex1).copy(normal);
-            this->vertexAveragedNormals->getAttribute(mappedIndex2).copy(normal);
-            this->vertexAveragedNormals->getAttribute(mappedIndex3).copy(normal);
-
-            vertexFaceNormals->getAttribute(mappedIndex1).copy(normal);
-            vertexFaceNormals->getAttribute(mappedIndex2).copy(normal);
-            vertexFaceNormals->getAttribute(mappedIndex3).copy(normal);
-        }
-
-        // This vector is used to store the calculated average normal for all equal vertices
-        // whose normals differ by an angle that is less than 'smoothingThreshhold'
-        std::vector<Vector3r> averageNormals;
-
-        // This vector is used to store the calculated average normal for all equal vertices
-        std::vector<Vector3r> fullAverageNormals;
+        std::vector<UInt32> vertexCorners;
+        Mesh::getLastCorners(indices, cornerCount, vertexCount, vertexCorners);
 
         // compute the cosine of the smoothing threshhold angle
         Real cosSmoothingThreshhold = (Math::cos(smoothingThreshhold));
 
-        // loop through each vertex and lookup the associated list of
-        // normals associated with that vertex, and then calculate the
-        // average normal from that list.
-        for (UInt32 v = 0; v < realVertexCount; v++) {
-
-            UInt32 mappedIndex = v;
-            if (this->indexed) {
-                mappedIndex = indices->getIndex(mappedIndex);
-            }
-
-            // get existing normal for this vertex
-            Vector3r oNormal;
-            oNormal = vertexFaceNormals->getAttribute(mappedIndex);
-            oNormal.normalize();
-
-            // retrieve the list of equal vertices for vertex [v]
-            std::vector<UInt32>* listPtr = vertexCrossMap[v];
-            if (listPtr == nullptr) {
-                throw Exception("Mesh::calculateNormals -> Null pointer to vertex group list.");
-            }
-
-            Vector3r avg(0, 0, 0);
-            Real divisor = 0;
-            Vector3r fullAvg(0, 0, 0);
-            Real fullDivisor = 0;
-
-            std::vector<UInt32>& list = *listPtr;
-
-            for (UInt32 i = 0; i < list.size(); i++) {
-                UInt32 vIndex = list[i];
-
-                UInt32 mappedSubIndex = vIndex;
-                if (this->indexed) {
-                    mappedSubIndex = indices->getIndex(mappedSubIndex);
+        forEachChunk(vertexCount, Mesh::ParallelChunkSize,
+                     [&](UInt32 start, UInt32 end) {
+            for (UInt32 vertex = start; vertex < end; vertex++) {
+                UInt32 v = vertexCorners[vertex];
+                if (v == Mesh::NoCorner) continue;
+
+                // get existing normal for this vertex
+                const Vector3r& oNormal = triangleNormals[v / 3];
+
+                UInt32 group = crossMap.getGroup(v);
+                const UInt32* corners = crossMap.getGroupCorners(group);
+                UInt32 groupSize = crossMap.getGroupSize(group);
+
+                Vector3r avg(0, 0, 0);
+                Real divisor = 0;
+                for (UInt32 i = 0; i < groupSize; i++) {
+                    const Vector3r& current = triangleNormals[corners[i] / 3];
+
+                    // calculate angle between the normal that exists for this vertex,
+                    // and the current normal in the list.
+                    Real dot = Vector3r::dot(current, oNormal);
+                    if (dot > cosSmoothingThreshhold) {
+                        avg.x += current.x;
+                        avg.y += current.y;
+                        avg.z += current.z;
+                        divisor++;
+                    }
                 }
 
-                Vector3r current = vertexFaceNormals->getAttribute(mappedSubIndex);
-                current.normalize();
-
-                // calculate angle between the normal that exists for this vertex,
-                // and the current normal in the list.
-                Real dot = Vector3r::dot(current, oNormal);
-
-                if (dot > cosSmoothingThreshhold) {
-                    avg.x += current.x;
-                    avg.y += current.y;
-                    avg.z += current.z;
-                    divisor++;
+                // if divisor <= 1, then no valid normals were found to include in the average,
+                // so just use the existing one
+                if (divisor <= 1) {
+                    avg = oNormal;
                 }
-                fullAvg.x += current.x;
-                fullAvg.y += current.y;
-                fullAvg.z += current.z;
-                fullDivisor++;
-            }
-
-            // if divisor <= 1, then no valid normals were found to include in the average,
-            // so just use the existing one
-            if (divisor <= 1) {
-                avg.x = oNormal.x;
-                avg.y = oNormal.y;
-                avg.z = oNormal.z;
-            }
-            else {
-                Real scaleFactor = (Real)1.0 / divisor;
-                avg.scale(scaleFactor);
-            }
-            averageNormals.push_back(avg);
-
-            // if fullDivisor <= 1, then no valid normals were found to include in the average,
-            // so just use the existing one
-            if (fullDivisor <= 1) {
-                fullAvg.x = oNormal.x;
-                fullAvg.y = oNormal.y;
-                fullAvg.z = oNormal.z;
-            }
-            else {
-                Real scaleFactor = (Real)1.0 / fullDivisor;
-                fullAvg.scale(scaleFactor);
-            }
+                else {
+                    avg.scale((Real)1.0 / divisor);
+                }
+                avg.normalize();
 
-            fullAverageNormals.push_back(fullAvg);
-        }
+                Vector3r fullAvg = groupSize <= 1 ? oNormal : groupAverages[group];
+                fullAvg.normalize();
 
-        // loop through each vertex and assign the average normal
-        // calculated for that vertex
-        for (UInt32 v = 0; v < realVertexCount; v++) {
-            Vector3r avg = averageNormals[v];
-            avg.normalize();
-            Vector3r fullAvg = fullAverageNormals[v];
-            fullAvg.normalize();
-            
-            UInt32 mappedIndex = v;
-            if (this->indexed) {
-                mappedIndex = indices->getIndex(mappedIndex);
+                normals.set(vertex, avg);
+                averagedNormals.set(vertex, fullAvg);
+                faceNormals.set(vertex, oNormal);
             }
-
-            // set the normal for this vertex to the averaged normal
-            vertexNormals->getAttribute(mappedIndex).copy(avg);
-            vertexAveragedNormals->getAttribute(mappedIndex).copy(fullAvg);
-        }
+        });
 
         //if (invertNormals)InvertNormals(); 
-
-        vertexNormals->updateGPUStorageData();
-        vertexAveragedNormals->updateGPUStorageData();
-        vertexFaceNormals->updateGPUStorageData();
     }
 
     /*
-     * For a given face in the sub-mesh specified by [faceVertexIndex], calculate the face's
-     * normal and store the result in [result]. [faceVertexIndex] will be the index of the
-     * face's first vertex in [vertexPositions], the next two will be at [faceVertexIndex] + 1,
-     * and [faceVertexIndex] + 2.
+     * Calculate the normalized normal of triangles [start, end) into [result], indexed by
+     * triangle. The corners of triangle t are [indices][t * 3 .. t * 3 + 2], or vertices
+     * t * 3 .. t * 3 + 2 when [indices] is null.
      */
-    void Mesh::calculateFaceNormal(UInt32 faceVertexIndex, Vector3r& result) {
-        UInt32 realVertexCount = this->vertexCount;
-        WeakPointer<IndexBuffer> indices;
-        if (this->indexed) {
-            indices = this->getIndexBuffer();
-            realVertexCount = this->indexCount;
-        }
-        if (faceVertexIndex >= realVertexCount - 2) {
-            throw Exception("Mesh::calculateFaceNormal -> 'faceIndex' is out range.");
-        }
-
-        UInt32 mappedFaceIndex1 = faceVertexIndex;
-        UInt32 mappedFaceIndex2 = faceVertexIndex + 1;
-        UInt32 mappedFaceIndex3 = faceVertexIndex + 2;
-        if (this->indexed) {
-            mappedFaceIndex1 = indices->getIndex(mappedFaceIndex1);
-            mappedFaceIndex2 = indices->getIndex(mappedFaceIndex2);
-            mappedFaceIndex3 = indices->getIndex(mappedFaceIndex3);
+    void Mesh::calculateFaceNormals(const Real* positions, const UInt32* indices, UInt32 start, UInt32 end, Vector3r* result) {
+        const UInt32 stride = Point3rs::ComponentCount;
+        for (UInt32 t = start; t < end; t++) {
+            UInt32 i1 = indices ? indices[t * 3] : t * 3;
+            UInt32 i2 = indices ? indices[t * 3 + 1] : t * 3 + 1;
+            UInt32 i3 = indices ? indices[t * 3 + 2] : t * 3 + 2;
+            const Real* p1 = positions + i1 * stride;
+            const Real* p2 = positions + i2 * stride;
+            const Real* p3 = positions + i3 * stride;
+            Vector3r& normal = result[t];
+
+#if defined(CORE_MESH_SSE)
+            __m128 v1 = _mm_loadu_ps(p1);
+            // form 2 vectors based on triangle's vertices
+            __m128 a = _mm_sub_ps(_mm_loadu_ps(p3), v1);
+            __m128 b = _mm_sub_ps(_mm_loadu_ps(p2), v1);
+            // cross product: (a * b.yzx - a.yzx * b).yzx
+            __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+            _mm_storeu_ps(normal.data, _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+            normal.data[3] = 0.0f;
+#else
+            Vector3r a(p3[0] - p1[0], p3[1] - p1[1], p3[2] - p1[2]);
+            Vector3r b(p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2]);
+            Vector3r::cross(a, b, normal);
+#endif
+            normal.normalize();
         }
-     
-        Vector3r a, b;
-
-        WeakPointer<AttributeArray<Point3rs>> positions = this->vertexPositions;
-       
-        Point3r p1 = positions->getAttribute(mappedFaceIndex1);
-        Point3r p2 = positions->getAttribute(mappedFaceIndex2);
-        Point3r p3 = positions->getAttribute(mappedFaceIndex3);
-
-        // form 2 vectors based on triangle's vertices
-        a = p3 - p1;
-        b = p2 - p1;
-
-        // calculate cross product
-        Vector3r::cross(a, b, result);
-        result.normalize();
     }
 
      /*
@@ -483,105 +686,120 @@ namespace Core {
     */
     void Mesh::calculateTangents(Real smoothingThreshhold) {
         if (!StandardAttributes::hasAttribute(this->enabledAttributes, StandardAttribute::Tangent)) return;
-
-        WeakPointer<AttributeArray<Vector3rs>> tangents = this->getVertexTangents();
-        WeakPointer<AttributeArray<Vector3rs>> faceNormals = this->getVertexFaceNormals();
-
-        // loop through each triangle in this mesh's vertices
-        // and calculate tangents for each
-        for (UInt32 v = 0; v < this->vertexCount - 2; v += 3) {
-            Vector3r t0, t1, t2;
-
-            this->calculateTangent(v, v + 2, v + 1, t0);
-            this->calculateTangent(v + 1, v, v + 2, t1);
-            this->calculateTangent(v + 2, v + 1, v, t2);
-
-            tangents->getAttribute(v).copy(t0);
-            tangents->getAttribute(v + 1).copy(t1);
-            tangents->getAttribute(v + 2).copy(t2);
+        if (this->generateTangents(smoothingThreshhold)) {
+            this->vertexTangents->updateGPUStorageData();
         }
+    }
 
-        // This vector is used to store the calculated average tangent for all equal vertices
-        std::vector<Vector3r> averageTangents;
-
-        // loop through each vertex and lookup the associated list of
-        // tangents associated with that vertex, and then calculate the
-        // average tangents from that list.
-        for (UInt32 v = 0; v < this->vertexCount; v++) {
-            // get existing normal for this vertex
-            Vector3r oNormal;
-            oNormal = faceNormals->getAttribute(v);
-            oNormal.normalize();
-
-            Vector3r oTangent;
-            oTangent = vertexTangents->getAttribute(v);
-            oTangent.normalize();
-
-            // retrieve the list of equal vertices for vertex [v]
-            std::vector<UInt32>* listPtr = vertexCrossMap[v];
-            if (listPtr == nullptr) {
-                throw Exception("Mesh::calculateTangents -> Null pointer to vertex group list.");
-            }
+    Bool Mesh::generateTangents(Real smoothingThreshhold) {
+        if (!StandardAttributes::hasAttribute(this->enabledAttributes, StandardAttribute::Tangent)) return false;
 
-            Vector3r avg(0, 0, 0);
-            Real divisor = 0;
+        // if the mesh doesn't have UVs dedicated for normal mapping, use the albedo UVs as a backup
+        WeakPointer<AttributeArray<Vector2rs>> sourceUVs = this->getVertexNormalUVs();
+        if (!sourceUVs) sourceUVs = this->getVertexAlbedoUVs();
+        if (!sourceUVs) return false;
 
-            std::vector<UInt32>& list = *listPtr;
+        if (!this->vertexCrossMap.isBuilt()) {
+            this->buildVertexCrossMap();
+        }
 
-            // compute the cosine of the smoothing threshhold angle
-            Real cosSmoothingThreshhold = (Math::cos(Math::DegreesToRads * smoothingThreshhold));
+        UInt32 cornerCount = this->indexed ? this->indexCount : this->vertexCount;
+        return Mesh::generateTangents(this->vertexPositions->getStorage(), sourceUVs->getStorage(), this->getCornerIndices(), this->vertexCount,
+                                      cornerCount, this->vertexCrossMap, smoothingThreshhold, this->getVertexTangents()->getView());
+    }
 
-            for (UInt32 i = 0; i < list.size(); i++) {
-                UInt32 vIndex = list[i];
-                Vector3rs& current = faceNormals->getAttribute(vIndex);
-                current.normalize();
+    /*
+     * Same as generateTangents(Real), for vertex data that does not belong to a mesh (see the static
+     * generateNormals()). [uvs] are the texture coordinates the tangents follow.
+     */
+    Bool Mesh::generateTangents(const Real* positions, const Real* uvs, const UInt32* indices, UInt32 vertexCount, UInt32 cornerCount,
+                                const VertexCrossMap& crossMap, Real smoothingThreshhold, AttributeView<Vector3rs> tangents) {
+        UInt32 triangleCount = cornerCount / 3;
+        if (triangleCount == 0) return false;
+        cornerCount = triangleCount * 3;
+
+        // normalized normal of every triangle; like generateNormals(), the smoothing test compares
+        // the normals of the triangles a corner belongs to, not the normals stored per vertex, which
+        // an indexed mesh shares between triangles
+        std::vector<Vector3r> triangleNormals(triangleCount);
+        forEachChunk(triangleCount, Mesh::ParallelChunkSize, [positions, indices, &triangleNormals](UInt32 start, UInt32 end) {
+            Mesh::calculateFaceNormals(positions, indices, start, end, triangleNormals.data());
+        });
+
+        // un-averaged tangent of every corner
+        std::vector<Vector3r> cornerTangents(cornerCount);
+        forEachChunk(triangleCount, Mesh::ParallelChunkSize, [&](UInt32 start, UInt32 end) {
+            for (UInt32 t = start; t < end; t++) {
+                UInt32 c = t * 3;
+                UInt32 v0 = indices ? indices[c] : c;
+                UInt32 v1 = indices ? indices[c + 1] : c + 1;
+                UInt32 v2 = indices ? indices[c + 2] : c + 2;
+                Mesh::calculateTangent(positions, uvs, v0, v2, v1, cornerTangents[c]);
+                Mesh::calculateTangent(positions, uvs, v1, v0, v2, cornerTangents[c + 1]);
+                Mesh::calculateTangent(positions, uvs, v2, v1, v0, cornerTangents[c + 2]);
+            }
+        });
 
-                // calculate angle between the normal that exists for this vertex,
-                // and the current normal in the list.
-                Real dot = Vector3r::dot(current, oNormal);
+        std::vector<UInt32> vertexCorners;
+        Mesh::getLastCorners(indices, cornerCount, vertexCount, vertexCorners);
 
-                if (dot > cosSmoothingThreshhold) {
-                    Vector3rs& tangent = tangents->getAttribute(vIndex);
-                    avg.x += tangent.x;
-                    avg.y += tangent.y;
-                    avg.z += tangent.z;
-                    divisor++;
+        // compute the cosine of the smoothing threshhold angle
+        Real cosSmoothingThreshhold = (Math::cos(Math::DegreesToRads * smoothingThreshhold));
+
+        forEachChunk(vertexCount, Mesh::ParallelChunkSize, [&](UInt32 start, UInt32 end) {
+            for (UInt32 vertex = start; vertex < end; vertex++) {
+                UInt32 v = vertexCorners[vertex];
+                if (v == Mesh::NoCorner) continue;
+
+                // get existing normal for this vertex
+                const Vector3r& oNormal = triangleNormals[v / 3];
+
+                Vector3r oTangent = cornerTangents[v];
+                oTangent.normalize();
+
+                UInt32 group = crossMap.getGroup(v);
+                const UInt32* corners = crossMap.getGroupCorners(group);
+                UInt32 groupSize = crossMap.getGroupSize(group);
+
+                Vector3r avg(0, 0, 0);
+                Real divisor = 0;
+                for (UInt32 i = 0; i < groupSize; i++) {
+                    UInt32 corner = corners[i];
+                    const Vector3r& current = triangleNormals[corner / 3];
+
+                    // calculate angle between the normal that exists for this vertex,
+                    // and the current normal in the list.
+                    Real dot = Vector3r::dot(current, oNormal);
+                    if (dot > cosSmoothingThreshhold) {
+                        const Vector3r& tangent = cornerTangents[corner];
+                        avg.x += tangent.x;
+                        avg.y += tangent.y;
+                        avg.z += tangent.z;
+                        divisor++;
+                    }
                 }
-            }
 
-            // if divisor < 1, then no extra tangents were found to include in the average,
-            // so just use the original one
+                // if divisor < 1, then no extra tangents were found to include in the average,
+                // so just use the original one
+                if (divisor <= 1) {
+                    avg = oTangent;
+                }
+                else {
+                    avg.scale((Real)1.0 / divisor);
+                }
+                avg.normalize();
 
-            if (divisor <= 1) {
-                avg.x = oTangent.x;
-                avg.y = oTangent.y;
-                avg.z = oTangent.z;
-            }
-            else {
-                Real scaleFactor = (Real)1.0 / divisor;
-                avg.scale(scaleFactor);
-                //avg.Normalize();
+                // set the tangent for this vertex to the averaged tangent
+                tangents.set(vertex, avg);
             }
-
-            averageTangents.push_back(avg);
-        }
-
-        // loop through each vertex and assign the average tangent
-        // calculated for that vertex
-        for (UInt32 v = 0; v < this->vertexCount; v++) {
-            Vector3r avg = averageTangents[v];
-            avg.normalize();
-            // set the tangent for this vertex to the averaged tangent
-            tangents->getAttribute(v).set(avg.x, avg.y, avg.z);
-        }
+        });
 
         //if (invertTangents)InvertTangents();
-
-        tangents->updateGPUStorageData();
+        return true;
     }
 
     /*
-    * Calculate the tangent for the vertex at [vertexIndex] in member [positions].
+    * Calculate the tangent for the vertex at [vertexIndex] in [positions].
     *
     * The two edges used in the calculation (e1 and e2) are formed from the three vertices: v0, v1, v2.
     *
@@ -589,32 +807,30 @@ namespace Core {
     * v2 is the vertex at [rightIndex] in [positions].
     * v1 is the vertex at [leftIndex] in [positions].
     */
-    void Mesh::calculateTangent(UInt32 vertexIndex, UInt32 rightIndex, UInt32 leftIndex, Vector3r& result) {
-        // if the mesh doesn't have UVs dedicated for normal mapping, use the albedo UVs as a backup
-        WeakPointer<AttributeArray<Vector2rs>> sourceUVs = this->getVertexNormalUVs();
-        if (!sourceUVs) sourceUVs = this->getVertexAlbedoUVs();
-        Vector2r uv0 = sourceUVs->getAttribute(vertexIndex);
-        Vector2r uv2 = sourceUVs->getAttribute(rightIndex);
-        Vector2r uv1 = sourceUVs->getAttribute(leftIndex);
+    void Mesh::calculateTangent(const Real* positions, const Real* uvs, UInt32 vertexIndex, UInt32 rightIndex, UInt32 leftIndex, Vector3r& result) {
+        const UInt32 positionStride = Point3rs::ComponentCount;
+        const UInt32 uvStride = Vector2rs::ComponentCount;
+        const Real* uv0 = uvs + vertexIndex * uvStride;
+        const Real* uv2 = uvs + rightIndex * uvStride;
+        const Real* uv1 = uvs + leftIndex * uvStride;
 
-        WeakPointer<AttributeArray<Point3rs>> sourcePositions = this->getVertexPositions();
-        Point3r p0 = sourcePositions->getAttribute(vertexIndex);
-        Point3r p2 = sourcePositions->getAttribute(rightIndex);
-        Point3r p1 = sourcePositions->getAttribute(leftIndex);
+        const Real* p0 = positions + vertexIndex * positionStride;
+        const Real* p2 = positions + rightIndex * positionStride;
+        const Real* p1 = positions + leftIndex * positionStride;
 
-        Vector3r e1 = p1 - p0;
-        Vector3r e2 = p2 - p0;
+        Vector3r e1(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+        Vector3r e2(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
 
         Real u0, u1, u2;
         Real v0, v1, v2;
 
-        u0 = uv0.x;
-        u1 = uv1.x;
-        u2 = uv2.x;
+        u0 = uv0[0];
+        u1 = uv1[0];
+        u2 = uv2[0];
 
-        v0 = uv0.y;
-        v1 = uv1.y;
-        v2 = uv2.y;
+        v0 = uv0[1];
+        v1 = uv1[1];
+        v2 = uv2[1];
 
         Real du1 = u1 - u0;
         Real du2 = u2 - u0;
@@ -632,76 +848,50 @@ namespace Core {
     }
 
     /*
-     * Deallocate and destroy [vertexCrossMap].
+     * The mesh's index list if it is indexed, otherwise null (corner i is vertex i).
      */
-    void Mesh::destroyVertexCrossMap() {
-        if (this->vertexCrossMap != nullptr) {
-            UInt32 realVertexCount = this->vertexCount;
-            if (this->indexed) {
-                realVertexCount = this->indexCount;
-            }
-
-            std::unordered_map<std::vector<UInt32>*, Bool> deleted;
-            for (UInt32 i = 0; i < realVertexCount; i++) {
-                std::vector<UInt32>* list = this->vertexCrossMap[i];
-                if (list != nullptr && !deleted[list]) {
-                    delete list;
-                    deleted[list] = true;
-                }
-            }
+    const UInt32* Mesh::getCornerIndices() {
+        if (!this->indexed || !this->indexBuffer) return nullptr;
+        return this->indexBuffer->getIndices();
+    }
 
-            delete[] this->vertexCrossMap;
-            this->vertexCrossMap = nullptr;
+    /*
+     * For every vertex, find the last of the first [cornerCount] corners that references it,
+     * or NoCorner if none does.
+     */
+    void Mesh::getLastCorners(const UInt32* indices, UInt32 cornerCount, UInt32 vertexCount, std::vector<UInt32>& vertexCorners) {
+        vertexCorners.assign(vertexCount, Mesh::NoCorner);
+        for (UInt32 c = 0; c < cornerCount; c++) {
+            UInt32 vertex = indices ? indices[c] : c;
+            if (vertex < vertexCount) vertexCorners[vertex] = c;
         }
     }
 
+    /*
+     * Deallocate and destroy [vertexCrossMap].
+     */
+    void Mesh::destroyVertexCrossMap() {
+        this->vertexCrossMap.clear();
+    }
+
     /*
      * Construct [vertexCrossMap]. The vertex cross map is used to group all vertices that are equal.
-     * For a given combination of x,y,z, a corresponding list exists in [vertexCrossMap] with all the indices
-     * of vertices in [vertexPositions] which have a matching value for x,y, and z.
+     * For a given combination of x,y,z, a corresponding group exists in [vertexCrossMap] with all the
+     * corners (indices into the index list, or into [vertexPositions] for meshes without indices)
+     * whose positions match.
      */
     Bool Mesh::buildVertexCrossMap() {
-        // destroy existing cross map (if there is one).
-        this->destroyVertexCrossMap();
-
-        // This map is used to link all equal vertices. Many triangles in a mesh can potentially have equal
-        // vertices, so this structure is used to store indices in [vertexPositions] for those vertices.
-        std::unordered_map<Point3r, std::vector<UInt32>*, Vector3Base<Real>::Hasher, Vector3Base<Real>::Eq> vertexGroups;
-
-        UInt32 realVertexCount = this->vertexCount;
-        WeakPointer<IndexBuffer> indices;
-        if (this->indexed) {
-            indices = this->getIndexBuffer();
-            realVertexCount = this->indexCount;
-        }
-
-        vertexCrossMap = new(std::nothrow) std::vector<UInt32>*[realVertexCount];
-        if (vertexCrossMap == nullptr) {
-            throw AllocationException("Mesh::buildVertexCrossMap -> Could not allocate vertexCrossMap.");
-        }
-        
-        // loop through each vertex in the mesh and add the index in [vertexPositions] for that vertex to the
-        // appropriate vertex group.
-        for (UInt32 v = 0; v < realVertexCount; v++) {
-            UInt32 mappedIndex = v;
-            if (this->indexed) {
-                mappedIndex = indices->getIndex(mappedIndex);
-            }
-
-            Point3r point = this->vertexPositions->getAttribute(mappedIndex);
-
-            std::vector<UInt32>*& list = vertexGroups[point];
-
-            if (list == nullptr)list = new(std::nothrow) std::vector<UInt32>();
-            if (list == nullptr) {
-                throw AllocationException("Mesh::buildVertexCrossMap -> Could not allocate sub list.");
-            }
-
-            // add the normal at index [v] to the vertex group linked to [point]
-            list->push_back(v);
-            vertexCrossMap[v] = list;
-        }
-
+        UInt32 cornerCount = this->indexed ? this->indexCount : this->vertexCount;
+        Mesh::buildVertexCrossMap(this->vertexPositions->getStorage(), this->getCornerIndices(), cornerCount, this->vertexCrossMap);
         return true;
     }
+
+    /*
+     * Build [crossMap] for the triangles described by [cornerCount] corners in [indices] (or by the vertices
+     * at [positions] in order if [indices] is null), the way the static generateNormals() and generateTangents()
+     * expect it.
+     */
+    void Mesh::buildVertexCrossMap(const Real* positions, const UInt32* indices, UInt32 cornerCount, VertexCrossMap& crossMap) {
+        crossMap.build(positions, Point3rs::ComponentCount, indices, cornerCount / 3 * 3, Mesh::VertexWeldTolerance);
+    }
 }
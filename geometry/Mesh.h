@@ -12,6 +12,9 @@
 #include "../common/types.h"
 #include "../material/StandardAttributes.h"
 #include "AttributeArray.h"
+#include "AttributeEncoder.h"
+#include "InterleavedAttributeBuffer.h"
+#include "VertexCrossMap.h"
 #include "Vector2.h"
 #include "Vector3.h"
 #include "Box3.h"
@@ -22,13 +25,17 @@ namespace Core {
     class Engine;
     class Object3D;
     class IndexBuffer;
+    class Material;
 
     class Mesh : public Renderable<Mesh> {
         friend class Engine;
+        friend class MeshOptimizer;
+        friend class VertexWelder;
 
     public:
         virtual ~Mesh();
         virtual void init();
+        void init(WeakPointer<Material> targetMaterial);
 
         UInt32 getVertexCount() const;
         UInt32 getIndexCount() const;
@@ -51,6 +58,13 @@ namespace Core {
         Bool initVertexAlbedoUVs();
         Bool initVertexNormalUVs();
 
+        void setGPUStorageUsage(GPUStorageUsage usage);
+        GPUStorageUsage getGPUStorageUsage() const;
+        void setCompressedAttributes(Bool compressed);
+        Bool hasCompressedAttributes() const;
+        void setInterleavedAttributes(StandardAttributeSet attributes);
+        Bool isInterleaved() const;
+
         void enableAttribute(StandardAttribute attribute);
         void disableAttribute(StandardAttribute attribute);
         Bool isAttributeEnabled(StandardAttribute attribute);
@@ -58,6 +72,7 @@ namespace Core {
 
         void calculateBoundingBox();
         const Box3& getBoundingBox() const;
+        Real getUVDensity();
 
         void setNormalsSmoothingThreshold(Real threshold);
         void setCalculateNormals(Bool calculateNormals);
@@ -67,19 +82,39 @@ namespace Core {
         void calculateTangents(Real smoothingThreshhold);
 
         void update();
+        void generateAttributes();
+        void updateGPUStorage();
+        UInt64 getGPUStorageSize() const;
         void reverseVertexAttributeWindingOrder();
 
+        static void buildVertexCrossMap(const Real* positions, const UInt32* indices, UInt32 cornerCount, VertexCrossMap& crossMap);
+        static void generateNormals(const Real* positions, const UInt32* indices, UInt32 vertexCount, UInt32 cornerCount, const VertexCrossMap& crossMap,
+                                    Real smoothingThreshhold, AttributeView<Vector3rs> normals, AttributeView<Vector3rs> averagedNormals,
+                                    AttributeView<Vector3rs> faceNormals);
+        static Bool generateTangents(const Real* positions, const Real* uvs, const UInt32* indices, UInt32 vertexCount, UInt32 cornerCount,
+                                     const VertexCrossMap& crossMap, Real smoothingThreshhold, AttributeView<Vector3rs> tangents);
+
     protected:
         Mesh(WeakPointer<Graphics> graphics, UInt32 vertexCount, UInt32 indexCount);
         void initAttributes();
         Bool initIndices();
-        void calculateFaceNormal(UInt32 faceIndex, Vector3r& result);
-        void calculateTangent(UInt32 vertexIndex, UInt32 rightIndex, UInt32 leftIndex, Vector3r& result);
+        const UInt32* getCornerIndices();
         void destroyVertexCrossMap();
         Bool buildVertexCrossMap();
+        void generateNormals(Real smoothingThreshhold);
+        Bool generateTangents(Real smoothingThreshhold);
+
+        Real calculateUVDensity() const;
+
+        static void getLastCorners(const UInt32* indices, UInt32 cornerCount, UInt32 vertexCount, std::vector<UInt32>& vertexCorners);
+        static void calculateFaceNormals(const Real* positions, const UInt32* indices, UInt32 start, UInt32 end, Vector3r* result);
+        static void calculateTangent(const Real* positions, const Real* uvs, UInt32 vertexIndex, UInt32 rightIndex, UInt32 leftIndex, Vector3r& result);
+
+        static UInt32 getAttributeComponentCount(StandardAttribute attribute);
+        static AttributeType getAttributeGPUType(StandardAttribute attribute, Bool compressed);
 
         template <typename T>
-        Bool initVertexAttributes(std::shared_ptr<AttributeArray<T>>* attributes, UInt32 vertexCount) {          
+        Bool initVertexAttributes(std::shared_ptr<AttributeArray<T>>* attributes, UInt32 vertexCount, StandardAttribute attribute) {          
             try {
                 *attributes = std::make_shared<AttributeArray<T>>(vertexCount);
             }
@@ -87,8 +122,16 @@ namespace Core {
                 throw AllocationException("MeshGL::initVertexAttributes() -> Unable to allocate array.");
             }
 
-            std::shared_ptr<AttributeArrayGPUStorage> gpuStorage =
-                this->graphics->createGPUStorage((*attributes)->getSize(), T::ComponentCount, AttributeType::Float, false);
+            AttributeType gpuType = Mesh::getAttributeGPUType(attribute, this->compressedAttributes);
+            Bool normalize = AttributeEncoder::isNormalized(gpuType);
+            std::shared_ptr<AttributeArrayGPUStorage> gpuStorage;
+            if (this->interleavedBuffer && StandardAttributes::hasAttribute(this->interleavedAttributes, attribute)) {
+                gpuStorage = this->graphics->createGPUStorage((*attributes)->getSize(), T::ComponentCount, gpuType, normalize,
+                                                              this->interleavedBuffer, this->interleavedOffsets[(UInt32)attribute]);
+            }
+            else {
+                gpuStorage = this->graphics->createGPUStorage((*attributes)->getSize(), T::ComponentCount, gpuType, normalize, this->gpuStorageUsage);
+            }
             (*attributes)->setGPUStorage(gpuStorage);
             return true;
         }
@@ -100,6 +143,10 @@ namespace Core {
         Bool indexed;
         UInt32 indexCount;
         Box3 boundingBox;
+        // world units per UV unit; negative until getUVDensity() calculates it
+        Real uvDensity;
+        GPUStorageUsage gpuStorageUsage;
+        Bool compressedAttributes;
 
         std::shared_ptr<AttributeArray<Point3rs>> vertexPositions;
         std::shared_ptr<AttributeArray<Vector3rs>> vertexNormals;
@@ -111,8 +158,18 @@ namespace Core {
         std::shared_ptr<AttributeArray<Vector2rs>> vertexNormalUVs;
         std::shared_ptr<IndexBuffer> indexBuffer;
 
-        // maps vertices to other equal vertices
-        std::vector<UInt32>** vertexCrossMap;
+        // when set, the attributes in [interleavedAttributes] share [interleavedBuffer], each at
+        // its byte offset within a vertex
+        std::shared_ptr<InterleavedAttributeBuffer> interleavedBuffer;
+        StandardAttributeSet interleavedAttributes;
+        UInt32 interleavedOffsets[(UInt32)StandardAttribute::_Count];
+
+        static const UInt32 NoCorner = 0xFFFFFFFF;
+        static const UInt32 ParallelChunkSize = 8192;
+        static constexpr Real VertexWeldTolerance = 0.005f;
+
+        // groups corners whose positions are equal
+        VertexCrossMap vertexCrossMap;
         Bool shoudCalculateNormals;
         Bool shoudCalculateTangents;
         Bool shouldCalculateBoundingBox;
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <string.h>
+
+#include "MeshOptimizer.h"
+#include "Mesh.h"
+#include "IndexBuffer.h"
+#include "../common/Exception.h"
+#include "../math/Math.h"
+
+namespace Core {
+
+    /*
+     * Run [indices] through a simulated FIFO post-transform cache of [cacheSize] entries.
+     */
+    MeshOptimizer::CacheStatistics MeshOptimizer::analyzeVertexCache(const UInt32* indices, UInt32 indexCount, UInt32 vertexCount, UInt32 cacheSize) {
+        CacheStatistics statistics;
+        if (indexCount < 3 || vertexCount == 0) return statistics;
+
+        // entry time of each vertex; a vertex is cached while fewer than [cacheSize] misses followed it
+        std::vector<UInt32> cacheTime(vertexCount, 0);
+        std::vector<Bool> referenced(vertexCount, false);
+        UInt32 time = cacheSize + 1;
+        UInt32 misses = 0;
+        UInt32 uniqueVertices = 0;
+
+        for (UInt32 i = 0; i < indexCount; i++) {
+            UInt32 v = indices[i];
+            if (!referenced[v]) {
+                referenced[v] = true;
+                uniqueVertices++;
+            }
+            if (time - cacheTime[v] > cacheSize) {
+                cacheTime[v] = time;
+                time++;
+                misses++;
+            }
+        }
+
+        statistics.acmr = (Real)misses / (Real)(indexCount / 3);
+        statistics.atvr = uniqueVertices > 0 ? (Real)misses / (Real)uniqueVertices : 0.0f;
+        return statistics;
+    }
+
+    /*
+     * Reorder the triangles in [indices] for the post-transform vertex cache using Tipsify
+     * (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+     * Overdraw"). The reordered list goes to [destination], which must not alias [indices].
+     * If [clusters] is given, it receives the first triangle of every run that had to jump
+     * to an unconnected part of the mesh; those are natural cut points for optimizeOverdraw().
+     */
+    void MeshOptimizer::optimizeVertexCache(const UInt32* indices, UInt32 indexCount, UInt32 vertexCount, UInt32* destination,
+                                            std::vector<UInt32>* clusters, UInt32 cacheSize) {
+        if (clusters) clusters->clear();
+        UInt32 triangleCount = indexCount / 3;
+        if (triangleCount == 0 || vertexCount == 0) return;
+
+        // vertex -> triangle adjacency, in compressed rows
+        std::vector<UInt32> liveTriangles(vertexCount, 0);
+        for (UInt32 i = 0; i < triangleCount * 3; i++) liveTriangles[indices[i]]++;
+        std::vector<UInt32> adjacencyOffsets(vertexCount + 1, 0);
+        for (UInt32 v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+        std::vector<UInt32> adjacency(adjacencyOffsets[vertexCount]);
+        std::vector<UInt32> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (UInt32 t = 0; t < triangleCount; t++) {
+            for (UInt32 k = 0; k < 3; k++) {
+                UInt32 v = indices[t * 3 + k];
+                adjacency[fill[v]++] = t;
+            }
+        }
+
+        std::vector<UInt32> cacheTime(vertexCount, 0);
+        std::vector<Bool> emitted(triangleCount, false);
+        std::vector<UInt32> deadEnd;
+        std::vector<UInt32> candidates;
+        UInt32 time = cacheSize + 1;
+        UInt32 cursor = 0;
+        UInt32 outputTriangles = 0;
+
+        Int64 fanning = 0;
+        if (clusters) clusters->push_back(0);
+
+        while (fanning >= 0) {
+            UInt32 f = (UInt32)fanning;
+            candidates.clear();
+
+            for (UInt32 a = adjacencyOffsets[f]; a < adjacencyOffsets[f + 1]; a++) {
+                UInt32 t = adjacency[a];
+                if (emitted[t]) continue;
+
+                for (UInt32 k = 0; k < 3; k++) {
+                    UInt32 v = indices[t * 3 + k];
+                    destination[outputTriangles * 3 + k] = v;
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    liveTriangles[v]--;
+                    if (time - cacheTime[v] > cacheSize) {
+                        cacheTime[v] = time;
+                        time++;
+                    }
+                }
+                emitted[t] = true;
+                outputTriangles++;
+            }
+
+            // prefer the candidate that will still be in the cache after its remaining triangles
+            // are emitted, and among those the oldest one
+            Int64 next = -1;
+            Int64 bestPriority = -1;
+            for (UInt32 v : candidates) {
+                if (liveTriangles[v] == 0) continue;
+                Int64 priority = 0;
+                if ((Int64)(time - cacheTime[v]) + 2 * (Int64)liveTriangles[v] <= (Int64)cacheSize) {
+                    priority = time - cacheTime[v];
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+
+            if (next == -1) {
+                while (!deadEnd.empty()) {
+                    UInt32 v = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (liveTriangles[v] > 0) {
+                        next = v;
+                        break;
+                    }
+                }
+                while (next == -1 && cursor < vertexCount) {
+                    if (liveTriangles[cursor] > 0) next = cursor;
+                    cursor++;
+                }
+                if (next != -1 && clusters) clusters->push_back(outputTriangles);
+            }
+
+            fanning = next;
+        }
+    }
+
+    /*
+     * Reorder vertex-cache-optimized [indices] so that triangle clusters likely to occlude
+     * others are drawn first. The hard [clusters] from optimizeVertexCache() are split further
+     * wherever the cluster's own cache miss ratio is within [threshold] times that of the whole
+     * list, so the reordering costs little cache efficiency. Clusters are then sorted by how
+     * far out they face from the mesh centroid. [positions] holds [positionStride] Reals per
+     * vertex, x, y and z first. [destination] must not alias [indices].
+     */
+    void MeshOptimizer::optimizeOverdraw(const UInt32* indices, UInt32 indexCount, const Real* positions, UInt32 positionStride,
+                                         const std::vector<UInt32>& clusters, UInt32* destination, Real threshold, UInt32 cacheSize) {
+        UInt32 triangleCount = indexCount / 3;
+        if (triangleCount == 0) return;
+
+        UInt32 vertexCount = 0;
+        for (UInt32 i = 0; i < triangleCount * 3; i++) vertexCount = Math::max(vertexCount, indices[i] + 1);
+
+        Real targetACMR = analyzeVertexCache(indices, triangleCount * 3, vertexCount, cacheSize).acmr * threshold;
+
+        // split the hard clusters at soft boundaries
+        std::vector<UInt32> splitClusters;
+        std::vector<UInt32> cacheTime(vertexCount, 0);
+        UInt32 time = cacheSize + 1;
+        for (UInt32 c = 0; c < clusters.size(); c++) {
+            UInt32 start = clusters[c];
+            UInt32 end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+            splitClusters.push_back(start);
+
+            // every cluster may end up anywhere in the draw order, so it starts with a cold cache
+            time += cacheSize + 1;
+            UInt32 misses = 0;
+            UInt32 clusterTriangles = 0;
+            for (UInt32 t = start; t < end; t++) {
+                for (UInt32 k = 0; k < 3; k++) {
+                    UInt32 v = indices[t * 3 + k];
+                    if (time - cacheTime[v] > cacheSize) {
+                        cacheTime[v] = time;
+                        time++;
+                        misses++;
+                    }
+                }
+                clusterTriangles++;
+                if (t + 1 < end && (Real)misses / (Real)clusterTriangles <= targetACMR) {
+                    splitClusters.push_back(t + 1);
+                    time += cacheSize + 1;
+                    misses = 0;
+                    clusterTriangles = 0;
+                }
+            }
+        }
+
+        UInt32 clusterCount = (UInt32)splitClusters.size();
+        std::vector<Real> clusterData(clusterCount * 6, 0.0f);
+        Real meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+        Real meshArea = 0.0f;
+
+        for (UInt32 c = 0; c < clusterCount; c++) {
+            UInt32 start = splitClusters[c];
+            UInt32 end = c + 1 < clusterCount ? splitClusters[c + 1] : triangleCount;
+            Real* centroid = &clusterData[c * 6];
+            Real* normal = &clusterData[c * 6 + 3];
+            Real clusterArea = 0.0f;
+
+            for (UInt32 t = start; t < end; t++) {
+                const Real* p0 = positions + indices[t * 3] * positionStride;
+                const Real* p1 = positions + indices[t * 3 + 1] * positionStride;
+                const Real* p2 = positions + indices[t * 3 + 2] * positionStride;
+                Real e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                Real e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                Real n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+                Real area = Math::squareRoot(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                for (UInt32 k = 0; k < 3; k++) {
+                    Real center = (p0[k] + p1[k] + p2[k]) / 3.0f;
+                    centroid[k] += center * area;
+                    meshCentroid[k] += center * area;
+                    normal[k] += n[k];
+                }
+                clusterArea += area;
+            }
+
+            if (clusterArea > 0.0f) {
+                for (UInt32 k = 0; k < 3; k++) centroid[k] /= clusterArea;
+            }
+            meshArea += clusterArea;
+        }
+
+        if (meshArea > 0.0f) {
+            for (UInt32 k = 0; k < 3; k++) meshCentroid[k] /= meshArea;
+        }
+
+        std::vector<Real> sortKeys(clusterCount);
+        std::vector<UInt32> order(clusterCount);
+        for (UInt32 c = 0; c < clusterCount; c++) {
+            const Real* centroid = &clusterData[c * 6];
+            const Real* normal = &clusterData[c * 6 + 3];
+            Real length = Math::squareRoot(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            Real key = 0.0f;
+            if (length > 0.0f) {
+                for (UInt32 k = 0; k < 3; k++) key += (centroid[k] - meshCentroid[k]) * normal[k];
+                key /= length;
+            }
+            sortKeys[c] = key;
+            order[c] = c;
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&sortKeys](UInt32 a, UInt32 b) {
+            return sortKeys[a] > sortKeys[b];
+        });
+
+        UInt32 outputIndex = 0;
+        for (UInt32 c : order) {
+            UInt32 start = splitClusters[c];
+            UInt32 end = c + 1 < clusterCount ? splitClusters[c + 1] : triangleCount;
+            UInt32 count = (end - start) * 3;
+            memcpy(destination + outputIndex, indices + start * 3, count * sizeof(UInt32));
+            outputIndex += count;
+        }
+    }
+
+    /*
+     * Renumber vertices in the order [indices] first references them, so vertex fetches walk
+     * memory forward. [indices] is rewritten in place and [remap] (one entry per vertex) maps
+     * each old vertex index to its new one; unreferenced vertices move to the end. Returns the
+     * number of referenced vertices.
+     */
+    UInt32 MeshOptimizer::optimizeVertexFetch(UInt32* indices, UInt32 indexCount, UInt32 vertexCount, UInt32* remap) {
+        const UInt32 unassigned = 0xFFFFFFFF;
+        for (UInt32 v = 0; v < vertexCount; v++) remap[v] = unassigned;
+
+        UInt32 nextVertex = 0;
+        for (UInt32 i = 0; i < indexCount; i++) {
+            UInt32 v = indices[i];
+            if (remap[v] == unassigned) remap[v] = nextVertex++;
+            indices[i] = remap[v];
+        }
+
+        UInt32 referencedCount = nextVertex;
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            if (remap[v] == unassigned) remap[v] = nextVertex++;
+        }
+        return referencedCount;
+    }
+
+    template <typename T>
+    static void remapVertexAttributes(WeakPointer<AttributeArray<T>> attributes, const std::vector<UInt32>& remap, std::vector<Byte>& scratch) {
+        if (!attributes.isValid()) return;
+
+        UInt32 elementSize = attributes->getElementSize();
+        Byte* data = (Byte*)attributes->getStorage();
+        scratch.resize(attributes->getSize());
+        for (UInt32 v = 0; v < attributes->getAttributeCount(); v++) {
+            memcpy(scratch.data() + remap[v] * elementSize, data + v * elementSize, elementSize);
+        }
+        memcpy(data, scratch.data(), attributes->getSize());
+        attributes->updateGPUStorageData();
+    }
+
+    /*
+     * Run the vertex cache, overdraw and vertex fetch passes on the first [indexCount] indices
+     * of [indices], in place, and report the vertex cache efficiency before and after. [remap]
+     * receives the new index of each of the [vertexCount] vertices; the caller moves its vertex
+     * data accordingly. Nothing here touches a Mesh, so it is safe to run on any thread.
+     */
+    MeshOptimizer::Report MeshOptimizer::optimize(UInt32* indices, UInt32 indexCount, UInt32 vertexCount, const Real* positions,
+                                                  UInt32 positionStride, UInt32* remap, UInt32 cacheSize) {
+        Report report;
+        indexCount -= indexCount % 3;
+        if (indexCount == 0 || vertexCount == 0) {
+            for (UInt32 v = 0; v < vertexCount; v++) remap[v] = v;
+            return report;
+        }
+
+        report.before = analyzeVertexCache(indices, indexCount, vertexCount, cacheSize);
+
+        std::vector<UInt32> cacheOptimized(indexCount);
+        std::vector<UInt32> clusters;
+        optimizeVertexCache(indices, indexCount, vertexCount, cacheOptimized.data(), &clusters, cacheSize);
+        optimizeOverdraw(cacheOptimized.data(), indexCount, positions, positionStride, clusters, indices, 1.05f, cacheSize);
+        optimizeVertexFetch(indices, indexCount, vertexCount, remap);
+
+        report.after = analyzeVertexCache(indices, indexCount, vertexCount, cacheSize);
+        report.optimized = true;
+        return report;
+    }
+
+    /*
+     * Run the vertex cache, overdraw and vertex fetch passes on [mesh] and report its vertex
+     * cache efficiency before and after. Meshes without indices are left untouched, since
+     * every triangle already has vertices of its own.
+     */
+    MeshOptimizer::Report MeshOptimizer::optimize(WeakPointer<Mesh> mesh, UInt32 cacheSize) {
+        Report report;
+        UInt32 vertexCount = mesh->getVertexCount();
+
+        if (!mesh->isIndexed() || mesh->getIndexCount() < 3 || !mesh->getVertexPositions().isValid()) {
+            std::vector<UInt32> sequential(vertexCount - vertexCount % 3);
+            for (UInt32 i = 0; i < sequential.size(); i++) sequential[i] = i;
+            report.before = analyzeVertexCache(sequential.data(), (UInt32)sequential.size(), vertexCount, cacheSize);
+            report.after = report.before;
+            return report;
+        }
+
+        WeakPointer<IndexBuffer> indexBuffer = mesh->getIndexBuffer();
+        std::vector<UInt32> indices(mesh->getIndexCount());
+        for (UInt32 i = 0; i < indices.size(); i++) indices[i] = indexBuffer->getIndex(i);
+
+        std::vector<UInt32> remap(vertexCount);
+        const Real* positions = mesh->getVertexPositions()->getStorage();
+        report = optimize(indices.data(), (UInt32)indices.size(), vertexCount, positions, Point3rs::ComponentCount, remap.data(), cacheSize);
+
+        std::vector<Byte> scratch;
+        remapVertexAttributes(mesh->getVertexPositions(), remap, scratch);
+        remapVertexAttributes(mesh->getVertexNormals(), remap, scratch);
+        remapVertexAttributes(mesh->getVertexAveragedNormals(), remap, scratch);
+        remapVertexAttributes(mesh->getVertexFaceNormals(), remap, scratch);
+        remapVertexAttributes(mesh->getVertexTangents(), remap, scratch);
+        remapVertexAttributes(mesh->getVertexColors(), remap, scratch);
+        remapVertexAttributes(mesh->getVertexAlbedoUVs(), remap, scratch);
+        remapVertexAttributes(mesh->getVertexNormalUVs(), remap, scratch);
+
+        // trailing indices that did not form a whole triangle keep their (remapped) values
+        UInt32 indexCount = mesh->getIndexCount() - mesh->getIndexCount() % 3;
+        for (UInt32 i = indexCount; i < indices.size(); i++) indices[i] = remap[indices[i]];
+        indexBuffer->setIndices(indices.data());
+
+        // vertex numbering changed, so the cached groups of equal vertices are stale
+        mesh->destroyVertexCrossMap();
+
+        return report;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+#include "../util/WeakPointer.h"
+
+namespace Core {
+
+    // forward declarations
+    class Mesh;
+
+    /*
+     * Reorders indexed triangle meshes for the GPU: triangles for the post-transform vertex
+     * cache (Tipsify), clusters of triangles for less overdraw, and vertices for fetch locality.
+     * The low-level passes work on plain index lists; optimize() runs all of them on a Mesh.
+     */
+    class MeshOptimizer {
+    public:
+        static const UInt32 DefaultCacheSize = 16;
+
+        class CacheStatistics {
+        public:
+            CacheStatistics(): acmr(0.0f), atvr(0.0f) {}
+
+            // average cache miss ratio: vertices transformed per triangle (0.5 is ideal, 3 is worst)
+            Real acmr;
+            // average transform to vertex ratio: vertices transformed per unique vertex (1 is ideal)
+            Real atvr;
+        };
+
+        class Report {
+        public:
+            Report(): optimized(false) {}
+
+            Bool optimized;
+            CacheStatistics before;
+            CacheStatistics after;
+        };
+
+        static CacheStatistics analyzeVertexCache(const UInt32* indices, UInt32 indexCount, UInt32 vertexCount,
+                                                  UInt32 cacheSize = DefaultCacheSize);
+        static void optimizeVertexCache(const UInt32* indices, UInt32 indexCount, UInt32 vertexCount, UInt32* destination,
+                                        std::vector<UInt32>* clusters = nullptr, UInt32 cacheSize = DefaultCacheSize);
+        static void optimizeOverdraw(const UInt32* indices, UInt32 indexCount, const Real* positions, UInt32 positionStride,
+                                     const std::vector<UInt32>& clusters, UInt32* destination, Real threshold = 1.05f,
+                                     UInt32 cacheSize = DefaultCacheSize);
+        static UInt32 optimizeVertexFetch(UInt32* indices, UInt32 indexCount, UInt32 vertexCount, UInt32* remap);
+
+        static Report optimize(UInt32* indices, UInt32 indexCount, UInt32 vertexCount, const Real* positions, UInt32 positionStride,
+                               UInt32* remap, UInt32 cacheSize = DefaultCacheSize);
+        static Report optimize(WeakPointer<Mesh> mesh, UInt32 cacheSize = DefaultCacheSize);
+
+    private:
+        MeshOptimizer();
+    };
+}
@@ -9,9 +9,9 @@ namespace Core {
 
     Bool Ray::intersectMesh(WeakPointer<Mesh> mesh, std::vector<Hit>& hits) const {
         WeakPointer<AttributeArray<Point3rs>> vertexArray = mesh->getVertexPositions();
-        Point3rs * vertices = vertexArray->getAttributes();
+        AttributeView<Point3rs> vertices = vertexArray->getView();
 
-        UInt32 tCount = vertexArray->getAttributeCount();
+        UInt32 tCount = vertices.size();
         WeakPointer<IndexBuffer> indices;
         if (mesh->isIndexed()) {
             indices = mesh->getIndexBuffer();
@@ -21,9 +21,9 @@ namespace Core {
         Hit hit;
         for (UInt32 i = 0; i < tCount; i+=3) {
             Bool wasHit = false;
-            Point3r a = mesh->isIndexed() ? *(vertices + indices->getIndex(i)) : *(vertices + i);
-            Point3r b = mesh->isIndexed() ? *(vertices + indices->getIndex(i + 1)) : *(vertices + i + 1);
-            Point3r c = mesh->isIndexed() ? *(vertices + indices->getIndex(i + 2)) : *(vertices + i + 2);
+            Point3r a = vertices.get(mesh->isIndexed() ? indices->getIndex(i) : i);
+            Point3r b = vertices.get(mesh->isIndexed() ? indices->getIndex(i + 1) : i + 1);
+            Point3r c = vertices.get(mesh->isIndexed() ? indices->getIndex(i + 2) : i + 2);
             wasHit = this->intersectTriangle(a, b, c, hit);
             if (wasHit) {
                 hit.Object = mesh;
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../base/VectorStorage.h"
+#include "../base/VectorAccessor.h"
 #include "../common/types.h"
 #include "Vector2Components.h"
 #include "../math/Math.h"
@@ -9,30 +9,24 @@ namespace Core {
 
 #define VECTOR2_COMPONENT_COUNT 2
 
-    template <typename T, bool customStorage, typename Enable = void>
+    template <typename T, typename Enable = void>
     class Vector2;
 
-    template <typename T, bool customStorage>
-    class Vector2<T, customStorage, Core::enable_if_t<Core::is_numeric<T>::value>> : public VectorStorage<T, VECTOR2_COMPONENT_COUNT, customStorage>,
-                                                                                     public Vector2Components<T> {
+    template <typename T>
+    class Vector2<T, Core::enable_if_t<Core::is_numeric<T>::value>> : public Vector2Components<T> {
     public:
+        static const UInt32 ComponentCount = VECTOR2_COMPONENT_COUNT;
+        typedef T ComponentType;
+
         Vector2() : Vector2(0.0, 0.0) {}
-        Vector2(const T& x, const T& y) : Vector2Components<T>(this->data, x, y) {}
-        Vector2(const Vector2<T, true>& src) : Vector2(src.x, src.y) {}
-        Vector2(const Vector2<T, false>& src) : Vector2(src.x, src.y) {}
-        Vector2(T* storage) : Vector2(storage, 0.0, 0.0) {}
-        Vector2(T* storage, const T& x, const T& y) : VectorStorage<T, VECTOR2_COMPONENT_COUNT, true>(storage), Vector2Components<T>(this->data, x, y) {}
-
-        Vector2& operator=(const Vector2& other) {
-            if (this == &other) return *this;
-            this->copy(other);
-            return *this;
+        Vector2(const T& x, const T& y) : Vector2Components<T>(x, y) {}
+
+        T* getData() {
+            return this->data;
         }
 
-        template <Bool otherCustomStorage>
-        Vector2& operator=(const Vector2<T, otherCustomStorage>& other) {
-            this->copy(other);
-            return *this;
+        const T* getConstData() const {
+            return this->data;
         }
 
         void normalize() {
@@ -48,7 +42,7 @@ namespace Core {
         }
 
         T magnitude() const {
-            return Vector2<T, customStorage>::magnitude(this->x, this->y);
+            return Vector2<T>::magnitude(this->x, this->y);
         }
 
         static T magnitude(const T& x, const T& y) {
@@ -56,7 +50,7 @@ namespace Core {
         };
 
         Real squareMagnitude() const {
-            return Vector2<T, customStorage>::squareMagnitude(this->x, this->y);
+            return Vector2<T>::squareMagnitude(this->x, this->y);
         }
 
         static T squareMagnitude(const T& x, const T& y) {
@@ -78,12 +72,12 @@ namespace Core {
         }
     };
 
-    typedef Vector2<Real, false> Vector2r;
-    typedef Vector2<Real, true> Vector2rs;
+    typedef Vector2<Real> Vector2r;
+    typedef VectorAccessor<Vector2r> Vector2rs;
 
-    typedef Vector2<Int32, false> Vector2i;
-    typedef Vector2<Int32, true> Vector2is;
+    typedef Vector2<Int32> Vector2i;
+    typedef VectorAccessor<Vector2i> Vector2is;
 
-    typedef Vector2<UInt32, false> Vector2u;
-    typedef Vector2<UInt32, true> Vector2us;
+    typedef Vector2<UInt32> Vector2u;
+    typedef VectorAccessor<Vector2u> Vector2us;
 }
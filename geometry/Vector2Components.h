@@ -7,22 +7,22 @@ namespace Core {
   template <typename T>
   class Vector2Components {
   public:
-    T& x;
-    T& y;
-
-    Vector2Components(T* data, const T& x, const T& y): x(data[0]), y(data[1]) {
+    union {
+      struct {
+        T x;
+        T y;
+      };
+      T data[2];
+    };
+
+    Vector2Components(const T& x, const T& y) {
       this->set(x, y);
     }
 
-    virtual ~Vector2Components() = 0;
-
     void set(const T& x, const T& y) {
       this->x = x;
       this->y = y;
     }
 
   };
-
-  template <typename T>
-  Vector2Components<T>::~Vector2Components() {}
 }
@@ -3,43 +3,34 @@
 #include <iostream>
 #include <memory>
 #include <type_traits>
-#include "../base/VectorStorage.h"
+#include "../base/VectorAccessor.h"
 #include "../common/types.h"
 #include "Vector3Components.h"
 
 namespace Core {
 
-#define VECTOR3_COMPONENT_COUNT 4
-
-    template <typename T, bool customStorage = false, typename Enable = void>
+    template <typename T, typename Enable = void>
     class Vector3Base;
 
-    template <typename T, bool customStorage>
-    class Vector3Base<T, customStorage, Core::enable_if_t<Core::is_numeric<T>::value>> : public VectorStorage<T, VECTOR3_COMPONENT_COUNT, customStorage>,
-                                                                                         public Vector3Components<T> {
+    template <typename T>
+    class Vector3Base<T, Core::enable_if_t<Core::is_numeric<T>::value>> : public Vector3Components<T> {
     public:
-        Vector3Base() : Vector3Base(0.0, 0.0, 0.0) {}
-        Vector3Base(const Vector3Base& src) : Vector3Base(src.x, src.y, src.z) {}
-        Vector3Base(const T& x, const T& y, const T& z) : VectorStorage<T, VECTOR3_COMPONENT_COUNT, false>(), Vector3Components<T>(this->data, x, y, z) {
-            this->set(x, y, z);
-        }
+        static const UInt32 ComponentCount = VECTOR3_COMPONENT_COUNT;
+        typedef T ComponentType;
 
-        Vector3Base(T* storage) : Vector3Base(storage, 0.0, 0.0, 0.0) {}
-        Vector3Base(T* storage, const T& x, const T& y, const T& z)
-            : VectorStorage<T, VECTOR3_COMPONENT_COUNT, true>(storage), Vector3Components<T>(this->data, x, y, z) {
-            this->set(x, y, z);
-        }
+        Vector3Base() : Vector3Base(0.0, 0.0, 0.0, 0.0) {}
+        Vector3Base(const T& x, const T& y, const T& z, const T& w) : Vector3Components<T>(x, y, z, w) {}
 
-        virtual ~Vector3Base() {}
+        T* getData() {
+            return this->data;
+        }
 
-        T getW() const {
-            return this->w;
+        const T* getConstData() const {
+            return this->data;
         }
 
-        operator Vector3Base<T, true>() {
-            Vector3Base<T, true> n(this->x, this->y, this->z); 
-            n->w = this->w;
-            return n;
+        T getW() const {
+            return this->data[3];
         }
 
         void invert() {
@@ -60,7 +51,7 @@ namespace Core {
         }
 
         T magnitude() const {
-            return Vector3Base<T, customStorage>::magnitude(this->x, this->y, this->z);
+            return Vector3Base<T>::magnitude(this->x, this->y, this->z);
         }
 
         static T magnitude(const T& x, const T& y, const T& z) {
@@ -68,7 +59,7 @@ namespace Core {
         };
 
         Real squareMagnitude() const {
-            return Vector3Base<T, customStorage>::squareMagnitude(this->x, this->y, this->z);
+            return Vector3Base<T>::squareMagnitude(this->x, this->y, this->z);
         }
 
         static T squareMagnitude(const T& x, const T& y, const T& z) {
@@ -101,118 +92,87 @@ namespace Core {
         }Hasher;
 
         typedef struct {
-            Bool operator() (const Vector3Base& a, const Vector3Base& b) const { 
+            Bool operator() (const Vector3Base& a, const Vector3Base& b) const {
                 Real epsilon = .005f;
                 return Math::abs(a.x - b.x) < epsilon && Math::abs(a.y - b.y) < epsilon && Math::abs(a.z - b.z) < epsilon;
-    
+
             }
         }Eq;
 
     protected:
-        T& w = this->data[3];
-
-        template <Bool otherCustomStorage>
-        Bool operator==(const Vector3Base<T, otherCustomStorage>& other) {
+        Bool operator==(const Vector3Base<T>& other) const {
             if (this == &other) return true;
             Real epsilon = .005f;
             return Math::abs(other.x - this->x) < epsilon && Math::abs(other.y - this->y) < epsilon && Math::abs(other.z - this->z) < epsilon;
         }
 
-        const Vector3Base<T, false> operator*(Real scale) const {
-            Vector3Base<T, false> vec = *this;
-            vec.scale(scale);
-            return vec;
-        }
-
-        template <Bool otherCustomStorage>
-        void subtract(const Vector3Base<T, otherCustomStorage>& other) {
+        void subtract(const Vector3Base<T>& other) {
             this->x -= other.x;
             this->y -= other.y;
             this->z -= other.z;
         }
 
-        template <Bool otherCustomStorage>
-        void add(const Vector3Base<T, otherCustomStorage>& other) {
+        void add(const Vector3Base<T>& other) {
             this->x += other.x;
             this->y += other.y;
             this->z += other.z;
         }
     };
 
-    template <typename T, bool customStorage = false>
-    class Vector3 : public Vector3Base<T, customStorage> {
+    /*
+     * Vector3 and Point3 are plain values: the components are stored inline, there is no vtable
+     * and no indirection, so they are trivially copyable and can be packed into arrays. Vectors
+     * that live in external storage are reached through VectorAccessor (Vector3rs, Point3rs).
+     */
+    template <typename T>
+    class Vector3 : public Vector3Base<T> {
     public:
-        static const Vector3<T, customStorage> Zero;
-        static const Vector3<T, customStorage> UnitY;
-        static const Vector3<T, customStorage> UnitX;
-        static const Vector3<T, customStorage> Forward;
-        static const Vector3<T, customStorage> Backward;
-        static const Vector3<T, customStorage> Left;
-        static const Vector3<T, customStorage> Right;
-        static const Vector3<T, customStorage> Up;
-        static const Vector3<T, customStorage> Down;
+        static const Vector3<T> Zero;
+        static const Vector3<T> UnitY;
+        static const Vector3<T> UnitX;
+        static const Vector3<T> Forward;
+        static const Vector3<T> Backward;
+        static const Vector3<T> Left;
+        static const Vector3<T> Right;
+        static const Vector3<T> Up;
+        static const Vector3<T> Down;
 
         Vector3() : Vector3(0.0, 0.0, 0.0) {}
-        Vector3(const Vector3<T, true>& src) : Vector3(src.x, src.y, src.z) {}
-        Vector3(const Vector3<T, false>& src) : Vector3(src.x, src.y, src.z) {}
-        Vector3(const T& x, const T& y, const T& z) : Vector3Base<T, customStorage>(x, y, z) {
-            _set(x, y, z);
-        }
+        Vector3(const T& x, const T& y, const T& z) : Vector3Base<T>(x, y, z, 0.0) {}
 
-        Vector3(T* storage) : Vector3(storage, 0.0, 0.0, 0.0) {}
-        Vector3(T* storage, const T& x, const T& y, const T& z) : Vector3Base<T, customStorage>(storage, x, y, z) {
-            _set(x, y, z);
-        }
-
-        virtual void set(const T& x, const T& y, const T& z) override {
-            _set(x, y, z);
-        }
-
-        Vector3& operator=(const Vector3& other) {
-            if (this == &other) return *this;
-            this->copy(other);
-            return *this;
-        }
-
-        template <Bool otherCustomStorage>
-        Vector3& operator=(const Vector3<T, otherCustomStorage>& other) {
-            this->copy(other);
-            return *this;
+        void set(const T& x, const T& y, const T& z) {
+            Vector3Components<T>::set(x, y, z);
+            this->data[3] = 0.0;
         }
 
-        template <Bool otherCustomStorage>
-        void copy(const Vector3<T, otherCustomStorage>& other) {
-            BaseVector<T, VECTOR3_COMPONENT_COUNT>::copy(other);
+        void copy(const Vector3& other) {
+            *this = other;
         }
 
-        template <Bool otherCustomStorage>
-        Bool operator==(const Vector3<T, otherCustomStorage>& other) {
-            return Vector3Base<T, customStorage>::operator==(other);
+        Bool operator==(const Vector3& other) const {
+            return Vector3Base<T>::operator==(other);
         }
 
-        template <Bool otherCustomStorage>
-        Vector3<T, false> operator-(const Vector3<T, otherCustomStorage>& other) const {
-            Vector3<T, false> temp(this->x, this->y, this->z);
+        Vector3 operator-(const Vector3& other) const {
+            Vector3 temp = *this;
             temp.subtract(other);
             return temp;
         }
 
-        template <Bool otherCustomStorage>
-        Vector3<T, false> operator+(const Vector3<T, otherCustomStorage>& other) const {
-            Vector3<T, false> temp(this->x, this->y, this->z);
+        Vector3 operator+(const Vector3& other) const {
+            Vector3 temp = *this;
             temp.add(other);
             return temp;
         }
 
-        Vector3<T, false> operator*(const T& scale) const {
-            Vector3<T, false> vec = *this;
+        Vector3 operator*(const T& scale) const {
+            Vector3 vec = *this;
             vec.scale(scale);
             return vec;
         }
 
-        template <Bool otherCustomStorage>
-        Vector3<T, false> cross(const Vector3<T, otherCustomStorage>& other) const {
-            Vector3<T, false> result;
+        Vector3 cross(const Vector3& other) const {
+            Vector3 result;
             cross(*this, other, result);
             return result;
         }
@@ -222,118 +182,83 @@ namespace Core {
             result.y = (a.z * b.x) - (a.x * b.z);
             result.z = (a.x * b.y) - (a.y * b.x);
         }
-    
-    private:
-
-        void _set(const T& x, const T& y, const T& z) {
-            Vector3Components<T>::set(x, y, z);
-            this->w = 0.0;
-        }
     };
 
-    template <typename T, bool customStorage = false>
-    class Point3 : public Vector3Base<T, customStorage> {
+    template <typename T>
+    class Point3 : public Vector3Base<T> {
     public:
         Point3() : Point3(0.0, 0.0, 0.0) {}
-        Point3(const Point3<T, true>& src) : Point3(src.x, src.y, src.z) {}
-        Point3(const Point3<T, false>& src) : Point3(src.x, src.y, src.z) {}
-        Point3(const T& x, const T& y, const T& z) : Vector3Base<T, customStorage>(x, y, z) {
-            _set(x, y, z);
-        }
-
-        Point3(T* storage) : Point3(storage, 0.0, 0.0, 0.0) {}
-        Point3(T* storage, const T& x, const T& y, const T& z) : Vector3Base<T, customStorage>(storage, x, y, z) {
-            _set(x, y, z);
-        }
+        Point3(const T& x, const T& y, const T& z) : Vector3Base<T>(x, y, z, 1.0) {}
 
-        virtual void set(const T& x, const T& y, const T& z) override {
-            _set(x, y, z);
-        }
-
-        void _set(const T& x, const T& y, const T& z) {
+        void set(const T& x, const T& y, const T& z) {
             Vector3Components<T>::set(x, y, z);
-            this->w = 1.0;
-        }
-
-        Point3& operator=(const Point3& other) {
-            if (this == &other) return *this;
-            this->copy(other);
-            return *this;
-        }
-
-        template <Bool otherCustomStorage>
-        Point3& operator=(const Point3<T, otherCustomStorage>& other) {
-            this->copy(other);
-            return *this;
+            this->data[3] = 1.0;
         }
 
-        template <Bool otherCustomStorage>
-        void copy(const Point3<T, otherCustomStorage>& other) {
-            BaseVector<T, VECTOR3_COMPONENT_COUNT>::copy(other);
+        void copy(const Point3& other) {
+            *this = other;
         }
 
-        template <Bool otherCustomStorage>
-        Bool operator==(const Point3<T, otherCustomStorage>& other) {
-            return Vector3Base<T, customStorage>::operator==(other);
+        Bool operator==(const Point3& other) const {
+            return Vector3Base<T>::operator==(other);
         }
 
-        Point3<T, false> operator*(const T& scale) const {
-            Vector3Base<T, false> temp = Vector3Base<T, customStorage>::operator*(scale);
-            return Point3<T, false>(temp.x, temp.y, temp.z);
+        Point3 operator*(const T& scale) const {
+            Point3 temp = *this;
+            temp.scale(scale);
+            return temp;
         }
 
-        template <Bool otherCustomStorage>
-        Point3<T, false> operator-(const Vector3<T, otherCustomStorage>& other) const {
-            Point3<T, false> temp(this->x, this->y, this->z);
+        Point3 operator-(const Vector3<T>& other) const {
+            Point3 temp = *this;
             temp.subtract(other);
             return temp;
         }
 
-        template <Bool otherCustomStorage>
-        Vector3<T, false> operator-(const Point3<T, otherCustomStorage>& other) const {
-            Vector3<T, false> temp(this->x, this->y, this->z);
-            Vector3<T, false> othertemp(other.x, other.y, other.z);
-            return temp - othertemp;
+        Vector3<T> operator-(const Point3& other) const {
+            return Vector3<T>(this->x - other.x, this->y - other.y, this->z - other.z);
         }
 
-        template <Bool otherCustomStorage>
-        Point3<T, false> operator+(const Vector3<T, otherCustomStorage>& other) const {
-            Point3<T, false> temp(this->x, this->y, this->z);
+        Point3 operator+(const Vector3<T>& other) const {
+            Point3 temp = *this;
             temp.add(other);
             return temp;
         }
-
     };
 
-    typedef Vector3<Real, false> Vector3r;
-    typedef Point3<Real, false> Point3r;
-    typedef Vector3<Real, true> Vector3rs;
-    typedef Point3<Real, true> Point3rs;
+    typedef Vector3<Real> Vector3r;
+    typedef Point3<Real> Point3r;
+    typedef VectorAccessor<Vector3r> Vector3rs;
+    typedef VectorAccessor<Point3r> Point3rs;
+
+    static_assert(sizeof(Vector3r) == sizeof(Real) * VECTOR3_COMPONENT_COUNT, "Vector3r must be exactly four packed Reals");
+    static_assert(std::is_trivially_copyable<Vector3r>::value && std::is_trivially_copyable<Point3r>::value,
+                  "Vector3r and Point3r must be trivially copyable");
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::Zero;
+    template <typename T>
+    const Vector3<T> Vector3<T>::Zero;
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::UnitY{0.0, 1.0, 0.0};
+    template <typename T>
+    const Vector3<T> Vector3<T>::UnitY{0.0, 1.0, 0.0};
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::UnitX{1.0, 0.0, 0.0};
+    template <typename T>
+    const Vector3<T> Vector3<T>::UnitX{1.0, 0.0, 0.0};
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::Forward{0.0, 0.0, -1.0};
+    template <typename T>
+    const Vector3<T> Vector3<T>::Forward{0.0, 0.0, -1.0};
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::Backward{0.0, 0.0, 1.0};
+    template <typename T>
+    const Vector3<T> Vector3<T>::Backward{0.0, 0.0, 1.0};
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::Left{-1.0, 0.0, 0.0};
+    template <typename T>
+    const Vector3<T> Vector3<T>::Left{-1.0, 0.0, 0.0};
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::Right{1.0, 0.0, 0.0};
+    template <typename T>
+    const Vector3<T> Vector3<T>::Right{1.0, 0.0, 0.0};
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::Up{0.0, 1.0, 0.0};
+    template <typename T>
+    const Vector3<T> Vector3<T>::Up{0.0, 1.0, 0.0};
 
-    template <typename T, bool customStorage>
-    const Vector3<T, customStorage> Vector3<T, customStorage>::Down{0.0, -1.0, 0.0};
+    template <typename T>
+    const Vector3<T> Vector3<T>::Down{0.0, -1.0, 0.0};
 }
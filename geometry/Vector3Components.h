@@ -5,27 +5,35 @@
 
 namespace Core {
 
+#define VECTOR3_COMPONENT_COUNT 4
+
+    /*
+     * Inline storage shared by Vector3 and Point3. The homogeneous w component lives in data[3] so
+     * the layout is a packed, 16-byte aligned vec4 that the matrix kernels can consume directly.
+     */
     template <typename T>
-    class Vector3Components {
+    class alignas(16) Vector3Components {
     public:
-        T& x;
-        T& y;
-        T& z;
+        union {
+            struct {
+                T x;
+                T y;
+                T z;
+            };
+            T data[VECTOR3_COMPONENT_COUNT];
+        };
 
-        Vector3Components(T* data, const T& x, const T& y, const T& z) : x(data[0]), y(data[1]), z(data[2]) {
-            this->set(x, y, z);
+        Vector3Components(const T& x, const T& y, const T& z, const T& w) {
+            this->data[0] = x;
+            this->data[1] = y;
+            this->data[2] = z;
+            this->data[3] = w;
         }
 
-        virtual ~Vector3Components() = 0;
-
-        virtual void set(const T& x, const T& y, const T& z) {
+        void set(const T& x, const T& y, const T& z) {
             this->x = x;
             this->y = y;
             this->z = z;
         }
     };
-
-    template <typename T>
-    Vector3Components<T>::~Vector3Components() {
-    }
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../base/VectorStorage.h"
+#include "../base/VectorAccessor.h"
 #include "../common/types.h"
 #include "Vector4Components.h"
 
@@ -8,30 +8,24 @@ namespace Core {
 
 #define VECTOR4_COMPONENT_COUNT 4
 
-    template <typename T, bool customStorage = false, typename Enable = void>
+    template <typename T, typename Enable = void>
     class Vector4;
 
-    template <typename T, bool customStorage>
-    class Vector4<T, customStorage, Core::enable_if_t<Core::is_numeric<T>::value>> : public VectorStorage<T, VECTOR4_COMPONENT_COUNT, customStorage>,
-                                                                                     public Vector4Components<T> {
+    template <typename T>
+    class Vector4<T, Core::enable_if_t<Core::is_numeric<T>::value>> : public Vector4Components<T> {
     public:
+        static const UInt32 ComponentCount = VECTOR4_COMPONENT_COUNT;
+        typedef T ComponentType;
+
         Vector4() : Vector4(0.0, 0.0, 0.0, 0.0) {}
-        Vector4(const T& x, const T& y, const T& z, const T& w) : Vector4Components<T>(this->data, x, y, z, w) {}
-        Vector4(T* storage) : Vector4(storage, 0.0, 0.0, 0.0, 0.0) {}
-        Vector4(T* storage, const T& x, const T& y, const T& z, const T& w)
-            : VectorStorage<T, VECTOR4_COMPONENT_COUNT, true>(storage), Vector4Components<T>(this->data, x, y, z, w) {
-        }
+        Vector4(const T& x, const T& y, const T& z, const T& w) : Vector4Components<T>(x, y, z, w) {}
 
-        Vector4& operator =(const Vector4& other) {
-            if (this == &other) return *this;
-            this->copy(other);
-            return *this;
+        T* getData() {
+            return this->data;
         }
 
-        template <Bool otherCustomStorage>
-        Vector4& operator=(const Vector4<T, otherCustomStorage>& other) {
-            this->copy(other);
-            return *this;
+        const T* getConstData() const {
+            return this->data;
         }
 
         Real dot(const Vector4Components<T>& b) const {
@@ -43,12 +37,12 @@ namespace Core {
         }
     };
 
-    typedef Vector4<Real, false> Vector4r;
-    typedef Vector4<Real, true> Vector4rs;
+    typedef Vector4<Real> Vector4r;
+    typedef VectorAccessor<Vector4r> Vector4rs;
 
-    typedef Vector4<Int32, false> Vector4i;
-    typedef Vector4<Int32, true> Vector4is;
+    typedef Vector4<Int32> Vector4i;
+    typedef VectorAccessor<Vector4i> Vector4is;
 
-    typedef Vector4<UInt32, false> Vector4u;
-    typedef Vector4<UInt32, true> Vector4us;
+    typedef Vector4<UInt32> Vector4u;
+    typedef VectorAccessor<Vector4u> Vector4us;
 }
@@ -5,19 +5,22 @@
 namespace Core {
 
   template <typename T>
-  class Vector4Components {
+  class alignas(16) Vector4Components {
   public:
-    T& x;
-    T& y;
-    T& z;
-    T& w;
-
-    Vector4Components(T* data, const T& x, const T& y, const T& z, const T& w): x(data[0]), y(data[1]), z(data[2]), w(data[3]) {
+    union {
+      struct {
+        T x;
+        T y;
+        T z;
+        T w;
+      };
+      T data[4];
+    };
+
+    Vector4Components(const T& x, const T& y, const T& z, const T& w) {
       this->set(x, y, z, w);
     }
 
-    virtual ~Vector4Components() = 0;
-
     void set(const T& x, const T& y, const T& z, const T& w) {
       this->x = x;
       this->y = y;
@@ -26,7 +29,4 @@ namespace Core {
     }
 
   };
-
-  template <typename T>
-  Vector4Components<T>::~Vector4Components() {}
 }
@@ -0,0 +1,162 @@
+#include <algorithm>
+
+#include "VertexCrossMap.h"
+#include "../math/Math.h"
+
+namespace Core {
+
+    VertexCrossMap::VertexCrossMap(): built(false) {
+
+    }
+
+    /*
+     * Group the [cornerCount] corners described by [indices] (or corners 0 .. cornerCount - 1
+     * if [indices] is null) by the position of their vertex in [positions], which holds
+     * [positionStride] Reals per vertex. Two vertices match when every coordinate differs by
+     * less than [tolerance], and groups are closed under matching. Vertices are bucketed into
+     * cells of size [tolerance] and sorted, and each vertex is compared only against its own
+     * cell and the neighbouring cells that follow it in sort order, so matches that straddle a
+     * cell boundary are still found and building stays O(n log n).
+     */
+    void VertexCrossMap::build(const Real* positions, UInt32 positionStride, const UInt32* indices, UInt32 cornerCount, Real tolerance) {
+        this->clear();
+
+        class CellKey {
+        public:
+            Int64 x, y, z;
+            UInt32 vertex;
+
+            Bool operator<(const CellKey& other) const {
+                if (this->x != other.x) return this->x < other.x;
+                if (this->y != other.y) return this->y < other.y;
+                if (this->z != other.z) return this->z < other.z;
+                return this->vertex < other.vertex;
+            }
+
+            Bool sameCell(const CellKey& other) const {
+                return this->x == other.x && this->y == other.y && this->z == other.z;
+            }
+        };
+
+        UInt32 vertexCount = cornerCount;
+        if (indices) {
+            vertexCount = 0;
+            for (UInt32 c = 0; c < cornerCount; c++) vertexCount = std::max(vertexCount, indices[c] + 1);
+        }
+        std::vector<Byte> referenced(vertexCount, indices ? 0 : 1);
+        if (indices) {
+            for (UInt32 c = 0; c < cornerCount; c++) referenced[indices[c]] = 1;
+        }
+
+        Real scale = tolerance > 0.0f ? (Real)1.0 / tolerance : (Real)1.0;
+        std::vector<CellKey> keys;
+        keys.reserve(vertexCount);
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            if (!referenced[v]) continue;
+            const Real* p = positions + v * positionStride;
+            CellKey key;
+            key.x = (Int64)Math::floor(p[0] * scale);
+            key.y = (Int64)Math::floor(p[1] * scale);
+            key.z = (Int64)Math::floor(p[2] * scale);
+            key.vertex = v;
+            keys.push_back(key);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        // union-find over vertices; every vertex starts as its own root
+        std::vector<UInt32> parents(vertexCount);
+        for (UInt32 v = 0; v < vertexCount; v++) parents[v] = v;
+        auto findRoot = [&parents](UInt32 v) {
+            while (parents[v] != v) {
+                parents[v] = parents[parents[v]];
+                v = parents[v];
+            }
+            return v;
+        };
+        auto matches = [positions, positionStride, tolerance](UInt32 a, UInt32 b) {
+            const Real* pa = positions + a * positionStride;
+            const Real* pb = positions + b * positionStride;
+            return Math::abs(pa[0] - pb[0]) < tolerance && Math::abs(pa[1] - pb[1]) < tolerance && Math::abs(pa[2] - pb[2]) < tolerance;
+        };
+        auto join = [&parents, &findRoot](UInt32 a, UInt32 b) {
+            UInt32 rootA = findRoot(a);
+            UInt32 rootB = findRoot(b);
+            if (rootA == rootB) return;
+            if (rootA < rootB) parents[rootB] = rootA;
+            else parents[rootA] = rootB;
+        };
+
+        for (UInt32 i = 0; i < keys.size(); i++) {
+            const CellKey& key = keys[i];
+            // the rest of this vertex's own cell
+            for (UInt32 j = i + 1; j < keys.size() && keys[j].sameCell(key); j++) {
+                if (matches(key.vertex, keys[j].vertex)) join(key.vertex, keys[j].vertex);
+            }
+            // the 13 neighbouring cells that sort after this one; the other 13 probe this cell instead
+            for (Int64 dx = 0; dx <= 1; dx++) {
+                for (Int64 dy = dx == 0 ? 0 : -1; dy <= 1; dy++) {
+                    for (Int64 dz = (dx == 0 && dy == 0) ? 1 : -1; dz <= 1; dz++) {
+                        CellKey neighbour;
+                        neighbour.x = key.x + dx;
+                        neighbour.y = key.y + dy;
+                        neighbour.z = key.z + dz;
+                        neighbour.vertex = 0;
+                        auto itr = std::lower_bound(keys.begin(), keys.end(), neighbour);
+                        for (; itr != keys.end() && itr->sameCell(neighbour); ++itr) {
+                            if (matches(key.vertex, itr->vertex)) join(key.vertex, itr->vertex);
+                        }
+                    }
+                }
+            }
+        }
+
+        // number the groups in order of their first corner, then lay the corners out by group
+        std::vector<UInt32> rootGroups(vertexCount, (UInt32)-1);
+        this->cornerGroups.resize(cornerCount);
+        UInt32 groupCount = 0;
+        for (UInt32 c = 0; c < cornerCount; c++) {
+            UInt32 root = findRoot(indices ? indices[c] : c);
+            if (rootGroups[root] == (UInt32)-1) rootGroups[root] = groupCount++;
+            this->cornerGroups[c] = rootGroups[root];
+        }
+
+        this->groupOffsets.assign(groupCount + 1, 0);
+        for (UInt32 c = 0; c < cornerCount; c++) this->groupOffsets[this->cornerGroups[c] + 1]++;
+        for (UInt32 g = 0; g < groupCount; g++) this->groupOffsets[g + 1] += this->groupOffsets[g];
+        this->groupCorners.resize(cornerCount);
+        std::vector<UInt32> fill(this->groupOffsets.begin(), this->groupOffsets.end() - 1);
+        for (UInt32 c = 0; c < cornerCount; c++) this->groupCorners[fill[this->cornerGroups[c]]++] = c;
+        this->built = true;
+    }
+
+    void VertexCrossMap::clear() {
+        this->cornerGroups.clear();
+        this->groupOffsets.clear();
+        this->groupCorners.clear();
+        this->built = false;
+    }
+
+    Bool VertexCrossMap::isBuilt() const {
+        return this->built;
+    }
+
+    UInt32 VertexCrossMap::getCornerCount() const {
+        return (UInt32)this->cornerGroups.size();
+    }
+
+    UInt32 VertexCrossMap::getGroupCount() const {
+        return this->groupOffsets.size() > 0 ? (UInt32)this->groupOffsets.size() - 1 : 0;
+    }
+
+    UInt32 VertexCrossMap::getGroup(UInt32 corner) const {
+        return this->cornerGroups[corner];
+    }
+
+    UInt32 VertexCrossMap::getGroupSize(UInt32 group) const {
+        return this->groupOffsets[group + 1] - this->groupOffsets[group];
+    }
+
+    const UInt32* VertexCrossMap::getGroupCorners(UInt32 group) const {
+        return this->groupCorners.data() + this->groupOffsets[group];
+    }
+}
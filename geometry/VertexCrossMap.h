@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+
+namespace Core {
+
+    /*
+     * Groups the corners of a triangle list (one corner per index, or per vertex for meshes
+     * without indices) by position: corners whose positions agree to within [tolerance] share
+     * a group. Groups are stored flat, in compressed rows: the corners of group g are
+     * getGroupCorners(g)[0 .. getGroupSize(g) - 1].
+     */
+    class VertexCrossMap {
+    public:
+        VertexCrossMap();
+
+        void build(const Real* positions, UInt32 positionStride, const UInt32* indices, UInt32 cornerCount, Real tolerance);
+        void clear();
+        Bool isBuilt() const;
+
+        UInt32 getCornerCount() const;
+        UInt32 getGroupCount() const;
+        UInt32 getGroup(UInt32 corner) const;
+        UInt32 getGroupSize(UInt32 group) const;
+        const UInt32* getGroupCorners(UInt32 group) const;
+
+    private:
+        Bool built;
+        std::vector<UInt32> cornerGroups;
+        std::vector<UInt32> groupOffsets;
+        std::vector<UInt32> groupCorners;
+    };
+}
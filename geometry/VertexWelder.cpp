@@ -0,0 +1,203 @@
+#include <string.h>
+
+#include "VertexWelder.h"
+#include "Mesh.h"
+#include "IndexBuffer.h"
+#include "../common/Exception.h"
+
+namespace Core {
+
+    static const UInt32 EmptySlot = 0xFFFFFFFF;
+
+    static inline UInt32 rotateLeft(UInt32 value, UInt32 count) {
+        return (value << count) | (value >> (32 - count));
+    }
+
+    /*
+     * MurmurHash3 over the raw bits of every attribute of [vertex].
+     */
+    static UInt32 hashVertex(const std::vector<VertexWelder::AttributeStream>& streams, UInt32 vertex) {
+        UInt32 hash = 0;
+        for (const VertexWelder::AttributeStream& stream : streams) {
+            const Byte* bytes = (const Byte*)(stream.data + vertex * stream.componentCount);
+            UInt32 size = stream.componentCount * sizeof(Real);
+            for (UInt32 offset = 0; offset + sizeof(UInt32) <= size; offset += sizeof(UInt32)) {
+                UInt32 word;
+                memcpy(&word, bytes + offset, sizeof(UInt32));
+                word *= 0xcc9e2d51;
+                word = rotateLeft(word, 15);
+                word *= 0x1b873593;
+                hash ^= word;
+                hash = rotateLeft(hash, 13);
+                hash = hash * 5 + 0xe6546b64;
+            }
+        }
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    static Bool verticesEqual(const std::vector<VertexWelder::AttributeStream>& streams, UInt32 a, UInt32 b) {
+        for (const VertexWelder::AttributeStream& stream : streams) {
+            if (memcmp(stream.data + a * stream.componentCount, stream.data + b * stream.componentCount,
+                       stream.componentCount * sizeof(Real)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+     * Find the vertices of [streams] that are bitwise identical in every stream. [remap] receives,
+     * for each of the [vertexCount] vertices, the index of its unique vertex; unique vertices are
+     * numbered in order of first appearance. Returns the number of unique vertices.
+     */
+    UInt32 VertexWelder::generateRemap(const std::vector<AttributeStream>& streams, UInt32 vertexCount, UInt32* remap) {
+        if (vertexCount == 0) return 0;
+
+        // open addressing table holding the first vertex seen for each key, at most half full
+        UInt32 tableSize = 16;
+        while (tableSize < vertexCount * 2) tableSize *= 2;
+        std::vector<UInt32> table(tableSize, EmptySlot);
+        UInt32 mask = tableSize - 1;
+
+        UInt32 uniqueCount = 0;
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            UInt32 slot = hashVertex(streams, v) & mask;
+            while (true) {
+                UInt32 existing = table[slot];
+                if (existing == EmptySlot) {
+                    table[slot] = v;
+                    remap[v] = uniqueCount++;
+                    break;
+                }
+                if (verticesEqual(streams, existing, v)) {
+                    remap[v] = remap[existing];
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+
+        return uniqueCount;
+    }
+
+    /*
+     * Copy vertex v of [source] to vertex [remap][v] of [destination].
+     */
+    void VertexWelder::remapVertices(const Real* source, UInt32 componentCount, UInt32 vertexCount, const UInt32* remap, Real* destination) {
+        UInt32 elementSize = componentCount * sizeof(Real);
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            memcpy(destination + remap[v] * componentCount, source + v * componentCount, elementSize);
+        }
+    }
+
+    template <typename T>
+    static void addStream(std::vector<VertexWelder::AttributeStream>& streams, const std::shared_ptr<AttributeArray<T>>& attributes) {
+        if (attributes) streams.push_back(VertexWelder::AttributeStream(attributes->getStorage(), T::ComponentCount));
+    }
+
+    template <typename T>
+    static void compactAttributes(const std::shared_ptr<AttributeArray<T>>& attributes, const std::vector<UInt32>& remap,
+                                  UInt32 uniqueCount, std::vector<Real>& destination) {
+        if (!attributes) return;
+        destination.resize(uniqueCount * T::ComponentCount);
+        VertexWelder::remapVertices(attributes->getStorage(), T::ComponentCount, (UInt32)remap.size(), remap.data(), destination.data());
+    }
+
+    /*
+     * Weld the identical vertices of [mesh] and make it indexed. Vertices are compared on their
+     * positions, normals, colors and UVs, plus face normals and tangents when the mesh does not
+     * calculate those itself. All vertex attributes and the index buffer are reallocated, so
+     * this is meant to run once, before the mesh is drawn. Returns false if nothing changed.
+     */
+    Bool VertexWelder::weld(WeakPointer<Mesh> mesh) {
+        UInt32 vertexCount = mesh->vertexCount;
+        UInt32 cornerCount = mesh->indexed ? mesh->indexCount : vertexCount;
+        if (vertexCount == 0 || cornerCount == 0 || !mesh->vertexPositions) return false;
+
+        std::vector<AttributeStream> streams;
+        addStream(streams, mesh->vertexPositions);
+        if (mesh->isAttributeEnabled(StandardAttribute::Normal)) addStream(streams, mesh->vertexNormals);
+        if (mesh->isAttributeEnabled(StandardAttribute::Color)) addStream(streams, mesh->vertexColors);
+        if (mesh->isAttributeEnabled(StandardAttribute::AlbedoUV)) addStream(streams, mesh->vertexAlbedoUVs);
+        if (mesh->isAttributeEnabled(StandardAttribute::NormalUV)) addStream(streams, mesh->vertexNormalUVs);
+        if (mesh->isAttributeEnabled(StandardAttribute::FaceNormal) && !mesh->shoudCalculateNormals) {
+            addStream(streams, mesh->vertexFaceNormals);
+        }
+        if (mesh->isAttributeEnabled(StandardAttribute::Tangent) && !mesh->shoudCalculateTangents) {
+            addStream(streams, mesh->vertexTangents);
+        }
+
+        std::vector<UInt32> remap(vertexCount);
+        UInt32 uniqueCount = generateRemap(streams, vertexCount, remap.data());
+        if (mesh->indexed && uniqueCount == vertexCount) return false;
+
+        std::vector<UInt32> indices(cornerCount);
+        const UInt32* currentIndices = mesh->getCornerIndices();
+        for (UInt32 c = 0; c < cornerCount; c++) {
+            indices[c] = remap[currentIndices ? currentIndices[c] : c];
+        }
+
+        std::vector<Real> positions, normals, averagedNormals, faceNormals, tangents, colors, albedoUVs, normalUVs;
+        compactAttributes(mesh->vertexPositions, remap, uniqueCount, positions);
+        compactAttributes(mesh->vertexNormals, remap, uniqueCount, normals);
+        compactAttributes(mesh->vertexAveragedNormals, remap, uniqueCount, averagedNormals);
+        compactAttributes(mesh->vertexFaceNormals, remap, uniqueCount, faceNormals);
+        compactAttributes(mesh->vertexTangents, remap, uniqueCount, tangents);
+        compactAttributes(mesh->vertexColors, remap, uniqueCount, colors);
+        compactAttributes(mesh->vertexAlbedoUVs, remap, uniqueCount, albedoUVs);
+        compactAttributes(mesh->vertexNormalUVs, remap, uniqueCount, normalUVs);
+
+        mesh->vertexCount = uniqueCount;
+        mesh->indexCount = cornerCount;
+        mesh->indexed = true;
+        if (mesh->interleavedBuffer) {
+            mesh->setInterleavedAttributes(mesh->interleavedAttributes);
+        }
+
+        if (mesh->vertexPositions) {
+            mesh->initVertexPositions();
+            mesh->vertexPositions->store(positions.data());
+        }
+        if (mesh->vertexNormals) {
+            mesh->initVertexNormals();
+            mesh->vertexNormals->store(normals.data());
+            if (averagedNormals.size() > 0) mesh->vertexAveragedNormals->store(averagedNormals.data());
+        }
+        if (mesh->vertexFaceNormals) {
+            mesh->initVertexFaceNormals();
+            mesh->vertexFaceNormals->store(faceNormals.data());
+        }
+        if (mesh->vertexTangents) {
+            mesh->initVertexTangents();
+            mesh->vertexTangents->store(tangents.data());
+        }
+        if (mesh->vertexColors) {
+            mesh->initVertexColors();
+            mesh->vertexColors->store(colors.data());
+        }
+        if (mesh->vertexAlbedoUVs) {
+            mesh->initVertexAlbedoUVs();
+            mesh->vertexAlbedoUVs->store(albedoUVs.data());
+        }
+        if (mesh->vertexNormalUVs) {
+            mesh->initVertexNormalUVs();
+            mesh->vertexNormalUVs->store(normalUVs.data());
+        }
+
+        if (!mesh->initIndices() || !mesh->indexBuffer) {
+            throw AllocationException("VertexWelder::weld -> Unable to allocate index buffer.");
+        }
+        mesh->indexBuffer->setIndices(indices.data());
+
+        // vertex numbering and buffers changed, so cached groups and vertex array objects are stale
+        mesh->destroyVertexCrossMap();
+        if (mesh->graphics.isValid()) mesh->graphics->destroyVertexArrays(mesh.get());
+
+        return true;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+#include "../util/WeakPointer.h"
+
+namespace Core {
+
+    // forward declarations
+    class Mesh;
+
+    /*
+     * Merges vertices whose attributes are bitwise identical and describes the triangles with an
+     * index list instead. The low-level passes work on plain attribute streams; weld() turns a
+     * Mesh into an indexed mesh in place.
+     */
+    class VertexWelder {
+    public:
+        // one vertex attribute: [componentCount] Reals per vertex, packed
+        class AttributeStream {
+        public:
+            AttributeStream(const Real* data, UInt32 componentCount): data(data), componentCount(componentCount) {}
+
+            const Real* data;
+            UInt32 componentCount;
+        };
+
+        static UInt32 generateRemap(const std::vector<AttributeStream>& streams, UInt32 vertexCount, UInt32* remap);
+        static void remapVertices(const Real* source, UInt32 componentCount, UInt32 vertexCount, const UInt32* remap, Real* destination);
+
+        static Bool weld(WeakPointer<Mesh> mesh);
+
+    private:
+        VertexWelder();
+    };
+}
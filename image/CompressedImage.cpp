@@ -0,0 +1,118 @@
+#include "CompressedImage.h"
+
+namespace Core {
+
+    const UInt32 CompressedImage::BlockDimension;
+
+    CompressedImage::CompressedImage(TextureFormat format, UInt32 width, UInt32 height): format(format), width(width), height(height) {
+        if (!CompressedImage::isCompressedFormat(format)) {
+            throw Exception("CompressedImage::CompressedImage() -> [format] is not a block-compressed format.");
+        }
+    }
+
+    /*
+     * Allocate storage for [levelCount] levels, starting with the full-size image. Levels stop at
+     * 1x1, so asking for more than the full mip chain allocates just the full chain.
+     */
+    void CompressedImage::init(UInt32 levelCount) {
+        if (levelCount == 0) levelCount = 1;
+
+        this->levelOffsets.clear();
+        UInt64 size = 0;
+        UInt32 levelWidth = this->width;
+        UInt32 levelHeight = this->height;
+        for (UInt32 i = 0; i < levelCount; i++) {
+            this->levelOffsets.push_back(size);
+            size += CompressedImage::calcLevelSizeBytes(this->format, levelWidth, levelHeight);
+            if (levelWidth == 1 && levelHeight == 1) break;
+            levelWidth = levelWidth > 1 ? levelWidth / 2 : 1;
+            levelHeight = levelHeight > 1 ? levelHeight / 2 : 1;
+        }
+        this->levelOffsets.push_back(size);
+
+        try {
+            this->data.resize(size);
+        }
+        catch (...) {
+            throw AllocationException("CompressedImage::init() -> Unable to allocate memory for compressed image.");
+        }
+    }
+
+    TextureFormat CompressedImage::getFormat() const {
+        return this->format;
+    }
+
+    UInt32 CompressedImage::getWidth() const {
+        return this->width;
+    }
+
+    UInt32 CompressedImage::getHeight() const {
+        return this->height;
+    }
+
+    UInt32 CompressedImage::getLevelCount() const {
+        return this->levelOffsets.size() > 0 ? (UInt32)this->levelOffsets.size() - 1 : 0;
+    }
+
+    UInt32 CompressedImage::getLevelWidth(UInt32 level) const {
+        UInt32 levelWidth = this->width >> level;
+        return levelWidth > 0 ? levelWidth : 1;
+    }
+
+    UInt32 CompressedImage::getLevelHeight(UInt32 level) const {
+        UInt32 levelHeight = this->height >> level;
+        return levelHeight > 0 ? levelHeight : 1;
+    }
+
+    UInt64 CompressedImage::getLevelSizeBytes(UInt32 level) const {
+        if (level >= this->getLevelCount()) {
+            throw OutOfRangeException("CompressedImage::getLevelSizeBytes() -> [level] is out of range.");
+        }
+        return this->levelOffsets[level + 1] - this->levelOffsets[level];
+    }
+
+    Byte* CompressedImage::getLevelData(UInt32 level) {
+        if (level >= this->getLevelCount()) {
+            throw OutOfRangeException("CompressedImage::getLevelData() -> [level] is out of range.");
+        }
+        return this->data.data() + this->levelOffsets[level];
+    }
+
+    const Byte* CompressedImage::getLevelData(UInt32 level) const {
+        if (level >= this->getLevelCount()) {
+            throw OutOfRangeException("CompressedImage::getLevelData() -> [level] is out of range.");
+        }
+        return this->data.data() + this->levelOffsets[level];
+    }
+
+    UInt64 CompressedImage::imageSizeBytes() const {
+        return this->data.size();
+    }
+
+    Bool CompressedImage::isCompressedFormat(TextureFormat format) {
+        return CompressedImage::getBlockSizeBytes(format) > 0;
+    }
+
+    /*
+     * Bytes per 4x4 block of [format], or 0 if it isn't block-compressed.
+     */
+    UInt32 CompressedImage::getBlockSizeBytes(TextureFormat format) {
+        switch (format) {
+            case TextureFormat::BC1:
+            case TextureFormat::BC4:
+                return 8;
+            case TextureFormat::BC3:
+            case TextureFormat::BC5:
+            case TextureFormat::BC7:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    UInt64 CompressedImage::calcLevelSizeBytes(TextureFormat format, UInt32 width, UInt32 height) {
+        UInt64 blocksX = (width + BlockDimension - 1) / BlockDimension;
+        UInt64 blocksY = (height + BlockDimension - 1) / BlockDimension;
+        return blocksX * blocksY * CompressedImage::getBlockSizeBytes(format);
+    }
+}
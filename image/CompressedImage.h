@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+#include "../common/Exception.h"
+#include "TextureAttr.h"
+
+namespace Core {
+
+    /*
+     * Pixel data in one of the block-compressed texture formats (BC1, BC3, BC4, BC5, BC7), ready
+     * to be sent to the GPU as is. Every format encodes 4x4 pixel blocks into a fixed number of
+     * bytes; levels whose size is not a multiple of 4 are padded out to whole blocks. Level 0 is
+     * the full-size image and each further level is a mip level half the size of the one before.
+     */
+    class CompressedImage {
+    public:
+        CompressedImage(TextureFormat format, UInt32 width, UInt32 height);
+
+        void init(UInt32 levelCount);
+
+        TextureFormat getFormat() const;
+        UInt32 getWidth() const;
+        UInt32 getHeight() const;
+        UInt32 getLevelCount() const;
+        UInt32 getLevelWidth(UInt32 level) const;
+        UInt32 getLevelHeight(UInt32 level) const;
+        UInt64 getLevelSizeBytes(UInt32 level) const;
+        Byte* getLevelData(UInt32 level);
+        const Byte* getLevelData(UInt32 level) const;
+        UInt64 imageSizeBytes() const;
+
+        static Bool isCompressedFormat(TextureFormat format);
+        static UInt32 getBlockSizeBytes(TextureFormat format);
+        static UInt64 calcLevelSizeBytes(TextureFormat format, UInt32 width, UInt32 height);
+
+        static const UInt32 BlockDimension = 4;
+
+    private:
+        TextureFormat format;
+        UInt32 width;
+        UInt32 height;
+        std::vector<UInt64> levelOffsets;
+        std::vector<Byte> data;
+    };
+}
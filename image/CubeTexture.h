@@ -2,6 +2,7 @@
 
 #include "../util/WeakPointer.h"
 #include "RawImage.h"
+#include "CompressedImage.h"
 #include "Texture.h"
 
 namespace Core {
@@ -15,6 +16,9 @@ namespace Core {
         virtual void buildFromImages(WeakPointer<HDRImage> front, WeakPointer<HDRImage> back, 
                                      WeakPointer<HDRImage> top, WeakPointer<HDRImage> bottom, 
                                      WeakPointer<HDRImage> left, WeakPointer<HDRImage> right) = 0;
+        virtual void buildFromCompressedImages(WeakPointer<CompressedImage> front, WeakPointer<CompressedImage> back,
+                                               WeakPointer<CompressedImage> top, WeakPointer<CompressedImage> bottom,
+                                               WeakPointer<CompressedImage> left, WeakPointer<CompressedImage> right) = 0;
     protected:
         CubeTexture(const TextureAttributes& attributes);
     };
@@ -1,13 +1,17 @@
+#include <cstring>
+
 #include <IL/il.h>
 
 #include "ImageLoader.h"
 #include "RawImage.h"
+#include "PNGLoader.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "STBImage.h"
 
 namespace Core {
 
     Bool ImageLoader::initialized = false;
+    std::mutex ImageLoader::decodeMutex;
 
     Bool ImageLoader::initialize() {
         if (!ImageLoader::initialized) {
@@ -29,7 +33,78 @@ namespace Core {
         return loadImageU(fullPath, false);
     }
 
+    /*
+     * Formats stb_image can read (PNG, JPEG, TGA, BMP, PSD, GIF, HDR, PIC, PNM) are decoded with
+     * decodeImageU(), which any number of threads can run at once. Everything else goes through
+     * DevIL, which keeps the bound image and the origin setting in global state, so those decodes
+     * are serialized. Either way it is safe to load images from several threads at once.
+     */
     std::shared_ptr<StandardImage> ImageLoader::loadImageU(const std::string& fullPath, Bool reverseOrigin) {
+        UInt32 width, height;
+        if (!getImageDimensions(fullPath, width, height)) {
+            return loadImageUDevIL(fullPath, reverseOrigin);
+        }
+
+        StandardImage * rawImagePtr = new(std::nothrow) StandardImage(width, height);
+        if (rawImagePtr == nullptr) throw ImageLoaderException("ImageLoader::loadImageU -> Could not allocate StandardImage.");
+
+        std::shared_ptr<StandardImage> rawImage(rawImagePtr);
+        rawImage->init();
+        decodeImageU(fullPath, *rawImage, reverseOrigin);
+        return rawImage;
+    }
+
+    /*
+     * Read the size of the image at [fullPath] from its header. Returns false if stb_image does not
+     * recognize the format, in which case decodeImageU() can't decode it either.
+     */
+    Bool ImageLoader::getImageDimensions(const std::string& fullPath, UInt32& width, UInt32& height) {
+        int imageWidth, imageHeight, components;
+        if (!stbi_info(fullPath.c_str(), &imageWidth, &imageHeight, &components)) return false;
+        width = (UInt32)imageWidth;
+        height = (UInt32)imageHeight;
+        return true;
+    }
+
+    /*
+     * Decode the image at [fullPath] as RGBA into [image], which must already be initialized with
+     * the size getImageDimensions() reports. PNGs are decoded by libpng straight into the image's
+     * pixel data; other formats are decoded by stb_image and copied over once. Rows are stored
+     * bottom row first unless [reverseOrigin] is set, matching loadImageU(). Touches no shared
+     * state, so it can run on many threads at once.
+     */
+    void ImageLoader::decodeImageU(const std::string& fullPath, StandardImage& image, Bool reverseOrigin) {
+        if (image.getImageData() == nullptr) {
+            throw ImageLoaderException("ImageLoader::decodeImageU -> Target image is not initialized.");
+        }
+
+        if (PNGLoader::isPNG(fullPath)) {
+            PNGLoader::decodePNG(fullPath, image, reverseOrigin);
+            return;
+        }
+
+        int width, height, components;
+        stbi_uc* data = stbi_load(fullPath.c_str(), &width, &height, &components, 4);
+        if (data == nullptr) {
+            std::string msg("ImageLoader::decodeImageU -> Could not decode image: ");
+            msg = msg + fullPath + " (" + stbi_failure_reason() + ")";
+            throw ImageLoaderException(msg);
+        }
+        if ((UInt32)width != image.getWidth() || (UInt32)height != image.getHeight()) {
+            stbi_image_free(data);
+            throw ImageLoaderException("ImageLoader::decodeImageU -> Image size does not match the target image: " + fullPath);
+        }
+
+        UInt32 rowSize = image.calcRowSizeBytes();
+        for (UInt32 y = 0; y < (UInt32)height; y++) {
+            UInt32 targetRow = reverseOrigin ? y : height - y - 1;
+            memcpy(image.calcOffsetLocationBytes(0, targetRow), data + y * rowSize, rowSize);
+        }
+        stbi_image_free(data);
+    }
+
+    std::shared_ptr<StandardImage> ImageLoader::loadImageUDevIL(const std::string& fullPath, Bool reverseOrigin) {
+        std::lock_guard<std::mutex> lock(ImageLoader::decodeMutex);
         Bool initializeSuccess = initialize();
 
         if (!initializeSuccess) {
@@ -84,17 +159,13 @@ namespace Core {
         return loadImageHDR(fullPath, false);
     }
 
+    /*
+     * stb_image's own flip setting is global, so rows are flipped while converting instead, which
+     * leaves HDR decodes free to run concurrently with each other and with decodeImageU().
+     */
     std::shared_ptr<HDRImage> ImageLoader::loadImageHDR(const std::string& fullPath, bool invertY) {
-        Bool initializeSuccess = initialize();
-
-        if (!initializeSuccess) {
-            throw ImageLoaderException("ImageLoader::loadImageHDR -> Error occurred while initializing image loader.");
-        }
-
-        stbi_set_flip_vertically_on_load(invertY);
-
         int width, height, nrComponents;
-        float *hdr_data = stbi_loadf(fullPath.c_str(), &width, &height, &nrComponents, 0);
+        float *hdr_data = stbi_loadf(fullPath.c_str(), &width, &height, &nrComponents, 3);
 
         if (hdr_data == NULL) {
             std::string msg("ImageLoader::loadImageHDR -> Could not load HDRImage: ");
@@ -103,21 +174,32 @@ namespace Core {
         }
 
         HDRImage * hdrImagePtr = new(std::nothrow) HDRImage(width, height);
-        if (hdrImagePtr == nullptr) throw ImageLoaderException("ImageLoader::loadImageHDR -> Could not allocate HDRImage.");
+        if (hdrImagePtr == nullptr) {
+            stbi_image_free(hdr_data);
+            throw ImageLoaderException("ImageLoader::loadImageHDR -> Could not allocate HDRImage.");
+        }
 
         std::shared_ptr<HDRImage> hdrImage(hdrImagePtr);
-        Bool initSuccess = hdrImage->init();
-        if (!initSuccess) {
+        try {
+            hdrImage->init();
+        }
+        catch (...) {
+            stbi_image_free(hdr_data);
             throw ImageLoaderException("ImageLoader::loadImageHDR -> Could not init HDRImage.");
         }
-        for (UInt32 i = 0; i < width * height; i++) {
-            UInt32 baseIndex = i * 4;
-            UInt32 baseHDRIndex = i * 3;
-            hdrImage->setElement(baseIndex, hdr_data[baseHDRIndex]);
-            hdrImage->setElement(baseIndex + 1, hdr_data[baseHDRIndex + 1]);
-            hdrImage->setElement(baseIndex + 2, hdr_data[baseHDRIndex + 2]);
-            hdrImage->setElement(baseIndex + 3, 1.0f);
+
+        for (UInt32 y = 0; y < (UInt32)height; y++) {
+            UInt32 sourceRow = invertY ? height - y - 1 : y;
+            const float* source = hdr_data + sourceRow * width * 3;
+            Real* target = hdrImage->calcOffsetLocationElements(0, y);
+            for (UInt32 x = 0; x < (UInt32)width; x++) {
+                target[x * 4] = source[x * 3];
+                target[x * 4 + 1] = source[x * 3 + 1];
+                target[x * 4 + 2] = source[x * 3 + 2];
+                target[x * 4 + 3] = 1.0f;
+            }
         }
+        stbi_image_free(hdr_data);
 
         return hdrImage;
     }
@@ -135,9 +217,7 @@ namespace Core {
             throw ImageLoaderException("ImageLoader::getStandardImageFromILData -> Could not init StandardImage.");
         }
 
-        for (UInt32 i = 0; i < width * height * 4; i++) {
-            rawImage->setElement(i, (Byte)data[i]);
-        }
+        memcpy(rawImage->getImageData(), data, rawImage->imageSizeBytes());
 
         return rawImage;
     }
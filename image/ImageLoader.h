@@ -2,6 +2,7 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
 
 #ifdef CORE_USE_PRIVATE_INCLUDES
 #include <IL/il.h>
@@ -31,11 +32,15 @@ namespace Core {
         static std::shared_ptr<StandardImage> loadImageU(const std::string& fullPath, Bool reverseOrigin);
         static std::shared_ptr<HDRImage> loadImageHDR(const std::string& fullPath);
         static std::shared_ptr<HDRImage> loadImageHDR(const std::string& fullPath, Bool reverseOrigin);
+        static Bool getImageDimensions(const std::string& fullPath, UInt32& width, UInt32& height);
+        static void decodeImageU(const std::string& fullPath, StandardImage& image, Bool reverseOrigin);
         static std::string getFileExtension(const std::string& filePath);
     
     private:
         static Bool initialized;
+        static std::mutex decodeMutex;
         static Bool initialize();
+        static std::shared_ptr<StandardImage> loadImageUDevIL(const std::string& fullPath, Bool reverseOrigin);
 #ifdef CORE_USE_PRIVATE_INCLUDES
         static std::shared_ptr<StandardImage> getStandardImageFromILData(const ILubyte * data, UInt32 width, UInt32 height);
 #endif
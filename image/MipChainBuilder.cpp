@@ -0,0 +1,304 @@
+#include <cmath>
+#include <functional>
+#include <new>
+
+#include "MipChainBuilder.h"
+#include "../util/ThreadPool.h"
+
+// SIMD paths are only used for single-precision pixels; everything else takes the scalar code
+#if !defined(_Real_DoublePrecision_) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define CORE_MIP_CHAIN_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Core {
+
+    static const Real Pi = 3.14159265358979f;
+    static const Real KaiserAlpha = 4.0f;
+
+    // for every pixel of a resampled row or column, the source pixels it is made of and their
+    // weights. each pixel has [tapCount] taps; source indices are already clamped to the edge
+    class ResampleTaps {
+    public:
+        UInt32 tapCount;
+        std::vector<UInt32> sourceIndices;
+        std::vector<Real> weights;
+    };
+
+    // conversion between 8-bit sRGB and linear values
+    class SRGBTables {
+    public:
+        Real toLinear[256];
+        // the linear value halfway between each pair of adjacent 8-bit values
+        Real thresholds[255];
+
+        SRGBTables() {
+            for (UInt32 i = 0; i < 256; i++) {
+                Real value = (Real)i / 255.0f;
+                this->toLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            }
+            for (UInt32 i = 0; i < 255; i++) this->thresholds[i] = (this->toLinear[i] + this->toLinear[i + 1]) * 0.5f;
+        }
+
+        Byte fromLinear(Real value) const {
+            UInt32 low = 0, high = 255;
+            while (low < high) {
+                UInt32 middle = (low + high) / 2;
+                if (value < this->thresholds[middle]) high = middle;
+                else low = middle + 1;
+            }
+            return (Byte)low;
+        }
+    };
+
+    static const SRGBTables& getSRGBTables() {
+        static const SRGBTables tables;
+        return tables;
+    }
+
+    static void forEachRow(UInt32 rowCount, ThreadPool* threadPool, const std::function<void(UInt32)>& func) {
+        if (threadPool != nullptr) {
+            threadPool->parallelFor(rowCount, func);
+        }
+        else {
+            for (UInt32 row = 0; row < rowCount; row++) func(row);
+        }
+    }
+
+    static Real sinc(Real x) {
+        if (std::fabs(x) < 1.0e-6f) return 1.0f;
+        return std::sin(Pi * x) / (Pi * x);
+    }
+
+    // modified Bessel function of the first kind, order 0
+    static Real besselI0(Real x) {
+        Real sum = 1.0f, term = 1.0f;
+        for (UInt32 k = 1; k < 32; k++) {
+            Real factor = x / (2.0f * (Real)k);
+            term *= factor * factor;
+            sum += term;
+            if (term < sum * 1.0e-8f) break;
+        }
+        return sum;
+    }
+
+    static Real getFilterSupport(MipChainBuilder::Filter filter) {
+        return filter == MipChainBuilder::Filter::Box ? 0.5f : 3.0f;
+    }
+
+    /*
+     * Weight of a source pixel [x] target pixels away from the center of a target pixel.
+     */
+    static Real evaluateFilter(MipChainBuilder::Filter filter, Real x) {
+        Real support = getFilterSupport(filter);
+        Real distance = std::fabs(x);
+        if (distance >= support) return 0.0f;
+        switch (filter) {
+            case MipChainBuilder::Filter::Box:
+                return 1.0f;
+            case MipChainBuilder::Filter::Kaiser: {
+                Real t = distance / support;
+                return sinc(x) * besselI0(KaiserAlpha * std::sqrt(1.0f - t * t)) / besselI0(KaiserAlpha);
+            }
+            case MipChainBuilder::Filter::Lanczos:
+                return sinc(x) * sinc(x / support);
+        }
+        return 0.0f;
+    }
+
+    static void buildTaps(UInt32 sourceSize, UInt32 targetSize, MipChainBuilder::Filter filter, ResampleTaps& taps) {
+        Real scale = (Real)sourceSize / (Real)targetSize;
+        Real radius = getFilterSupport(filter) * scale;
+        taps.tapCount = (UInt32)std::ceil(radius) * 2 + 2;
+        taps.sourceIndices.assign(targetSize * taps.tapCount, 0);
+        taps.weights.assign(targetSize * taps.tapCount, 0.0f);
+
+        for (UInt32 i = 0; i < targetSize; i++) {
+            Real center = ((Real)i + 0.5f) * scale;
+            Int32 first = (Int32)std::floor(center - radius);
+            Real total = 0.0f;
+            for (UInt32 t = 0; t < taps.tapCount; t++) {
+                Int32 source = first + (Int32)t;
+                Real weight = evaluateFilter(filter, ((Real)source + 0.5f - center) / scale);
+                Int32 clamped = source < 0 ? 0 : (source >= (Int32)sourceSize ? (Int32)sourceSize - 1 : source);
+                taps.sourceIndices[i * taps.tapCount + t] = (UInt32)clamped;
+                taps.weights[i * taps.tapCount + t] = weight;
+                total += weight;
+            }
+            if (total != 0.0f) {
+                for (UInt32 t = 0; t < taps.tapCount; t++) taps.weights[i * taps.tapCount + t] /= total;
+            }
+        }
+    }
+
+    /*
+     * Resample the RGBA pixels in [source] ([width] x [height]) to [targetWidth] x [targetHeight]
+     * in [target], filtering rows first and then columns.
+     */
+    static void resampleLevel(const std::vector<Real>& source, UInt32 width, UInt32 height, std::vector<Real>& target,
+                              UInt32 targetWidth, UInt32 targetHeight, MipChainBuilder::Filter filter, ThreadPool* threadPool) {
+        ResampleTaps horizontalTaps, verticalTaps;
+        buildTaps(width, targetWidth, filter, horizontalTaps);
+        buildTaps(height, targetHeight, filter, verticalTaps);
+
+        std::vector<Real> rows((UInt64)targetWidth * height * 4);
+        forEachRow(height, threadPool, [&source, &rows, &horizontalTaps, width, targetWidth](UInt32 y) {
+            const Real* sourceRow = source.data() + (UInt64)y * width * 4;
+            Real* targetRow = rows.data() + (UInt64)y * targetWidth * 4;
+            for (UInt32 x = 0; x < targetWidth; x++) {
+                const UInt32* indices = horizontalTaps.sourceIndices.data() + x * horizontalTaps.tapCount;
+                const Real* weights = horizontalTaps.weights.data() + x * horizontalTaps.tapCount;
+#if defined(CORE_MIP_CHAIN_SSE)
+                __m128 sum = _mm_setzero_ps();
+                for (UInt32 t = 0; t < horizontalTaps.tapCount; t++) {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(sourceRow + indices[t] * 4)));
+                }
+                _mm_storeu_ps(targetRow + x * 4, sum);
+#else
+                Real sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                for (UInt32 t = 0; t < horizontalTaps.tapCount; t++) {
+                    const Real* pixel = sourceRow + indices[t] * 4;
+                    for (UInt32 c = 0; c < 4; c++) sum[c] += weights[t] * pixel[c];
+                }
+                for (UInt32 c = 0; c < 4; c++) targetRow[x * 4 + c] = sum[c];
+#endif
+            }
+        });
+
+        target.assign((UInt64)targetWidth * targetHeight * 4, 0.0f);
+        forEachRow(targetHeight, threadPool, [&rows, &target, &verticalTaps, targetWidth](UInt32 y) {
+            const UInt32* indices = verticalTaps.sourceIndices.data() + y * verticalTaps.tapCount;
+            const Real* weights = verticalTaps.weights.data() + y * verticalTaps.tapCount;
+            Real* targetRow = target.data() + (UInt64)y * targetWidth * 4;
+            UInt32 elementCount = targetWidth * 4;
+            for (UInt32 t = 0; t < verticalTaps.tapCount; t++) {
+                if (weights[t] == 0.0f) continue;
+                const Real* sourceRow = rows.data() + (UInt64)indices[t] * elementCount;
+                UInt32 e = 0;
+#if defined(CORE_MIP_CHAIN_SSE)
+                __m128 weight = _mm_set1_ps(weights[t]);
+                for (; e + 4 <= elementCount; e += 4) {
+                    _mm_storeu_ps(targetRow + e, _mm_add_ps(_mm_loadu_ps(targetRow + e), _mm_mul_ps(weight, _mm_loadu_ps(sourceRow + e))));
+                }
+#endif
+                for (; e < elementCount; e++) targetRow[e] += weights[t] * sourceRow[e];
+            }
+            // the negative lobes of the sharper filters can overshoot
+            for (UInt32 e = 0; e < elementCount; e++) {
+                targetRow[e] = targetRow[e] < 0.0f ? 0.0f : (targetRow[e] > 1.0f ? 1.0f : targetRow[e]);
+            }
+        });
+    }
+
+    static Real calculateAlphaCoverage(const std::vector<Real>& pixels, Real cutoff, Real scale) {
+        UInt64 pixelCount = pixels.size() / 4;
+        if (pixelCount == 0) return 0.0f;
+        UInt64 covered = 0;
+        for (UInt64 p = 0; p < pixelCount; p++) {
+            if (pixels[p * 4 + 3] * scale >= cutoff) covered++;
+        }
+        return (Real)covered / (Real)pixelCount;
+    }
+
+    /*
+     * Find the factor to scale the alpha of [pixels] by so that the fraction of them at or above
+     * [cutoff] is as close as possible to [coverage].
+     */
+    static Real findAlphaScale(const std::vector<Real>& pixels, Real cutoff, Real coverage) {
+        Real low = 0.0f, high = 4.0f;
+        for (UInt32 i = 0; i < 12; i++) {
+            Real scale = (low + high) * 0.5f;
+            if (calculateAlphaCoverage(pixels, cutoff, scale) < coverage) low = scale;
+            else high = scale;
+        }
+        // coverage is a step function of the scale, so the closer of the two sides of the step wins
+        Real lowError = std::fabs(calculateAlphaCoverage(pixels, cutoff, low) - coverage);
+        Real highError = std::fabs(calculateAlphaCoverage(pixels, cutoff, high) - coverage);
+        return lowError < highError ? low : high;
+    }
+
+    static std::shared_ptr<StandardImage> encodeLevel(const std::vector<Real>& pixels, UInt32 width, UInt32 height, Bool sRGB,
+                                                      Real alphaScale, ThreadPool* threadPool) {
+        StandardImage* levelPtr = new(std::nothrow) StandardImage(width, height);
+        if (levelPtr == nullptr) {
+            throw AllocationException("MipChainBuilder::buildMipChain -> Unable to allocate mip level.");
+        }
+        std::shared_ptr<StandardImage> level(levelPtr);
+        level->init();
+
+        const SRGBTables& tables = getSRGBTables();
+        forEachRow(height, threadPool, [&pixels, &level, &tables, width, sRGB, alphaScale](UInt32 y) {
+            const Real* source = pixels.data() + (UInt64)y * width * 4;
+            Byte* target = level->calcOffsetLocationBytes(0, y);
+            for (UInt32 x = 0; x < width * 4; x += 4) {
+                for (UInt32 c = 0; c < 3; c++) {
+                    target[x + c] = sRGB ? tables.fromLinear(source[x + c]) : (Byte)(source[x + c] * 255.0f + 0.5f);
+                }
+                Real alpha = source[x + 3] * alphaScale;
+                target[x + 3] = (Byte)((alpha > 1.0f ? 1.0f : alpha) * 255.0f + 0.5f);
+            }
+        });
+        return level;
+    }
+
+    MipChainBuilder::Settings::Settings(): filter(Filter::Kaiser), sRGB(false), preserveAlphaCoverage(false), alphaCutoff(0.5f), maxLevels(0) {
+
+    }
+
+    /*
+     * Build the mip levels below [image]: the first returned image is half its size, the last one
+     * either 1x1 or level [settings].maxLevels - 1.
+     */
+    std::vector<std::shared_ptr<StandardImage>> MipChainBuilder::buildMipChain(const StandardImage& image, const Settings& settings, ThreadPool* threadPool) {
+        std::vector<std::shared_ptr<StandardImage>> levels;
+        UInt32 width = image.getWidth();
+        UInt32 height = image.getHeight();
+        UInt32 levelCount = MipChainBuilder::getFullChainLevelCount(width, height);
+        if (settings.maxLevels > 0 && settings.maxLevels < levelCount) levelCount = settings.maxLevels;
+        if (levelCount <= 1) return levels;
+
+        const SRGBTables& tables = getSRGBTables();
+        std::vector<Real> current((UInt64)width * height * 4);
+        forEachRow(height, threadPool, [&image, &current, &tables, &settings, width](UInt32 y) {
+            const Byte* source = image.calcOffsetLocationBytes(0, y);
+            Real* target = current.data() + (UInt64)y * width * 4;
+            for (UInt32 x = 0; x < width * 4; x += 4) {
+                for (UInt32 c = 0; c < 3; c++) {
+                    target[x + c] = settings.sRGB ? tables.toLinear[source[x + c]] : (Real)source[x + c] / 255.0f;
+                }
+                target[x + 3] = (Real)source[x + 3] / 255.0f;
+            }
+        });
+
+        Real coverage = settings.preserveAlphaCoverage ? calculateAlphaCoverage(current, settings.alphaCutoff, 1.0f) : 0.0f;
+
+        std::vector<Real> next;
+        for (UInt32 level = 1; level < levelCount; level++) {
+            UInt32 nextWidth = width > 1 ? width / 2 : 1;
+            UInt32 nextHeight = height > 1 ? height / 2 : 1;
+            resampleLevel(current, width, height, next, nextWidth, nextHeight, settings.filter, threadPool);
+
+            // the scaled alpha only goes into the stored level, so the next level is still filtered from the original
+            Real alphaScale = settings.preserveAlphaCoverage ? findAlphaScale(next, settings.alphaCutoff, coverage) : 1.0f;
+            levels.push_back(encodeLevel(next, nextWidth, nextHeight, settings.sRGB, alphaScale, threadPool));
+
+            current.swap(next);
+            width = nextWidth;
+            height = nextHeight;
+        }
+        return levels;
+    }
+
+    /*
+     * Number of levels from a [width] x [height] image down to 1x1, including the image itself.
+     */
+    UInt32 MipChainBuilder::getFullChainLevelCount(UInt32 width, UInt32 height) {
+        UInt32 levelCount = 1;
+        while (width > 1 || height > 1) {
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+            levelCount++;
+        }
+        return levelCount;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "../common/types.h"
+#include "RawImage.h"
+
+namespace Core {
+
+    // forward declarations
+    class ThreadPool;
+
+    /*
+     * Builds the mip levels of an image on the CPU, as a replacement for glGenerateMipmap(),
+     * which box-filters in gamma space, differs between drivers and runs on the GL thread.
+     *
+     * Each level is resampled from the one above it, kept in linear floating point so rounding
+     * doesn't accumulate down the chain. sRGB-encoded color channels are converted to linear
+     * before filtering and back afterwards; alpha is always linear. Alpha-tested textures can
+     * keep the fraction of pixels that pass the alpha test constant across levels, so cut-out
+     * geometry doesn't thin out in the distance. Rows of each level are filtered in parallel on
+     * [threadPool] if given.
+     */
+    class MipChainBuilder {
+    public:
+        enum class Filter { Box = 0, Kaiser = 1, Lanczos = 2 };
+
+        class Settings {
+        public:
+            Settings();
+
+            Filter filter;
+            // the RGB channels hold sRGB-encoded values (e.g. albedo), not linear data (e.g. normals)
+            Bool sRGB;
+            Bool preserveAlphaCoverage;
+            Real alphaCutoff;
+            // total number of levels including the source image; 0 means down to 1x1
+            UInt32 maxLevels;
+        };
+
+        static std::vector<std::shared_ptr<StandardImage>> buildMipChain(const StandardImage& image, const Settings& settings, ThreadPool* threadPool);
+        static UInt32 getFullChainLevelCount(UInt32 width, UInt32 height);
+
+    private:
+        MipChainBuilder();
+    };
+}
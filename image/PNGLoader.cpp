@@ -1,102 +1,181 @@
+#include <cstdio>
 #include <cstring>
 #include <vector>
 
+#include "png.h"
+
 #include "PNGLoader.h"
 
 namespace Core {
 
-    std::shared_ptr<StandardImage> PNGLoader::loadPNG(const std::string& path) {
+    class PNGErrorState {
+    public:
+        char message[256];
+    };
 
-        int width, height;
-        png_byte color_type;
-        png_byte bit_depth;
-        png_bytep *row_pointers = nullptr;
+    static void onPNGError(png_structp png, png_const_charp message) {
+        PNGErrorState* errorState = (PNGErrorState*)png_get_error_ptr(png);
+        strncpy(errorState->message, message, sizeof(errorState->message) - 1);
+        png_longjmp(png, 1);
+    }
 
-        FILE *fp = fopen(path.c_str(), "rb");
+    static void onPNGWarning(png_structp png, png_const_charp message) {
+    }
 
-        png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-        if(!png) abort();
+    /*
+     * Read the PNG in [file] as 8-bit RGBA. With [rows] null only the header is read and its size
+     * stored in [width] and [height]; otherwise the size must match them and every row is decoded
+     * straight into the memory [rows] points to. libpng reports errors by longjmp-ing back here,
+     * so nothing in this function may have a destructor.
+     */
+    static Bool readPNG(FILE* file, png_bytep* rows, UInt32& width, UInt32& height, PNGErrorState& errorState) {
+        png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, &errorState, onPNGError, onPNGWarning);
+        if (!png) {
+            strncpy(errorState.message, "Could not allocate PNG read object.", sizeof(errorState.message) - 1);
+            return false;
+        }
 
         png_infop info = png_create_info_struct(png);
-        if(!info) {
-            throw PNGLoaderException("PNGLoader::loadPNG() -> Could not allocate PNG info object.");
+        if (!info) {
+            png_destroy_read_struct(&png, nullptr, nullptr);
+            strncpy(errorState.message, "Could not allocate PNG info object.", sizeof(errorState.message) - 1);
+            return false;
         }
 
-        if(setjmp(png_jmpbuf(png))) abort();
-
-        png_init_io(png, fp);
+        if (setjmp(png_jmpbuf(png))) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            return false;
+        }
 
+        png_init_io(png, file);
         png_read_info(png, info);
 
-        width      = png_get_image_width(png, info);
-        height     = png_get_image_height(png, info);
-        color_type = png_get_color_type(png, info);
-        bit_depth  = png_get_bit_depth(png, info);
+        UInt32 pngWidth = png_get_image_width(png, info);
+        UInt32 pngHeight = png_get_image_height(png, info);
+        if (rows == nullptr) {
+            width = pngWidth;
+            height = pngHeight;
+            png_destroy_read_struct(&png, &info, nullptr);
+            return true;
+        }
+        if (pngWidth != width || pngHeight != height) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            strncpy(errorState.message, "Image size does not match the target image.", sizeof(errorState.message) - 1);
+            return false;
+        }
+
+        png_byte colorType = png_get_color_type(png, info);
+        png_byte bitDepth = png_get_bit_depth(png, info);
 
         // Read any color_type into 8bit depth, RGBA format.
         // See http://www.libpng.org/pub/png/libpng-manual.txt
 
-        if(bit_depth == 16)
+        if (bitDepth == 16)
             png_set_strip_16(png);
 
-        if(color_type == PNG_COLOR_TYPE_PALETTE)
+        if (colorType == PNG_COLOR_TYPE_PALETTE)
             png_set_palette_to_rgb(png);
 
         // PNG_COLOR_TYPE_GRAY_ALPHA is always 8 or 16bit depth.
-        if(color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+        if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
             png_set_expand_gray_1_2_4_to_8(png);
 
-        if(png_get_valid(png, info, PNG_INFO_tRNS))
+        if (png_get_valid(png, info, PNG_INFO_tRNS))
             png_set_tRNS_to_alpha(png);
 
         // These color_type don't have an alpha channel then fill it with 0xff.
-        if(color_type == PNG_COLOR_TYPE_RGB ||
-            color_type == PNG_COLOR_TYPE_GRAY ||
-            color_type == PNG_COLOR_TYPE_PALETTE) {
-                png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
-            }
-
-        if(color_type == PNG_COLOR_TYPE_GRAY ||
-            color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
+        if (colorType == PNG_COLOR_TYPE_RGB ||
+            colorType == PNG_COLOR_TYPE_GRAY ||
+            colorType == PNG_COLOR_TYPE_PALETTE)
+            png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+
+        if (colorType == PNG_COLOR_TYPE_GRAY ||
+            colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
             png_set_gray_to_rgb(png);
 
+        png_set_interlace_handling(png);
         png_read_update_info(png, info);
 
-        std::vector<int> rowSizes;
-        row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * height);
-        for(int y = 0; y < height; y++) {
-            size_t rowSize = png_get_rowbytes(png,info);
-            row_pointers[y] = (png_byte*)malloc(rowSize);
-            rowSizes.push_back(rowSize);
+        if (png_get_rowbytes(png, info) != (png_size_t)width * 4) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            strncpy(errorState.message, "Unsupported PNG pixel format.", sizeof(errorState.message) - 1);
+            return false;
         }
 
-        png_read_image(png, row_pointers);
+        png_read_image(png, rows);
+        png_read_end(png, nullptr);
+        png_destroy_read_struct(&png, &info, nullptr);
+        return true;
+    }
 
-        fclose(fp);
+    Bool PNGLoader::isPNG(const std::string& path) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) return false;
+
+        png_byte signature[8];
+        Bool result = fread(signature, 1, sizeof(signature), file) == sizeof(signature) && png_sig_cmp(signature, 0, sizeof(signature)) == 0;
+        fclose(file);
+        return result;
+    }
+
+    std::shared_ptr<StandardImage> PNGLoader::loadPNG(const std::string& path) {
+        return loadPNG(path, false);
+    }
+
+    std::shared_ptr<StandardImage> PNGLoader::loadPNG(const std::string& path, Bool reverseOrigin) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            throw PNGLoaderException("PNGLoader::loadPNG() -> Could not open file: " + path);
+        }
+
+        UInt32 width = 0, height = 0;
+        PNGErrorState errorState = {};
+        Bool success = readPNG(file, nullptr, width, height, errorState);
+        fclose(file);
+        if (!success) {
+            throw PNGLoaderException(std::string("PNGLoader::loadPNG() -> ") + errorState.message + " (" + path + ")");
+        }
 
         StandardImage * rawPNG = new(std::nothrow) StandardImage(width, height);
         if (rawPNG == nullptr) {
             throw PNGLoaderException("PNGLoader::loadPNG() -> Could not allocate StandardImage object.");
         }
-        rawPNG->init();
         std::shared_ptr<StandardImage> pngPtr = std::shared_ptr<StandardImage>(rawPNG);
+        rawPNG->init();
 
-        Byte * rawData = rawPNG->getImageData();
+        decodePNG(path, *rawPNG, reverseOrigin);
+        return pngPtr;
+    }
 
-        UInt32 index = 0;
-        for(int y = 0; y < height; y++) {
-            UInt32 targetIndex = height - y - 1;
-            size_t rowSize = rowSizes[targetIndex];
-            memcpy(rawData + index, row_pointers[targetIndex], rowSize);
-            index += rowSize;
+    /*
+     * Decode the PNG at [path] into [image], which must already be initialized with the size of
+     * the PNG. Rows are written straight into the image's pixel data, bottom row first unless
+     * [reverseOrigin] is set. Uses no global state, so any number of threads can decode at once.
+     */
+    void PNGLoader::decodePNG(const std::string& path, StandardImage& image, Bool reverseOrigin) {
+        if (image.getImageData() == nullptr || image.getWidth() == 0 || image.getHeight() == 0) {
+            throw PNGLoaderException("PNGLoader::decodePNG() -> Target image is not initialized.");
         }
 
-        for(int y = 0; y < height; y++) {
-            free(row_pointers[y]);
+        UInt32 width = image.getWidth();
+        UInt32 height = image.getHeight();
+        std::vector<png_bytep> rows(height);
+        for (UInt32 y = 0; y < height; y++) {
+            UInt32 targetRow = reverseOrigin ? y : height - y - 1;
+            rows[y] = image.calcOffsetLocationBytes(0, targetRow);
         }
-        free(row_pointers);      
 
-        return pngPtr;
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            throw PNGLoaderException("PNGLoader::decodePNG() -> Could not open file: " + path);
+        }
+
+        PNGErrorState errorState = {};
+        Bool success = readPNG(file, rows.data(), width, height, errorState);
+        fclose(file);
+        if (!success) {
+            throw PNGLoaderException(std::string("PNGLoader::decodePNG() -> ") + errorState.message + " (" + path + ")");
+        }
     }
 
-}
\ No newline at end of file
+}
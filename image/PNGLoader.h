@@ -3,8 +3,6 @@
 #include <string>
 #include <memory>
 
-#include "png.h"
-
 #include "../common/types.h"
 #include "../common/Exception.h"
 #include "RawImage.h"
@@ -20,7 +18,10 @@ namespace Core {
             PNGLoaderException(const char* msg): Exception(msg) {}
         };
 
+        static Bool isPNG(const std::string& path);
         static std::shared_ptr<StandardImage> loadPNG(const std::string& path);
+        static std::shared_ptr<StandardImage> loadPNG(const std::string& path, Bool reverseOrigin);
+        static void decodePNG(const std::string& path, StandardImage& image, Bool reverseOrigin);
 
     };
 
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../common/types.h"
+
+namespace Core {
+
+    /*
+     * Texture data that was copied into memory the GPU can upload from directly (see
+     * Graphics::stageTextureData()), so uploading it later doesn't stall on a copy. The memory is
+     * handed back once the data has been uploaded, or when the object is destroyed without it.
+     */
+    class StagedTextureData {
+    public:
+        virtual ~StagedTextureData() {}
+
+        UInt64 getSize() const {
+            return this->size;
+        }
+
+    protected:
+        StagedTextureData(UInt64 size): size(size) {}
+
+        UInt64 size;
+    };
+}
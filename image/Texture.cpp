@@ -16,6 +16,10 @@ namespace Core {
         return this->textureId;
     }
 
+    const TextureAttributes& Texture::getAttributes() const {
+        return this->attributes;
+    }
+
     Bool Texture::isBuilt() const {
         return this->textureId > 0;
     }
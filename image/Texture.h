@@ -19,6 +19,7 @@ namespace Core {
 
         virtual ~Texture();
         Int32 getTextureID() const;
+        const TextureAttributes& getAttributes() const;
         Bool isBuilt() const;
         virtual void buildEmpty(UInt32 width, UInt32 height) = 0;
         virtual void updateMipMaps() = 0;
@@ -4,7 +4,8 @@
 
 namespace Core {
 
-    Texture2D::Texture2D(const TextureAttributes& attributes): Texture(attributes) {
+    Texture2D::Texture2D(const TextureAttributes& attributes): Texture(attributes), streamed(false), streamedWidth(0), streamedHeight(0),
+                                                                streamedLevelCount(0), firstAllocatedLevel(0), firstLoadedLevel(0) {
 
     }
 
@@ -12,4 +13,31 @@ namespace Core {
 
     }
 
+    Bool Texture2D::isStreamed() const {
+        return this->streamed;
+    }
+
+    UInt32 Texture2D::getStreamedWidth() const {
+        return this->streamedWidth;
+    }
+
+    UInt32 Texture2D::getStreamedHeight() const {
+        return this->streamedHeight;
+    }
+
+    UInt32 Texture2D::getStreamedLevelCount() const {
+        return this->streamedLevelCount;
+    }
+
+    UInt32 Texture2D::getFirstAllocatedLevel() const {
+        return this->firstAllocatedLevel;
+    }
+
+    /*
+     * The finest level that holds data; equal to getStreamedLevelCount() while none do.
+     */
+    UInt32 Texture2D::getFirstLoadedLevel() const {
+        return this->firstLoadedLevel;
+    }
+
 };
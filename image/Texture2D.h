@@ -1,20 +1,56 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "../util/WeakPointer.h"
 #include "Texture.h"
 #include "../image/RawImage.h"
+#include "../image/CompressedImage.h"
+#include "../image/StagedTextureData.h"
 
 namespace Core {
 
     class Texture2D: public Texture {
     public:
+        // the data of one mip level, laid out the way the texture's format stores it
+        class LevelData {
+        public:
+            UInt32 level;
+            UInt32 width;
+            UInt32 height;
+            std::vector<Byte> data;
+            // if set, [data] was already copied into upload memory and has been released
+            std::shared_ptr<StagedTextureData> staged;
+        };
+
         virtual ~Texture2D();
         virtual void buildFromImage(WeakPointer<StandardImage> imageData) = 0;
         virtual void buildFromImage(WeakPointer<HDRImage> imageData) = 0;
+        virtual void buildFromCompressedImage(WeakPointer<CompressedImage> imageData) = 0;
+        virtual void buildFromMipChain(WeakPointer<StandardImage> imageData, const std::vector<std::shared_ptr<StandardImage>>& mipLevels) = 0;
+        virtual void buildFromLevels(const std::vector<LevelData>& levels) = 0;
+
+        virtual void buildStreamed(UInt32 width, UInt32 height, UInt32 levelCount, UInt32 firstAllocatedLevel) = 0;
+        virtual void allocateStreamedLevels(UInt32 firstLevel) = 0;
+        virtual void uploadStreamedLevel(const LevelData& levelData) = 0;
+        Bool isStreamed() const;
+        UInt32 getStreamedWidth() const;
+        UInt32 getStreamedHeight() const;
+        UInt32 getStreamedLevelCount() const;
+        UInt32 getFirstAllocatedLevel() const;
+        UInt32 getFirstLoadedLevel() const;
 
     protected:
         Texture2D(const TextureAttributes& attributes);
+
+        // mip streaming: of the [streamedLevelCount] levels of a [streamedWidth] x [streamedHeight] image,
+        // storage exists for the ones from [firstAllocatedLevel] down and data for the ones from [firstLoadedLevel] down
+        Bool streamed;
+        UInt32 streamedWidth;
+        UInt32 streamedHeight;
+        UInt32 streamedLevelCount;
+        UInt32 firstAllocatedLevel;
+        UInt32 firstLoadedLevel;
     };
 }
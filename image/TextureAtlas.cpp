@@ -0,0 +1,187 @@
+#include <string.h>
+
+#include "TextureAtlas.h"
+#include "../common/Exception.h"
+#include "../util/ThreadPool.h"
+
+namespace Core {
+
+    const UInt32 TextureAtlas::DefaultMaxSize;
+
+    /*
+     * Index into a [size] texels long row or column of a mirror-wrapped texture for [index], which may lie
+     * up to [size] texels outside of it on either side.
+     */
+    static Int32 mirrorIndex(Int32 index, Int32 size) {
+        if (index < 0) return -index - 1;
+        if (index >= size) return 2 * size - index - 1;
+        return index;
+    }
+
+    TextureAtlas::Region::Region(): uOffset(0.0f), vOffset(0.0f), uScale(1.0f), vScale(1.0f) {
+
+    }
+
+    TextureAtlas::Region::Region(Real uOffset, Real vOffset, Real uScale, Real vScale): uOffset(uOffset), vOffset(vOffset), uScale(uScale), vScale(vScale) {
+
+    }
+
+    /*
+     * Whether the region covers a whole texture, i.e. the texture isn't packed into an atlas.
+     */
+    Bool TextureAtlas::Region::isWhole() const {
+        return this->uOffset == 0.0f && this->vOffset == 0.0f && this->uScale == 1.0f && this->vScale == 1.0f;
+    }
+
+    /*
+     * Create an empty atlas with [levelCount] mip levels that grows up to [maxSize] x [maxSize] texels.
+     */
+    TextureAtlas::TextureAtlas(UInt32 maxSize, UInt32 levelCount): width(0), height(0) {
+        this->levelCount = levelCount > 0 ? levelCount : 1;
+        this->gutter = 1 << (this->levelCount - 1);
+        this->maxSize = maxSize / this->gutter * this->gutter;
+    }
+
+    /*
+     * Whether [image] with the levels below it in [mipLevels] could be packed into an atlas like this one
+     * if it were empty: it must have at least as many levels as the atlas, and be a multiple of the gutter
+     * width in size so every level places exactly.
+     */
+    Bool TextureAtlas::canHold(const StandardImage& image, const std::vector<std::shared_ptr<StandardImage>>& mipLevels) const {
+        UInt32 imageWidth = image.getWidth();
+        UInt32 imageHeight = image.getHeight();
+        if (imageWidth == 0 || imageHeight == 0 || imageWidth % this->gutter != 0 || imageHeight % this->gutter != 0) return false;
+        if (imageWidth + 2 * this->gutter > this->maxSize || imageHeight + 2 * this->gutter > this->maxSize) return false;
+        if (mipLevels.size() + 1 < this->levelCount) return false;
+        for (UInt32 level = 1; level < this->levelCount; level++) {
+            const StandardImage& levelImage = *mipLevels[level - 1];
+            if (levelImage.getWidth() != imageWidth >> level || levelImage.getHeight() != imageHeight >> level) return false;
+        }
+        return true;
+    }
+
+    /*
+     * Find a place for [image] and its [mipLevels] and return its index in [entry]. Entries are placed on
+     * shelves, on the lowest one they fit on or on a new one; adding them tallest first packs best. Returns
+     * false if the image can't be packed or there is no room left.
+     */
+    Bool TextureAtlas::add(std::shared_ptr<StandardImage> image, const std::vector<std::shared_ptr<StandardImage>>& mipLevels, UInt32& entry) {
+        if (!image || !this->canHold(*image, mipLevels)) return false;
+        if (this->image) {
+            throw Exception("TextureAtlas::add -> The atlas has already been built.");
+        }
+
+        UInt32 paddedWidth = image->getWidth() + 2 * this->gutter;
+        UInt32 paddedHeight = image->getHeight() + 2 * this->gutter;
+        Shelf* shelf = nullptr;
+        for (Shelf& candidate : this->shelves) {
+            if (candidate.height >= paddedHeight && candidate.nextX + paddedWidth <= this->maxSize) {
+                if (shelf == nullptr || candidate.height < shelf->height) shelf = &candidate;
+            }
+        }
+        if (shelf == nullptr) {
+            if (this->height + paddedHeight > this->maxSize) return false;
+            this->shelves.push_back({this->height, paddedHeight, 0});
+            shelf = &this->shelves.back();
+        }
+
+        Entry newEntry;
+        newEntry.x = shelf->nextX + this->gutter;
+        newEntry.y = shelf->y + this->gutter;
+        newEntry.width = image->getWidth();
+        newEntry.height = image->getHeight();
+        newEntry.levels.push_back(image);
+        newEntry.levels.insert(newEntry.levels.end(), mipLevels.begin(), mipLevels.begin() + (this->levelCount - 1));
+        shelf->nextX += paddedWidth;
+        if (shelf->nextX > this->width) this->width = shelf->nextX;
+        if (shelf->y + shelf->height > this->height) this->height = shelf->y + shelf->height;
+
+        entry = (UInt32)this->entries.size();
+        this->entries.push_back(newEntry);
+        return true;
+    }
+
+    UInt32 TextureAtlas::getEntryCount() const {
+        return (UInt32)this->entries.size();
+    }
+
+    /*
+     * Put the atlas images together from the added entries, which are released afterwards. The atlas is only
+     * as large as the entries need. Entries are copied in parallel on [threadPool] if given.
+     */
+    void TextureAtlas::build(ThreadPool* threadPool) {
+        if (this->entries.size() == 0) {
+            throw Exception("TextureAtlas::build -> The atlas is empty.");
+        }
+
+        for (UInt32 level = 0; level < this->levelCount; level++) {
+            StandardImage* levelPtr = new(std::nothrow) StandardImage(this->width >> level, this->height >> level);
+            if (levelPtr == nullptr) {
+                throw AllocationException("TextureAtlas::build -> Unable to allocate atlas level.");
+            }
+            std::shared_ptr<StandardImage> levelImage(levelPtr);
+            levelImage->init();
+            // the space between shelves is never sampled, but shouldn't hold garbage either
+            memset(levelImage->getImageBytes(), 0, levelImage->imageSizeBytes());
+
+            auto copyEntry = [this, level, &levelImage](UInt32 i) {
+                this->copyEntryLevel(this->entries[i], level, *levelImage);
+            };
+            if (threadPool != nullptr) threadPool->parallelFor((UInt32)this->entries.size(), copyEntry);
+            else for (UInt32 i = 0; i < this->entries.size(); i++) copyEntry(i);
+
+            if (level == 0) this->image = levelImage;
+            else this->mipLevels.push_back(levelImage);
+        }
+
+        for (Entry& entry : this->entries) {
+            entry.levels.clear();
+        }
+    }
+
+    /*
+     * Where entry [entry] ended up; final once all entries have been added.
+     */
+    TextureAtlas::Region TextureAtlas::getRegion(UInt32 entry) const {
+        if (entry >= this->entries.size()) {
+            throw OutOfRangeException("TextureAtlas::getRegion -> Invalid entry.");
+        }
+        const Entry& atlasEntry = this->entries[entry];
+        return Region((Real)atlasEntry.x / (Real)this->width, (Real)atlasEntry.y / (Real)this->height,
+                      (Real)atlasEntry.width / (Real)this->width, (Real)atlasEntry.height / (Real)this->height);
+    }
+
+    UInt32 TextureAtlas::getLevelCount() const {
+        return this->levelCount;
+    }
+
+    std::shared_ptr<StandardImage> TextureAtlas::getImage() const {
+        return this->image;
+    }
+
+    const std::vector<std::shared_ptr<StandardImage>>& TextureAtlas::getMipLevels() const {
+        return this->mipLevels;
+    }
+
+    /*
+     * Copy [level] of [entry] into the matching atlas level [target], surrounded by its mirrored gutter.
+     */
+    void TextureAtlas::copyEntryLevel(const Entry& entry, UInt32 level, StandardImage& target) const {
+        const StandardImage& source = *entry.levels[level];
+        Int32 levelWidth = (Int32)(entry.width >> level);
+        Int32 levelHeight = (Int32)(entry.height >> level);
+        Int32 levelGutter = (Int32)(this->gutter >> level);
+        UInt32 x = entry.x >> level;
+        UInt32 y = entry.y >> level;
+
+        for (Int32 row = -levelGutter; row < levelHeight + levelGutter; row++) {
+            const Byte* sourceRow = source.calcOffsetLocationBytes(0, mirrorIndex(row, levelHeight));
+            Byte* targetRow = target.calcOffsetLocationBytes(x, (UInt32)((Int32)y + row));
+            memcpy(targetRow, sourceRow, source.calcRowSizeBytes());
+            for (Int32 column = 1; column <= levelGutter; column++) {
+                memcpy(targetRow - column * 4, sourceRow + mirrorIndex(-column, levelWidth) * 4, 4);
+                memcpy(targetRow + (levelWidth + column - 1) * 4, sourceRow + mirrorIndex(levelWidth + column - 1, levelWidth) * 4, 4);
+            }
+        }
+    }
+}
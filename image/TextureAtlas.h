@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "../common/types.h"
+#include "RawImage.h"
+
+namespace Core {
+
+    // forward declarations
+    class ThreadPool;
+
+    /*
+     * Packs many small textures of the same kind into one, so materials using them all share a
+     * texture and drawing them doesn't need a texture bind each. A material samples its part of
+     * the atlas through the Region it was packed into.
+     *
+     * Each texture is placed with its own mip chain, and every atlas level is put together from
+     * the matching levels of the textures rather than filtered as a whole, so levels don't bleed
+     * between neighbours. Around each texture is a gutter holding its edge texels mirrored, which
+     * is what filtering at the edge of a mirror-wrapped texture reads. The gutter halves with
+     * every level and is one texel wide at the last one, so an atlas with [levelCount] levels
+     * needs gutters of 2^(levelCount - 1) texels, and texture sizes and placement are multiples
+     * of that.
+     */
+    class TextureAtlas {
+    public:
+        // the part of the atlas a texture was packed into, in texture coordinates
+        class Region {
+        public:
+            Region();
+            Region(Real uOffset, Real vOffset, Real uScale, Real vScale);
+            Bool isWhole() const;
+
+            Real uOffset;
+            Real vOffset;
+            Real uScale;
+            Real vScale;
+        };
+
+        static const UInt32 DefaultMaxSize = 2048;
+
+        TextureAtlas(UInt32 maxSize, UInt32 levelCount);
+
+        Bool canHold(const StandardImage& image, const std::vector<std::shared_ptr<StandardImage>>& mipLevels) const;
+        Bool add(std::shared_ptr<StandardImage> image, const std::vector<std::shared_ptr<StandardImage>>& mipLevels, UInt32& entry);
+        UInt32 getEntryCount() const;
+        void build(ThreadPool* threadPool);
+        Region getRegion(UInt32 entry) const;
+        UInt32 getLevelCount() const;
+        std::shared_ptr<StandardImage> getImage() const;
+        const std::vector<std::shared_ptr<StandardImage>>& getMipLevels() const;
+
+    private:
+        class Entry {
+        public:
+            UInt32 x;
+            UInt32 y;
+            UInt32 width;
+            UInt32 height;
+            // level 0 followed by the levels below it; released by build()
+            std::vector<std::shared_ptr<StandardImage>> levels;
+        };
+
+        // a row of entries; entries sit side by side from the left and are at most [height] tall, gutters included
+        class Shelf {
+        public:
+            UInt32 y;
+            UInt32 height;
+            UInt32 nextX;
+        };
+
+        void copyEntryLevel(const Entry& entry, UInt32 level, StandardImage& target) const;
+
+        UInt32 maxSize;
+        UInt32 levelCount;
+        UInt32 gutter;
+        UInt32 width;
+        UInt32 height;
+        std::vector<Entry> entries;
+        std::vector<Shelf> shelves;
+        std::shared_ptr<StandardImage> image;
+        std::vector<std::shared_ptr<StandardImage>> mipLevels;
+    };
+}
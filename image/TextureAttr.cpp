@@ -14,5 +14,16 @@ namespace Core {
     TextureAttributes::~TextureAttributes() {
 
     }
+
+    Bool TextureAttributes::operator==(const TextureAttributes& other) const {
+        return MipLevels == other.MipLevels && IsDepthTexture == other.IsDepthTexture && UseAlpha == other.UseAlpha &&
+               FilterMode == other.FilterMode && WrapMode == other.WrapMode && Format == other.Format &&
+               BorderWrapColor.r == other.BorderWrapColor.r && BorderWrapColor.g == other.BorderWrapColor.g &&
+               BorderWrapColor.b == other.BorderWrapColor.b && BorderWrapColor.a == other.BorderWrapColor.a;
+    }
+
+    Bool TextureAttributes::operator!=(const TextureAttributes& other) const {
+        return !(*this == other);
+    }
     
 }
\ No newline at end of file
@@ -39,6 +39,12 @@ namespace Core {
         DEPTH16 = 7,
         DEPTH24 = 8,
         DEPTH32 = 9,
+        // block-compressed, built from a CompressedImage
+        BC1 = 10,
+        BC3 = 11,
+        BC4 = 12,
+        BC5 = 13,
+        BC7 = 14,
     };
 
     class TextureAttributes {
@@ -54,6 +60,9 @@ namespace Core {
 
         TextureAttributes();
         ~TextureAttributes();
+
+        Bool operator==(const TextureAttributes& other) const;
+        Bool operator!=(const TextureAttributes& other) const;
     };
     
 }
@@ -0,0 +1,104 @@
+#include "TextureCache.h"
+#include "Texture2D.h"
+#include "../filesys/FileSystem.h"
+
+namespace Core {
+
+    TextureCache::TextureCache() {
+
+    }
+
+    /*
+     * Look up the texture created from the file at [path] with [attributes]. If there is one,
+     * it gains a reference and is returned, otherwise the result is invalid.
+     */
+    WeakPointer<Texture2D> TextureCache::acquireTexture2D(const std::string& path, const TextureAttributes& attributes) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto result = this->entries.find(TextureCache::getCanonicalPath(path));
+        if (result == this->entries.end()) return WeakPointer<Texture2D>();
+
+        for (Entry& entry : result->second) {
+            if (entry.attributes == attributes && !entry.texture.expired()) {
+                entry.referenceCount++;
+                return entry.texture;
+            }
+        }
+        return WeakPointer<Texture2D>();
+    }
+
+    Bool TextureCache::hasTexture2D(const std::string& path, const TextureAttributes& attributes) const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto result = this->entries.find(TextureCache::getCanonicalPath(path));
+        if (result == this->entries.end()) return false;
+
+        for (const Entry& entry : result->second) {
+            if (entry.attributes == attributes && !entry.texture.expired()) return true;
+        }
+        return false;
+    }
+
+    /*
+     * Register [texture], created from the file at [path] with [attributes], with one reference
+     * held by the caller.
+     */
+    void TextureCache::addTexture2D(const std::string& path, const TextureAttributes& attributes, WeakPointer<Texture2D> texture) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        const Texture2D* key = texture.lock().get();
+        if (key == nullptr) return;
+
+        std::string canonicalPath = TextureCache::getCanonicalPath(path);
+        std::vector<Entry>& pathEntries = this->entries[canonicalPath];
+        for (UInt32 i = 0; i < pathEntries.size(); i++) {
+            // drop entries whose texture was destroyed behind the cache's back or that are replaced
+            if (pathEntries[i].texture.expired() || pathEntries[i].attributes == attributes) {
+                this->texturePaths.erase(pathEntries[i].key);
+                pathEntries.erase(pathEntries.begin() + i);
+                i--;
+            }
+        }
+
+        Entry entry;
+        entry.attributes = attributes;
+        entry.texture = texture;
+        entry.key = key;
+        entry.referenceCount = 1;
+        pathEntries.push_back(entry);
+        this->texturePaths[key] = canonicalPath;
+    }
+
+    /*
+     * Drop one reference to [texture]. Returns true if the caller should destroy the texture:
+     * either that was the last reference or the texture never came from the cache.
+     */
+    Bool TextureCache::releaseTexture2D(WeakPointer<Texture2D> texture) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        const Texture2D* key = texture.lock().get();
+        auto path = this->texturePaths.find(key);
+        if (key == nullptr || path == this->texturePaths.end()) return true;
+
+        auto result = this->entries.find(path->second);
+        if (result != this->entries.end()) {
+            std::vector<Entry>& pathEntries = result->second;
+            for (UInt32 i = 0; i < pathEntries.size(); i++) {
+                Entry& entry = pathEntries[i];
+                if (entry.key != key) continue;
+
+                if (entry.referenceCount > 1) {
+                    entry.referenceCount--;
+                    return false;
+                }
+                pathEntries.erase(pathEntries.begin() + i);
+                break;
+            }
+            if (pathEntries.size() == 0) this->entries.erase(result);
+        }
+
+        this->texturePaths.erase(path);
+        return true;
+    }
+
+    std::string TextureCache::getCanonicalPath(const std::string& path) {
+        return FileSystem::getInstance()->getCanonicalPath(path);
+    }
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../util/WeakPointer.h"
+#include "../common/types.h"
+#include "TextureAttr.h"
+
+namespace Core {
+
+    // forward declarations
+    class Texture2D;
+
+    /*
+     * Textures loaded from image files, keyed by the file's canonical path and the attributes the
+     * texture was created with, so that everything referencing the same file shares one texture.
+     * Every texture handed out counts as a reference; Engine::destroyTexture2D() drops one and
+     * only destroys the texture once the last reference is gone. The cache can be queried from
+     * streaming threads while the main thread adds and releases textures.
+     */
+    class TextureCache {
+    public:
+        TextureCache();
+
+        WeakPointer<Texture2D> acquireTexture2D(const std::string& path, const TextureAttributes& attributes);
+        Bool hasTexture2D(const std::string& path, const TextureAttributes& attributes) const;
+        void addTexture2D(const std::string& path, const TextureAttributes& attributes, WeakPointer<Texture2D> texture);
+        Bool releaseTexture2D(WeakPointer<Texture2D> texture);
+
+    private:
+        class Entry {
+        public:
+            TextureAttributes attributes;
+            WeakPointer<Texture2D> texture;
+            const Texture2D* key;
+            UInt32 referenceCount;
+        };
+
+        static std::string getCanonicalPath(const std::string& path);
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::vector<Entry>> entries;
+        std::unordered_map<const Texture2D*, std::string> texturePaths;
+    };
+
+}
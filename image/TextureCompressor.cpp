@@ -0,0 +1,606 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#include "TextureCompressor.h"
+#include "../util/ThreadPool.h"
+#include "../filesys/FileSystem.h"
+
+// SIMD paths are only used for single-precision palettes; everything else takes the scalar code
+#if !defined(_Real_DoublePrecision_) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define CORE_TEXTURE_COMPRESSOR_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Core {
+
+    static const UInt32 BlockPixelCount = 16;
+    static const UInt32 MaxPaletteSize = 16;
+    static const Real Unreachable = 1.0e9f;
+
+    // BC7 4-bit index interpolation weights, out of 64
+    static const UInt32 BC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // "CTEX"
+    static const UInt32 CacheMagic = 0x58455443;
+    static const UInt32 CacheVersion = 2;
+
+    class CacheHeader {
+    public:
+        UInt32 magic;
+        UInt32 version;
+        UInt32 format;
+        UInt32 width;
+        UInt32 height;
+        UInt32 levelCount;
+        UInt64 sourceSize;
+        Int64 sourceModificationTime;
+        UInt64 dataSize;
+    };
+
+    // the colors a block's indices can pick from, stored channel by channel so that four entries
+    // can be compared at once; unused entries are unreachable
+    class BlockPalette {
+    public:
+        Real channels[4][MaxPaletteSize];
+        UInt32 size;
+
+        BlockPalette(UInt32 size): size(size) {
+            for (UInt32 c = 0; c < 4; c++) {
+                for (UInt32 i = 0; i < MaxPaletteSize; i++) this->channels[c][i] = Unreachable;
+            }
+        }
+
+        void setEntry(UInt32 index, Real r, Real g, Real b, Real a) {
+            this->channels[0][index] = r;
+            this->channels[1][index] = g;
+            this->channels[2][index] = b;
+            this->channels[3][index] = a;
+        }
+    };
+
+    /*
+     * Copy the 4x4 block at [blockX], [blockY] of [image] into [pixels] as 16 RGBA values. Blocks
+     * that reach past the edge of the image repeat its last row and column. Channels beyond
+     * [channelCount] are set to 0 so they don't count when colors are compared.
+     */
+    static void readBlock(const StandardImage& image, UInt32 blockX, UInt32 blockY, UInt32 channelCount, Real* pixels) {
+        UInt32 width = image.getWidth();
+        UInt32 height = image.getHeight();
+        for (UInt32 y = 0; y < 4; y++) {
+            UInt32 sourceY = blockY * 4 + y < height ? blockY * 4 + y : height - 1;
+            for (UInt32 x = 0; x < 4; x++) {
+                UInt32 sourceX = blockX * 4 + x < width ? blockX * 4 + x : width - 1;
+                const Byte* source = image.calcOffsetLocationBytes(sourceX, sourceY);
+                Real* pixel = pixels + (y * 4 + x) * 4;
+                for (UInt32 c = 0; c < 4; c++) pixel[c] = c < channelCount ? (Real)source[c] : 0.0f;
+            }
+        }
+    }
+
+    /*
+     * Pick the closest [palette] entry for every one of the 16 [pixels] and return the total
+     * squared error.
+     */
+    static Real findClosestEntries(const Real* pixels, const BlockPalette& palette, Byte* indices) {
+        Real totalError = 0.0f;
+        for (UInt32 p = 0; p < BlockPixelCount; p++) {
+            const Real* pixel = pixels + p * 4;
+            Real bestError = Unreachable * Unreachable;
+            UInt32 bestIndex = 0;
+#if defined(CORE_TEXTURE_COMPRESSOR_SSE)
+            __m128 r = _mm_set1_ps(pixel[0]);
+            __m128 g = _mm_set1_ps(pixel[1]);
+            __m128 b = _mm_set1_ps(pixel[2]);
+            __m128 a = _mm_set1_ps(pixel[3]);
+            for (UInt32 e = 0; e < palette.size; e += 4) {
+                __m128 dr = _mm_sub_ps(_mm_loadu_ps(palette.channels[0] + e), r);
+                __m128 dg = _mm_sub_ps(_mm_loadu_ps(palette.channels[1] + e), g);
+                __m128 db = _mm_sub_ps(_mm_loadu_ps(palette.channels[2] + e), b);
+                __m128 da = _mm_sub_ps(_mm_loadu_ps(palette.channels[3] + e), a);
+                __m128 error = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)),
+                                          _mm_add_ps(_mm_mul_ps(db, db), _mm_mul_ps(da, da)));
+                Real errors[4];
+                _mm_storeu_ps(errors, error);
+                for (UInt32 i = 0; i < 4; i++) {
+                    if (errors[i] < bestError) {
+                        bestError = errors[i];
+                        bestIndex = e + i;
+                    }
+                }
+            }
+#else
+            for (UInt32 e = 0; e < palette.size; e++) {
+                Real error = 0.0f;
+                for (UInt32 c = 0; c < 4; c++) {
+                    Real d = palette.channels[c][e] - pixel[c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = e;
+                }
+            }
+#endif
+            indices[p] = (Byte)bestIndex;
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    static Real clampChannel(Real value) {
+        return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+    }
+
+    /*
+     * Find the line through the first [channelCount] channels of [pixels] along which they vary the
+     * most (by power iteration on their covariance) and set [e0] and [e1] to the ends of the
+     * segment of that line the pixels project onto.
+     */
+    static void fitEndpoints(const Real* pixels, UInt32 channelCount, Real* e0, Real* e1) {
+        Real mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (UInt32 p = 0; p < BlockPixelCount; p++) {
+            for (UInt32 c = 0; c < channelCount; c++) mean[c] += pixels[p * 4 + c];
+        }
+        for (UInt32 c = 0; c < channelCount; c++) mean[c] /= (Real)BlockPixelCount;
+
+        Real covariance[4][4] = {};
+        for (UInt32 p = 0; p < BlockPixelCount; p++) {
+            for (UInt32 i = 0; i < channelCount; i++) {
+                Real di = pixels[p * 4 + i] - mean[i];
+                for (UInt32 j = 0; j < channelCount; j++) covariance[i][j] += di * (pixels[p * 4 + j] - mean[j]);
+            }
+        }
+
+        // start from the row of the channel with the largest variance
+        UInt32 start = 0;
+        for (UInt32 c = 1; c < channelCount; c++) {
+            if (covariance[c][c] > covariance[start][start]) start = c;
+        }
+        Real axis[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (UInt32 c = 0; c < channelCount; c++) axis[c] = covariance[start][c];
+
+        for (UInt32 iteration = 0; iteration < 8; iteration++) {
+            Real next[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            Real largest = 0.0f;
+            for (UInt32 i = 0; i < channelCount; i++) {
+                for (UInt32 j = 0; j < channelCount; j++) next[i] += covariance[i][j] * axis[j];
+                if (std::fabs(next[i]) > largest) largest = std::fabs(next[i]);
+            }
+            if (largest < 1.0e-6f) break;
+            for (UInt32 c = 0; c < channelCount; c++) axis[c] = next[c] / largest;
+        }
+
+        Real axisLengthSquared = 0.0f;
+        for (UInt32 c = 0; c < channelCount; c++) axisLengthSquared += axis[c] * axis[c];
+        if (axisLengthSquared < 1.0e-6f) {
+            // every pixel has the same color
+            for (UInt32 c = 0; c < 4; c++) e0[c] = e1[c] = c < channelCount ? mean[c] : 0.0f;
+            return;
+        }
+
+        Real low = 0.0f, high = 0.0f;
+        for (UInt32 p = 0; p < BlockPixelCount; p++) {
+            Real t = 0.0f;
+            for (UInt32 c = 0; c < channelCount; c++) t += (pixels[p * 4 + c] - mean[c]) * axis[c];
+            t /= axisLengthSquared;
+            if (p == 0 || t < low) low = t;
+            if (p == 0 || t > high) high = t;
+        }
+        for (UInt32 c = 0; c < 4; c++) {
+            e0[c] = c < channelCount ? clampChannel(mean[c] + axis[c] * low) : 0.0f;
+            e1[c] = c < channelCount ? clampChannel(mean[c] + axis[c] * high) : 0.0f;
+        }
+    }
+
+    /*
+     * Given the palette index of every pixel, where index i lies [weights][i] of the way from [e0]
+     * to [e1], move the endpoints to the least-squares fit of the pixels. Returns false if the
+     * indices don't determine the endpoints (all pixels use the same weight).
+     */
+    static Bool refineEndpoints(const Real* pixels, UInt32 channelCount, const Byte* indices, const Real* weights, Real* e0, Real* e1) {
+        Real aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        Real ax[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        Real bx[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (UInt32 p = 0; p < BlockPixelCount; p++) {
+            Real b = weights[indices[p]];
+            Real a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (UInt32 c = 0; c < channelCount; c++) {
+                ax[c] += a * pixels[p * 4 + c];
+                bx[c] += b * pixels[p * 4 + c];
+            }
+        }
+
+        Real determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1.0e-6f) return false;
+        for (UInt32 c = 0; c < channelCount; c++) {
+            e0[c] = clampChannel((bb * ax[c] - ab * bx[c]) / determinant);
+            e1[c] = clampChannel((aa * bx[c] - ab * ax[c]) / determinant);
+        }
+        return true;
+    }
+
+    static UInt16 quantize565(const Real* color) {
+        UInt32 r = (UInt32)(color[0] * 31.0f / 255.0f + 0.5f);
+        UInt32 g = (UInt32)(color[1] * 63.0f / 255.0f + 0.5f);
+        UInt32 b = (UInt32)(color[2] * 31.0f / 255.0f + 0.5f);
+        return (UInt16)((r << 11) | (g << 5) | b);
+    }
+
+    static void expand565(UInt16 value, Real* color) {
+        UInt32 r = (value >> 11) & 0x1F;
+        UInt32 g = (value >> 5) & 0x3F;
+        UInt32 b = value & 0x1F;
+        color[0] = (Real)((r << 3) | (r >> 2));
+        color[1] = (Real)((g << 2) | (g >> 4));
+        color[2] = (Real)((b << 3) | (b >> 2));
+        color[3] = 0.0f;
+    }
+
+    /*
+     * Encode the RGB channels of [pixels] as an 8-byte BC1 color block. Only the four-color mode
+     * is used, so the block is always opaque.
+     */
+    static void encodeBC1Block(const Real* pixels, Byte* block) {
+        static const Real weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+        Real e0[4], e1[4];
+        fitEndpoints(pixels, 3, e0, e1);
+
+        Real bestError = -1.0f;
+        UInt16 best0 = 0, best1 = 0;
+        Byte bestIndices[BlockPixelCount] = {};
+        for (UInt32 iteration = 0; iteration < 2; iteration++) {
+            UInt16 q0 = quantize565(e0);
+            UInt16 q1 = quantize565(e1);
+            // the four-color mode requires the first endpoint to be the larger one
+            if (q0 < q1) {
+                UInt16 swap = q0; q0 = q1; q1 = swap;
+            }
+            Real c0[4], c1[4];
+            expand565(q0, c0);
+            expand565(q1, c1);
+
+            BlockPalette palette(4);
+            palette.setEntry(0, c0[0], c0[1], c0[2], 0.0f);
+            if (q0 == q1) {
+                palette.setEntry(1, c0[0], c0[1], c0[2], 0.0f);
+                palette.setEntry(2, c0[0], c0[1], c0[2], 0.0f);
+                palette.setEntry(3, c0[0], c0[1], c0[2], 0.0f);
+            }
+            else {
+                palette.setEntry(1, c1[0], c1[1], c1[2], 0.0f);
+                palette.setEntry(2, (2.0f * c0[0] + c1[0]) / 3.0f, (2.0f * c0[1] + c1[1]) / 3.0f, (2.0f * c0[2] + c1[2]) / 3.0f, 0.0f);
+                palette.setEntry(3, (c0[0] + 2.0f * c1[0]) / 3.0f, (c0[1] + 2.0f * c1[1]) / 3.0f, (c0[2] + 2.0f * c1[2]) / 3.0f, 0.0f);
+            }
+
+            Byte indices[BlockPixelCount];
+            Real error = findClosestEntries(pixels, palette, indices);
+            if (bestError < 0.0f || error < bestError) {
+                bestError = error;
+                best0 = q0;
+                best1 = q1;
+                memcpy(bestIndices, indices, BlockPixelCount);
+            }
+            if (q0 == q1 || !refineEndpoints(pixels, 3, indices, weights, e0, e1)) break;
+        }
+
+        UInt32 indexBits = 0;
+        for (UInt32 p = 0; p < BlockPixelCount; p++) indexBits |= (UInt32)bestIndices[p] << (p * 2);
+        block[0] = (Byte)(best0 & 0xFF);
+        block[1] = (Byte)(best0 >> 8);
+        block[2] = (Byte)(best1 & 0xFF);
+        block[3] = (Byte)(best1 >> 8);
+        for (UInt32 i = 0; i < 4; i++) block[4 + i] = (Byte)(indexBits >> (i * 8));
+    }
+
+    /*
+     * Encode [channel] of [pixels] as an 8-byte BC4 block, using the eight-value mode between the
+     * smallest and the largest value.
+     */
+    static void encodeBC4Block(const Real* pixels, UInt32 channel, Byte* block) {
+        Real low = 255.0f, high = 0.0f;
+        for (UInt32 p = 0; p < BlockPixelCount; p++) {
+            Real value = pixels[p * 4 + channel];
+            if (value < low) low = value;
+            if (value > high) high = value;
+        }
+        UInt32 r0 = (UInt32)(high + 0.5f);
+        UInt32 r1 = (UInt32)(low + 0.5f);
+        block[0] = (Byte)r0;
+        block[1] = (Byte)r1;
+
+        UInt64 indexBits = 0;
+        if (r0 > r1) {
+            Real values[8];
+            values[0] = (Real)r0;
+            values[1] = (Real)r1;
+            for (UInt32 i = 1; i < 7; i++) values[i + 1] = ((7 - i) * (Real)r0 + i * (Real)r1) / 7.0f;
+
+            for (UInt32 p = 0; p < BlockPixelCount; p++) {
+                Real value = pixels[p * 4 + channel];
+                UInt32 bestIndex = 0;
+                for (UInt32 i = 1; i < 8; i++) {
+                    if (std::fabs(values[i] - value) < std::fabs(values[bestIndex] - value)) bestIndex = i;
+                }
+                indexBits |= (UInt64)bestIndex << (p * 3);
+            }
+        }
+        for (UInt32 i = 0; i < 6; i++) block[2 + i] = (Byte)(indexBits >> (i * 8));
+    }
+
+    /*
+     * Quantize [color] to 7 bits per channel plus one p-bit shared by all channels, choosing the
+     * p-bit that lands closer.
+     */
+    static void quantizeBC7Endpoint(const Real* color, Byte* quantized, Byte& pBit) {
+        Real bestError = -1.0f;
+        for (UInt32 p = 0; p < 2; p++) {
+            Byte candidate[4];
+            Real error = 0.0f;
+            for (UInt32 c = 0; c < 4; c++) {
+                Int32 value = (Int32)std::floor((color[c] - (Real)p) / 2.0f + 0.5f);
+                value = value < 0 ? 0 : (value > 127 ? 127 : value);
+                candidate[c] = (Byte)value;
+                Real d = (Real)((value << 1) | p) - color[c];
+                error += d * d;
+            }
+            if (bestError < 0.0f || error < bestError) {
+                bestError = error;
+                memcpy(quantized, candidate, 4);
+                pBit = (Byte)p;
+            }
+        }
+    }
+
+    // appends [count] bits of [value] to [block], least significant bit first
+    static void writeBits(Byte* block, UInt32& position, UInt32 value, UInt32 count) {
+        for (UInt32 i = 0; i < count; i++, position++) {
+            if ((value >> i) & 1) block[position / 8] |= (Byte)(1 << (position % 8));
+        }
+    }
+
+    /*
+     * Encode [pixels] as a 16-byte BC7 block in mode 6.
+     */
+    static void encodeBC7Block(const Real* pixels, Byte* block) {
+        Real weights[16];
+        for (UInt32 i = 0; i < 16; i++) weights[i] = (Real)BC7Weights[i] / 64.0f;
+
+        Real e0[4], e1[4];
+        fitEndpoints(pixels, 4, e0, e1);
+
+        Real bestError = -1.0f;
+        Byte best0[4] = {}, best1[4] = {};
+        Byte bestP0 = 0, bestP1 = 0;
+        Byte bestIndices[BlockPixelCount] = {};
+        for (UInt32 iteration = 0; iteration < 2; iteration++) {
+            Byte q0[4], q1[4];
+            Byte p0, p1;
+            quantizeBC7Endpoint(e0, q0, p0);
+            quantizeBC7Endpoint(e1, q1, p1);
+
+            BlockPalette palette(16);
+            for (UInt32 i = 0; i < 16; i++) {
+                Real entry[4];
+                for (UInt32 c = 0; c < 4; c++) {
+                    UInt32 c0 = ((UInt32)q0[c] << 1) | p0;
+                    UInt32 c1 = ((UInt32)q1[c] << 1) | p1;
+                    entry[c] = (Real)(((64 - BC7Weights[i]) * c0 + BC7Weights[i] * c1 + 32) >> 6);
+                }
+                palette.setEntry(i, entry[0], entry[1], entry[2], entry[3]);
+            }
+
+            Byte indices[BlockPixelCount];
+            Real error = findClosestEntries(pixels, palette, indices);
+            if (bestError < 0.0f || error < bestError) {
+                bestError = error;
+                memcpy(best0, q0, 4);
+                memcpy(best1, q1, 4);
+                bestP0 = p0;
+                bestP1 = p1;
+                memcpy(bestIndices, indices, BlockPixelCount);
+            }
+            if (!refineEndpoints(pixels, 4, indices, weights, e0, e1)) break;
+        }
+
+        // the first pixel's index is stored without its top bit, which must therefore be 0. the
+        // weights are symmetric, so swapping the endpoints and mirroring the indices is lossless
+        if (bestIndices[0] & 0x8) {
+            for (UInt32 c = 0; c < 4; c++) {
+                Byte swap = best0[c]; best0[c] = best1[c]; best1[c] = swap;
+            }
+            Byte swap = bestP0; bestP0 = bestP1; bestP1 = swap;
+            for (UInt32 p = 0; p < BlockPixelCount; p++) bestIndices[p] = (Byte)(15 - bestIndices[p]);
+        }
+
+        memset(block, 0, 16);
+        UInt32 position = 0;
+        writeBits(block, position, 1 << 6, 7);
+        for (UInt32 c = 0; c < 4; c++) {
+            writeBits(block, position, best0[c], 7);
+            writeBits(block, position, best1[c], 7);
+        }
+        writeBits(block, position, bestP0, 1);
+        writeBits(block, position, bestP1, 1);
+        for (UInt32 p = 0; p < BlockPixelCount; p++) {
+            writeBits(block, position, bestIndices[p], p == 0 ? 3 : 4);
+        }
+    }
+
+    static void encodeBlock(TextureFormat format, const StandardImage& image, UInt32 blockX, UInt32 blockY, Byte* block) {
+        Real pixels[BlockPixelCount * 4];
+        switch (format) {
+            case TextureFormat::BC1:
+                readBlock(image, blockX, blockY, 3, pixels);
+                encodeBC1Block(pixels, block);
+                break;
+            case TextureFormat::BC3:
+                readBlock(image, blockX, blockY, 4, pixels);
+                encodeBC4Block(pixels, 3, block);
+                for (UInt32 p = 0; p < BlockPixelCount; p++) pixels[p * 4 + 3] = 0.0f;
+                encodeBC1Block(pixels, block + 8);
+                break;
+            case TextureFormat::BC4:
+                readBlock(image, blockX, blockY, 1, pixels);
+                encodeBC4Block(pixels, 0, block);
+                break;
+            case TextureFormat::BC5:
+                readBlock(image, blockX, blockY, 2, pixels);
+                encodeBC4Block(pixels, 0, block);
+                encodeBC4Block(pixels, 1, block + 8);
+                break;
+            case TextureFormat::BC7:
+                readBlock(image, blockX, blockY, 4, pixels);
+                encodeBC7Block(pixels, block);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /*
+     * Encode [image] in [format] as a compressed image with a single level.
+     */
+    std::shared_ptr<CompressedImage> TextureCompressor::compress(const StandardImage& image, TextureFormat format, ThreadPool* threadPool) {
+        CompressedImage* compressedImagePtr = new(std::nothrow) CompressedImage(format, image.getWidth(), image.getHeight());
+        if (compressedImagePtr == nullptr) {
+            throw AllocationException("TextureCompressor::compress -> Unable to allocate compressed image.");
+        }
+        std::shared_ptr<CompressedImage> compressedImage(compressedImagePtr);
+        compressedImage->init(1);
+        TextureCompressor::compressLevel(image, *compressedImage, 0, threadPool);
+        return compressedImage;
+    }
+
+    /*
+     * Encode [image] and the mip levels below it ([mipLevels], each half the size of the one
+     * before) in [format] as a compressed image with all of those levels.
+     */
+    std::shared_ptr<CompressedImage> TextureCompressor::compress(const StandardImage& image, const std::vector<std::shared_ptr<StandardImage>>& mipLevels,
+                                                                 TextureFormat format, ThreadPool* threadPool) {
+        CompressedImage* compressedImagePtr = new(std::nothrow) CompressedImage(format, image.getWidth(), image.getHeight());
+        if (compressedImagePtr == nullptr) {
+            throw AllocationException("TextureCompressor::compress -> Unable to allocate compressed image.");
+        }
+        std::shared_ptr<CompressedImage> compressedImage(compressedImagePtr);
+        compressedImage->init((UInt32)mipLevels.size() + 1);
+        if (compressedImage->getLevelCount() != mipLevels.size() + 1) {
+            throw TextureCompressorException("TextureCompressor::compress -> Too many mip levels for image size.");
+        }
+        TextureCompressor::compressLevel(image, *compressedImage, 0, threadPool);
+        for (UInt32 i = 0; i < mipLevels.size(); i++) {
+            TextureCompressor::compressLevel(*mipLevels[i], *compressedImage, i + 1, threadPool);
+        }
+        return compressedImage;
+    }
+
+    /*
+     * Encode [image] into [level] of [target], whose size it must have.
+     */
+    void TextureCompressor::compressLevel(const StandardImage& image, CompressedImage& target, UInt32 level, ThreadPool* threadPool) {
+        if (image.getWidth() != target.getLevelWidth(level) || image.getHeight() != target.getLevelHeight(level)) {
+            throw TextureCompressorException("TextureCompressor::compressLevel -> Image size does not match the target level.");
+        }
+        if (image.getWidth() == 0 || image.getHeight() == 0) return;
+
+        TextureFormat format = target.getFormat();
+        UInt32 blockSize = CompressedImage::getBlockSizeBytes(format);
+        UInt32 blocksX = (image.getWidth() + CompressedImage::BlockDimension - 1) / CompressedImage::BlockDimension;
+        UInt32 blocksY = (image.getHeight() + CompressedImage::BlockDimension - 1) / CompressedImage::BlockDimension;
+        Byte* data = target.getLevelData(level);
+
+        auto encodeRow = [format, &image, blockSize, blocksX, data](UInt32 blockY) {
+            for (UInt32 blockX = 0; blockX < blocksX; blockX++) {
+                encodeBlock(format, image, blockX, blockY, data + ((UInt64)blockY * blocksX + blockX) * blockSize);
+            }
+        };
+        if (threadPool != nullptr) {
+            threadPool->parallelFor(blocksY, encodeRow);
+        }
+        else {
+            for (UInt32 blockY = 0; blockY < blocksY; blockY++) encodeRow(blockY);
+        }
+    }
+
+    /*
+     * Load the image encoded in [format] from the file at [sourcePath] out of [cacheDirectory].
+     * Returns null if there is no cache file for it or the file has changed since it was cached.
+     */
+    std::shared_ptr<CompressedImage> TextureCompressor::loadCachedImage(const std::string& cacheDirectory, const std::string& sourcePath, TextureFormat format) {
+        std::shared_ptr<FileSystem> fileSystem = FileSystem::getInstance();
+        UInt64 sourceSize;
+        Int64 sourceModificationTime;
+        if (!fileSystem->getFileInfo(fileSystem->fixupPathForLocalFilesystem(sourcePath), sourceSize, sourceModificationTime)) return nullptr;
+
+        std::ifstream file(TextureCompressor::getCachePath(cacheDirectory, sourcePath, format).c_str(), std::ios::binary);
+        if (!file.is_open()) return nullptr;
+
+        CacheHeader header;
+        if (!file.read((char*)&header, sizeof(CacheHeader))) return nullptr;
+        if (header.magic != CacheMagic || header.version != CacheVersion || header.format != (UInt32)format ||
+            header.sourceSize != sourceSize || header.sourceModificationTime != sourceModificationTime) {
+            return nullptr;
+        }
+
+        CompressedImage* compressedImagePtr = new(std::nothrow) CompressedImage(format, header.width, header.height);
+        if (compressedImagePtr == nullptr) {
+            throw AllocationException("TextureCompressor::loadCachedImage -> Unable to allocate compressed image.");
+        }
+        std::shared_ptr<CompressedImage> compressedImage(compressedImagePtr);
+        compressedImage->init(header.levelCount);
+        if (compressedImage->getLevelCount() != header.levelCount || compressedImage->imageSizeBytes() != header.dataSize) return nullptr;
+
+        // levels are stored back to back, in the same layout CompressedImage keeps them in
+        if (!file.read((char*)compressedImage->getLevelData(0), header.dataSize)) return nullptr;
+        return compressedImage;
+    }
+
+    /*
+     * Store [image], encoded from the file at [sourcePath], in [cacheDirectory], which must exist.
+     * Returns false if the cache file could not be written.
+     */
+    Bool TextureCompressor::saveCachedImage(const std::string& cacheDirectory, const std::string& sourcePath, const CompressedImage& image) {
+        std::shared_ptr<FileSystem> fileSystem = FileSystem::getInstance();
+        CacheHeader header;
+        memset(&header, 0, sizeof(CacheHeader));
+        if (!fileSystem->getFileInfo(fileSystem->fixupPathForLocalFilesystem(sourcePath), header.sourceSize, header.sourceModificationTime)) return false;
+        header.magic = CacheMagic;
+        header.version = CacheVersion;
+        header.format = (UInt32)image.getFormat();
+        header.width = image.getWidth();
+        header.height = image.getHeight();
+        header.levelCount = image.getLevelCount();
+        header.dataSize = image.imageSizeBytes();
+
+        std::ofstream file(TextureCompressor::getCachePath(cacheDirectory, sourcePath, image.getFormat()).c_str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write((const char*)&header, sizeof(CacheHeader));
+        file.write((const char*)image.getLevelData(0), header.dataSize);
+        return file.good();
+    }
+
+    std::string TextureCompressor::getCachePath(const std::string& cacheDirectory, const std::string& sourcePath, TextureFormat format) {
+        std::shared_ptr<FileSystem> fileSystem = FileSystem::getInstance();
+        std::string canonicalPath = fileSystem->getCanonicalPath(sourcePath);
+
+        // FNV-1a
+        UInt64 hash = 0xcbf29ce484222325ull;
+        for (Char c : canonicalPath) {
+            hash ^= (Byte)c;
+            hash *= 0x100000001b3ull;
+        }
+        static const Char hexDigits[] = "0123456789abcdef";
+        std::string fileName;
+        for (Int32 shift = 60; shift >= 0; shift -= 4) fileName += hexDigits[(hash >> shift) & 0xF];
+        fileName += "_" + std::to_string((UInt32)format) + ".ctex";
+
+        std::string path = cacheDirectory;
+        if (path.size() > 0 && path[path.size() - 1] != fileSystem->getPathSeparator()) path += fileSystem->getPathSeparator();
+        return path + fileName;
+    }
+}
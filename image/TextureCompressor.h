@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../common/types.h"
+#include "../common/Exception.h"
+#include "RawImage.h"
+#include "CompressedImage.h"
+#include "TextureAttr.h"
+
+namespace Core {
+
+    // forward declarations
+    class ThreadPool;
+
+    /*
+     * CPU encoder for the block-compressed texture formats:
+     *   BC1 - opaque RGB, 4 bits per pixel (albedo without alpha)
+     *   BC3 - RGB with smooth alpha, 8 bits per pixel
+     *   BC4 - one channel, 4 bits per pixel (roughness, gloss, masks)
+     *   BC5 - two channels, 8 bits per pixel (tangent-space normals as XY)
+     *   BC7 - RGBA, 8 bits per pixel, highest quality (albedo)
+     *
+     * Each block is fitted along the principal axis of its colors, and the endpoints are refined
+     * by least squares once. BC7 uses mode 6 (one subset, RGBA endpoints with p-bits and 4-bit
+     * indices) for every block. Rows of blocks are encoded in parallel on [threadPool] if given.
+     *
+     * Since encoding is slow compared to decoding, compressed images can be kept in a cache
+     * directory on disk. A cache file is named after the path of the image it was encoded from
+     * and the format, and is only used while that image's size and modification time match.
+     */
+    class TextureCompressor {
+    public:
+        class TextureCompressorException : public Exception {
+        public:
+            TextureCompressorException(const std::string& msg) : Exception(msg) {
+            }
+            TextureCompressorException(const char* msg) : Exception(msg) {
+            }
+        };
+
+        static std::shared_ptr<CompressedImage> compress(const StandardImage& image, TextureFormat format, ThreadPool* threadPool);
+        static std::shared_ptr<CompressedImage> compress(const StandardImage& image, const std::vector<std::shared_ptr<StandardImage>>& mipLevels,
+                                                         TextureFormat format, ThreadPool* threadPool);
+        static void compressLevel(const StandardImage& image, CompressedImage& target, UInt32 level, ThreadPool* threadPool);
+
+        static std::shared_ptr<CompressedImage> loadCachedImage(const std::string& cacheDirectory, const std::string& sourcePath, TextureFormat format);
+        static Bool saveCachedImage(const std::string& cacheDirectory, const std::string& sourcePath, const CompressedImage& image);
+
+    private:
+        TextureCompressor();
+
+        static std::string getCachePath(const std::string& cacheDirectory, const std::string& sourcePath, TextureFormat format);
+    };
+}
@@ -0,0 +1,286 @@
+#include <cmath>
+#include <memory>
+#include <queue>
+
+#include "TextureStreamer.h"
+#include "CompressedImage.h"
+#include "../Engine.h"
+#include "../Graphics.h"
+#include "../material/Material.h"
+
+namespace Core {
+
+    const UInt64 TextureStreamer::DefaultMemoryBudget;
+    const UInt32 TextureStreamer::TailSize;
+
+    // closest distance used for meshes the camera is inside of or very near
+    static const Real MinimumDistance = 0.001f;
+
+    TextureStreamer::TextureStreamer(): memoryBudget(DefaultMemoryBudget), levelBias(0.0f), frame(0) {
+
+    }
+
+    /*
+     * Start streaming [texture], which must have been built with Texture2D::buildStreamed() and hold
+     * the levels from [tailLevel] down. [loader] provides the finer levels when they are needed.
+     */
+    void TextureStreamer::addTexture(WeakPointer<Texture2D> texture, UInt32 tailLevel, LevelLoader loader) {
+        if (!texture->isStreamed() || texture->getFirstLoadedLevel() > tailLevel) {
+            throw Exception("TextureStreamer::addTexture -> Texture must be streamed and have its tail levels loaded.");
+        }
+
+        StreamedTexture entry;
+        entry.texture = texture;
+        entry.loader = loader;
+        entry.tailLevel = tailLevel;
+        entry.pixelsPerUV = 0.0f;
+        entry.lastUsedFrame = this->frame;
+        entry.wantedLevel = texture->getFirstLoadedLevel();
+        entry.targetLevel = entry.wantedLevel;
+        this->textures[texture.get()] = entry;
+    }
+
+    /*
+     * Stop streaming [texture], e.g. because it is about to be destroyed. Levels that are still
+     * being loaded for it are dropped.
+     */
+    void TextureStreamer::removeTexture(const Texture* texture) {
+        auto result = this->textures.find(texture);
+        if (result == this->textures.end()) return;
+        if (result->second.request) result->second.request->cancel();
+        this->textures.erase(result);
+    }
+
+    Bool TextureStreamer::hasTextures() const {
+        return this->textures.size() > 0;
+    }
+
+    /*
+     * Record that [material] was drawn on a mesh one UV unit of which covered [pixelsPerUV] pixels
+     * on screen. Called by the renderers for every draw.
+     */
+    void TextureStreamer::reportUsage(WeakPointer<Material> material, Real pixelsPerUV) {
+        this->materialTextures.clear();
+        material->getTextures(this->materialTextures);
+        for (WeakPointer<Texture>& texture : this->materialTextures) {
+            auto result = this->textures.find(texture.get());
+            if (result == this->textures.end()) continue;
+            if (pixelsPerUV > result->second.pixelsPerUV) result->second.pixelsPerUV = pixelsPerUV;
+        }
+    }
+
+    /*
+     * Work out the level every streamed texture needs from the usage reported since the last call,
+     * fit the total into the memory budget, drop levels that are no longer needed and request the
+     * ones that are missing. Must be called once per frame on the main thread.
+     */
+    void TextureStreamer::update() {
+        this->frame++;
+
+        std::vector<StreamedTexture*> entries;
+        UInt64 totalBytes = 0;
+        for (auto& pair : this->textures) {
+            StreamedTexture& entry = pair.second;
+            if (entry.pixelsPerUV > 0.0f) {
+                entry.wantedLevel = this->calculateWantedLevel(entry);
+                entry.lastUsedFrame = this->frame;
+                entry.pixelsPerUV = 0.0f;
+            }
+            entry.targetLevel = entry.wantedLevel;
+            totalBytes += TextureStreamer::calculateChainSizeBytes(*entry.texture.get(), entry.targetLevel);
+            entries.push_back(&entry);
+        }
+        if (totalBytes > this->memoryBudget) this->fitMemoryBudget(entries, totalBytes);
+
+        for (StreamedTexture* entry : entries) {
+            Texture2D& texture = *entry->texture.get();
+            if (entry->targetLevel > texture.getFirstAllocatedLevel()) {
+                if (entry->request) {
+                    entry->request->cancel();
+                    entry->request.reset();
+                }
+                texture.allocateStreamedLevels(entry->targetLevel);
+            }
+            else if (entry->targetLevel < texture.getFirstLoadedLevel() && !entry->request && entry->loader) {
+                this->requestLevels(*entry);
+            }
+        }
+    }
+
+    void TextureStreamer::setMemoryBudget(UInt64 bytes) {
+        this->memoryBudget = bytes;
+    }
+
+    UInt64 TextureStreamer::getMemoryBudget() const {
+        return this->memoryBudget;
+    }
+
+    /*
+     * Added to the level calculated for each texture; positive values trade sharpness for memory.
+     */
+    void TextureStreamer::setLevelBias(Real bias) {
+        this->levelBias = bias;
+    }
+
+    Real TextureStreamer::getLevelBias() const {
+        return this->levelBias;
+    }
+
+    /*
+     * Video memory currently allocated for the levels of all streamed textures.
+     */
+    UInt64 TextureStreamer::getAllocatedBytes() const {
+        UInt64 totalBytes = 0;
+        for (auto& pair : this->textures) {
+            const Texture2D& texture = *pair.second.texture.get();
+            totalBytes += TextureStreamer::calculateChainSizeBytes(texture, texture.getFirstAllocatedLevel());
+        }
+        return totalBytes;
+    }
+
+    /*
+     * Screen pixels one world unit covers at the point of [worldBounds] closest to [cameraPosition],
+     * for a viewport [viewportHeight] pixels high.
+     */
+    Real TextureStreamer::calculatePixelsPerUnit(const Matrix4x4& projection, const Point3r& cameraPosition, const Box3& worldBounds, UInt32 viewportHeight) {
+        const Real* data = projection.getConstData();
+        Real pixelsPerUnit = data[5] * (Real)viewportHeight * 0.5f;
+        // orthographic projections don't depend on distance
+        if (data[15] != 0.0f) return pixelsPerUnit;
+
+        const Vector3r& min = worldBounds.getMin();
+        const Vector3r& max = worldBounds.getMax();
+        Real dx = cameraPosition.x < min.x ? min.x - cameraPosition.x : (cameraPosition.x > max.x ? cameraPosition.x - max.x : 0.0f);
+        Real dy = cameraPosition.y < min.y ? min.y - cameraPosition.y : (cameraPosition.y > max.y ? cameraPosition.y - max.y : 0.0f);
+        Real dz = cameraPosition.z < min.z ? min.z - cameraPosition.z : (cameraPosition.z > max.z ? cameraPosition.z - max.z : 0.0f);
+        Real distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (distance < MinimumDistance) distance = MinimumDistance;
+        return pixelsPerUnit / distance;
+    }
+
+    /*
+     * The first level of a [width] x [height] image that is no larger than TailSize.
+     */
+    UInt32 TextureStreamer::calculateTailLevel(UInt32 width, UInt32 height) {
+        UInt32 level = 0;
+        while (width > TailSize || height > TailSize) {
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+            level++;
+        }
+        return level;
+    }
+
+    UInt64 TextureStreamer::calculateLevelSizeBytes(TextureFormat format, UInt32 width, UInt32 height) {
+        if (CompressedImage::isCompressedFormat(format)) return CompressedImage::calcLevelSizeBytes(format, width, height);
+        UInt64 pixelCount = (UInt64)width * height;
+        switch (format) {
+            case TextureFormat::RGBA16F:
+                return pixelCount * 8;
+            case TextureFormat::RGBA32F:
+                return pixelCount * 16;
+            case TextureFormat::DEPTH16:
+                return pixelCount * 2;
+            default:
+                return pixelCount * 4;
+        }
+    }
+
+    /*
+     * Push the targets of the least recently drawn textures to coarser levels, one level at a time,
+     * until the total fits the memory budget or every texture is down to its tail.
+     */
+    void TextureStreamer::fitMemoryBudget(std::vector<StreamedTexture*>& entries, UInt64 totalBytes) {
+        auto keepLonger = [](StreamedTexture* a, StreamedTexture* b) {
+            if (a->lastUsedFrame != b->lastUsedFrame) return a->lastUsedFrame > b->lastUsedFrame;
+            return TextureStreamer::calculateLevelSizeBytes(*a->texture.get(), a->targetLevel) <
+                   TextureStreamer::calculateLevelSizeBytes(*b->texture.get(), b->targetLevel);
+        };
+        std::priority_queue<StreamedTexture*, std::vector<StreamedTexture*>, decltype(keepLonger)> candidates(keepLonger);
+        for (StreamedTexture* entry : entries) {
+            if (entry->targetLevel < entry->tailLevel) candidates.push(entry);
+        }
+
+        while (totalBytes > this->memoryBudget && !candidates.empty()) {
+            StreamedTexture* entry = candidates.top();
+            candidates.pop();
+            totalBytes -= TextureStreamer::calculateLevelSizeBytes(*entry->texture.get(), entry->targetLevel);
+            entry->targetLevel++;
+            if (entry->targetLevel < entry->tailLevel) candidates.push(entry);
+        }
+    }
+
+    /*
+     * Load the levels [entry] is missing down to its target on a streaming thread and stage them in
+     * upload memory there, then upload them coarsest first, one per AssetStreamer upload. The first
+     * upload allocates storage for them.
+     */
+    void TextureStreamer::requestLevels(StreamedTexture& entry) {
+        WeakPointer<Texture2D> texture = entry.texture;
+        LevelLoader loader = entry.loader;
+        UInt32 firstLevel = entry.targetLevel;
+        UInt32 lastLevel = texture->getFirstLoadedLevel() - 1;
+        const Texture* key = texture.get();
+        // textures showing nothing better than their tail are the most visibly blurry
+        AssetStreamer::Priority priority = texture->getFirstLoadedLevel() >= entry.tailLevel ? AssetStreamer::Priority::High : AssetStreamer::Priority::Normal;
+
+        entry.request = Engine::instance()->getAssetStreamer().enqueue(priority, [texture, loader, firstLevel, lastLevel](AssetStreamer::Request& request) {
+            std::shared_ptr<std::vector<Texture2D::LevelData>> levels = std::make_shared<std::vector<Texture2D::LevelData>>();
+            loader(firstLevel, lastLevel, *levels);
+            if (levels->size() != lastLevel - firstLevel + 1) {
+                throw Exception("TextureStreamer::requestLevels -> Loader returned the wrong number of levels.");
+            }
+
+            WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+            for (UInt32 i = (UInt32)levels->size(); i > 0; i--) {
+                UInt32 index = i - 1;
+                Texture2D::LevelData& levelData = (*levels)[index];
+                UInt64 byteCount = levelData.data.size();
+                // copy the level where the GPU can fetch it now, so the upload on the main thread doesn't copy
+                levelData.staged = graphics->stageTextureData(levelData.data.data(), byteCount);
+                if (levelData.staged) std::vector<Byte>().swap(levelData.data);
+
+                request.addUpload(byteCount, [texture, levels, index, firstLevel](AssetStreamer::Request& request) mutable {
+                    Texture2D* texturePtr = texture.get();
+                    if (texturePtr->getFirstAllocatedLevel() > firstLevel) texturePtr->allocateStreamedLevels(firstLevel);
+                    texturePtr->uploadStreamedLevel((*levels)[index]);
+                    // the level lives on the GPU now
+                    std::vector<Byte>().swap((*levels)[index].data);
+                    (*levels)[index].staged.reset();
+                });
+            }
+        }, [this, key](AssetStreamer::Request& request) {
+            auto result = this->textures.find(key);
+            if (result == this->textures.end() || result->second.request.get() != &request) return;
+            result->second.request.reset();
+            // don't keep retrying a source that can't be loaded; the texture stays at the levels it has
+            if (request.getState() == AssetStreamer::State::Failed) result->second.loader = nullptr;
+        });
+    }
+
+    /*
+     * The level at which one texel of [entry]'s texture covers about one pixel, where it was drawn largest.
+     */
+    UInt32 TextureStreamer::calculateWantedLevel(const StreamedTexture& entry) const {
+        const Texture2D& texture = *entry.texture.get();
+        UInt32 size = texture.getStreamedWidth() > texture.getStreamedHeight() ? texture.getStreamedWidth() : texture.getStreamedHeight();
+        Real level = std::log2((Real)size / entry.pixelsPerUV) + this->levelBias;
+        if (level <= 0.0f) return 0;
+        UInt32 wantedLevel = (UInt32)level;
+        return wantedLevel < entry.tailLevel ? wantedLevel : entry.tailLevel;
+    }
+
+    UInt64 TextureStreamer::calculateLevelSizeBytes(const Texture2D& texture, UInt32 level) {
+        UInt32 width = texture.getStreamedWidth() >> level;
+        UInt32 height = texture.getStreamedHeight() >> level;
+        return TextureStreamer::calculateLevelSizeBytes(texture.getAttributes().Format, width > 0 ? width : 1, height > 0 ? height : 1);
+    }
+
+    UInt64 TextureStreamer::calculateChainSizeBytes(const Texture2D& texture, UInt32 firstLevel) {
+        UInt64 totalBytes = 0;
+        for (UInt32 level = firstLevel; level < texture.getStreamedLevelCount(); level++) {
+            totalBytes += TextureStreamer::calculateLevelSizeBytes(texture, level);
+        }
+        return totalBytes;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "../util/WeakPointer.h"
+#include "../common/types.h"
+#include "../asset/AssetStreamer.h"
+#include "../geometry/Box3.h"
+#include "../math/Matrix4x4.h"
+#include "Texture2D.h"
+
+namespace Core {
+
+    // forward declarations
+    class Material;
+    class Texture;
+
+    /*
+     * Keeps only the mip levels of streamed textures that are needed on screen in video memory.
+     *
+     * A streamed texture always holds its tail: the small levels from [tailLevel] down. While
+     * rendering, MeshRenderer reports how many screen pixels one UV unit of each drawn mesh
+     * covers (see reportUsage()), from which update() derives the finest level each texture
+     * needs. Missing levels are loaded by the texture's LevelLoader on the asset streaming
+     * threads and uploaded within the AssetStreamer's per-frame budget, coarsest first. When the
+     * levels wanted by all textures don't fit in the memory budget, the finest levels of the
+     * least recently drawn textures are dropped first, largest first among equally recent ones.
+     */
+    class TextureStreamer {
+    public:
+        // loads levels [firstLevel] to [lastLevel] into [levels], in that order; runs on a streaming thread
+        typedef std::function<void(UInt32 firstLevel, UInt32 lastLevel, std::vector<Texture2D::LevelData>& levels)> LevelLoader;
+
+        TextureStreamer();
+
+        void addTexture(WeakPointer<Texture2D> texture, UInt32 tailLevel, LevelLoader loader);
+        void removeTexture(const Texture* texture);
+        Bool hasTextures() const;
+        void reportUsage(WeakPointer<Material> material, Real pixelsPerUV);
+        void update();
+
+        void setMemoryBudget(UInt64 bytes);
+        UInt64 getMemoryBudget() const;
+        void setLevelBias(Real bias);
+        Real getLevelBias() const;
+        UInt64 getAllocatedBytes() const;
+
+        static Real calculatePixelsPerUnit(const Matrix4x4& projection, const Point3r& cameraPosition, const Box3& worldBounds, UInt32 viewportHeight);
+        static UInt32 calculateTailLevel(UInt32 width, UInt32 height);
+        static UInt64 calculateLevelSizeBytes(TextureFormat format, UInt32 width, UInt32 height);
+
+        static const UInt64 DefaultMemoryBudget = 512 * 1024 * 1024;
+        // levels this size or smaller always stay resident
+        static const UInt32 TailSize = 64;
+
+    private:
+        class StreamedTexture {
+        public:
+            WeakPointer<Texture2D> texture;
+            LevelLoader loader;
+            UInt32 tailLevel;
+            // the most screen pixels one UV unit covered in a draw since the last update()
+            Real pixelsPerUV;
+            UInt64 lastUsedFrame;
+            // the finest level the texture was needed at when last drawn
+            UInt32 wantedLevel;
+            // [wantedLevel], or coarser if the memory budget requires it
+            UInt32 targetLevel;
+            AssetStreamer::RequestHandle request;
+        };
+
+        TextureStreamer(const TextureStreamer& other) = delete;
+        TextureStreamer& operator=(const TextureStreamer& other) = delete;
+
+        void fitMemoryBudget(std::vector<StreamedTexture*>& entries, UInt64 totalBytes);
+        void requestLevels(StreamedTexture& entry);
+        UInt32 calculateWantedLevel(const StreamedTexture& entry) const;
+
+        static UInt64 calculateLevelSizeBytes(const Texture2D& texture, UInt32 level);
+        static UInt64 calculateChainSizeBytes(const Texture2D& texture, UInt32 firstLevel);
+
+        UInt64 memoryBudget;
+        Real levelBias;
+        UInt64 frame;
+        std::unordered_map<const Texture*, StreamedTexture> textures;
+        // reused by reportUsage() to avoid reallocating for every draw
+        std::vector<WeakPointer<Texture>> materialTextures;
+    };
+}
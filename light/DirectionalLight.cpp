@@ -78,9 +78,9 @@ namespace Core {
         Transform& targetCameraTransform = targetCameraOwner->getTransform();
         targetCameraTransform.updateWorldMatrix();
 
-        lightOwner->getTransform().updateWorldMatrix();
-        Matrix4x4 lightTransformInverse = lightOwner->getTransform().getWorldMatrix();
-        lightTransformInverse.invert();
+        Matrix4x4 lightTransformInverse = lightOwner->getTransform().getConstInverseWorldMatrix();
+        Matrix4x4 viewToLightTransform = lightTransformInverse;
+        viewToLightTransform.multiply(targetCameraTransform.getConstWorldMatrix());
 
         Real aspectRatio = targetCamera->getAspectRatio();
         Real fov = targetCamera->getFOV();
@@ -104,19 +104,22 @@ namespace Core {
                 Real yf = this->cascadeBoundaries[i] * tanHalfVFOV;
 
                 const UInt32 NumFrustumCorners = 8;
-                Point3r frustumCorners[NumFrustumCorners] = {
-                    // near face
-                    Point3r(xn, yn, -this->cascadeBoundaries[i - 1]),
-                    Point3r(-xn, yn, -this->cascadeBoundaries[i - 1]),
-                    Point3r(xn, -yn, -this->cascadeBoundaries[i - 1]),
-                    Point3r(-xn, -yn, -this->cascadeBoundaries[i - 1]),
-
-                    // far face
-                    Point3r(xf, yf, -this->cascadeBoundaries[i]),
-                    Point3r(-xf, yf, -this->cascadeBoundaries[i]),
-                    Point3r(xf, -yf, -this->cascadeBoundaries[i]),
-                    Point3r(-xf, -yf, -this->cascadeBoundaries[i]) 
-                };
+                Real cornerZ[2] = {-this->cascadeBoundaries[i - 1], -this->cascadeBoundaries[i]};
+                Real cornerX[2] = {xn, xf};
+                Real cornerY[2] = {yn, yf};
+
+                // (x, y, z, w) corners of the cascade's frustum slice; near face first
+                Real frustumCorners[NumFrustumCorners * 4];
+                for (UInt32 j = 0; j < NumFrustumCorners; j++) {
+                    UInt32 face = j / 4;
+                    frustumCorners[j * 4] = (j & 1) ? -cornerX[face] : cornerX[face];
+                    frustumCorners[j * 4 + 1] = (j & 2) ? -cornerY[face] : cornerY[face];
+                    frustumCorners[j * 4 + 2] = cornerZ[face];
+                    frustumCorners[j * 4 + 3] = 1.0f;
+                }
+
+                // transform the frustum corners from view space to world space to light space in one batch
+                viewToLightTransform.transformPoints(frustumCorners, frustumCorners, NumFrustumCorners);
 
                 float minX = 0.0f;
                 float maxX = 0.0f;
@@ -126,20 +129,13 @@ namespace Core {
                 float maxZ = 0.0f;
 
                 for (UInt32 j = 0 ; j < NumFrustumCorners ; j++) {
-
-                    // Transform the frustum coordinate from view to world space
-                    Point3r corner = frustumCorners[j];                               
-                    targetCameraTransform.getWorldMatrix().transform(corner);
-                    // Transform the frustum coordinate from world to light space
-                    lightTransformInverse.transform(corner);
-
-                    minX = j == 0 ? corner.x : Math::min(minX, corner.x);
-                    maxX = j == 0 ? corner.x : Math::max(maxX, corner.x);
-                    minY = j == 0 ? corner.y : Math::min(minY, corner.y);
-                    maxY = j == 0 ? corner.y : Math::max(maxY, corner.y);
-                    minZ = j == 0 ? corner.z : Math::min(minZ, corner.z);
-                    maxZ = j == 0 ? corner.z : Math::max(maxZ, corner.z);
-
+                    const Real* corner = frustumCorners + j * 4;
+                    minX = j == 0 ? corner[0] : Math::min(minX, corner[0]);
+                    maxX = j == 0 ? corner[0] : Math::max(maxX, corner[0]);
+                    minY = j == 0 ? corner[1] : Math::min(minY, corner[1]);
+                    maxY = j == 0 ? corner[1] : Math::max(maxY, corner[1]);
+                    minZ = j == 0 ? corner[2] : Math::min(minZ, corner[2]);
+                    maxZ = j == 0 ? corner[2] : Math::max(maxZ, corner[2]);
                 }
 
                 OrthoProjection& oProj = this->projections[i - 1];
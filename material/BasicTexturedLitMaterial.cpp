@@ -226,4 +226,9 @@ namespace Core {
     UInt32 BasicTexturedLitMaterial::textureCount() {
         return 1;
     }
+
+    void BasicTexturedLitMaterial::getTextures(std::vector<WeakPointer<Texture>>& textures) {
+        if (this->albedoMapEnabled) textures.push_back(this->albedoMap);
+        if (this->normalMapEnabled) textures.push_back(this->normalMap);
+    }
 }
\ No newline at end of file
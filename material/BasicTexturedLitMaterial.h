@@ -24,6 +24,7 @@ namespace Core {
         void setNormalMapEnabled(Bool enabled);
         void setNormalMap(WeakPointer<Texture> normalMap);
         virtual UInt32 textureCount() override;
+        virtual void getTextures(std::vector<WeakPointer<Texture>>& textures) override;
 
     protected:
         BasicTexturedLitMaterial(WeakPointer<Graphics> graphics);
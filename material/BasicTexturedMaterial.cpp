@@ -57,6 +57,10 @@ namespace Core {
         this->texture = texture;
     }
 
+    void BasicTexturedMaterial::getTextures(std::vector<WeakPointer<Texture>>& textures) {
+        if (this->texture.isValid()) textures.push_back(this->texture);
+    }
+
     void BasicTexturedMaterial::sendCustomUniformsToShader() {
         if (this->texture) {
             this->shader->setTexture2D(0, textureLocation, this->texture->getTextureID());
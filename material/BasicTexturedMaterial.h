@@ -19,6 +19,7 @@ namespace Core {
         virtual void sendCustomUniformsToShader() override;
         virtual WeakPointer<Material> clone() override;
         void setTexture(WeakPointer<Texture> texture);
+        virtual void getTextures(std::vector<WeakPointer<Texture>>& textures) override;
 
     protected:
         BasicTexturedMaterial(WeakPointer<Graphics> graphics);
@@ -41,6 +41,27 @@ namespace Core {
         return 0;
     }
 
+    /*
+     * Append the textures the material samples to [textures].
+     */
+    void Material::getTextures(std::vector<WeakPointer<Texture>>& textures) {
+
+    }
+
+    /*
+     * The set of standard vertex attributes this material's shader actually reads.
+     */
+    StandardAttributeSet Material::getConsumedAttributes() {
+        StandardAttributeSet consumed = StandardAttributes::createAttributeSet();
+        for (UInt32 i = 0; i < (UInt32)StandardAttribute::_Count; i++) {
+            StandardAttribute attribute = (StandardAttribute)i;
+            if (this->getShaderLocation(attribute) >= 0) {
+                StandardAttributes::addAttribute(&consumed, attribute);
+            }
+        }
+        return consumed;
+    }
+
     Bool Material::getColorWriteEnabled() const {
         return this->colorWriteEnabled;
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "../Graphics.h"
 #include "../util/PersistentWeakPointer.h"
@@ -13,6 +14,7 @@ namespace Core {
 
     // forward declarations
     class Shader;
+    class Texture;
 
     class Material {
     public:
@@ -26,6 +28,8 @@ namespace Core {
         virtual void sendCustomUniformsToShader() = 0;
         virtual WeakPointer<Material> clone() = 0;
         virtual UInt32 textureCount();
+        virtual void getTextures(std::vector<WeakPointer<Texture>>& textures);
+        StandardAttributeSet getConsumedAttributes();
 
         Bool getColorWriteEnabled() const;
         void setColorWriteEnabled(Bool enabled);
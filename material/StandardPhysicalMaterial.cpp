@@ -168,6 +168,25 @@ namespace Core {
         this->metallicMapEnabled = enabled;
     }
 
+    /*
+     * Use only [region] of the albedo map's texture, when the map was packed into a TextureAtlas.
+     */
+    void StandardPhysicalMaterial::setAlbedoMapRegion(const TextureAtlas::Region& region) {
+        this->albedoMapRegion = region;
+    }
+
+    void StandardPhysicalMaterial::setNormalMapRegion(const TextureAtlas::Region& region) {
+        this->normalMapRegion = region;
+    }
+
+    void StandardPhysicalMaterial::setRoughnessMapRegion(const TextureAtlas::Region& region) {
+        this->roughnessMapRegion = region;
+    }
+
+    void StandardPhysicalMaterial::setMetallicMapRegion(const TextureAtlas::Region& region) {
+        this->metallicMapRegion = region;
+    }
+
     void StandardPhysicalMaterial::sendCustomUniformsToShader() {
         UInt32 textureLoc = 0;
         if (this->albedoMapEnabled) {
@@ -205,6 +224,25 @@ namespace Core {
         
         this->shader->setUniform1f(this->ambientOcclusionLocation, this->ambientOcclusion);
         this->shader->setUniform1i(this->enabledMapLocation, this->getEnabledMapMask());
+
+        UInt32 atlasMapMask = this->getAtlasMapMask();
+        this->shader->setUniform1i(this->atlasMapLocation, atlasMapMask);
+        if (atlasMapMask & ALBEDO_MAP_MASK) {
+            const TextureAtlas::Region& region = this->albedoMapRegion;
+            this->shader->setUniform4f(this->albedoMapRegionLocation, region.uOffset, region.vOffset, region.uScale, region.vScale);
+        }
+        if (atlasMapMask & NORMAL_MAP_MASK) {
+            const TextureAtlas::Region& region = this->normalMapRegion;
+            this->shader->setUniform4f(this->normalMapRegionLocation, region.uOffset, region.vOffset, region.uScale, region.vScale);
+        }
+        if (atlasMapMask & ROUGHNESS_MAP_MASK) {
+            const TextureAtlas::Region& region = this->roughnessMapRegion;
+            this->shader->setUniform4f(this->roughnessMapRegionLocation, region.uOffset, region.vOffset, region.uScale, region.vScale);
+        }
+        if (atlasMapMask & METALLIC_MAP_MASK) {
+            const TextureAtlas::Region& region = this->metallicMapRegion;
+            this->shader->setUniform4f(this->metallicMapRegionLocation, region.uOffset, region.vOffset, region.uScale, region.vScale);
+        }
     }
 
     void StandardPhysicalMaterial::copyTo(WeakPointer<Material> target) {
@@ -218,6 +256,10 @@ namespace Core {
         targetMaterial->normalMapEnabled = this->normalMapEnabled;
         targetMaterial->roughnessMapEnabled = this->roughnessMapEnabled;
         targetMaterial->metallicMapEnabled = this->metallicMapEnabled;
+        targetMaterial->albedoMapRegion = this->albedoMapRegion;
+        targetMaterial->normalMapRegion = this->normalMapRegion;
+        targetMaterial->roughnessMapRegion = this->roughnessMapRegion;
+        targetMaterial->metallicMapRegion = this->metallicMapRegion;
         targetMaterial->positionLocation = this->positionLocation;
         targetMaterial->normalLocation = this->normalLocation;
         targetMaterial->faceNormalLocation = this->faceNormalLocation;
@@ -264,6 +306,11 @@ namespace Core {
         targetMaterial->roughnessLocation = this->roughnessLocation;
         targetMaterial->ambientOcclusionLocation = this->ambientOcclusionLocation;
         targetMaterial->enabledMapLocation = this->enabledMapLocation;
+        targetMaterial->atlasMapLocation = this->atlasMapLocation;
+        targetMaterial->albedoMapRegionLocation = this->albedoMapRegionLocation;
+        targetMaterial->normalMapRegionLocation = this->normalMapRegionLocation;
+        targetMaterial->roughnessMapRegionLocation = this->roughnessMapRegionLocation;
+        targetMaterial->metallicMapRegionLocation = this->metallicMapRegionLocation;
         targetMaterial->metallic = this->metallic;
         targetMaterial->roughness = this->roughness;
         targetMaterial->ambientOcclusion = this->ambientOcclusion;
@@ -325,6 +372,11 @@ namespace Core {
         this->roughnessLocation = this->shader->getUniformLocation("roughness");
         this->ambientOcclusionLocation = this->shader->getUniformLocation("ambientOcclusion");
         this->enabledMapLocation = this->shader->getUniformLocation("enabledMap");
+        this->atlasMapLocation = this->shader->getUniformLocation("atlasMap");
+        this->albedoMapRegionLocation = this->shader->getUniformLocation("albedoMapRegion");
+        this->normalMapRegionLocation = this->shader->getUniformLocation("normalMapRegion");
+        this->roughnessMapRegionLocation = this->shader->getUniformLocation("roughnessMapRegion");
+        this->metallicMapRegionLocation = this->shader->getUniformLocation("metallicMapRegion");
     }
 
     UInt32 StandardPhysicalMaterial::textureCount() {
@@ -336,6 +388,13 @@ namespace Core {
        return textureCount;
     }
 
+    void StandardPhysicalMaterial::getTextures(std::vector<WeakPointer<Texture>>& textures) {
+        if (this->albedoMapEnabled) textures.push_back(this->albedoMap);
+        if (this->normalMapEnabled) textures.push_back(this->normalMap);
+        if (this->metallicMapEnabled) textures.push_back(this->metallicMap);
+        if (this->roughnessMapEnabled) textures.push_back(this->roughnessMap);
+    }
+
     UInt32 StandardPhysicalMaterial::getEnabledMapMask() {
         UInt32 mask = 0;
         if (this->albedoMapEnabled) mask = mask | ALBEDO_MAP_MASK;
@@ -344,4 +403,16 @@ namespace Core {
         if (this->metallicMapEnabled) mask = mask | METALLIC_MAP_MASK;
         return mask;
     }
+
+    /*
+     * The enabled maps that sample only a region of their texture.
+     */
+    UInt32 StandardPhysicalMaterial::getAtlasMapMask() {
+        UInt32 mask = 0;
+        if (this->albedoMapEnabled && !this->albedoMapRegion.isWhole()) mask = mask | ALBEDO_MAP_MASK;
+        if (this->normalMapEnabled && !this->normalMapRegion.isWhole()) mask = mask | NORMAL_MAP_MASK;
+        if (this->roughnessMapEnabled && !this->roughnessMapRegion.isWhole()) mask = mask | ROUGHNESS_MAP_MASK;
+        if (this->metallicMapEnabled && !this->metallicMapRegion.isWhole()) mask = mask | METALLIC_MAP_MASK;
+        return mask;
+    }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../util/WeakPointer.h"
 #include "ShaderMaterial.h"
 #include "../common/Constants.h"
+#include "../image/TextureAtlas.h"
 
 namespace Core {
 
@@ -31,7 +32,12 @@ namespace Core {
         void setNormalMapEnabled(Bool enabled);
         void setRoughnessMapEnabled(Bool enabled);
         void setMetallicMapEnabled(Bool enabled);
+        void setAlbedoMapRegion(const TextureAtlas::Region& region);
+        void setNormalMapRegion(const TextureAtlas::Region& region);
+        void setRoughnessMapRegion(const TextureAtlas::Region& region);
+        void setMetallicMapRegion(const TextureAtlas::Region& region);
         virtual UInt32 textureCount() override;
+        virtual void getTextures(std::vector<WeakPointer<Texture>>& textures) override;
         virtual void copyTo(WeakPointer<Material> targetMaterial) override;
         virtual void bindShaderVarLocations() override;
 
@@ -44,6 +50,7 @@ namespace Core {
         StandardPhysicalMaterial(const std::string& vertexShader, const std::string& fragmentShader, WeakPointer<Graphics> graphics);
         StandardPhysicalMaterial(WeakPointer<Graphics> graphics);
         UInt32 getEnabledMapMask();
+        UInt32 getAtlasMapMask();
 
         Real metallic;
         Real roughness;
@@ -59,6 +66,12 @@ namespace Core {
         Bool roughnessMapEnabled;
         Bool metallicMapEnabled;
 
+        // where in their textures the maps are, for maps packed into a TextureAtlas
+        TextureAtlas::Region albedoMapRegion;
+        TextureAtlas::Region normalMapRegion;
+        TextureAtlas::Region roughnessMapRegion;
+        TextureAtlas::Region metallicMapRegion;
+
         Int32 positionLocation;
         Int32 normalLocation;
         Int32 faceNormalLocation;
@@ -104,5 +117,10 @@ namespace Core {
         Int32 roughnessLocation;
         Int32 ambientOcclusionLocation;
         Int32 enabledMapLocation;
+        Int32 atlasMapLocation;
+        Int32 albedoMapRegionLocation;
+        Int32 normalMapRegionLocation;
+        Int32 roughnessMapRegionLocation;
+        Int32 metallicMapRegionLocation;
     };
 }
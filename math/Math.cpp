@@ -47,6 +47,10 @@ namespace Core {
         return (Real)floor(n + 0.5f);
     }
 
+    Real Math::floor(Real n) {
+        return (Real)std::floor(n);
+    }
+
     Real Math::inverseSquareRoot(Real n) {
         Real root = squareRoot(n);
         if (root == 0) return 0;
@@ -16,6 +16,7 @@ namespace Core {
     static Real squareRoot(Real n);
     static Real quickSquareRoot(Real n);
     static Real round(Real n);
+    static Real floor(Real n);
     static Real cos(Real n);
     static Real aCos(Real n);
     static Real sin(Real n);
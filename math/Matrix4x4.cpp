@@ -1,11 +1,43 @@
 #include "Matrix4x4.h"
 #include <string.h>
+#include <type_traits>
 #include "../common/Exception.h"
 #include "../common/debug.h"
+#include "../geometry/Box3.h"
+#include "../util/ThreadPool.h"
 #include "Quaternion.h"
 
+// SIMD paths are only used for single-precision matrices; everything else takes the scalar code
+#if !defined(_Real_DoublePrecision_) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define CORE_MATRIX4X4_SSE
+#include <xmmintrin.h>
+#if defined(__AVX__)
+#define CORE_MATRIX4X4_AVX
+#include <immintrin.h>
+#endif
+#endif
+
 namespace Core {
 
+    static_assert(sizeof(Matrix4x4) == sizeof(Real) * SIZE_MATRIX_4X4, "Matrix4x4 must contain nothing but its elements.");
+    static_assert(std::is_trivially_copyable<Matrix4x4>::value, "Matrix4x4 must be trivially copyable.");
+
+    // batched transforms of at least this many elements are split across a thread pool, if one is given
+    static const UInt32 ParallelTransformThreshold = 16384;
+    static const UInt32 TransformChunkSize = 4096;
+
+#if defined(CORE_MATRIX4X4_SSE)
+    /*
+     * Cross product of the xyz portions of [a] and [b]; w of the result is a.w * b.w - a.w * b.w.
+     */
+    static inline __m128 cross3(__m128 a, __m128 b) {
+        __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+        return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+#endif
+
 #define I(_i, _j) ((_j) + ROWSIZE_MATRIX_4X4 * (_i))
 
     /*********************************************
@@ -40,13 +72,6 @@ namespace Core {
         }
     }
 
-    Matrix4x4::Matrix4x4(const Matrix4x4 &source) {
-        this->copy(source);
-    }
-
-    Matrix4x4::~Matrix4x4() {
-    }
-
     Real *Matrix4x4::getData() {
         return this->data;
     }
@@ -71,15 +96,6 @@ namespace Core {
         }
     }
 
-    /*
-     * Overloaded assignment operator
-     */
-    Matrix4x4 &Matrix4x4::operator=(const Matrix4x4 &source) {
-        if (this == &source) return *this;
-        this->copy(source);
-        return *this;
-    }
-
     /*
      * Copy data from existing matrix to this one
      */
@@ -112,6 +128,17 @@ namespace Core {
         if (source == nullptr) throw NullPointerException("Matrix4x4::transpose -> 'source' is null.");
         if (dest == nullptr) throw NullPointerException("Matrix4x4::transpose -> 'dest' is null.");
 
+#if defined(CORE_MATRIX4X4_SSE)
+        __m128 col0 = _mm_loadu_ps(source);
+        __m128 col1 = _mm_loadu_ps(source + 4);
+        __m128 col2 = _mm_loadu_ps(source + 8);
+        __m128 col3 = _mm_loadu_ps(source + 12);
+        _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+        _mm_storeu_ps(dest, col0);
+        _mm_storeu_ps(dest + 4, col1);
+        _mm_storeu_ps(dest + 8, col2);
+        _mm_storeu_ps(dest + 12, col3);
+#else
         for (Int32 i = 0; i < ROWSIZE_MATRIX_4X4; i++) {
             Int32 mBase = i * ROWSIZE_MATRIX_4X4;
             dest[i] = source[mBase];
@@ -119,6 +146,7 @@ namespace Core {
             dest[i + ROWSIZE_MATRIX_4X4 * 2] = source[mBase + 2];
             dest[i + ROWSIZE_MATRIX_4X4 * 3] = source[mBase + 3];
         }
+#endif
     }
 
     /*
@@ -150,15 +178,15 @@ namespace Core {
      * Returns false if the matrix cannot be inverted
      */
     Bool Matrix4x4::invert(const Real *source, Real *dest) {
-        // we need to know if the matrix is affine so that we can make it affine
-        // once again after the inversion. the inversion process can introduce very small
-        // precision errors that accumulate over time and eventually
-        // result in a non-affine matrix
-        Bool isAffine = Matrix4x4::isAffine(source);
-
         if (source == nullptr) throw NullPointerException("Matrix4x4::invert -> 'source' is null.");
         if (dest == nullptr) throw NullPointerException("Matrix4x4::invert -> 'dest' is null.");
 
+        // affine matrices (the common case for scene transforms) have a much cheaper inverse, and
+        // the affine path writes an exact bottom row so precision errors can't accumulate there
+        if (Matrix4x4::isAffine(source)) {
+            return Matrix4x4::invertAffine(source, dest);
+        }
+
         Real adjoin[SIZE_MATRIX_4X4];
         Real det = Matrix4x4::calculateDeterminant(source, adjoin);
 
@@ -170,16 +198,96 @@ namespace Core {
         det = 1 / det;
         for (Int32 j = 0; j < SIZE_MATRIX_4X4; j++) dest[j] = adjoin[j] * det;
 
-        // if the matrix was affine before inversion, make it affine again
-        // to avoid accumulating preicision errors
-        if (isAffine) {
-            dest[3] = 0;
-            dest[7] = 0;
-            dest[11] = 0;
-            dest[15] = 1;
+        return true;
+    }
+
+    /*
+     * Invert the affine 4x4 matrix pointed to by [source] and store the result in [dest]. Only the
+     * upper 3x3 portion is inverted (via its adjugate); the inverse translation is then derived from it.
+     * [source] and [dest] may point to the same array.
+     *
+     * Returns false if the matrix cannot be inverted
+     */
+    Bool Matrix4x4::invertAffine(const Real *source, Real *dest) {
+        if (source == nullptr) throw NullPointerException("Matrix4x4::invertAffine -> 'source' is null.");
+        if (dest == nullptr) throw NullPointerException("Matrix4x4::invertAffine -> 'dest' is null.");
+
+#if defined(CORE_MATRIX4X4_SSE)
+        // the rows of the adjugate of the upper 3x3 portion are the cross products of pairs of its
+        // columns; the columns' w components are zero since the matrix is affine
+        __m128 col0 = _mm_loadu_ps(source);
+        __m128 col1 = _mm_loadu_ps(source + 4);
+        __m128 col2 = _mm_loadu_ps(source + 8);
+        __m128 translation = _mm_loadu_ps(source + 12);
+        __m128 row0 = cross3(col1, col2);
+        __m128 row1 = cross3(col2, col0);
+        __m128 row2 = cross3(col0, col1);
+
+        Real products[4];
+        _mm_storeu_ps(products, _mm_mul_ps(col0, row0));
+        Real det = products[0] + products[1] + products[2];
+        if (det == 0.0f) {
+            return false;
         }
 
+        __m128 invDet = _mm_set1_ps(1 / det);
+        row0 = _mm_mul_ps(row0, invDet);
+        row1 = _mm_mul_ps(row1, invDet);
+        row2 = _mm_mul_ps(row2, invDet);
+        __m128 row3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+        // after the transpose row0..row2 hold the columns of the inverted 3x3 portion
+        __m128 invTranslation = _mm_mul_ps(row0, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(0, 0, 0, 0)));
+        invTranslation = _mm_add_ps(invTranslation, _mm_mul_ps(row1, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(1, 1, 1, 1))));
+        invTranslation = _mm_add_ps(invTranslation, _mm_mul_ps(row2, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(2, 2, 2, 2))));
+        invTranslation = _mm_sub_ps(_mm_setzero_ps(), invTranslation);
+
+        _mm_storeu_ps(dest, row0);
+        _mm_storeu_ps(dest + 4, row1);
+        _mm_storeu_ps(dest + 8, row2);
+        _mm_storeu_ps(dest + 12, invTranslation);
+        dest[15] = 1;
+        return true;
+#else
+        // upper 3x3 portion, named by row
+        Real a = source[0], b = source[4], c = source[8];
+        Real d = source[1], e = source[5], f = source[9];
+        Real g = source[2], h = source[6], i = source[10];
+
+        Real c00 = e * i - f * h;
+        Real c01 = f * g - d * i;
+        Real c02 = d * h - e * g;
+        Real det = a * c00 + b * c01 + c * c02;
+
+        if (det == 0.0f) {
+            return false;
+        }
+
+        det = 1 / det;
+        Real temp[SIZE_MATRIX_4X4];
+        temp[0] = c00 * det;
+        temp[1] = c01 * det;
+        temp[2] = c02 * det;
+        temp[3] = 0;
+        temp[4] = (c * h - b * i) * det;
+        temp[5] = (a * i - c * g) * det;
+        temp[6] = (b * g - a * h) * det;
+        temp[7] = 0;
+        temp[8] = (b * f - c * e) * det;
+        temp[9] = (c * d - a * f) * det;
+        temp[10] = (a * e - b * d) * det;
+        temp[11] = 0;
+
+        Real tx = source[12], ty = source[13], tz = source[14];
+        temp[12] = -(temp[0] * tx + temp[4] * ty + temp[8] * tz);
+        temp[13] = -(temp[1] * tx + temp[5] * ty + temp[9] * tz);
+        temp[14] = -(temp[2] * tx + temp[6] * ty + temp[10] * tz);
+        temp[15] = 1;
+
+        memcpy(dest, temp, sizeof(Real) * SIZE_MATRIX_4X4);
         return true;
+#endif
     }
 
     /*
@@ -189,23 +297,23 @@ namespace Core {
         Matrix4x4 rotMatrix = rotation.rotationMatrix();
 
         // Build the final matrix, with translation, scale, and rotation
-        A0 = scale.x * rotMatrix.A0;
-        A1 = scale.y * rotMatrix.A1;
-        A2 = scale.z * rotMatrix.A2;
-        A3 = translation.x;
-        B0 = scale.x * rotMatrix.B0;
-        B1 = scale.y * rotMatrix.B1;
-        B2 = scale.z * rotMatrix.B2;
-        B3 = translation.y;
-        C0 = scale.x * rotMatrix.C0;
-        C1 = scale.y * rotMatrix.C1;
-        C2 = scale.z * rotMatrix.C2;
-        C3 = translation.z;
-
-        D0 = 0;
-        D1 = 0;
-        D2 = 0;
-        D3 = 1;
+        A0() = scale.x * rotMatrix.A0();
+        A1() = scale.y * rotMatrix.A1();
+        A2() = scale.z * rotMatrix.A2();
+        A3() = translation.x;
+        B0() = scale.x * rotMatrix.B0();
+        B1() = scale.y * rotMatrix.B1();
+        B2() = scale.z * rotMatrix.B2();
+        B3() = translation.y;
+        C0() = scale.x * rotMatrix.C0();
+        C1() = scale.y * rotMatrix.C1();
+        C2() = scale.z * rotMatrix.C2();
+        C3() = translation.z;
+
+        D0() = 0;
+        D1() = 0;
+        D2() = 0;
+        D3() = 1;
     }
 
     void Matrix4x4::decompose(Vector3Components<Real> &translation, Quaternion &rotation, Vector3Components<Real> &scale) const {
@@ -214,41 +322,41 @@ namespace Core {
         Matrix4x4 rotMatrix;
 
         // build orthogonal matrix [rotMatrix]
-        Real fInvLength = Math::inverseSquareRoot(A0 * A0 + B0 * B0 + C0 * C0);
+        Real fInvLength = Math::inverseSquareRoot(A0() * A0() + B0() * B0() + C0() * C0());
 
-        rotMatrix.A0 = A0 * fInvLength;
-        rotMatrix.B0 = B0 * fInvLength;
-        rotMatrix.C0 = C0 * fInvLength;
+        rotMatrix.A0() = A0() * fInvLength;
+        rotMatrix.B0() = B0() * fInvLength;
+        rotMatrix.C0() = C0() * fInvLength;
 
-        Real fDot = rotMatrix.A0 * A1 + rotMatrix.B0 * B1 + rotMatrix.C0 * C1;
-        rotMatrix.A1 = A1 - fDot * rotMatrix.A0;
-        rotMatrix.B1 = B1 - fDot * rotMatrix.B0;
-        rotMatrix.C1 = C1 - fDot * rotMatrix.C0;
-        fInvLength = Math::inverseSquareRoot(rotMatrix.A1 * rotMatrix.A1 + rotMatrix.B1 * rotMatrix.B1 + rotMatrix.C1 * rotMatrix.C1);
+        Real fDot = rotMatrix.A0() * A1() + rotMatrix.B0() * B1() + rotMatrix.C0() * C1();
+        rotMatrix.A1() = A1() - fDot * rotMatrix.A0();
+        rotMatrix.B1() = B1() - fDot * rotMatrix.B0();
+        rotMatrix.C1() = C1() - fDot * rotMatrix.C0();
+        fInvLength = Math::inverseSquareRoot(rotMatrix.A1() * rotMatrix.A1() + rotMatrix.B1() * rotMatrix.B1() + rotMatrix.C1() * rotMatrix.C1());
 
-        rotMatrix.A1 *= fInvLength;
-        rotMatrix.B1 *= fInvLength;
-        rotMatrix.C1 *= fInvLength;
+        rotMatrix.A1() *= fInvLength;
+        rotMatrix.B1() *= fInvLength;
+        rotMatrix.C1() *= fInvLength;
 
-        fDot = rotMatrix.A0 * A2 + rotMatrix.B0 * B2 + rotMatrix.C0 * C2;
-        rotMatrix.A2 = A2 - fDot * rotMatrix.A0;
-        rotMatrix.B2 = B2 - fDot * rotMatrix.B0;
-        rotMatrix.C2 = C2 - fDot * rotMatrix.C0;
+        fDot = rotMatrix.A0() * A2() + rotMatrix.B0() * B2() + rotMatrix.C0() * C2();
+        rotMatrix.A2() = A2() - fDot * rotMatrix.A0();
+        rotMatrix.B2() = B2() - fDot * rotMatrix.B0();
+        rotMatrix.C2() = C2() - fDot * rotMatrix.C0();
 
-        fDot = rotMatrix.A1 * A2 + rotMatrix.B1 * B2 + rotMatrix.C1 * C2;
-        rotMatrix.A2 -= fDot * rotMatrix.A1;
-        rotMatrix.B2 -= fDot * rotMatrix.B1;
-        rotMatrix.C2 -= fDot * rotMatrix.C1;
+        fDot = rotMatrix.A1() * A2() + rotMatrix.B1() * B2() + rotMatrix.C1() * C2();
+        rotMatrix.A2() -= fDot * rotMatrix.A1();
+        rotMatrix.B2() -= fDot * rotMatrix.B1();
+        rotMatrix.C2() -= fDot * rotMatrix.C1();
 
-        fInvLength = Math::inverseSquareRoot(rotMatrix.A2 * rotMatrix.A2 + rotMatrix.B2 * rotMatrix.B2 + rotMatrix.C2 * rotMatrix.C2);
+        fInvLength = Math::inverseSquareRoot(rotMatrix.A2() * rotMatrix.A2() + rotMatrix.B2() * rotMatrix.B2() + rotMatrix.C2() * rotMatrix.C2());
 
-        rotMatrix.A2 *= fInvLength;
-        rotMatrix.B2 *= fInvLength;
-        rotMatrix.C2 *= fInvLength;
+        rotMatrix.A2() *= fInvLength;
+        rotMatrix.B2() *= fInvLength;
+        rotMatrix.C2() *= fInvLength;
 
         // guarantee that orthogonal matrix has determinant 1 (no reflections)
-        Real fDet = rotMatrix.A0 * rotMatrix.B1 * rotMatrix.C2 + rotMatrix.A1 * rotMatrix.B2 * rotMatrix.C0 + rotMatrix.A2 * rotMatrix.B0 * rotMatrix.C1 -
-                    rotMatrix.A2 * rotMatrix.B1 * rotMatrix.C0 - rotMatrix.A1 * rotMatrix.B0 * rotMatrix.C2 - rotMatrix.A0 * rotMatrix.B2 * rotMatrix.C1;
+        Real fDet = rotMatrix.A0() * rotMatrix.B1() * rotMatrix.C2() + rotMatrix.A1() * rotMatrix.B2() * rotMatrix.C0() + rotMatrix.A2() * rotMatrix.B0() * rotMatrix.C1() -
+                    rotMatrix.A2() * rotMatrix.B1() * rotMatrix.C0() - rotMatrix.A1() * rotMatrix.B0() * rotMatrix.C2() - rotMatrix.A0() * rotMatrix.B2() * rotMatrix.C1();
 
         if (fDet < 0.0) {
             for (size_t iRow = 0; iRow < 3; iRow++)
@@ -257,32 +365,32 @@ namespace Core {
 
         // build "right" matrix [rightMatrix]
         Matrix4x4 rightMatrix;
-        rightMatrix.A0 = rotMatrix.A0 * A0 + rotMatrix.B0 * B0 + rotMatrix.C0 * C0;
-        rightMatrix.A1 = rotMatrix.A0 * A1 + rotMatrix.B0 * B1 + rotMatrix.C0 * C1;
-        rightMatrix.B1 = rotMatrix.A1 * A1 + rotMatrix.B1 * B1 + rotMatrix.C1 * C1;
-        rightMatrix.A2 = rotMatrix.A0 * A2 + rotMatrix.B0 * B2 + rotMatrix.C0 * C2;
-        rightMatrix.B2 = rotMatrix.A1 * A2 + rotMatrix.B1 * B2 + rotMatrix.C1 * C2;
-        rightMatrix.C2 = rotMatrix.A2 * A2 + rotMatrix.B2 * B2 + rotMatrix.C2 * C2;
+        rightMatrix.A0() = rotMatrix.A0() * A0() + rotMatrix.B0() * B0() + rotMatrix.C0() * C0();
+        rightMatrix.A1() = rotMatrix.A0() * A1() + rotMatrix.B0() * B1() + rotMatrix.C0() * C1();
+        rightMatrix.B1() = rotMatrix.A1() * A1() + rotMatrix.B1() * B1() + rotMatrix.C1() * C1();
+        rightMatrix.A2() = rotMatrix.A0() * A2() + rotMatrix.B0() * B2() + rotMatrix.C0() * C2();
+        rightMatrix.B2() = rotMatrix.A1() * A2() + rotMatrix.B1() * B2() + rotMatrix.C1() * C2();
+        rightMatrix.C2() = rotMatrix.A2() * A2() + rotMatrix.B2() * B2() + rotMatrix.C2() * C2();
 
         // the scaling component
-        scale.x = rightMatrix.A0;
-        scale.y = rightMatrix.B1;
-        scale.z = rightMatrix.C2;
+        scale.x = rightMatrix.A0();
+        scale.y = rightMatrix.B1();
+        scale.z = rightMatrix.C2();
 
         Vector3r shear;
 
         // the shear component
         Real fInvD0 = 1.0f / scale.x;
-        shear.x = rightMatrix.A1 * fInvD0;
-        shear.y = rightMatrix.A2 * fInvD0;
-        shear.z = rightMatrix.B2 / scale.y;
+        shear.x = rightMatrix.A1() * fInvD0;
+        shear.y = rightMatrix.A2() * fInvD0;
+        shear.z = rightMatrix.B2() / scale.y;
 
         rotation.fromMatrix(rotMatrix);
-        translation.set(A3, B3, C3);
+        translation.set(A3(), B3(), C3());
     }
 
     Bool Matrix4x4::isAffine(void) const {
-        return D0 == 0 && D1 == 0 && D2 == 0 && D3 == 1;
+        return D0() == 0 && D1() == 0 && D2() == 0 && D3() == 1;
     }
 
     Bool Matrix4x4::isAffine(const Real *data) {
@@ -443,6 +551,138 @@ namespace Core {
         memcpy(vector4f, temp, sizeof(Real) * ROWSIZE_MATRIX_4X4);
     }
 
+    /*
+     * Transform [count] points stored as consecutive (x, y, z, w) groups in [source] (the layout of
+     * packed Point3rs/Vector3rs storage) and store them in [dest], which may be the same array. Each
+     * point is treated as having w = 1, and as with transform(Vector3Base&), the result is divided by
+     * the transformed w when this matrix is not affine. Large batches are split across [threadPool].
+     */
+    void Matrix4x4::transformPoints(const Real *source, Real *dest, UInt32 count, ThreadPool *threadPool) const {
+        if (source == nullptr) throw NullPointerException("Matrix4x4::transformPoints -> 'source' is null.");
+        if (dest == nullptr) throw NullPointerException("Matrix4x4::transformPoints -> 'dest' is null.");
+        this->transformStream(source, dest, count, 1.0f, threadPool);
+    }
+
+    /*
+     * Same as transformPoints(), but each element is treated as a direction (w = 0), so the
+     * translation portion of this matrix has no effect.
+     */
+    void Matrix4x4::transformDirections(const Real *source, Real *dest, UInt32 count, ThreadPool *threadPool) const {
+        if (source == nullptr) throw NullPointerException("Matrix4x4::transformDirections -> 'source' is null.");
+        if (dest == nullptr) throw NullPointerException("Matrix4x4::transformDirections -> 'dest' is null.");
+        this->transformStream(source, dest, count, 0.0f, threadPool);
+    }
+
+    void Matrix4x4::transformStream(const Real *source, Real *dest, UInt32 count, Real w, ThreadPool *threadPool) const {
+        if (threadPool == nullptr || count < ParallelTransformThreshold) {
+            this->transformStreamRange(source, dest, count, w);
+            return;
+        }
+        UInt32 chunkCount = (count + TransformChunkSize - 1) / TransformChunkSize;
+        threadPool->parallelFor(chunkCount, [this, source, dest, count, w](UInt32 chunk) {
+            UInt32 start = chunk * TransformChunkSize;
+            UInt32 chunkSize = count - start < TransformChunkSize ? count - start : TransformChunkSize;
+            this->transformStreamRange(source + start * ROWSIZE_MATRIX_4X4, dest + start * ROWSIZE_MATRIX_4X4, chunkSize, w);
+        });
+    }
+
+    void Matrix4x4::transformStreamRange(const Real *source, Real *dest, UInt32 count, Real w) const {
+        if (this->isAffine()) {
+#if defined(CORE_MATRIX4X4_SSE)
+            __m128 col0 = _mm_loadu_ps(this->data);
+            __m128 col1 = _mm_loadu_ps(this->data + 4);
+            __m128 col2 = _mm_loadu_ps(this->data + 8);
+            // for an affine matrix the result's w is exactly [w], so no divide is needed
+            __m128 translation = _mm_mul_ps(_mm_loadu_ps(this->data + 12), _mm_set1_ps(w));
+            for (UInt32 i = 0; i < count; i++) {
+                __m128 v = _mm_loadu_ps(source + i * ROWSIZE_MATRIX_4X4);
+                __m128 result = _mm_add_ps(translation, _mm_mul_ps(col0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))));
+                result = _mm_add_ps(result, _mm_mul_ps(col1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+                result = _mm_add_ps(result, _mm_mul_ps(col2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+                _mm_storeu_ps(dest + i * ROWSIZE_MATRIX_4X4, result);
+            }
+            return;
+#endif
+        }
+
+        Real temp[ROWSIZE_MATRIX_4X4];
+        for (UInt32 i = 0; i < count; i++) {
+            const Real *in = source + i * ROWSIZE_MATRIX_4X4;
+            Real *out = dest + i * ROWSIZE_MATRIX_4X4;
+            Matrix4x4::mx4transform(in[0], in[1], in[2], w, this->data, temp);
+            if (temp[3] != 1.0f && temp[3] != 0.0f) {
+                temp[0] /= temp[3];
+                temp[1] /= temp[3];
+                temp[2] /= temp[3];
+            }
+            out[0] = temp[0];
+            out[1] = temp[1];
+            out[2] = temp[2];
+            out[3] = w;
+        }
+    }
+
+    /*
+     * Transform the axis-aligned [box] by this matrix and store the axis-aligned box that bounds the
+     * result in [out] ([box] and [out] may be the same object). Uses Arvo's method: each output extent
+     * starts at the translation, and for every input axis adds the smaller (for min) or larger (for max)
+     * of the matrix element times the input min and max. Non-affine matrices fall back to transforming
+     * the eight corners.
+     */
+    void Matrix4x4::transformBox(const Box3 &box, Box3 &out) const {
+        Real boxMin[3] = {box.getMin().x, box.getMin().y, box.getMin().z};
+        Real boxMax[3] = {box.getMax().x, box.getMax().y, box.getMax().z};
+        Real newMin[ROWSIZE_MATRIX_4X4];
+        Real newMax[ROWSIZE_MATRIX_4X4];
+
+        if (!this->isAffine()) {
+            Real corners[8 * ROWSIZE_MATRIX_4X4];
+            for (UInt32 i = 0; i < 8; i++) {
+                corners[i * 4] = (i & 1) ? boxMax[0] : boxMin[0];
+                corners[i * 4 + 1] = (i & 2) ? boxMax[1] : boxMin[1];
+                corners[i * 4 + 2] = (i & 4) ? boxMax[2] : boxMin[2];
+                corners[i * 4 + 3] = 1.0f;
+            }
+            this->transformStreamRange(corners, corners, 8, 1.0f);
+            for (UInt32 c = 0; c < 3; c++) {
+                newMin[c] = newMax[c] = corners[c];
+                for (UInt32 i = 1; i < 8; i++) {
+                    Real value = corners[i * 4 + c];
+                    if (value < newMin[c]) newMin[c] = value;
+                    if (value > newMax[c]) newMax[c] = value;
+                }
+            }
+        }
+        else {
+#if defined(CORE_MATRIX4X4_SSE)
+            __m128 minResult = _mm_loadu_ps(this->data + 12);
+            __m128 maxResult = minResult;
+            for (UInt32 j = 0; j < 3; j++) {
+                __m128 col = _mm_loadu_ps(this->data + j * ROWSIZE_MATRIX_4X4);
+                __m128 a = _mm_mul_ps(col, _mm_set1_ps(boxMin[j]));
+                __m128 b = _mm_mul_ps(col, _mm_set1_ps(boxMax[j]));
+                minResult = _mm_add_ps(minResult, _mm_min_ps(a, b));
+                maxResult = _mm_add_ps(maxResult, _mm_max_ps(a, b));
+            }
+            _mm_storeu_ps(newMin, minResult);
+            _mm_storeu_ps(newMax, maxResult);
+#else
+            for (UInt32 i = 0; i < 3; i++) {
+                newMin[i] = newMax[i] = this->data[12 + i];
+                for (UInt32 j = 0; j < 3; j++) {
+                    Real a = this->data[j * ROWSIZE_MATRIX_4X4 + i] * boxMin[j];
+                    Real b = this->data[j * ROWSIZE_MATRIX_4X4 + i] * boxMax[j];
+                    newMin[i] += a < b ? a : b;
+                    newMax[i] += a < b ? b : a;
+                }
+            }
+#endif
+        }
+
+        out.setMin(newMin[0], newMin[1], newMin[2]);
+        out.setMax(newMax[0], newMax[1], newMax[2]);
+    }
+
     /*
      * Add [matrix] to this matrix
      */
@@ -503,6 +743,13 @@ namespace Core {
         if (matrix == nullptr) throw NullPointerException("Matrix4x4::mx4transform -> 'lhsMat' is null.");
         if (pDest == nullptr) throw NullPointerException("Matrix4x4::mx4transform -> 'pDest' is null.");
 
+#if defined(CORE_MATRIX4X4_SSE)
+        __m128 result = _mm_mul_ps(_mm_loadu_ps(matrix), _mm_set1_ps(x));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(matrix + 4), _mm_set1_ps(y)));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(matrix + 8), _mm_set1_ps(z)));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(matrix + 12), _mm_set1_ps(w)));
+        _mm_storeu_ps(pDest, result);
+#else
         pDest[0] = matrix[0 + ROWSIZE_MATRIX_4X4 * 0] * x + matrix[0 + ROWSIZE_MATRIX_4X4 * 1] * y + matrix[0 + ROWSIZE_MATRIX_4X4 * 2] * z +
                    matrix[0 + ROWSIZE_MATRIX_4X4 * 3] * w;
         pDest[1] = matrix[1 + ROWSIZE_MATRIX_4X4 * 0] * x + matrix[1 + ROWSIZE_MATRIX_4X4 * 1] * y + matrix[1 + ROWSIZE_MATRIX_4X4 * 2] * z +
@@ -511,6 +758,7 @@ namespace Core {
                    matrix[2 + ROWSIZE_MATRIX_4X4 * 3] * w;
         pDest[3] = matrix[3 + ROWSIZE_MATRIX_4X4 * 0] * x + matrix[3 + ROWSIZE_MATRIX_4X4 * 1] * y + matrix[3 + ROWSIZE_MATRIX_4X4 * 2] * z +
                    matrix[3 + ROWSIZE_MATRIX_4X4 * 3] * w;
+#endif
     }
 
     /*********************************************************
@@ -525,8 +773,40 @@ namespace Core {
      * [lhs] The Real array that holds the left-hand-side 4x4 matrix.
      * [rhs] The Real array that holds the right-hand-side 4x4 matrix.
      *
+     * The SIMD paths read all of [lhs] and each column of [rhs] before writing the
+     * corresponding column of [out], so [out] may alias either input.
+     *
      *********************************************************/
     void Matrix4x4::multiplyMM(const Real *lhs, const Real *rhs, Real *out) {
+#if defined(CORE_MATRIX4X4_AVX)
+        // each 256-bit register holds two output columns: lhs column k is broadcast to both
+        // halves and multiplied by element k of the two corresponding rhs columns
+        __m256 lhs0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(lhs));
+        __m256 lhs1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(lhs + 4));
+        __m256 lhs2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(lhs + 8));
+        __m256 lhs3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(lhs + 12));
+        for (Int32 i = 0; i < ROWSIZE_MATRIX_4X4; i += 2) {
+            __m256 rhsCols = _mm256_loadu_ps(rhs + i * ROWSIZE_MATRIX_4X4);
+            __m256 result = _mm256_mul_ps(lhs0, _mm256_permute_ps(rhsCols, _MM_SHUFFLE(0, 0, 0, 0)));
+            result = _mm256_add_ps(result, _mm256_mul_ps(lhs1, _mm256_permute_ps(rhsCols, _MM_SHUFFLE(1, 1, 1, 1))));
+            result = _mm256_add_ps(result, _mm256_mul_ps(lhs2, _mm256_permute_ps(rhsCols, _MM_SHUFFLE(2, 2, 2, 2))));
+            result = _mm256_add_ps(result, _mm256_mul_ps(lhs3, _mm256_permute_ps(rhsCols, _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm256_storeu_ps(out + i * ROWSIZE_MATRIX_4X4, result);
+        }
+#elif defined(CORE_MATRIX4X4_SSE)
+        __m128 lhs0 = _mm_loadu_ps(lhs);
+        __m128 lhs1 = _mm_loadu_ps(lhs + 4);
+        __m128 lhs2 = _mm_loadu_ps(lhs + 8);
+        __m128 lhs3 = _mm_loadu_ps(lhs + 12);
+        for (Int32 i = 0; i < ROWSIZE_MATRIX_4X4; i++) {
+            __m128 rhsCol = _mm_loadu_ps(rhs + i * ROWSIZE_MATRIX_4X4);
+            __m128 result = _mm_mul_ps(lhs0, _mm_shuffle_ps(rhsCol, rhsCol, _MM_SHUFFLE(0, 0, 0, 0)));
+            result = _mm_add_ps(result, _mm_mul_ps(lhs1, _mm_shuffle_ps(rhsCol, rhsCol, _MM_SHUFFLE(1, 1, 1, 1))));
+            result = _mm_add_ps(result, _mm_mul_ps(lhs2, _mm_shuffle_ps(rhsCol, rhsCol, _MM_SHUFFLE(2, 2, 2, 2))));
+            result = _mm_add_ps(result, _mm_mul_ps(lhs3, _mm_shuffle_ps(rhsCol, rhsCol, _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm_storeu_ps(out + i * ROWSIZE_MATRIX_4X4, result);
+        }
+#else
         for (Int32 i = 0; i < ROWSIZE_MATRIX_4X4; i++) {
             const Real rhs_i0 = rhs[I(i, 0)];
             Real ri0 = lhs[I(0, 0)] * rhs_i0;
@@ -545,6 +825,7 @@ namespace Core {
             out[I(i, 2)] = ri2;
             out[I(i, 3)] = ri3;
         }
+#endif
     }
 
     /*
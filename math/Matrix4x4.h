@@ -1,6 +1,5 @@
 #pragma once
 
-#include "../base/BaseVector.h"
 #include "../common/types.h"
 #include "../geometry/Vector3.h"
 #include "../geometry/Vector4.h"
@@ -9,40 +8,49 @@ namespace Core {
 
     // forward declarations
     class Quaternion;
+    class Box3;
+    class ThreadPool;
 
 #define SIZE_MATRIX_4X4 16
 #define ROWSIZE_MATRIX_4X4 4
 
-    class Matrix4x4 {
+// accessors for the element in row [row] (A..D) and column [column] (0..3) of the column-major storage
+#define MATRIX4X4_ELEMENT(row, column, index) \
+        Real& row##column() { return this->data[index]; } \
+        Real row##column() const { return this->data[index]; }
+
+    /*
+     * 4x4 column-major matrix. The element storage is the only member, so a matrix is exactly
+     * 16 Reals, 16-byte aligned for SIMD loads and trivially copyable. Single elements are
+     * reached through A0()..D3() (row letter, column digit).
+     */
+    class alignas(16) Matrix4x4 {
     public:
         Matrix4x4();
         explicit Matrix4x4(const Real* sourceData);
-        Matrix4x4(const Matrix4x4& source);
-        virtual ~Matrix4x4();
-
-        Real& A0 = data[0];
-        Real& A1 = data[4];
-        Real& A2 = data[8];
-        Real& A3 = data[12];
-        Real& B0 = data[1];
-        Real& B1 = data[5];
-        Real& B2 = data[9];
-        Real& B3 = data[13];
-        Real& C0 = data[2];
-        Real& C1 = data[6];
-        Real& C2 = data[10];
-        Real& C3 = data[14];
-        Real& D0 = data[3];
-        Real& D1 = data[7];
-        Real& D2 = data[11];
-        Real& D3 = data[15];
+
+        MATRIX4X4_ELEMENT(A, 0, 0)
+        MATRIX4X4_ELEMENT(B, 0, 1)
+        MATRIX4X4_ELEMENT(C, 0, 2)
+        MATRIX4X4_ELEMENT(D, 0, 3)
+        MATRIX4X4_ELEMENT(A, 1, 4)
+        MATRIX4X4_ELEMENT(B, 1, 5)
+        MATRIX4X4_ELEMENT(C, 1, 6)
+        MATRIX4X4_ELEMENT(D, 1, 7)
+        MATRIX4X4_ELEMENT(A, 2, 8)
+        MATRIX4X4_ELEMENT(B, 2, 9)
+        MATRIX4X4_ELEMENT(C, 2, 10)
+        MATRIX4X4_ELEMENT(D, 2, 11)
+        MATRIX4X4_ELEMENT(A, 3, 12)
+        MATRIX4X4_ELEMENT(B, 3, 13)
+        MATRIX4X4_ELEMENT(C, 3, 14)
+        MATRIX4X4_ELEMENT(D, 3, 15)
 
         Real* getData();
         const Real* getConstData() const;
         void setIdentity();
         void setIdentity(Real* target);
 
-        Matrix4x4& operator=(const Matrix4x4& source);
         void copy(const Matrix4x4& src);
         void copy(const Real* sourceData);
 
@@ -51,6 +59,7 @@ namespace Core {
         Bool invert();
         Bool invert(Matrix4x4& out);
         static Bool invert(const Real* source, Real* dest);
+        static Bool invertAffine(const Real* source, Real* dest);
 
         void buildFromComponents(const Vector3Components<Real>& translation, const Quaternion& rotation, const Vector3Components<Real>& scale);
         void decompose(Vector3Components<Real>& translation, Quaternion& rotation, Vector3Components<Real>& scale) const;
@@ -66,6 +75,9 @@ namespace Core {
         void transform(const Vector3Base<Real>& vector, Vector3Base<Real>& out) const;
         void transform(Vector3Base<Real>& vector) const;
         void transform(Real* vector4f) const;
+        void transformPoints(const Real* source, Real* dest, UInt32 count, ThreadPool* threadPool = nullptr) const;
+        void transformDirections(const Real* source, Real* dest, UInt32 count, ThreadPool* threadPool = nullptr) const;
+        void transformBox(const Box3& box, Box3& out) const;
         void add(const Matrix4x4& matrix);
         void multiply(const Matrix4x4& matrix);
         void preMultiply(const Matrix4x4& matrix);
@@ -105,5 +117,10 @@ namespace Core {
 
     private:
         Real data[SIZE_MATRIX_4X4];
+
+        void transformStream(const Real* source, Real* dest, UInt32 count, Real w, ThreadPool* threadPool) const;
+        void transformStreamRange(const Real* source, Real* dest, UInt32 count, Real w) const;
     };
+
+#undef MATRIX4X4_ELEMENT
 }
@@ -0,0 +1,184 @@
+/*
+ * Micro-benchmark for the Matrix4x4 operations the scene update leans on: copying, multiplying,
+ * inverting, transposing and transforming vectors. Each operation runs over [MatrixCount]
+ * matrices [Iterations] times, once through Matrix4x4 and once through the plain scalar
+ * reference below (the code Matrix4x4 used before it had SIMD paths), and the results of the
+ * two are compared.
+ *
+ * Not part of the library; built by the matrix4x4_benchmark target when CORE_BUILD_BENCHMARKS
+ * is on. Run it from an optimized build:
+ *
+ *   cmake -DCMAKE_BUILD_TYPE=Release -DCORE_BUILD_BENCHMARKS=ON .. && make matrix4x4_benchmark
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "Matrix4x4.h"
+
+using namespace Core;
+
+static const UInt32 MatrixCount = 4096;
+static const UInt32 Iterations = 200;
+
+static void referenceMultiply(const Real* lhs, const Real* rhs, Real* out) {
+    for (UInt32 column = 0; column < 4; column++) {
+        for (UInt32 row = 0; row < 4; row++) {
+            Real sum = 0.0f;
+            for (UInt32 k = 0; k < 4; k++) sum += lhs[k * 4 + row] * rhs[column * 4 + k];
+            out[column * 4 + row] = sum;
+        }
+    }
+}
+
+static void referenceTranspose(const Real* source, Real* dest) {
+    for (UInt32 column = 0; column < 4; column++) {
+        for (UInt32 row = 0; row < 4; row++) dest[row * 4 + column] = source[column * 4 + row];
+    }
+}
+
+static void referenceTransform(const Real* matrix, const Real* vector, Real* out) {
+    for (UInt32 row = 0; row < 4; row++) {
+        out[row] = matrix[row] * vector[0] + matrix[4 + row] * vector[1] + matrix[8 + row] * vector[2] + matrix[12 + row] * vector[3];
+    }
+}
+
+/*
+ * Cofactor expansion with a full determinant, as the scalar invert() does it.
+ */
+static Bool referenceInvert(const Real* m, Real* out) {
+    Real inv[16];
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    Real det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.0f) return false;
+    for (UInt32 i = 0; i < 16; i++) out[i] = inv[i] / det;
+    return true;
+}
+
+/*
+ * Milliseconds [func] takes for [Iterations] passes.
+ */
+static double time(const std::function<void()>& func) {
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (UInt32 i = 0; i < Iterations; i++) func();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+/*
+ * Largest difference between [a] and [b] relative to the magnitude of [b].
+ */
+static Real maxRelativeError(const Real* a, const Real* b, UInt32 count) {
+    Real maxError = 0.0f;
+    for (UInt32 i = 0; i < count; i++) {
+        Real error = std::fabs(a[i] - b[i]) / (std::fabs(b[i]) > 1.0f ? std::fabs(b[i]) : 1.0f);
+        if (error > maxError) maxError = error;
+    }
+    return maxError;
+}
+
+static Real maxRelativeError(const std::vector<Matrix4x4>& a, const std::vector<Matrix4x4>& b) {
+    Real maxError = 0.0f;
+    for (UInt32 i = 0; i < a.size(); i++) {
+        Real error = maxRelativeError(a[i].getConstData(), b[i].getConstData(), 16);
+        if (error > maxError) maxError = error;
+    }
+    return maxError;
+}
+
+static void report(const char* name, double referenceTime, double matrixTime, Real error) {
+    printf("%-12s %9.2f ms %9.2f ms %7.2fx   max rel. error %.2g\n", name, referenceTime, matrixTime, referenceTime / matrixTime, error);
+}
+
+int main(int argc, char** argv) {
+    // random affine matrices: rotation and scale plus translation, which is what transforms hold
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<Real> angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<Real> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<Real> scale(0.5f, 2.0f);
+    std::vector<Matrix4x4> matrices(MatrixCount);
+    std::vector<Matrix4x4> others(MatrixCount);
+    std::vector<Matrix4x4> results(MatrixCount);
+    std::vector<Matrix4x4> referenceResults(MatrixCount);
+    std::vector<Real> vectors(MatrixCount * 4);
+    std::vector<Real> transformed(MatrixCount * 4);
+    std::vector<Real> referenceTransformed(MatrixCount * 4);
+    for (UInt32 i = 0; i < MatrixCount; i++) {
+        matrices[i].rotate(unit(random), unit(random), unit(random) + 2.0f, angle(random));
+        matrices[i].scale(scale(random), scale(random), scale(random));
+        matrices[i].preTranslate(unit(random) * 10.0f, unit(random) * 10.0f, unit(random) * 10.0f);
+        others[i].rotate(unit(random) + 2.0f, unit(random), unit(random), angle(random));
+        others[i].preTranslate(unit(random), unit(random), unit(random));
+        for (UInt32 c = 0; c < 3; c++) vectors[i * 4 + c] = unit(random) * 10.0f;
+        vectors[i * 4 + 3] = 1.0f;
+    }
+
+    printf("%u matrices x %u iterations\n", MatrixCount, Iterations);
+    printf("%-12s %12s %12s %8s\n", "", "reference", "Matrix4x4", "speedup");
+
+    double referenceTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) {
+            const Real* source = matrices[i].getConstData();
+            Real* dest = referenceResults[i].getData();
+            for (UInt32 e = 0; e < 16; e++) dest[e] = source[e];
+        }
+    });
+    double matrixTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) results[i] = matrices[i];
+    });
+    report("copy", referenceTime, matrixTime, maxRelativeError(results, referenceResults));
+
+    referenceTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) referenceMultiply(matrices[i].getConstData(), others[i].getConstData(), referenceResults[i].getData());
+    });
+    matrixTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) Matrix4x4::multiplyMM(matrices[i].getConstData(), others[i].getConstData(), results[i].getData());
+    });
+    report("multiply", referenceTime, matrixTime, maxRelativeError(results, referenceResults));
+
+    referenceTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) referenceInvert(matrices[i].getConstData(), referenceResults[i].getData());
+    });
+    matrixTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) Matrix4x4::invert(matrices[i].getConstData(), results[i].getData());
+    });
+    report("invert", referenceTime, matrixTime, maxRelativeError(results, referenceResults));
+
+    referenceTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) referenceTranspose(matrices[i].getConstData(), referenceResults[i].getData());
+    });
+    matrixTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) Matrix4x4::transpose(matrices[i].getConstData(), results[i].getData());
+    });
+    report("transpose", referenceTime, matrixTime, maxRelativeError(results, referenceResults));
+
+    referenceTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) referenceTransform(matrices[i].getConstData(), &vectors[i * 4], &referenceTransformed[i * 4]);
+    });
+    matrixTime = time([&]() {
+        for (UInt32 i = 0; i < MatrixCount; i++) Matrix4x4::multiplyMV(matrices[i].getConstData(), &vectors[i * 4], &transformed[i * 4]);
+    });
+    report("transform", referenceTime, matrixTime, maxRelativeError(transformed.data(), referenceTransformed.data(), MatrixCount * 4));
+
+    return 0;
+}
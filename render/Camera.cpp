@@ -156,9 +156,9 @@ namespace Core {
         camTransform.updateWorldMatrix();
 
         Core::Point3r worldPos = viewPos;
-        camTransform.getWorldMatrix().transform(worldPos);
+        camTransform.getConstWorldMatrix().transform(worldPos);
         Core::Point3r origin;
-        camTransform.getWorldMatrix().transform(origin);
+        camTransform.getConstWorldMatrix().transform(origin);
         Core::Vector3r rayDir = worldPos - origin;
         rayDir.normalize();
         Core::Ray ray(origin, rayDir);
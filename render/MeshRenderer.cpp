@@ -5,11 +5,13 @@
 #include "../geometry/Mesh.h"
 #include "../image/Texture.h"
 #include "../image/Texture2D.h"
+#include "../image/TextureStreamer.h"
 #include "../light/AmbientIBLLight.h"
 #include "../light/PointLight.h"
 #include "../light/DirectionalLight.h"
 #include "../material/Material.h"
 #include "../material/Shader.h"
+#include "../math/Math.h"
 #include "../render/Camera.h"
 #include "../render/RenderTarget.h"
 #include "RenderableContainer.h"
@@ -17,6 +19,21 @@
 
 namespace Core {
 
+    /*
+     * Unbinds the vertex array activated for a draw when it goes out of scope, so that an
+     * exception thrown part way through a draw does not leave the VAO bound.
+     */
+    class VertexArrayScope {
+    public:
+        VertexArrayScope(WeakPointer<Graphics> graphics): graphics(graphics) {}
+        ~VertexArrayScope() {
+            this->graphics->deactivateVertexArray();
+        }
+
+    private:
+        WeakPointer<Graphics> graphics;
+    };
+
     MeshRenderer::MeshRenderer(WeakPointer<Graphics> graphics, WeakPointer<Material> material, WeakPointer<Object3D> owner)
         : ObjectRenderer<Mesh>(graphics, owner), material(material) {
     }
@@ -60,17 +77,30 @@ namespace Core {
         // send custom uniforms first so that the renderer can override if necessary.
         material->sendCustomUniformsToShader();
 
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Position, StandardAttribute::Position, mesh->getVertexPositions());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Normal, StandardAttribute::Normal, mesh->getVertexNormals());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AveragedNormal, StandardAttribute::AveragedNormal, mesh->getVertexAveragedNormals());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::FaceNormal, StandardAttribute::FaceNormal, mesh->getVertexFaceNormals());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Tangent, StandardAttribute::Tangent, mesh->getVertexTangents());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::Color, StandardAttribute::Color, mesh->getVertexColors());
-        this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, StandardAttribute::AlbedoUV, mesh->getVertexAlbedoUVs());
+        // shadow and reflection passes don't decide which texture levels are needed
+        if (Engine::instance()->getTextureStreamer().hasTextures() && !viewDescriptor.overrideMaterial.isValid() && viewDescriptor.cubeFace < 0) {
+            this->reportTextureUsage(viewDescriptor, mesh, material);
+        }
+
+        this->attributeBindings.clear();
+        this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::Position, StandardAttribute::Position, mesh->getVertexPositions());
+        this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::Normal, StandardAttribute::Normal, mesh->getVertexNormals());
+        this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::AveragedNormal, StandardAttribute::AveragedNormal, mesh->getVertexAveragedNormals());
+        this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::FaceNormal, StandardAttribute::FaceNormal, mesh->getVertexFaceNormals());
+        this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::Tangent, StandardAttribute::Tangent, mesh->getVertexTangents());
+        this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::Color, StandardAttribute::Color, mesh->getVertexColors());
+        this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, StandardAttribute::AlbedoUV, mesh->getVertexAlbedoUVs());
         if (mesh->getVertexNormalUVs())
-            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::NormalUV, StandardAttribute::NormalUV, mesh->getVertexNormalUVs());
+            this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::NormalUV, StandardAttribute::NormalUV, mesh->getVertexNormalUVs());
         else
-            this->checkAndSetShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, StandardAttribute::NormalUV, mesh->getVertexAlbedoUVs());
+            this->checkAndAddShaderAttribute(mesh, material, StandardAttribute::AlbedoUV, StandardAttribute::NormalUV, mesh->getVertexAlbedoUVs());
+
+        VertexArrayScope vertexArrayScope(this->graphics);
+        if (!this->graphics->activateVertexArray(mesh, shader, this->attributeBindings)) {
+            for (auto& binding : this->attributeBindings) {
+                binding.storage->sendToShader(binding.location);
+            }
+        }
 
         Int32 cameraPositionLoc = material->getShaderLocation(StandardUniform::CameraPosition);
         Int32 projectionLoc = material->getShaderLocation(StandardUniform::ProjectionMatrix);
@@ -95,13 +125,12 @@ namespace Core {
         }
 
         if (modelMatrixLoc >= 0) {
-            Matrix4x4 modelmatrix = this->owner->getTransform().getWorldMatrix();
+            Matrix4x4 modelmatrix = this->owner->getTransform().getConstWorldMatrix();
             shader->setUniformMatrix4(modelMatrixLoc, modelmatrix);
         }
 
         if (modelInverseTransposeMatrixLoc >= 0) {
-            Matrix4x4 modelInverseTransposeMatrix = this->owner->getTransform().getWorldMatrix();
-            modelInverseTransposeMatrix.invert();
+            Matrix4x4 modelInverseTransposeMatrix = this->owner->getTransform().getConstInverseWorldMatrix();
             modelInverseTransposeMatrix.transpose();
             shader->setUniformMatrix4(modelInverseTransposeMatrixLoc, modelInverseTransposeMatrix);
         }
@@ -328,16 +357,42 @@ namespace Core {
         return this->material;
     }
 
-    void MeshRenderer::checkAndSetShaderAttribute(WeakPointer<Mesh> mesh, WeakPointer<Material> material, StandardAttribute checkAttribute,
+    void MeshRenderer::checkAndAddShaderAttribute(WeakPointer<Mesh> mesh, WeakPointer<Material> material, StandardAttribute checkAttribute,
                                                   StandardAttribute setAttribute, WeakPointer<AttributeArrayBase> array) {
         if (mesh->isAttributeEnabled(checkAttribute)) {
             Int32 shaderLocation = material->getShaderLocation(setAttribute);
-            if (array->getGPUStorage()) {
-                array->getGPUStorage()->sendToShader(shaderLocation);
+            if (shaderLocation >= 0 && array->getGPUStorage()) {
+                this->attributeBindings.push_back(VertexAttributeBinding((UInt32)shaderLocation, array->getGPUStorage()));
             }
         }
     }
 
+    /*
+     * Tell the texture streamer how many screen pixels one UV unit of [mesh] covers in this draw.
+     */
+    void MeshRenderer::reportTextureUsage(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, WeakPointer<Material> material) {
+        Real uvDensity = mesh->getUVDensity();
+        if (uvDensity <= 0.0f || !viewDescriptor.renderTarget.isValid()) return;
+
+        Matrix4x4 worldMatrix = this->owner->getTransform().getConstWorldMatrix();
+        Box3 worldBounds;
+        worldMatrix.transformBox(mesh->getBoundingBox(), worldBounds);
+
+        // largest scale along any axis
+        const Real* data = worldMatrix.getConstData();
+        Real scale = 0.0f;
+        for (UInt32 axis = 0; axis < 3; axis++) {
+            const Real* column = data + axis * 4;
+            Real axisScale = Math::squareRoot(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]);
+            if (axisScale > scale) scale = axisScale;
+        }
+
+        WeakPointer<RenderTarget> renderTarget = viewDescriptor.renderTarget;
+        Vector2u renderSize = renderTarget->getSize();
+        Real pixelsPerUnit = TextureStreamer::calculatePixelsPerUnit(viewDescriptor.projectionMatrix, viewDescriptor.cameraPosition, worldBounds, renderSize.y);
+        Engine::instance()->getTextureStreamer().reportUsage(material, pixelsPerUnit * uvDensity * scale);
+    }
+
     void MeshRenderer::drawMesh(WeakPointer<Mesh> mesh) {
         if (mesh->isIndexed()) {
             this->graphics->drawBoundVertexBuffer(mesh->getIndexCount(), mesh->getIndexBuffer());
@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 
+#include "../geometry/AttributeArrayGPUStorage.h"
 #include "../material/StandardAttributes.h"
 #include "../render/ObjectRenderer.h"
 #include "../util/PersistentWeakPointer.h"
@@ -31,10 +32,13 @@ namespace Core {
 
     private:
         MeshRenderer(WeakPointer<Graphics> graphics, WeakPointer<Material> material, WeakPointer<Object3D> owner);
-        void checkAndSetShaderAttribute(WeakPointer<Mesh> mesh, WeakPointer<Material> material, StandardAttribute checkAttribute,
+        void checkAndAddShaderAttribute(WeakPointer<Mesh> mesh, WeakPointer<Material> material, StandardAttribute checkAttribute,
                                         StandardAttribute setAttribute, WeakPointer<AttributeArrayBase> array);
         void drawMesh(WeakPointer<Mesh> mesh);
+        void reportTextureUsage(const ViewDescriptor& viewDescriptor, WeakPointer<Mesh> mesh, WeakPointer<Material> material);
 
         PersistentWeakPointer<Material> material;
+        // reused between draws to avoid reallocating the binding list for every mesh
+        std::vector<VertexAttributeBinding> attributeBindings;
     };
 }
@@ -32,7 +32,33 @@
 
 namespace Core {
 
-    Renderer::Renderer() {
+    const UInt32 Renderer::ParallelTraversalThreshold = 4096;
+    const UInt32 Renderer::MaxTraversalSplitDepth = 3;
+
+    /*
+     * Add the active components of [registry] whose owners were reached by the scene traversal
+     * [frame] to [out], in traversal order (and in the order they were added to an object), the
+     * same order walking the components of the traversed objects gives. The scene hierarchy thus
+     * still decides e.g. which reflection probe provides image-based lighting.
+     */
+    template <typename T>
+    static void collectRegisteredComponents(const ComponentRegistry<T>& registry, UInt32 frame, std::vector<WeakPointer<T>>& out) {
+        typedef typename ComponentRegistry<T>::Entry Entry;
+        static std::vector<const Entry*> found;
+        found.resize(0);
+        for (const Entry& entry : registry.getEntries()) {
+            if (entry.owner->getTraversalFrame() != frame || !entry.component.isValid() || !entry.componentPtr->isActive()) continue;
+            found.push_back(&entry);
+        }
+        std::stable_sort(found.begin(), found.end(), [](const Entry* a, const Entry* b) {
+            return a->owner->getTraversalIndex() < b->owner->getTraversalIndex();
+        });
+        for (const Entry* entry : found) {
+            out.push_back(entry->component);
+        }
+    }
+
+    Renderer::Renderer(): currentRenderFrame(0) {
         
     }
 
@@ -62,81 +88,84 @@ namespace Core {
 
     void Renderer::renderScene(WeakPointer<Object3D> rootObject, WeakPointer<Material> overrideMaterial) {
         static std::vector<WeakPointer<Object3D>> objectList;
+        static std::vector<WeakPointer<BaseRenderableContainer>> renderableContainerList;
+        static std::vector<WeakPointer<Object3D>> renderList;
         static std::vector<WeakPointer<Camera>> cameraList;
         static std::vector<WeakPointer<Light>> lightList;
         static std::vector<WeakPointer<Light>> nonIBLLightList;
         static std::vector<WeakPointer<ReflectionProbe>> reflectionProbeList;
         static std::vector<WeakPointer<Object3D>> emptyObjectList;
         objectList.resize(0);
+        renderableContainerList.resize(0);
+        renderList.resize(0);
         cameraList.resize(0);
         lightList.resize(0);
         nonIBLLightList.resize(0);
         reflectionProbeList.resize(0);
 
-        WeakPointer<Graphics> graphics = Engine::instance()->getGraphicsSystem();
+        static std::vector<WeakPointer<Light>> activeLightList;
+        activeLightList.resize(0);
+
+        WeakPointer<Engine> engine = Engine::instance();
+        this->currentRenderFrame++;
+        engine->getTransformStore().updateWorldMatrices(engine->getThreadPool());
         this->processScene(rootObject, objectList);
+        for (UInt32 i = 0; i < objectList.size(); i++) {
+            objectList[i]->setTraversalStamp(this->currentRenderFrame, i);
+        }
 
-        for (WeakPointer<Object3D> object : objectList) {
-            for (SceneObjectIterator<Object3DComponent> compItr = object->beginIterateComponents(); compItr != object->endIterateComponents(); ++compItr) {
-                WeakPointer<Object3DComponent> comp = (*compItr);
-                WeakPointer<Camera> camera = WeakPointer<Object3DComponent>::dynamicPointerCast<Camera>(comp);
-                if (camera.isValid() && camera->isActive()) {
-                    cameraList.push_back(camera);
-                    continue;
-                }
-                WeakPointer<ReflectionProbe> reflectionProbe = WeakPointer<Object3DComponent>::dynamicPointerCast<ReflectionProbe>(comp);
-                if (reflectionProbe.isValid() && reflectionProbe->isActive()) {
-                    reflectionProbeList.push_back(reflectionProbe);
-                    continue;
+        collectRegisteredComponents(engine->getCameraRegistry(), this->currentRenderFrame, cameraList);
+        collectRegisteredComponents(engine->getReflectionProbeRegistry(), this->currentRenderFrame, reflectionProbeList);
+        collectRegisteredComponents(engine->getLightRegistry(), this->currentRenderFrame, activeLightList);
+
+        // only renderable containers draw anything, so the render passes walk those instead of every traversed object
+        collectRegisteredComponents(engine->getRenderableContainerRegistry(), this->currentRenderFrame, renderableContainerList);
+        for (WeakPointer<BaseRenderableContainer>& container : renderableContainerList) {
+            renderList.push_back(container);
+        }
+
+        for (WeakPointer<Light>& lightPtr : activeLightList) {
+            Light* light = lightPtr.get();
+            if (light->getType() == LightType::AmbientIBL) {
+                if (reflectionProbeList.size() > 0) {
+                    AmbientIBLLight* ambientIBLlight = static_cast<AmbientIBLLight*>(light);
+
+                    WeakPointer<CubeTexture> irradianceMap = WeakPointer<Texture>::dynamicPointerCast<CubeTexture>(reflectionProbeList[0]->getIrradianceMap()->getColorTexture());
+                    ambientIBLlight->setIrradianceMap(irradianceMap);
+
+                    WeakPointer<CubeTexture> specularIBLPreFilteredMap = WeakPointer<Texture>::dynamicPointerCast<CubeTexture>(reflectionProbeList[0]->getSpecularIBLPreFilteredMap()->getColorTexture());
+                    ambientIBLlight->setSpecularIBLPreFilteredMap(specularIBLPreFilteredMap);
+
+                    WeakPointer<Texture2D> specularIBLBRDFMap = WeakPointer<Texture>::dynamicPointerCast<Texture2D>(reflectionProbeList[0]->getSpecularIBLBRDFMap()->getColorTexture());
+                    ambientIBLlight->setSpecularIBLBRDFMap(specularIBLBRDFMap);
                 }
+                else continue;
             }
-            for (SceneObjectIterator<Object3DComponent> compItr = object->beginIterateComponents(); compItr != object->endIterateComponents(); ++compItr) {
-                WeakPointer<Object3DComponent> comp = (*compItr);
-                WeakPointer<Light> light = WeakPointer<Object3DComponent>::dynamicPointerCast<Light>(comp);
-                if (light.isValid() && light->isActive()) {
-                    if (light->getType() == LightType::AmbientIBL) {
-                        if (reflectionProbeList.size() > 0) {
-                            WeakPointer<AmbientIBLLight> ambientIBLlight = WeakPointer<Object3DComponent>::dynamicPointerCast<AmbientIBLLight>(comp);
-                            
-                            WeakPointer<CubeTexture> irradianceMap = WeakPointer<Texture>::dynamicPointerCast<CubeTexture>(reflectionProbeList[0]->getIrradianceMap()->getColorTexture());
-                            ambientIBLlight->setIrradianceMap(irradianceMap);
-                            
-                            WeakPointer<CubeTexture> specularIBLPreFilteredMap = WeakPointer<Texture>::dynamicPointerCast<CubeTexture>(reflectionProbeList[0]->getSpecularIBLPreFilteredMap()->getColorTexture());
-                            ambientIBLlight->setSpecularIBLPreFilteredMap(specularIBLPreFilteredMap);
-                            
-                            WeakPointer<Texture2D> specularIBLBRDFMap = WeakPointer<Texture>::dynamicPointerCast<Texture2D>(reflectionProbeList[0]->getSpecularIBLBRDFMap()->getColorTexture());
-                            ambientIBLlight->setSpecularIBLBRDFMap(specularIBLBRDFMap);
-                        }
-                        else continue;
-                    }
-                    else {
-                        nonIBLLightList.push_back(light);
-                    }
-                    lightList.push_back(light);
-                    continue;
-                }
+            else {
+                nonIBLLightList.push_back(lightPtr);
             }
+            lightList.push_back(lightPtr);
         }
 
         std::sort(lightList.begin(), lightList.end(), Renderer::compareLights);
         std::sort(nonIBLLightList.begin(), nonIBLLightList.end(), Renderer::compareLights);
         
-        this->renderShadowMaps(lightList, LightType::Point, objectList);
+        this->renderShadowMaps(lightList, LightType::Point, renderList);
         for (auto camera : cameraList) {
-            this->renderShadowMaps(lightList, LightType::Directional, objectList, camera);
+            this->renderShadowMaps(lightList, LightType::Directional, renderList, camera);
         }
 
         for (auto reflectionProbe : reflectionProbeList) {
             if (reflectionProbe->getNeedsFullUpdate() || reflectionProbe->getNeedsSpecularUpdate()) {
                 Bool specularOnly = !reflectionProbe->getNeedsFullUpdate();
-                this->renderReflectionProbe(reflectionProbe, specularOnly, objectList, nonIBLLightList);
+                this->renderReflectionProbe(reflectionProbe, specularOnly, renderList, nonIBLLightList);
                 if (specularOnly) reflectionProbe->setNeedsSpecularUpdate(false);
                 else reflectionProbe->setNeedsFullUpdate(false);
             }
         }
 
         for (auto camera : cameraList) {
-            this->render(camera, objectList, lightList, overrideMaterial, true);
+            this->render(camera, renderList, lightList, overrideMaterial, true);
         }
     }
 
@@ -145,10 +174,9 @@ namespace Core {
         static std::vector<WeakPointer<Object3D>> objectList;
         objectList.resize(0);
 
-        Matrix4x4 baseTransformation;
-        rootObject->getTransform().getAncestorWorldMatrix(baseTransformation);
-
-        this->processScene(rootObject, objectList, baseTransformation);
+        WeakPointer<Engine> engine = Engine::instance();
+        engine->getTransformStore().updateWorldMatrices(engine->getThreadPool());
+        this->processScene(rootObject, objectList);
         this->render(camera, objectList, overrideMaterial, matchPhysicalPropertiesWithLighting);
     }
 
@@ -217,7 +245,7 @@ namespace Core {
         this->getViewDescriptorForCamera(camera, baseViewDescriptor);
         for (unsigned int i = 0; i < 6; i++) {
             ViewDescriptor viewDescriptor = baseViewDescriptor;
-            Matrix4x4 cameraTransform = camera->getOwner()->getTransform().getWorldMatrix();
+            Matrix4x4 cameraTransform = camera->getOwner()->getTransform().getConstWorldMatrix();
             cameraTransform.multiply(orientations[i]);
             this->getViewDescriptorTransformations(cameraTransform, camera->getProjectionMatrix(),
                                                    camera->getAutoClearRenderBuffers(), viewDescriptor);
@@ -308,10 +336,9 @@ namespace Core {
 
     void Renderer::renderObjectDirect(WeakPointer<Object3D> object, ViewDescriptor& viewDescriptor,
                             std::vector<WeakPointer<Light>>& lightList, Bool matchPhysicalPropertiesWithLighting) {
-        std::shared_ptr<Object3D> objectShared = object.lock();
-        std::shared_ptr<BaseRenderableContainer> containerPtr = std::dynamic_pointer_cast<BaseRenderableContainer>(objectShared);
-        if (containerPtr) {
-            WeakPointer<BaseObjectRenderer> objectRenderer = containerPtr->getBaseRenderer();
+        BaseRenderableContainer* container = object->getRenderableContainer();
+        if (container != nullptr) {
+            WeakPointer<BaseObjectRenderer> objectRenderer = container->getBaseRenderer();
             if (objectRenderer) {
                 objectRenderer->forwardRender(viewDescriptor, lightList, matchPhysicalPropertiesWithLighting);
             }
@@ -336,10 +363,9 @@ namespace Core {
         toRender.resize(0);
         for (UInt32 i = 0; i < objects.size(); i++) {
             WeakPointer<Object3D> object = objects[i];
-            std::shared_ptr<Object3D> objectShared = object.lock();
-            std::shared_ptr<BaseRenderableContainer> containerPtr = std::dynamic_pointer_cast<BaseRenderableContainer>(objectShared);
-            if (containerPtr) {
-                WeakPointer<BaseObjectRenderer> objectRenderer = containerPtr->getBaseRenderer();
+            BaseRenderableContainer* container = object->getRenderableContainer();
+            if (container != nullptr) {
+                WeakPointer<BaseObjectRenderer> objectRenderer = container->getBaseRenderer();
                 if (objectRenderer && objectRenderer->castsShadows()) {
                     toRender.push_back(object);
                 }
@@ -357,8 +383,8 @@ namespace Core {
                         if (pointLight->getShadowsEnabled()) {
                             WeakPointer<RenderTarget> shadowMapRenderTarget = pointLight->getShadowMap();
                             WeakPointer<Object3D> lightObject = light->getOwner();
-                            Matrix4x4 lightTransform = lightObject->getTransform().getWorldMatrix();
-                            perspectiveShadowMapCameraObject->getTransform().getWorldMatrix().copy(lightTransform);
+                            Matrix4x4 lightTransform = lightObject->getTransform().getConstWorldMatrix();
+                            perspectiveShadowMapCameraObject->getTransform().setLocalMatrix(lightTransform);
                             Vector4u renderTargetDimensions = shadowMapRenderTarget->getViewport();
                             perspectiveShadowMapCamera->setRenderTarget(shadowMapRenderTarget);  
                             perspectiveShadowMapCamera->setAspectRatioFromDimensions(renderTargetDimensions.z, renderTargetDimensions.w);                     
@@ -372,7 +398,7 @@ namespace Core {
                         WeakPointer<DirectionalLight> directionalLight = WeakPointer<Light>::dynamicPointerCast<DirectionalLight>(light);
                         if (directionalLight->getShadowsEnabled()) {
                             std::vector<DirectionalLight::OrthoProjection>& projections = directionalLight->buildProjections(renderCamera);
-                            Matrix4x4 viewTrans = directionalLight->getOwner()->getTransform().getWorldMatrix();
+                            Matrix4x4 viewTrans = directionalLight->getOwner()->getTransform().getConstWorldMatrix();
                             for (UInt32 i = 0; i < directionalLight->getCascadeCount(); i++) {
                                 DirectionalLight::OrthoProjection& proj = projections[i];  
                                 orthoShadowMapCamera->setDimensions(proj.top, proj.bottom, proj.left, proj.right);        
@@ -421,7 +447,7 @@ namespace Core {
         viewDescriptor.hdrExposure = camera->getHDRExposure();
         viewDescriptor.hdrGamma = camera->getHDRGamma();
         viewDescriptor.skybox = camera->isSkyboxEnabled() ? &camera->getSkybox() : nullptr;
-        this->getViewDescriptorTransformations(camera->getOwner()->getTransform().getWorldMatrix(),
+        this->getViewDescriptorTransformations(camera->getOwner()->getTransform().getConstWorldMatrix(),
                                 camera->getProjectionMatrix(), camera->getAutoClearRenderBuffers(), viewDescriptor);
         viewDescriptor.cameraPosition.set(0.0f, 0.0f, 0.0f);
         viewDescriptor.cubeFace = -1;
@@ -444,26 +470,80 @@ namespace Core {
         processScene(scene->getRoot(), outObjects);
     }
 
+    /*
+     * Collect the active objects under [object] in depth-first order. Large scenes are split into
+     * segments (single objects plus whole subtrees) by expanding the hierarchy a few levels deep;
+     * contiguous runs of segments are traversed in parallel into per-task lists which are then
+     * concatenated in order, so the result is identical to a serial traversal.
+     */
     void Renderer::processScene(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects) {
-        Matrix4x4 rootTransform;
-        processScene(object, outObjects, rootTransform);
+        WeakPointer<Engine> engine = Engine::instance();
+        ThreadPool& threadPool = engine->getThreadPool();
+        UInt32 concurrency = threadPool.getConcurrency();
+        // the store is linearized by the world matrix update that precedes traversal, so this is a lookup
+        if (concurrency <= 1 || object->getTransform().getSubtreeSize() < ParallelTraversalThreshold) {
+            this->collectSceneObjects(object, outObjects);
+            return;
+        }
+
+        UInt32 targetTaskCount = concurrency * 4;
+        this->traversalSegments.clear();
+        this->traversalSegments.push_back(TraversalSegment(object, true));
+        for (UInt32 depth = 0; depth < MaxTraversalSplitDepth; depth++) {
+            this->nextTraversalSegments.clear();
+            Bool expanded = false;
+            for (TraversalSegment& segment : this->traversalSegments) {
+                if (segment.subtree && segment.object->isActive() && segment.object->childCount() > 0) {
+                    this->nextTraversalSegments.push_back(TraversalSegment(segment.object, false));
+                    for (SceneObjectIterator<Object3D> itr = segment.object->beginIterateChildren(); itr != segment.object->endIterateChildren(); ++itr) {
+                        this->nextTraversalSegments.push_back(TraversalSegment(*itr, true));
+                    }
+                    expanded = true;
+                }
+                else {
+                    this->nextTraversalSegments.push_back(segment);
+                }
+            }
+            this->traversalSegments.swap(this->nextTraversalSegments);
+            if (!expanded || this->traversalSegments.size() >= targetTaskCount) break;
+        }
+
+        UInt32 segmentCount = (UInt32)this->traversalSegments.size();
+        UInt32 taskCount = segmentCount < targetTaskCount ? segmentCount : targetTaskCount;
+        if (this->traversalOutputs.size() < taskCount) this->traversalOutputs.resize(taskCount);
+        threadPool.parallelFor(taskCount, [this, segmentCount, taskCount](UInt32 task) {
+            std::vector<WeakPointer<Object3D>>& taskOutput = this->traversalOutputs[task];
+            taskOutput.resize(0);
+            UInt32 end = (UInt32)((UInt64)segmentCount * (task + 1) / taskCount);
+            for (UInt32 i = (UInt32)((UInt64)segmentCount * task / taskCount); i < end; i++) {
+                TraversalSegment& segment = this->traversalSegments[i];
+                if (segment.subtree) {
+                    this->collectSceneObjects(segment.object, taskOutput);
+                }
+                else {
+                    taskOutput.push_back(segment.object);
+                }
+            }
+        });
+
+        for (UInt32 task = 0; task < taskCount; task++) {
+            std::vector<WeakPointer<Object3D>>& taskOutput = this->traversalOutputs[task];
+            outObjects.insert(outObjects.end(), taskOutput.begin(), taskOutput.end());
+        }
     }
 
-    void Renderer::processScene(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects, const Matrix4x4& curTransform) {
+    /*
+     * World matrices are brought up to date in a single pass over the engine's
+     * TransformStore before traversal, so this only collects active objects.
+     */
+    void Renderer::collectSceneObjects(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects) {
 
         if (!object->isActive()) return;
-        Matrix4x4 nextTransform = curTransform;
-        Transform& objTransform = object->getTransform();
-        nextTransform.multiply(objTransform.getLocalMatrix());
-        objTransform.getWorldMatrix().copy(nextTransform);
-        Matrix4x4& inverseWorld = objTransform.getInverseWorldMatrix();
-        inverseWorld.copy(nextTransform);
-        inverseWorld.invert();
         outObjects.push_back(object);
 
         for (SceneObjectIterator<Object3D> itr = object->beginIterateChildren(); itr != object->endIterateChildren(); ++itr) {
             WeakPointer<Object3D> obj = *itr;
-            this->processScene(obj, outObjects, nextTransform);
+            this->collectSceneObjects(obj, outObjects);
         }
     }
 
@@ -73,7 +73,7 @@ namespace Core {
                                IntMask clearBuffers, ViewDescriptor& viewDescriptor);
         void processScene(WeakPointer<Scene> scene, std::vector<WeakPointer<Object3D>>& outObjects);
         void processScene(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects);
-        void processScene(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects, const Matrix4x4& curTransform);
+        void collectSceneObjects(WeakPointer<Object3D> object, std::vector<WeakPointer<Object3D>>& outObjects);
         void renderReflectionProbe(WeakPointer<ReflectionProbe> reflectionProbe, Bool specularOnly,
                                    std::vector<WeakPointer<Object3D>>& renderObjects, std::vector<WeakPointer<Light>>& renderLights);
         
@@ -84,5 +84,21 @@ namespace Core {
         PersistentWeakPointer<DistanceOnlyMaterial> distanceMaterial;
         PersistentWeakPointer<Object3D> reflectionProbeObject;
         PersistentWeakPointer<TonemapMaterial> tonemapMaterial;
+        UInt32 currentRenderFrame;
+
+        // a piece of the scene hierarchy handed to one traversal task: either a single
+        // object (subtree == false) or an object and all of its descendants
+        class TraversalSegment {
+        public:
+            TraversalSegment(WeakPointer<Object3D> object, Bool subtree): object(object), subtree(subtree) {}
+            WeakPointer<Object3D> object;
+            Bool subtree;
+        };
+
+        static const UInt32 ParallelTraversalThreshold;
+        static const UInt32 MaxTraversalSplitDepth;
+        std::vector<TraversalSegment> traversalSegments;
+        std::vector<TraversalSegment> nextTraversalSegments;
+        std::vector<std::vector<WeakPointer<Object3D>>> traversalOutputs;
     };
 }
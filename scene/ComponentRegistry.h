@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../common/types.h"
+#include "../util/WeakPointer.h"
+
+namespace Core {
+
+    // forward declarations
+    class Object3D;
+
+    /*
+     * Flat, per-type list of the scene components attached to objects, in the order they were
+     * attached. Each entry caches raw pointers to the component and its owner so the renderer
+     * can walk the list every frame without RTTI or shared_ptr locking. Owners are created by
+     * the Engine and live until Engine::destroyObject3D() removes their entries; a component
+     * created elsewhere may go away, so [component] is checked before [componentPtr] is used.
+     */
+    template <typename T>
+    class ComponentRegistry {
+    public:
+
+        class Entry {
+        public:
+            Entry(WeakPointer<T> component, Object3D* owner): component(component), componentPtr(component.get()), owner(owner) {
+            }
+
+            WeakPointer<T> component;
+            T* componentPtr;
+            Object3D* owner;
+        };
+
+        void add(WeakPointer<T> component, Object3D* owner) {
+            this->entries.push_back(Entry(component, owner));
+        }
+
+        void remove(const Object3D* owner) {
+            this->entries.erase(std::remove_if(this->entries.begin(), this->entries.end(), [owner](const Entry& entry) {
+                return entry.owner == owner;
+            }), this->entries.end());
+        }
+
+        const std::vector<Entry>& getEntries() const {
+            return this->entries;
+        }
+
+        UInt32 size() const {
+            return this->entries.size();
+        }
+
+    private:
+        std::vector<Entry> entries;
+    };
+}
@@ -1,12 +1,13 @@
 #include "Object3D.h"
 #include "Transform.h"
 #include "Object3DComponent.h"
+#include "../Engine.h"
 
 namespace Core {
 
     UInt64 Object3D::_nextID = 0;
 
-    Object3D::Object3D() : transform(*this), active(true) {
+    Object3D::Object3D() : transform(*this), active(true), renderableContainer(nullptr), traversalFrame(0), traversalIndex(0) {
         this->id = Object3D::getNextID();
     }
 
@@ -51,15 +52,19 @@ namespace Core {
             object->parent->removeChild(object);
         }
 
-        Transform& worldTransform = this->getTransform();
-        worldTransform.updateWorldMatrix();
-        Matrix4x4 worldInverse = worldTransform.getWorldMatrix();
-        worldInverse.invert();
-
-        object->getTransform().getLocalMatrix().preMultiply(worldInverse);
+        // copyWorldMatrix() doesn't re-linearize the transform store, which would make building
+        // a hierarchy quadratic in its size
+        Transform& childTransform = object->getTransform();
+        Matrix4x4 localMatrix = childTransform.getConstLocalMatrix();
+        Matrix4x4 inverseWorldMatrix;
+        this->getTransform().copyWorldMatrix(inverseWorldMatrix);
+        inverseWorldMatrix.invert();
+        localMatrix.preMultiply(inverseWorldMatrix);
 
         this->children.push_back(object);
         object->parent = this->_self;
+        childTransform.setParent(&this->getTransform());
+        childTransform.setLocalMatrix(localMatrix);
     }
 
     void Object3D::removeChild(WeakPointer<Object3D> object) {
@@ -73,10 +78,12 @@ namespace Core {
         }
         if (result != end) {
             Transform& transform = object->getTransform();
-            transform.updateWorldMatrix();
-            transform.getLocalMatrix().copy(transform.getWorldMatrix());
+            Matrix4x4 worldMatrix;
+            transform.copyWorldMatrix(worldMatrix);
             this->children.erase(result.getSrc());
             object->parent = PersistentWeakPointer<Object3D>::nullPtr();
+            transform.setParent(nullptr);
+            transform.setLocalMatrix(worldMatrix);
         }
     }
 
@@ -94,6 +101,7 @@ namespace Core {
             }
         }
         this->components.push_back(component);
+        Engine::instance()->registerComponent(component, this);
         return true;
     }
 
@@ -128,4 +136,24 @@ namespace Core {
     WeakPointer<Object3D> Object3D::getChild(UInt32 index) {
         return this->children[index];
     }
+
+    BaseRenderableContainer* Object3D::getRenderableContainer() {
+        return this->renderableContainer;
+    }
+
+    /*
+     * Record that the renderer's traversal [frame] reached this object as the [index]-th active object.
+     */
+    void Object3D::setTraversalStamp(UInt32 frame, UInt32 index) {
+        this->traversalFrame = frame;
+        this->traversalIndex = index;
+    }
+
+    UInt32 Object3D::getTraversalFrame() const {
+        return this->traversalFrame;
+    }
+
+    UInt32 Object3D::getTraversalIndex() const {
+        return this->traversalIndex;
+    }
 }
\ No newline at end of file
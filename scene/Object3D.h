@@ -20,6 +20,7 @@ namespace Core {
     class MeshRenderer;
     class Engine;
     class Object3DComponent;
+    class BaseRenderableContainer;
 
     class Object3D: public CoreObject {
 
@@ -47,6 +48,10 @@ namespace Core {
         const std::string& getName() const;
         UInt32 childCount();
         WeakPointer<Object3D> getChild(UInt32 index);
+        BaseRenderableContainer* getRenderableContainer();
+        void setTraversalStamp(UInt32 frame, UInt32 index);
+        UInt32 getTraversalFrame() const;
+        UInt32 getTraversalIndex() const;
 
     protected:
         Object3D();
@@ -61,6 +66,14 @@ namespace Core {
         UInt64 id;
         std::string name;
 
+        // set by the Engine when this object is a renderable container, so that
+        // the renderer can reach it without a dynamic cast
+        BaseRenderableContainer* renderableContainer;
+        // id of the last scene traversal in which this object was found active, and its
+        // position in the list of objects that traversal produced
+        UInt32 traversalFrame;
+        UInt32 traversalIndex;
+
     private:
         static UInt64 getNextID();
         static UInt64 _nextID;
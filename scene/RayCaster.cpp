@@ -23,9 +23,7 @@ namespace Core {
             WeakPointer<Object3D> object = this->objects[i];
             if (object->isActive()) {
                 WeakPointer<Mesh> mesh = this->meshes[i];
-                Transform objTransform = object->getTransform();
-                objTransform.updateWorldMatrix();
-                Matrix4x4& transform = objTransform.getWorldMatrix();
+                Matrix4x4 transform = object->getTransform().getConstWorldMatrix();
                 hitFound = this->castRay(ray, mesh, transform, hits, i) || hitFound;
             }
         }
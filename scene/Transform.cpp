@@ -1,94 +1,95 @@
+#include "../Engine.h"
 #include "../util/WeakPointer.h"
 #include "Object3D.h"
 
 namespace Core {
 
-    Transform::Transform(const Object3D& target) : target(target) {
-        this->localMatrix.setIdentity();
-        this->worldMatrix.setIdentity();
+    Transform::Transform(Object3D& target) : store(Engine::instance()->getTransformStore()), target(target) {
+        Matrix4x4 identity;
+        this->handle = this->store.allocate(identity);
     }
 
-    Transform::Transform(const Object3D& target, const Matrix4x4& matrix) : target(target) {
-        this->localMatrix.copy(matrix);
+    Transform::Transform(Object3D& target, const Matrix4x4& matrix) : store(Engine::instance()->getTransformStore()), target(target) {
+        this->handle = this->store.allocate(matrix);
     }
 
     Transform::~Transform() {
-    }
-
-    Matrix4x4& Transform::getLocalMatrix() {
-        return this->localMatrix;
+        this->store.release(this->handle);
     }
 
     const Matrix4x4& Transform::getConstLocalMatrix() const {
-        return this->localMatrix;
-    }
-
-    Matrix4x4& Transform::getWorldMatrix() {
-        return this->worldMatrix;
+        return this->store.getConstLocalMatrix(this->handle);
     }
 
     const Matrix4x4& Transform::getConstWorldMatrix() const {
-        return this->worldMatrix;
-    }
-
-    Matrix4x4& Transform::getInverseWorldMatrix() {
-        return this->inverseWorldMatrix;
+        return this->store.getWorldMatrix(this->handle);
     }
 
     const Matrix4x4& Transform::getConstInverseWorldMatrix() const {
-        return this->inverseWorldMatrix;
+        return this->store.getInverseWorldMatrix(this->handle);
     }
 
     /*
      * Copy this Transform object's local matrix into [dest].
      */
     void Transform::copyLocalMatrix(Matrix4x4& dest) const {
-        dest.copy(this->localMatrix);
+        dest.copy(this->getConstLocalMatrix());
     }
 
     /*
      * Copy this Transform object's world matrix into [dest].
      */
     void Transform::copyWorldMatrix(Matrix4x4& dest) const {
-        dest.copy(this->worldMatrix);
+        this->store.copyWorldMatrix(this->handle, dest);
     }
 
     void Transform::setLocalMatrix(const Matrix4x4& mat) {
-        this->localMatrix.copy(mat);
+        this->store.setLocalMatrix(this->handle, mat);
     }
 
     void Transform::applyTransformationTo(Vector4<Real>& vector) {
-        this->updateWorldMatrix();
-        this->worldMatrix.transform(vector);
+        this->getConstWorldMatrix().transform(vector);
     }
 
     void Transform::applyTransformationTo(Vector3Base<Real>& vector) {
-        this->updateWorldMatrix();
-        this->worldMatrix.transform(vector);
-    }
-
-    void Transform::getWorldMatrix(WeakPointer<Object3D> target, Matrix4x4& result) {
-        result.setIdentity();
-        if (!target.isValid()) return;
-        result.copy(target->getTransform().getLocalMatrix());
-        WeakPointer<Object3D> parent = target->getParent();
-        while (parent.isValid()) {
-            result.preMultiply(parent->getTransform().getLocalMatrix());
-            parent = parent->getParent();
-        }
+        this->getConstWorldMatrix().transform(vector);
     }
 
     void Transform::getWorldMatrix(Matrix4x4& result) {
-        this->getAncestorWorldMatrix(result);
-        result.multiply(this->localMatrix);
+        this->store.copyWorldMatrix(this->handle, result);
     }
 
     void Transform::getAncestorWorldMatrix(Matrix4x4& result) {
-        Transform::getWorldMatrix(this->target.getParent(), result);
+        TransformStore::Handle parent = this->store.getParent(this->handle);
+        if (parent != TransformStore::InvalidHandle) {
+            this->store.copyWorldMatrix(parent, result);
+        }
+        else {
+            result.setIdentity();
+        }
     }
 
-    void Transform::updateWorldMatrix() {
-        this->getWorldMatrix(this->worldMatrix);
+    void Transform::updateWorldMatrix() const {
+        this->store.updateWorldMatrix(this->handle);
+    }
+
+    void Transform::markWorldMatrixDirty() {
+        this->store.markWorldMatrixDirty(this->handle);
+    }
+
+    Bool Transform::isWorldMatrixDirty() const {
+        return this->store.isWorldMatrixDirty(this->handle);
+    }
+
+    /*
+     * Number of transforms in the hierarchy below this one, this one included.
+     */
+    UInt32 Transform::getSubtreeSize() const {
+        return this->store.getSubtreeSize(this->handle);
+    }
+
+    void Transform::setParent(const Transform* parent) {
+        this->store.setParent(this->handle, parent != nullptr ? parent->handle : TransformStore::InvalidHandle);
     }
 
     /*
@@ -124,9 +125,9 @@ namespace Core {
      *  and produces (FI * nWorld * F) in [localTransformation].
      */
     void Transform::getLocalTransformationFromWorldTransformation(const Matrix4x4& newWorldTransformation, Matrix4x4& localTransformation) {
-        Matrix4x4 currentFullTransformation;
-        this->getWorldMatrix(currentFullTransformation);
-        this->getLocalTransformationFromWorldTransformation(newWorldTransformation, currentFullTransformation, localTransformation);
+        localTransformation = this->getConstWorldMatrix();
+        localTransformation.preMultiply(newWorldTransformation);
+        localTransformation.preMultiply(this->getConstInverseWorldMatrix());
     }
 
     void Transform::getLocalTransformationFromWorldTransformation(const Matrix4x4& newWorldTransformation, const Matrix4x4& currentFullTransformation, Matrix4x4& localTransformation) {
@@ -145,35 +146,42 @@ namespace Core {
     void Transform::lookAt(const Point3r& target, const Vector3r& up) {
 
         Point3r src;
-        this->updateWorldMatrix();
-        this->worldMatrix.transform(src);
+        Matrix4x4 worldMatrix;
+        this->copyWorldMatrix(worldMatrix);
+        worldMatrix.transform(src);
 
         Matrix4x4 temp;
         temp.lookAt(src, target, up);
 
-        WeakPointer<Object3D> parent = this->target.getParent();
+        TransformStore::Handle parent = this->store.getParent(this->handle);
 
-        if (parent.isValid()) {
-            parent->getTransform().updateWorldMatrix();
-            Matrix4x4 parentMat = parent->getTransform().getWorldMatrix();
-            parentMat.invert();
-            temp.preMultiply(parentMat);
+        if (parent != TransformStore::InvalidHandle) {
+            Matrix4x4 parentInverse;
+            this->store.copyWorldMatrix(parent, parentInverse);
+            parentInverse.invert();
+            temp.preMultiply(parentInverse);
         }
 
-        this->getLocalMatrix().copy(temp);
+        this->setLocalMatrix(temp);
     }
 
     void Transform::transformBy(const Matrix4x4& mat, TransformationSpace transformationSpace) {
         if (transformationSpace == TransformationSpace::Local) {
-            this->localMatrix.multiply(mat);
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.multiply(mat);
+            this->setLocalMatrix(localMatrix);
         }
         else if (transformationSpace == TransformationSpace::PreLocal) {
-            this->localMatrix.preMultiply(mat);
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.preMultiply(mat);
+            this->setLocalMatrix(localMatrix);
         }
         else {
             Matrix4x4 localTransformation;
             this->getLocalTransformationFromWorldTransformation(mat, localTransformation);
-            this->localMatrix.multiply(localTransformation); 
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.multiply(localTransformation);
+            this->setLocalMatrix(localMatrix); 
         }
     }
 
@@ -183,17 +191,23 @@ namespace Core {
 
     void Transform::translate(Real x, Real y, Real z, TransformationSpace transformationSpace) {
         if (transformationSpace == TransformationSpace::Local) {
-            this->localMatrix.translate(x, y, z);
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.translate(x, y, z);
+            this->setLocalMatrix(localMatrix);
         }
         else if (transformationSpace == TransformationSpace::PreLocal) {
-            this->localMatrix.preTranslate(x, y, z);
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.preTranslate(x, y, z);
+            this->setLocalMatrix(localMatrix);
         }
         else {
             Matrix4x4 localTransformation;
             Matrix4x4 worldTransformation;
             worldTransformation.translate(x, y, z);
             this->getLocalTransformationFromWorldTransformation(worldTransformation, localTransformation);
-            this->localMatrix.multiply(localTransformation);
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.multiply(localTransformation);
+            this->setLocalMatrix(localMatrix);
             
         }
     }
@@ -204,17 +218,23 @@ namespace Core {
 
     void Transform::rotate(Real x, Real y, Real z, Real angle, TransformationSpace transformationSpace) {
         if (transformationSpace == TransformationSpace::Local) {
-            this->localMatrix.rotate(x, y, z, angle);
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.rotate(x, y, z, angle);
+            this->setLocalMatrix(localMatrix);
         }
         else if (transformationSpace == TransformationSpace::PreLocal) {
-            this->localMatrix.preRotate(x, y, z, angle);
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.preRotate(x, y, z, angle);
+            this->setLocalMatrix(localMatrix);
         }
         else {
             Matrix4x4 localTransformation;
             Matrix4x4 worldTransformation;
             worldTransformation.rotate(x, y, z, angle);
             this->getLocalTransformationFromWorldTransformation(worldTransformation, localTransformation);
-            this->localMatrix.multiply(localTransformation);
+            Matrix4x4 localMatrix = this->getConstLocalMatrix();
+            localMatrix.multiply(localTransformation);
+            this->setLocalMatrix(localMatrix);
         }
     }
 
@@ -229,7 +249,9 @@ namespace Core {
         worldTransformation.preRotate(ax, ay, az, angle);
         worldTransformation.preTranslate(px, py, pz);
         this->getLocalTransformationFromWorldTransformation(worldTransformation, localTransformation);
-        this->localMatrix.multiply(localTransformation);
+        Matrix4x4 localMatrix = this->getConstLocalMatrix();
+        localMatrix.multiply(localTransformation);
+        this->setLocalMatrix(localMatrix);
     }
 
     void Transform::scale(Real x, Real y, Real z) {
@@ -247,26 +269,20 @@ namespace Core {
 
     void Transform::setWorldPosition(Real x, Real y, Real z) {
         Point3r oldPosition;
-        Matrix4x4 ancestorMatrix;
-        Matrix4x4 fullMatrix;
-        this->getAncestorWorldMatrix(ancestorMatrix);
-        fullMatrix = ancestorMatrix;
-        fullMatrix.multiply(this->localMatrix);
-        fullMatrix.transform(oldPosition);
+        this->getConstWorldMatrix().transform(oldPosition);
         Vector3r toNewPosition(x - oldPosition.x, y - oldPosition.y, z - oldPosition.z);
         Matrix4x4 worldTranslateMatrix;
         worldTranslateMatrix.preTranslate(toNewPosition);
         Matrix4x4 localTranslateMatrix;
-        this->getLocalTransformationFromWorldTransformation(worldTranslateMatrix, fullMatrix, localTranslateMatrix);
-        this->localMatrix.multiply(localTranslateMatrix);
-        this->worldMatrix = ancestorMatrix;
-        this->worldMatrix.multiply(this->localMatrix);
+        this->getLocalTransformationFromWorldTransformation(worldTranslateMatrix, localTranslateMatrix);
+        Matrix4x4 localMatrix = this->getConstLocalMatrix();
+        localMatrix.multiply(localTranslateMatrix);
+        this->setLocalMatrix(localMatrix);
     }
 
     Point3r Transform::getWorldPosition() {
         Point3r position;
-        this->updateWorldMatrix();
-        this->worldMatrix.transform(position);
+        this->getConstWorldMatrix().transform(position);
         return position;
     }
 }
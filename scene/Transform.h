@@ -2,24 +2,31 @@
 
 #include "../math/Matrix4x4.h"
 #include "TransformationSpace.h"
+#include "TransformStore.h"
 
 namespace Core {
 
     // forward declarations
     class Object3D;
 
+    /*
+     * Handle to a slot in the engine's TransformStore; the matrices themselves live in the
+     * store's contiguous arrays. The local matrix is only changed through setLocalMatrix() and
+     * the transformation methods, so the world matrices always know when they are out of date.
+     * References returned by the matrix accessors are only valid until the scene hierarchy
+     * changes or another transform is created; copy the matrix to keep it.
+     */
     class Transform {
+        friend class Object3D;
+
     public:
 
-        Transform(const Object3D& target);
-        explicit Transform(const Object3D& target, const Matrix4x4& matrix);
+        Transform(Object3D& target);
+        explicit Transform(Object3D& target, const Matrix4x4& matrix);
         virtual ~Transform();
 
-        Matrix4x4& getLocalMatrix();
         const Matrix4x4& getConstLocalMatrix() const;
-        Matrix4x4& getWorldMatrix();
         const Matrix4x4& getConstWorldMatrix() const;
-        Matrix4x4& getInverseWorldMatrix();
         const Matrix4x4& getConstInverseWorldMatrix() const;
 
         void copyLocalMatrix(Matrix4x4& dest) const;
@@ -49,19 +56,23 @@ namespace Core {
         void setWorldPosition(Real x, Real y, Real z);
         Point3r getWorldPosition();
 
-        void updateWorldMatrix();
+        void updateWorldMatrix() const;
+        void markWorldMatrixDirty();
+        Bool isWorldMatrixDirty() const;
+        UInt32 getSubtreeSize() const;
         void getAncestorWorldMatrix(Matrix4x4& result);
         void getWorldMatrix(Matrix4x4& result);
 
     private:
 
-        static void getWorldMatrix(WeakPointer<Object3D> target, Matrix4x4& result);
+        Transform(const Transform& source) = delete;
+        Transform& operator=(const Transform& source) = delete;
+        void setParent(const Transform* parent);
         void getLocalTransformationFromWorldTransformation(const Matrix4x4& newWorldTransformation, Matrix4x4& localTransformation);
         void getLocalTransformationFromWorldTransformation(const Matrix4x4& newWorldTransformation, const Matrix4x4& currentFullTransformation, Matrix4x4& localTransformation);
 
-        Matrix4x4 localMatrix;
-        Matrix4x4 worldMatrix;
-        Matrix4x4 inverseWorldMatrix; 
-        const Object3D& target;
+        TransformStore& store;
+        TransformStore::Handle handle;
+        Object3D& target;
     };
 }
@@ -0,0 +1,355 @@
+#include "TransformStore.h"
+#include "../util/ThreadPool.h"
+
+namespace Core {
+
+    const TransformStore::Handle TransformStore::InvalidHandle = 0xFFFFFFFF;
+    const UInt32 TransformStore::InvalidIndex = 0xFFFFFFFF;
+    const UInt32 TransformStore::ParallelUpdateThreshold = 4096;
+    const UInt32 TransformStore::MinParallelRangeSize = 256;
+
+    TransformStore::TransformStore(): hierarchyDirty(false) {
+    }
+
+    TransformStore::~TransformStore() {
+    }
+
+    /*
+     * Reserve a slot for a new (parentless) transform. New transforms are appended as roots,
+     * which keeps the parent-before-child ordering intact without re-linearizing.
+     */
+    TransformStore::Handle TransformStore::allocate(const Matrix4x4& localMatrix) {
+        Handle handle;
+        if (this->freeHandles.size() > 0) {
+            handle = this->freeHandles.back();
+            this->freeHandles.pop_back();
+        }
+        else {
+            handle = (Handle)this->handleIndices.size();
+            this->handleIndices.push_back(InvalidIndex);
+            this->handleParents.push_back(InvalidHandle);
+            this->handleLive.push_back(0);
+        }
+
+        UInt32 index = (UInt32)this->indexHandles.size();
+        this->localMatrices.push_back(localMatrix);
+        this->worldMatrices.push_back(localMatrix);
+        this->inverseWorldMatrices.push_back(Matrix4x4());
+        this->parentIndices.push_back(InvalidIndex);
+        this->subtreeSizes.push_back(1);
+        this->worldDirty.push_back(1);
+        this->inverseWorldDirty.push_back(1);
+        this->indexHandles.push_back(handle);
+
+        this->handleIndices[handle] = index;
+        this->handleParents[handle] = InvalidHandle;
+        this->handleLive[handle] = 1;
+        return handle;
+    }
+
+    /*
+     * The slot is compacted away (and the handle recycled) the next time the hierarchy is
+     * linearized, so releasing a large number of transforms stays linear.
+     */
+    void TransformStore::release(Handle handle) {
+        this->handleLive[handle] = 0;
+        this->releasedHandles.push_back(handle);
+        this->hierarchyDirty = true;
+    }
+
+    void TransformStore::setParent(Handle handle, Handle parent) {
+        if (this->handleParents[handle] == parent) return;
+        UInt32 index = this->handleIndices[handle];
+        this->worldDirty[index] = 1;
+        this->inverseWorldDirty[index] = 1;
+        this->handleParents[handle] = parent;
+        this->hierarchyDirty = true;
+    }
+
+    TransformStore::Handle TransformStore::getParent(Handle handle) const {
+        return this->handleParents[handle];
+    }
+
+    /*
+     * Replace the local matrix of a transform, which invalidates the world matrices of the
+     * transform and its descendants.
+     */
+    void TransformStore::setLocalMatrix(Handle handle, const Matrix4x4& localMatrix) {
+        this->markWorldMatrixDirty(handle);
+        this->localMatrices[this->handleIndices[handle]].copy(localMatrix);
+    }
+
+    const Matrix4x4& TransformStore::getConstLocalMatrix(Handle handle) const {
+        return this->localMatrices[this->handleIndices[handle]];
+    }
+
+    const Matrix4x4& TransformStore::getWorldMatrix(Handle handle) {
+        this->updateWorldMatrix(handle);
+        return this->worldMatrices[this->handleIndices[handle]];
+    }
+
+    const Matrix4x4& TransformStore::getInverseWorldMatrix(Handle handle) {
+        this->updateWorldMatrix(handle);
+        UInt32 index = this->handleIndices[handle];
+        if (this->inverseWorldDirty[index]) {
+            Matrix4x4::invert(this->worldMatrices[index].getConstData(), this->inverseWorldMatrices[index].getData());
+            this->inverseWorldDirty[index] = 0;
+        }
+        return this->inverseWorldMatrices[index];
+    }
+
+    /*
+     * Copy the world matrix of a transform into [dest] without re-linearizing the hierarchy. If it
+     * is linearized, the cached matrix is brought up to date as usual; otherwise the matrix is
+     * concatenated from the local matrices up the parent chain. Building a hierarchy one node at
+     * a time thus stays linear, and the store is linearized once, by the next full update.
+     */
+    void TransformStore::copyWorldMatrix(Handle handle, Matrix4x4& dest) {
+        UInt32 index = this->handleIndices[handle];
+        if (!this->hierarchyDirty) {
+            this->updateWorldMatrixAtIndex(index);
+            dest.copy(this->worldMatrices[index]);
+            return;
+        }
+
+        // released handles aren't recycled before the next linearize(), and a transform whose
+        // parent was released becomes a root there
+        dest.copy(this->localMatrices[index]);
+        for (Handle parent = this->handleParents[handle]; parent != InvalidHandle && this->handleLive[parent]; parent = this->handleParents[parent]) {
+            dest.preMultiply(this->localMatrices[this->handleIndices[parent]]);
+        }
+    }
+
+    /*
+     * Flag the world matrix of a transform and all of its descendants as out of date. While the
+     * hierarchy is linearized the descendants form a contiguous range; otherwise only the transform
+     * itself is flagged and linearize() pushes the flag down to its descendants.
+     */
+    void TransformStore::markWorldMatrixDirty(Handle handle) {
+        UInt32 index = this->handleIndices[handle];
+        if (this->hierarchyDirty) {
+            this->worldDirty[index] = 1;
+            this->inverseWorldDirty[index] = 1;
+            return;
+        }
+        if (this->worldDirty[index]) return;
+        UInt32 end = index + this->subtreeSizes[index];
+        for (UInt32 i = index; i < end; i++) {
+            this->worldDirty[i] = 1;
+            this->inverseWorldDirty[i] = 1;
+        }
+    }
+
+    Bool TransformStore::isWorldMatrixDirty(Handle handle) const {
+        return this->worldDirty[this->handleIndices[handle]] != 0;
+    }
+
+    void TransformStore::updateWorldMatrix(Handle handle) {
+        if (this->hierarchyDirty) this->linearize();
+        this->updateWorldMatrixAtIndex(this->handleIndices[handle]);
+    }
+
+    /*
+     * Bring every world matrix up to date in one forward pass; since parents precede their
+     * children, a parent's world matrix is always final by the time its children need it.
+     */
+    void TransformStore::updateWorldMatrices() {
+        if (this->hierarchyDirty) this->linearize();
+        UInt32 count = (UInt32)this->indexHandles.size();
+        for (UInt32 i = 0; i < count; i++) {
+            if (this->worldDirty[i]) this->updateWorldMatrixAtIndexUnchecked(i);
+        }
+    }
+
+    /*
+     * Same result as updateWorldMatrices(), with the work split across [threadPool]. A pre-order
+     * walk partitions the arrays into subtrees small enough to form a task; any transform whose
+     * subtree is too large is updated serially first and the walk descends into its children.
+     * Adjacent small subtrees are merged into one range. Every range's external parents are then
+     * serial transforms, so the ranges can be processed independently.
+     */
+    void TransformStore::updateWorldMatrices(ThreadPool& threadPool) {
+        if (this->hierarchyDirty) this->linearize();
+        UInt32 count = (UInt32)this->indexHandles.size();
+        UInt32 concurrency = threadPool.getConcurrency();
+        if (count < ParallelUpdateThreshold || concurrency <= 1) {
+            this->updateWorldMatrices();
+            return;
+        }
+
+        UInt32 maxRangeSize = count / (concurrency * 4);
+        if (maxRangeSize < MinParallelRangeSize) maxRangeSize = MinParallelRangeSize;
+
+        this->serialIndices.resize(0);
+        this->rangeStarts.resize(0);
+        this->rangeEnds.resize(0);
+        UInt32 i = 0;
+        while (i < count) {
+            UInt32 subtreeSize = this->subtreeSizes[i];
+            if (subtreeSize > maxRangeSize) {
+                this->serialIndices.push_back(i);
+                i++;
+                continue;
+            }
+            UInt32 rangeCount = (UInt32)this->rangeStarts.size();
+            if (rangeCount > 0 && this->rangeEnds[rangeCount - 1] == i &&
+                i + subtreeSize - this->rangeStarts[rangeCount - 1] <= maxRangeSize) {
+                this->rangeEnds[rangeCount - 1] = i + subtreeSize;
+            }
+            else {
+                this->rangeStarts.push_back(i);
+                this->rangeEnds.push_back(i + subtreeSize);
+            }
+            i += subtreeSize;
+        }
+
+        for (UInt32 index : this->serialIndices) {
+            if (this->worldDirty[index]) this->updateWorldMatrixAtIndexUnchecked(index);
+        }
+
+        threadPool.parallelFor((UInt32)this->rangeStarts.size(), [this](UInt32 range) {
+            UInt32 end = this->rangeEnds[range];
+            for (UInt32 index = this->rangeStarts[range]; index < end; index++) {
+                if (this->worldDirty[index]) this->updateWorldMatrixAtIndexUnchecked(index);
+            }
+        });
+    }
+
+    UInt32 TransformStore::size() const {
+        return (UInt32)this->indexHandles.size() - (UInt32)this->releasedHandles.size();
+    }
+
+    /*
+     * Number of transforms in the hierarchy rooted at a transform, itself included.
+     */
+    UInt32 TransformStore::getSubtreeSize(Handle handle) {
+        if (this->hierarchyDirty) this->linearize();
+        return this->subtreeSizes[this->handleIndices[handle]];
+    }
+
+    void TransformStore::updateWorldMatrixAtIndex(UInt32 index) {
+        if (!this->worldDirty[index]) return;
+        UInt32 parentIndex = this->parentIndices[index];
+        if (parentIndex != InvalidIndex) this->updateWorldMatrixAtIndex(parentIndex);
+        this->updateWorldMatrixAtIndexUnchecked(index);
+    }
+
+    void TransformStore::updateWorldMatrixAtIndexUnchecked(UInt32 index) {
+        UInt32 parentIndex = this->parentIndices[index];
+        if (parentIndex != InvalidIndex) {
+            Matrix4x4::multiplyMM(this->worldMatrices[parentIndex].getConstData(), this->localMatrices[index].getConstData(),
+                                  this->worldMatrices[index].getData());
+        }
+        else {
+            this->worldMatrices[index].copy(this->localMatrices[index]);
+        }
+        this->worldDirty[index] = 0;
+        this->inverseWorldDirty[index] = 1;
+    }
+
+    /*
+     * Re-sort the index-ordered arrays into pre-order (parent before child, each subtree
+     * contiguous), dropping released slots. Transforms whose parent was released become roots.
+     * Siblings keep their previous relative order, so the result is deterministic.
+     */
+    void TransformStore::linearize() {
+        UInt32 oldCount = (UInt32)this->indexHandles.size();
+        UInt32 handleCount = (UInt32)this->handleIndices.size();
+
+        std::vector<Handle> roots;
+        std::vector<Handle> firstChild(handleCount, InvalidHandle);
+        std::vector<Handle> nextSibling(handleCount, InvalidHandle);
+
+        // children are prepended, so each child list ends up in reverse index order; pushing
+        // that list onto the traversal stack below pops the children back out in index order
+        for (UInt32 i = 0; i < oldCount; i++) {
+            Handle handle = this->indexHandles[i];
+            if (!this->handleLive[handle]) continue;
+            Handle parent = this->handleParents[handle];
+            if (parent != InvalidHandle && !this->handleLive[parent]) {
+                parent = InvalidHandle;
+                this->handleParents[handle] = InvalidHandle;
+                this->worldDirty[i] = 1;
+                this->inverseWorldDirty[i] = 1;
+            }
+            if (parent == InvalidHandle) {
+                roots.push_back(handle);
+            }
+            else {
+                nextSibling[handle] = firstChild[parent];
+                firstChild[parent] = handle;
+            }
+        }
+
+        std::vector<Handle> order;
+        std::vector<Handle> stack;
+        order.reserve(oldCount);
+        for (Handle root : roots) {
+            stack.push_back(root);
+            while (stack.size() > 0) {
+                Handle handle = stack.back();
+                stack.pop_back();
+                order.push_back(handle);
+                for (Handle child = firstChild[handle]; child != InvalidHandle; child = nextSibling[child]) {
+                    stack.push_back(child);
+                }
+            }
+        }
+
+        UInt32 newCount = (UInt32)order.size();
+        std::vector<Matrix4x4> newLocalMatrices;
+        std::vector<Matrix4x4> newWorldMatrices;
+        std::vector<Matrix4x4> newInverseWorldMatrices;
+        std::vector<UInt32> newParentIndices(newCount, InvalidIndex);
+        std::vector<UInt32> newSubtreeSizes(newCount, 1);
+        std::vector<UInt8> newWorldDirty(newCount, 0);
+        std::vector<UInt8> newInverseWorldDirty(newCount, 0);
+        newLocalMatrices.reserve(newCount);
+        newWorldMatrices.reserve(newCount);
+        newInverseWorldMatrices.reserve(newCount);
+
+        for (UInt32 i = 0; i < newCount; i++) {
+            Handle handle = order[i];
+            UInt32 oldIndex = this->handleIndices[handle];
+            newLocalMatrices.push_back(this->localMatrices[oldIndex]);
+            newWorldMatrices.push_back(this->worldMatrices[oldIndex]);
+            newInverseWorldMatrices.push_back(this->inverseWorldMatrices[oldIndex]);
+            newWorldDirty[i] = this->worldDirty[oldIndex];
+            newInverseWorldDirty[i] = this->inverseWorldDirty[oldIndex];
+
+            // the parent was emitted earlier, so its handle already maps to its new index
+            Handle parent = this->handleParents[handle];
+            if (parent != InvalidHandle) {
+                UInt32 parentIndex = this->handleIndices[parent];
+                newParentIndices[i] = parentIndex;
+                if (newWorldDirty[parentIndex]) {
+                    newWorldDirty[i] = 1;
+                    newInverseWorldDirty[i] = 1;
+                }
+            }
+            this->handleIndices[handle] = i;
+        }
+
+        for (UInt32 i = newCount; i > 1; i--) {
+            UInt32 parentIndex = newParentIndices[i - 1];
+            if (parentIndex != InvalidIndex) newSubtreeSizes[parentIndex] += newSubtreeSizes[i - 1];
+        }
+
+        for (Handle handle : this->releasedHandles) {
+            this->handleIndices[handle] = InvalidIndex;
+            this->handleParents[handle] = InvalidHandle;
+            this->freeHandles.push_back(handle);
+        }
+        this->releasedHandles.clear();
+
+        this->localMatrices.swap(newLocalMatrices);
+        this->worldMatrices.swap(newWorldMatrices);
+        this->inverseWorldMatrices.swap(newInverseWorldMatrices);
+        this->parentIndices.swap(newParentIndices);
+        this->subtreeSizes.swap(newSubtreeSizes);
+        this->worldDirty.swap(newWorldDirty);
+        this->inverseWorldDirty.swap(newInverseWorldDirty);
+        this->indexHandles.swap(order);
+        this->hierarchyDirty = false;
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include "../common/types.h"
+#include "../math/Matrix4x4.h"
+
+namespace Core {
+
+    // forward declarations
+    class ThreadPool;
+
+    /*
+     * Contiguous storage for the matrices of every Transform in the engine. Local, world and
+     * inverse world matrices, parent indices and dirty flags are kept in parallel arrays that
+     * are sorted so a parent always precedes its children (pre-order), which means:
+     *
+     *   - the world matrices of the whole hierarchy can be brought up to date with a single
+     *     linear pass (updateWorldMatrices()),
+     *   - the descendants of the transform at index i occupy [i, i + subtreeSize[i]), so
+     *     invalidating a subtree is a contiguous fill.
+     *
+     * Transforms refer to their slot through a stable Handle; the index a handle maps to changes
+     * whenever the hierarchy is re-linearized, so references returned by the accessors below are
+     * only valid until the next hierarchy change or allocation.
+     */
+    class TransformStore {
+    public:
+        typedef UInt32 Handle;
+        static const Handle InvalidHandle;
+
+        TransformStore();
+        ~TransformStore();
+
+        Handle allocate(const Matrix4x4& localMatrix);
+        void release(Handle handle);
+
+        void setParent(Handle handle, Handle parent);
+        Handle getParent(Handle handle) const;
+
+        void setLocalMatrix(Handle handle, const Matrix4x4& localMatrix);
+        const Matrix4x4& getConstLocalMatrix(Handle handle) const;
+        const Matrix4x4& getWorldMatrix(Handle handle);
+        const Matrix4x4& getInverseWorldMatrix(Handle handle);
+        void copyWorldMatrix(Handle handle, Matrix4x4& dest);
+
+        void markWorldMatrixDirty(Handle handle);
+        Bool isWorldMatrixDirty(Handle handle) const;
+        void updateWorldMatrix(Handle handle);
+        void updateWorldMatrices();
+        void updateWorldMatrices(ThreadPool& threadPool);
+
+        UInt32 size() const;
+        UInt32 getSubtreeSize(Handle handle);
+
+    private:
+        static const UInt32 InvalidIndex;
+        static const UInt32 ParallelUpdateThreshold;
+        static const UInt32 MinParallelRangeSize;
+
+        void linearize();
+        void updateWorldMatrixAtIndex(UInt32 index);
+        void updateWorldMatrixAtIndexUnchecked(UInt32 index);
+
+        // handle-indexed: stable for the lifetime of a transform
+        std::vector<UInt32> handleIndices;
+        std::vector<Handle> handleParents;
+        std::vector<UInt8> handleLive;
+        std::vector<Handle> freeHandles;
+        std::vector<Handle> releasedHandles;
+        Bool hierarchyDirty;
+
+        // index-ordered (parent before child)
+        std::vector<Matrix4x4> localMatrices;
+        std::vector<Matrix4x4> worldMatrices;
+        std::vector<Matrix4x4> inverseWorldMatrices;
+        std::vector<UInt32> parentIndices;
+        std::vector<UInt32> subtreeSizes;
+        std::vector<UInt8> worldDirty;
+        std::vector<UInt8> inverseWorldDirty;
+        std::vector<Handle> indexHandles;
+
+        // scratch space for the parallel update, kept to avoid per-frame allocation
+        std::vector<UInt32> serialIndices;
+        std::vector<UInt32> rangeStarts;
+        std::vector<UInt32> rangeEnds;
+    };
+}
@@ -0,0 +1,156 @@
+#include <exception>
+
+#include "ThreadPool.h"
+
+namespace Core {
+
+    /*
+     * Default to one worker per hardware thread, minus the one calling parallelFor().
+     */
+    ThreadPool::ThreadPool(): queuedTaskCount(0), nextQueue(0), shuttingDown(false) {
+        UInt32 hardwareThreads = std::thread::hardware_concurrency();
+        this->start(hardwareThreads > 1 ? hardwareThreads - 1 : 0);
+    }
+
+    ThreadPool::ThreadPool(UInt32 workerCount): queuedTaskCount(0), nextQueue(0), shuttingDown(false) {
+        this->start(workerCount);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->wakeMutex);
+            this->shuttingDown = true;
+        }
+        this->wakeCondition.notify_all();
+        for (std::thread& worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    UInt32 ThreadPool::getConcurrency() const {
+        return (UInt32)this->workers.size() + 1;
+    }
+
+    /*
+     * Invoke [func] for every index in [0, count), spread across the workers and the calling
+     * thread. Nothing is known about which thread runs which index, so [func] must only touch
+     * state owned by that index. The workers only get helper tasks that claim indices of this
+     * call; the caller claims indices as well and then waits for the ones still running rather
+     * than picking up unrelated tasks, so a call never ends up running another caller's long work.
+     * If [func] throws, the remaining indices still run and the first exception is rethrown here.
+     */
+    void ThreadPool::parallelFor(UInt32 count, std::function<void(UInt32)> func) {
+        if (count == 0) return;
+        if (this->workers.size() == 0 || count == 1) {
+            for (UInt32 i = 0; i < count; i++) func(i);
+            return;
+        }
+
+        // helper tasks can still be queued after this call returns, once every index has been
+        // claimed, so they share ownership of the batch; they never call [func] then
+        std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+        batch->func = func;
+        batch->count = count;
+        batch->next = 0;
+        batch->finished = 0;
+
+        UInt32 queueCount = (UInt32)this->queues.size();
+        UInt32 helperCount = count - 1 < queueCount ? count - 1 : queueCount;
+        for (UInt32 i = 0; i < helperCount; i++) {
+            UInt32 queueIndex = this->nextQueue.fetch_add(1) % queueCount;
+            this->push(queueIndex, [batch]() {
+                ThreadPool::runBatch(*batch);
+            });
+        }
+        this->wakeCondition.notify_all();
+
+        ThreadPool::runBatch(*batch);
+        while (batch->finished.load() < count) {
+            std::this_thread::yield();
+        }
+        if (batch->error) std::rethrow_exception(batch->error);
+    }
+
+    /*
+     * Claim and run indices of [batch] until none are left.
+     */
+    void ThreadPool::runBatch(Batch& batch) {
+        while (true) {
+            UInt32 i = batch.next.fetch_add(1);
+            if (i >= batch.count) return;
+            try {
+                batch.func(i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(batch.errorMutex);
+                if (!batch.error) batch.error = std::current_exception();
+            }
+            batch.finished.fetch_add(1);
+        }
+    }
+
+    void ThreadPool::start(UInt32 workerCount) {
+        for (UInt32 i = 0; i < workerCount; i++) {
+            this->queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+        }
+        for (UInt32 i = 0; i < workerCount; i++) {
+            this->workers.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+        }
+    }
+
+    void ThreadPool::workerLoop(UInt32 queueIndex) {
+        while (true) {
+            if (this->tryRunTask(queueIndex)) continue;
+            std::unique_lock<std::mutex> lock(this->wakeMutex);
+            this->wakeCondition.wait(lock, [this]() {
+                return this->shuttingDown || this->queuedTaskCount.load() > 0;
+            });
+            if (this->shuttingDown) return;
+        }
+    }
+
+    void ThreadPool::push(UInt32 queueIndex, Task task) {
+        TaskQueue& queue = *this->queues[queueIndex];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(task);
+        }
+        {
+            // taken so a worker cannot miss the wake-up between its empty check and its wait
+            std::lock_guard<std::mutex> lock(this->wakeMutex);
+            this->queuedTaskCount.fetch_add(1);
+        }
+    }
+
+    /*
+     * Run one task, preferring the back of [queueIndex]'s own deque and otherwise stealing from
+     * the front of the others. Returns false if every deque was empty.
+     */
+    Bool ThreadPool::tryRunTask(UInt32 queueIndex) {
+        UInt32 queueCount = (UInt32)this->queues.size();
+        Task task;
+        Bool found = false;
+        {
+            TaskQueue& own = *this->queues[queueIndex];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.tasks.size() > 0) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                found = true;
+            }
+        }
+        for (UInt32 i = 1; i < queueCount && !found; i++) {
+            TaskQueue& victim = *this->queues[(queueIndex + i) % queueCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.size() > 0) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                found = true;
+            }
+        }
+        if (!found) return false;
+        this->queuedTaskCount.fetch_sub(1);
+        task();
+        return true;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../common/types.h"
+
+namespace Core {
+
+    /*
+     * Fixed set of worker threads, each with its own task deque. A worker pops from the back of
+     * its own deque and, when that runs dry, steals from the front of the others. The thread that
+     * calls parallelFor() takes part in its own batch of iterations only, never in other callers'
+     * work, and returns once every iteration of the batch is done.
+     */
+    class ThreadPool {
+    public:
+        typedef std::function<void()> Task;
+
+        ThreadPool();
+        explicit ThreadPool(UInt32 workerCount);
+        ~ThreadPool();
+
+        UInt32 getConcurrency() const;
+        void parallelFor(UInt32 count, std::function<void(UInt32)> func);
+
+    private:
+        class TaskQueue {
+        public:
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        // the iterations of one parallelFor() call, claimed one at a time through [next]
+        class Batch {
+        public:
+            std::function<void(UInt32)> func;
+            UInt32 count;
+            std::atomic<UInt32> next;
+            std::atomic<UInt32> finished;
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        void start(UInt32 workerCount);
+        void workerLoop(UInt32 queueIndex);
+        void push(UInt32 queueIndex, Task task);
+        Bool tryRunTask(UInt32 queueIndex);
+        static void runBatch(Batch& batch);
+
+        std::vector<std::unique_ptr<TaskQueue>> queues;
+        std::vector<std::thread> workers;
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        std::atomic<UInt32> queuedTaskCount;
+        std::atomic<UInt32> nextQueue;
+        Bool shuttingDown;
+    };
+}